@@ -0,0 +1,519 @@
+/*
+  ================================================================================
+  AxBits: Bit-Packed Boolean Matrices (STB-Style Single-Header Library)
+  ================================================================================
+  - AxBitMatrix stores one bit per entry, 64 per word, rows padded to whole
+  cache lines (8 words). Padding bits are always zero.
+  - Element-wise AND / OR / XOR / NOT run word-wise and vectorize.
+  - Products: the boolean product (OR of ANDs) and the intersection-count
+  product |a_i & b_j| used for Jaccard-style similarity, which uses
+  AVX-512 VPOPCNTDQ when available and the scalar popcount otherwise.
+  - Conversions to and from AxMatrix of any dtype (nonzero means set).
+  - Work is split across the thread pool by rows.
+  - Dependencies:
+  - "axmatrix.h"    (AxMatrix, AxTranspose; pulls in axalloc.h and axthread.h)
+  - <immintrin.h>   (AVX-512 popcount, when enabled)
+  ================================================================================
+  USAGE:
+  1) In **one** C or C++ file where you want the implementation, do:
+  #define AXBITS_IMPLEMENTATION
+  #include "axbits.h"
+
+  2) In any other files that need to use the library, just include "axbits.h"
+  without defining AXBITS_IMPLEMENTATION.
+  ================================================================================
+*/
+
+#ifndef AXBITS_H_
+#define AXBITS_H_
+
+#include "axmatrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct AxBitMatrix {
+    musz rows;
+    musz cols;
+    musz stride; // 64-bit words between rows, a multiple of 8
+    mu64* data;
+    bool data_owner; // Whether to free data on destroy
+  } AxBitMatrix;
+
+  // Creation (all bits cleared). A NULL arena falls back to malloc.
+  bool ax_bitmatrix_init(AxBitMatrix* mat, musz rows, musz cols, Arena* arena);
+  AxBitMatrix* ax_bitmatrix_create(musz rows, musz cols, Arena* arena);
+  void ax_bitmatrix_destroy(AxBitMatrix* mat);
+
+  static inline bool ax_bitmatrix_get(const AxBitMatrix* mat, musz i, musz j) {
+    return (mat->data[i * mat->stride + j / 64] >> (j % 64)) & 1;
+  }
+
+  static inline void ax_bitmatrix_set(AxBitMatrix* mat, musz i, musz j, bool value) {
+    mu64* w = &mat->data[i * mat->stride + j / 64];
+    mu64 bit = (mu64)1 << (j % 64);
+    *w = value ? (*w | bit) : (*w & ~bit);
+  }
+
+  // Element-wise logic; `dest` may alias an operand
+  bool ax_bitmatrix_and(AxBitMatrix* dest, const AxBitMatrix* a, const AxBitMatrix* b);
+  bool ax_bitmatrix_or(AxBitMatrix* dest, const AxBitMatrix* a, const AxBitMatrix* b);
+  bool ax_bitmatrix_xor(AxBitMatrix* dest, const AxBitMatrix* a, const AxBitMatrix* b);
+  bool ax_bitmatrix_not(AxBitMatrix* dest, const AxBitMatrix* a);
+
+  // dest bit (i, j) = src(i, j) != 0, for a src of any dtype
+  bool ax_bitmatrix_from_matrix(AxBitMatrix* dest, const AxMatrix* src);
+  // dest(i, j) = 1 or 0, for a dest of any dtype
+  bool ax_matrix_from_bitmatrix(AxMatrix* dest, const AxBitMatrix* src);
+
+  // Set bits per row into `out`, a vector of any dtype with one slot per row
+  bool ax_bitmatrix_row_counts(const AxBitMatrix* a, AxMatrix* out);
+
+  // c (i32, rows(a) x rows(b)) = |a_i & b_j|, the set intersection sizes of
+  // every pair of rows (a * b^T over the integers). `a` and `b` need the same
+  // number of columns. Jaccard similarity is c / (|a_i| + |b_j| - c).
+  bool ax_bitmatrix_intersect(const AxBitMatrix* a, const AxBitMatrix* b, AxMatrix* c);
+
+  // Boolean product c = a * op(b) (OR of ANDs). With AX_NO_TRANS every set
+  // bit (i, k) of `a` ORs row k of `b` into row i of `c`; with AX_TRANS
+  // c(i, j) tests a_i & b_j for any set bit. `c` must not alias `a` or `b`.
+  bool ax_bitmatrix_multiply(const AxBitMatrix* a, const AxBitMatrix* b, AxTranspose tb,
+                             AxBitMatrix* c);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+   ------------------------------------------------------------------------------
+   Implementation
+   ------------------------------------------------------------------------------
+*/
+#ifdef AXBITS_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Words per parallel chunk of the word-wise kernels (divided by the row stride)
+#define AX_BITS_GRAIN_WORDS 65536
+
+bool ax_bitmatrix_init(AxBitMatrix* mat, musz rows, musz cols, Arena* arena) {
+  musz stride = ((cols + 63) / 64 + 7) & ~(musz)7;
+  musz size = rows * stride * sizeof(mu64);
+  if (arena) {
+    mat->data = (mu64*)ax_alloc(arena, size ? size : 1);
+  } else {
+    AX_LOG(AX_LOG_INFO, "Arena is NULL, using malloc");
+    AX_LOG(AX_LOG_WARN, "DO NOT FORGET TO CALL ax_bitmatrix_destroy");
+    mat->data = (mu64*)malloc(size ? size : 1);
+  }
+  if (!mat->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_init: failed to allocate data");
+    return false;
+  }
+  memset(mat->data, 0, size);
+  mat->rows = rows;
+  mat->cols = cols;
+  mat->stride = stride;
+  mat->data_owner = (arena == NULL);
+  return true;
+}
+
+AxBitMatrix* ax_bitmatrix_create(musz rows, musz cols, Arena* arena) {
+  AxBitMatrix* mat;
+  if (arena) {
+    mat = (AxBitMatrix*)ax_alloc(arena, sizeof(AxBitMatrix));
+  } else {
+    mat = (AxBitMatrix*)malloc(sizeof(AxBitMatrix));
+  }
+  if (!mat) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_create: failed to allocate matrix struct");
+    return NULL;
+  }
+  if (!ax_bitmatrix_init(mat, rows, cols, arena)) {
+    if (!arena) free(mat);
+    return NULL;
+  }
+  return mat;
+}
+
+void ax_bitmatrix_destroy(AxBitMatrix* mat) {
+  if (!mat) return;
+  if (mat->data_owner) free(mat->data);
+  mat->data = NULL;
+  mat->rows = 0;
+  mat->cols = 0;
+  mat->stride = 0;
+}
+
+static inline mu64 ax__popcount64(mu64 x) {
+  return (mu64)__builtin_popcountll(x);
+}
+
+// Mask of the valid bits in the last word of a row
+static inline mu64 ax__bits_tail_mask(musz cols) {
+  return (cols % 64) ? (((mu64)1 << (cols % 64)) - 1) : ~(mu64)0;
+}
+
+typedef enum AxBitOp {
+  AX_BIT_AND,
+  AX_BIT_OR,
+  AX_BIT_XOR,
+  AX_BIT_NOT
+} AxBitOp;
+
+typedef struct AxBitTask {
+  AxBitOp op;
+  AxBitMatrix* dest;
+  const AxBitMatrix* a;
+  const AxBitMatrix* b;
+} AxBitTask;
+
+static void ax__bits_logic_task(void* ctx, musz begin, musz end) {
+  const AxBitTask* t = (const AxBitTask*)ctx;
+  musz nw = (t->a->cols + 63) / 64;
+  mu64 tail = ax__bits_tail_mask(t->a->cols);
+  for (musz i = begin; i < end; i++) {
+    mu64* d = t->dest->data + i * t->dest->stride;
+    const mu64* x = t->a->data + i * t->a->stride;
+    const mu64* y = t->b ? t->b->data + i * t->b->stride : NULL;
+    switch (t->op) {
+    case AX_BIT_AND: for (musz w = 0; w < nw; w++) d[w] = x[w] & y[w]; break;
+    case AX_BIT_OR:  for (musz w = 0; w < nw; w++) d[w] = x[w] | y[w]; break;
+    case AX_BIT_XOR: for (musz w = 0; w < nw; w++) d[w] = x[w] ^ y[w]; break;
+    case AX_BIT_NOT:
+      for (musz w = 0; w < nw; w++) d[w] = ~x[w];
+      if (nw) d[nw - 1] &= tail; // Keep the padding clear
+      break;
+    }
+  }
+}
+
+static bool ax__bits_logic(const char* fn, AxBitOp op, AxBitMatrix* dest,
+                           const AxBitMatrix* a, const AxBitMatrix* b) {
+  if (!dest || !a || !dest->data || !a->data || (op != AX_BIT_NOT && (!b || !b->data))) {
+    AX_LOG(AX_LOG_FATAL, "%s: null matrix", fn);
+    return false;
+  }
+  if (dest->rows != a->rows || dest->cols != a->cols ||
+      (b && (b->rows != a->rows || b->cols != a->cols))) {
+    AX_LOG(AX_LOG_FATAL, "%s: dimension mismatch", fn);
+    return false;
+  }
+  AxBitTask t = { op, dest, a, b };
+  ax_parallel_for(a->rows, AX_BITS_GRAIN_WORDS / (a->stride + 1) + 1, ax__bits_logic_task, &t);
+  return true;
+}
+
+bool ax_bitmatrix_and(AxBitMatrix* dest, const AxBitMatrix* a, const AxBitMatrix* b) {
+  return ax__bits_logic("ax_bitmatrix_and", AX_BIT_AND, dest, a, b);
+}
+
+bool ax_bitmatrix_or(AxBitMatrix* dest, const AxBitMatrix* a, const AxBitMatrix* b) {
+  return ax__bits_logic("ax_bitmatrix_or", AX_BIT_OR, dest, a, b);
+}
+
+bool ax_bitmatrix_xor(AxBitMatrix* dest, const AxBitMatrix* a, const AxBitMatrix* b) {
+  return ax__bits_logic("ax_bitmatrix_xor", AX_BIT_XOR, dest, a, b);
+}
+
+bool ax_bitmatrix_not(AxBitMatrix* dest, const AxBitMatrix* a) {
+  return ax__bits_logic("ax_bitmatrix_not", AX_BIT_NOT, dest, a, NULL);
+}
+
+// Conversions. Half-precision values are nonzero unless every bit but the
+// sign is clear.
+#define AX__BITS_DEFINE_CONVERT(T, s, ct)                               \
+  static void ax__bits_pack_##s(const ct* x, musz n, mu64* d) {         \
+    for (musz w = 0; w * 64 < n; w++) {                                 \
+      musz len = (n - w * 64 < 64) ? n - w * 64 : 64;                   \
+      mu64 bits = 0;                                                    \
+      for (musz b = 0; b < len; b++) bits |= (mu64)(x[w * 64 + b] != 0) << b; \
+      d[w] = bits;                                                      \
+    }                                                                   \
+  }                                                                     \
+  static void ax__bits_unpack_##s(const mu64* d, musz n, ct* x) {       \
+    for (musz j = 0; j < n; j++) x[j] = (ct)((d[j / 64] >> (j % 64)) & 1); \
+  }
+
+AX_DTYPE_LIST(AX__BITS_DEFINE_CONVERT)
+#undef AX__BITS_DEFINE_CONVERT
+
+static void ax__bits_pack_half(const mu16* x, musz n, mu64* d) {
+  for (musz w = 0; w * 64 < n; w++) {
+    musz len = (n - w * 64 < 64) ? n - w * 64 : 64;
+    mu64 bits = 0;
+    for (musz b = 0; b < len; b++) bits |= (mu64)((x[w * 64 + b] & 0x7fff) != 0) << b;
+    d[w] = bits;
+  }
+}
+
+static void ax__bits_unpack_half(const mu64* d, musz n, mu16 one, mu16* x) {
+  for (musz j = 0; j < n; j++) x[j] = ((d[j / 64] >> (j % 64)) & 1) ? one : 0;
+}
+
+typedef struct AxBitConvertTask {
+  AxBitMatrix* bits;
+  AxMatrix* mat;
+} AxBitConvertTask;
+
+static void ax__bits_from_matrix_task(void* ctx, musz begin, musz end) {
+  const AxBitConvertTask* t = (const AxBitConvertTask*)ctx;
+  musz esz = ax_dtype_size(t->mat->dtype);
+  for (musz i = begin; i < end; i++) {
+    const void* x = (const mu8*)t->mat->data + i * t->mat->stride * esz;
+    mu64* d = t->bits->data + i * t->bits->stride;
+    switch (t->mat->dtype) {
+#define AX__BITS_CASE(T, s, ct) case AX_##T: ax__bits_pack_##s((const ct*)x, t->mat->cols, d); break;
+      AX_DTYPE_LIST(AX__BITS_CASE)
+#undef AX__BITS_CASE
+    case AX_F16:
+    case AX_BF16:
+      ax__bits_pack_half((const mu16*)x, t->mat->cols, d);
+      break;
+    }
+  }
+}
+
+static void ax__matrix_from_bits_task(void* ctx, musz begin, musz end) {
+  const AxBitConvertTask* t = (const AxBitConvertTask*)ctx;
+  musz esz = ax_dtype_size(t->mat->dtype);
+  for (musz i = begin; i < end; i++) {
+    void* x = (mu8*)t->mat->data + i * t->mat->stride * esz;
+    const mu64* d = t->bits->data + i * t->bits->stride;
+    switch (t->mat->dtype) {
+#define AX__BITS_CASE(T, s, ct) case AX_##T: ax__bits_unpack_##s(d, t->mat->cols, (ct*)x); break;
+      AX_DTYPE_LIST(AX__BITS_CASE)
+#undef AX__BITS_CASE
+    case AX_F16:
+      ax__bits_unpack_half(d, t->mat->cols, ax_f32_to_f16(1.0f), (mu16*)x);
+      break;
+    case AX_BF16:
+      ax__bits_unpack_half(d, t->mat->cols, ax_f32_to_bf16(1.0f), (mu16*)x);
+      break;
+    }
+  }
+}
+
+static bool ax__bits_convert_check(const char* fn, const AxBitMatrix* bits, const AxMatrix* mat) {
+  if (!bits || !mat || !bits->data || !mat->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null matrix", fn);
+    return false;
+  }
+  if (bits->rows != mat->rows || bits->cols != mat->cols) {
+    AX_LOG(AX_LOG_FATAL, "%s: dimension mismatch", fn);
+    return false;
+  }
+  return true;
+}
+
+bool ax_bitmatrix_from_matrix(AxBitMatrix* dest, const AxMatrix* src) {
+  if (!ax__bits_convert_check("ax_bitmatrix_from_matrix", dest, src)) return false;
+  // The row kernels read through pointers, so column-strided views are staged
+  AxMatrix ss;
+  AxBitConvertTask t = { dest, ax__unit_stage(src, &ss, true) };
+  if (!t.mat) return false;
+  ax_parallel_for(src->rows, 65536 / (src->cols + 1) + 1, ax__bits_from_matrix_task, &t);
+  ax__unit_release(&ss, NULL);
+  return true;
+}
+
+bool ax_matrix_from_bitmatrix(AxMatrix* dest, const AxBitMatrix* src) {
+  if (!ax__bits_convert_check("ax_matrix_from_bitmatrix", src, dest)) return false;
+  AxMatrix ds;
+  AxBitConvertTask t = { (AxBitMatrix*)src, ax__unit_stage(dest, &ds, false) };
+  if (!t.mat) return false;
+  ax_parallel_for(src->rows, 65536 / (src->cols + 1) + 1, ax__matrix_from_bits_task, &t);
+  ax__unit_release(&ds, dest);
+  return true;
+}
+
+bool ax_bitmatrix_row_counts(const AxBitMatrix* a, AxMatrix* out) {
+  if (!a || !out || !out->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_row_counts: null matrix");
+    return false;
+  }
+  if (out->rows * out->cols != a->rows || (out->rows != 1 && out->cols != 1)) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_row_counts: output must be a vector of %zu", a->rows);
+    return false;
+  }
+  for (musz i = 0; i < a->rows; i++) {
+    const mu64* x = a->data + i * a->stride;
+    mu64 c = 0;
+    for (musz w = 0; w < a->stride; w++) c += ax__popcount64(x[w]);
+    if (out->rows == 1) ax_matrix_set(out, 0, i, (double)c);
+    else ax_matrix_set(out, i, 0, (double)c);
+  }
+  return true;
+}
+
+// Intersection counts. A 4 x 4 tile of row pairs is accumulated at once, so
+// every loaded word of `a` and `b` is used four times; rows of `b` are taken
+// in L2-sized blocks.
+#define AX_BITS_TILE 4
+#define AX_BITS_BLOCK_BYTES (512 * 1024)
+
+typedef struct AxBitIntersectTask {
+  const AxBitMatrix* a;
+  const AxBitMatrix* b;
+  AxMatrix* c;
+  musz j0, j1; // Current block of rows of b
+} AxBitIntersectTask;
+
+// cnt[r][q] = |a_(i + r) & b_(j + q)| over nw words (a multiple of 8);
+// rows past the end of either operand repeat the last valid one
+static void ax__bits_tile(const mu64* const* x, const mu64* const* y, musz nw,
+                          mu64 cnt[AX_BITS_TILE][AX_BITS_TILE]) {
+  enum { T = AX_BITS_TILE };
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512F__)
+  __m512i acc[T][T];
+  for (int r = 0; r < T; r++) {
+    for (int q = 0; q < T; q++) acc[r][q] = _mm512_setzero_si512();
+  }
+  for (musz w = 0; w < nw; w += 8) {
+    __m512i xv[T], yv[T];
+    for (int r = 0; r < T; r++) xv[r] = _mm512_loadu_si512((const void*)(x[r] + w));
+    for (int q = 0; q < T; q++) yv[q] = _mm512_loadu_si512((const void*)(y[q] + w));
+    for (int r = 0; r < T; r++) {
+      for (int q = 0; q < T; q++) {
+        acc[r][q] = _mm512_add_epi64(acc[r][q], _mm512_popcnt_epi64(_mm512_and_si512(xv[r], yv[q])));
+      }
+    }
+  }
+  for (int r = 0; r < T; r++) {
+    for (int q = 0; q < T; q++) cnt[r][q] = (mu64)_mm512_reduce_add_epi64(acc[r][q]);
+  }
+#else
+  for (int r = 0; r < T; r++) {
+    for (int q = 0; q < T; q++) cnt[r][q] = 0;
+  }
+  for (musz w = 0; w < nw; w++) {
+    for (int r = 0; r < T; r++) {
+      for (int q = 0; q < T; q++) cnt[r][q] += ax__popcount64(x[r][w] & y[q][w]);
+    }
+  }
+#endif
+}
+
+static void ax__bits_intersect_task(void* ctx, musz begin, musz end) {
+  const AxBitIntersectTask* t = (const AxBitIntersectTask*)ctx;
+  enum { T = AX_BITS_TILE };
+  const AxBitMatrix* a = t->a;
+  const AxBitMatrix* b = t->b;
+  musz nw = ((a->cols + 63) / 64 + 7) & ~(musz)7;
+  mu64 cnt[T][T];
+  for (musz ib = begin; ib < end; ib++) {
+    musz i = ib * T;
+    const mu64* x[T];
+    for (int r = 0; r < T; r++) {
+      musz ir = (i + (musz)r < a->rows) ? i + (musz)r : a->rows - 1;
+      x[r] = a->data + ir * a->stride;
+    }
+    for (musz j = t->j0; j < t->j1; j += T) {
+      const mu64* y[T];
+      for (int q = 0; q < T; q++) {
+        musz jq = (j + (musz)q < t->j1) ? j + (musz)q : t->j1 - 1;
+        y[q] = b->data + jq * b->stride;
+      }
+      ax__bits_tile(x, y, nw, cnt);
+      for (musz r = 0; r < T && i + r < a->rows; r++) {
+        mi32* ci = (mi32*)t->c->data + (i + r) * t->c->stride;
+        for (musz q = 0; q < T && j + q < t->j1; q++) ci[(j + q) * t->c->col_stride] = (mi32)cnt[r][q];
+      }
+    }
+  }
+}
+
+bool ax_bitmatrix_intersect(const AxBitMatrix* a, const AxBitMatrix* b, AxMatrix* c) {
+  if (!a || !b || !c || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_intersect: null matrix");
+    return false;
+  }
+  if (a->cols != b->cols || c->rows != a->rows || c->cols != b->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_intersect: %zux%zu and %zux%zu into %zux%zu",
+           a->rows, a->cols, b->rows, b->cols, c->rows, c->cols);
+    return false;
+  }
+  if (c->dtype != AX_I32) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_intersect: result dtype is %s, expected i32",
+           ax_dtype_name(c->dtype));
+    return false;
+  }
+  if (a->rows == 0 || b->rows == 0) return true;
+  AxBitIntersectTask t = { a, b, c, 0, 0 };
+  musz block = AX_BITS_BLOCK_BYTES / (b->stride * sizeof(mu64) + 1);
+  block = block < AX_BITS_TILE ? AX_BITS_TILE : block / AX_BITS_TILE * AX_BITS_TILE;
+  musz tiles = (a->rows + AX_BITS_TILE - 1) / AX_BITS_TILE;
+  for (t.j0 = 0; t.j0 < b->rows; t.j0 += block) {
+    t.j1 = (b->rows - t.j0 < block) ? b->rows : t.j0 + block;
+    ax_parallel_for(tiles, 1, ax__bits_intersect_task, &t);
+  }
+  return true;
+}
+
+typedef struct AxBitMultiplyTask {
+  const AxBitMatrix* a;
+  const AxBitMatrix* b;
+  AxBitMatrix* c;
+} AxBitMultiplyTask;
+
+// c_i = OR of the rows b_k for every set bit k of a_i
+static void ax__bits_multiply_task(void* ctx, musz begin, musz end) {
+  const AxBitMultiplyTask* t = (const AxBitMultiplyTask*)ctx;
+  musz nw = (t->c->cols + 63) / 64;
+  musz aw = (t->a->cols + 63) / 64;
+  for (musz i = begin; i < end; i++) {
+    mu64* ci = t->c->data + i * t->c->stride;
+    const mu64* ai = t->a->data + i * t->a->stride;
+    memset(ci, 0, t->c->stride * sizeof(mu64));
+    for (musz w = 0; w < aw; w++) {
+      for (mu64 bits = ai[w]; bits; bits &= bits - 1) {
+        musz k = w * 64 + (musz)__builtin_ctzll(bits);
+        const mu64* bk = t->b->data + k * t->b->stride;
+        for (musz q = 0; q < nw; q++) ci[q] |= bk[q];
+      }
+    }
+  }
+}
+
+// c(i, j) = any bit of a_i & b_j
+static void ax__bits_multiply_trans_task(void* ctx, musz begin, musz end) {
+  const AxBitMultiplyTask* t = (const AxBitMultiplyTask*)ctx;
+  musz nw = (t->a->cols + 63) / 64;
+  for (musz i = begin; i < end; i++) {
+    mu64* ci = t->c->data + i * t->c->stride;
+    const mu64* ai = t->a->data + i * t->a->stride;
+    memset(ci, 0, t->c->stride * sizeof(mu64));
+    for (musz j = 0; j < t->b->rows; j++) {
+      const mu64* bj = t->b->data + j * t->b->stride;
+      mu64 any = 0;
+      for (musz w = 0; w < nw; w++) any |= ai[w] & bj[w];
+      if (any) ci[j / 64] |= (mu64)1 << (j % 64);
+    }
+  }
+}
+
+bool ax_bitmatrix_multiply(const AxBitMatrix* a, const AxBitMatrix* b, AxTranspose tb,
+                           AxBitMatrix* c) {
+  if (!a || !b || !c) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_multiply: null matrix");
+    return false;
+  }
+  musz kb = (tb == AX_TRANS) ? b->cols : b->rows;
+  musz n = (tb == AX_TRANS) ? b->rows : b->cols;
+  if (a->cols != kb || c->rows != a->rows || c->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_bitmatrix_multiply: dimension mismatch");
+    return false;
+  }
+  AxBitMultiplyTask t = { a, b, c };
+  ax_parallel_for(a->rows, 1, tb == AX_TRANS ? ax__bits_multiply_trans_task : ax__bits_multiply_task, &t);
+  return true;
+}
+
+#endif /* AXBITS_IMPLEMENTATION */
+
+#endif /* AXBITS_H_ */
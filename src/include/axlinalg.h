@@ -0,0 +1,2863 @@
+/*
+  ================================================================================
+  AxLinalg: Dense Factorizations and Solvers (STB-Style Single-Header Library)
+  ================================================================================
+  - LU factorization with partial pivoting, in place on an AxMatrix, with
+  solves for many right-hand sides, determinant and inverse.
+  - Cholesky factorization of symmetric positive definite matrices (lower
+  or upper), with solves that reuse the factor in place.
+  - Householder QR with compact WY block reflectors and least-squares
+  solves, plus TSQR: the R factor of tall-skinny matrices by a tree
+  reduction over row blocks, in parallel or streamed one block at a time.
+  - Randomized truncated SVD and PCA: range finding with Gaussian sketches
+  and power iterations, or a single streaming pass over row blocks.
+  - Symmetric eigensolver: blocked tridiagonal reduction, divide and
+  conquer, bisection with inverse iteration for a subset of eigenpairs.
+  - Mixed-precision solves: factor in f32, refine to f64 accuracy with
+  f64 residuals, falling back to an f64 factorization when needed.
+  - BLAS-3 building blocks: TRSM (triangular solve with many right-hand
+  sides) and SYRK (symmetric rank-k update of one triangle).
+  - Factorizations are blocked and right-looking: panels are factored
+  recursively and trailing updates go through ax_matrix_gemm, so the bulk
+  of the work runs on the GEMM micro-kernels and the thread pool.
+  - Matrices are f32 or f64. Small bookkeeping arrays (pivots, reflector
+  factors) come from an Arena and are released with it.
+  - Dependencies:
+  - "axmatrix.h"    (AxMatrix, ax_matrix_gemm; pulls in axalloc.h and axthread.h)
+  - <float.h>       (DBL_EPSILON)
+  - <math.h>        (fabs, sqrt, hypot, log, cos)
+  - <stdlib.h>      (malloc, free for temporary buffers; qsort)
+  - <string.h>      (memcpy, memset)
+  ================================================================================
+  USAGE:
+  1) In **one** C or C++ file where you want the implementation, do:
+  #define AXLINALG_IMPLEMENTATION
+  #include "axlinalg.h"
+
+  2) In any other files that need to use the library, just include "axlinalg.h"
+  without defining AXLINALG_IMPLEMENTATION.
+  ================================================================================
+*/
+
+#ifndef AXLINALG_H_
+#define AXLINALG_H_
+
+#include "axmatrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef enum AxSide {
+    AX_LEFT,
+    AX_RIGHT
+  } AxSide;
+
+  typedef enum AxUplo {
+    AX_LOWER,
+    AX_UPPER
+  } AxUplo;
+
+  typedef enum AxDiag {
+    AX_NON_UNIT,
+    AX_UNIT // The diagonal is taken as ones and never read
+  } AxDiag;
+
+  // Solves op(a) * X = alpha * b (AX_LEFT) or X * op(a) = alpha * b
+  // (AX_RIGHT) in place of b, where `a` is square and only its `uplo`
+  // triangle is read. Operands share one dtype, f32 or f64.
+  bool ax_matrix_trsm(AxSide side, AxUplo uplo, AxTranspose ta, AxDiag diag, double alpha,
+                      const AxMatrix* a, AxMatrix* b);
+
+  // c = alpha * a * a^T + beta * c (AX_NO_TRANS) or alpha * a^T * a + beta * c
+  // (AX_TRANS), touching only the `uplo` triangle of c. With beta == 0, `c`
+  // is not read. `c` must not overlap `a`.
+  bool ax_matrix_syrk(AxUplo uplo, AxTranspose trans, double alpha, const AxMatrix* a,
+                      double beta, AxMatrix* c);
+
+  // P * A = L * U, stored over A: the unit lower triangle L below the
+  // diagonal and U on and above it. Rows were exchanged in order, row k
+  // with row piv[k], for k < min(rows, cols).
+  typedef struct AxLU {
+    AxMatrix* lu;
+    musz* piv;
+    int sign;      // +1 or -1, the parity of the row exchanges
+    bool singular; // Some pivot of U is exactly zero
+  } AxLU;
+
+  // Factors `a` in place; `lu` keeps a pointer to it. A singular matrix is
+  // still factored (and flagged), but cannot be solved with or inverted:
+  // ax_lu_solve and ax_lu_inverse then warn and return false, leaving their
+  // output untouched.
+  bool ax_lu_factor(AxMatrix* a, AxLU* lu, Arena* arena);
+
+  // Overwrites b (n x nrhs, the dtype of the factor) with A^-1 * b
+  bool ax_lu_solve(const AxLU* lu, AxMatrix* b);
+
+  double ax_lu_det(const AxLU* lu);
+
+  // inv (n x n, the dtype of the factor) = A^-1
+  bool ax_lu_inverse(const AxLU* lu, AxMatrix* inv);
+
+  // A = L * L^T (AX_LOWER) or U^T * U (AX_UPPER), stored over that triangle
+  // of A; the other triangle is left untouched.
+  typedef struct AxCholesky {
+    AxMatrix* factor;
+    AxUplo uplo;
+  } AxCholesky;
+
+  // Factors `a` in place. Returns false, leaving `a` partly overwritten, if
+  // it is not positive definite.
+  bool ax_cholesky_factor(AxMatrix* a, AxUplo uplo, AxCholesky* chol);
+
+  // Overwrites b (n x nrhs, the dtype of the factor) with A^-1 * b
+  bool ax_cholesky_solve(const AxCholesky* chol, AxMatrix* b);
+
+  // A = Q * R, stored over A: R on and above the diagonal and the Householder
+  // vectors below it (their leading ones implied). Q is the product of
+  // min(rows, cols) reflectors, applied in panels of AX_QR_NB columns, each
+  // panel as I - V * T * V^T with T kept in `t`.
+#define AX_QR_NB 64
+  typedef struct AxQR {
+    AxMatrix* qr;
+    AxMatrix* t; // AX_QR_NB x min(rows, cols): one upper triangle T per panel
+  } AxQR;
+
+  bool ax_qr_factor(AxMatrix* a, AxQR* qr, Arena* arena);
+
+  // b (rows x nrhs, the dtype of the factor) = op(Q) * b
+  bool ax_qr_apply(const AxQR* qr, AxTranspose trans, AxMatrix* b);
+
+  // q (rows x c, c <= rows) = the first c columns of Q
+  bool ax_qr_form_q(const AxQR* qr, AxMatrix* q);
+
+  // Least squares min ||A x - b|| for rows >= cols and full rank: b (rows x
+  // nrhs) is overwritten with Q^T * b, after which its first cols rows hold
+  // x and the norms of the remaining rows are the residual norms. An exactly
+  // zero diagonal entry of R (e.g. an all-zero column) warns and returns
+  // false, leaving b untouched.
+  bool ax_qr_solve(const AxQR* qr, AxMatrix* b);
+
+  // Streaming TSQR: R (cols x cols, upper triangular) of all row blocks
+  // pushed so far, equal to the R of a QR factorization of the stacked
+  // blocks up to the signs of its rows. Each push splits the block across
+  // the thread pool and merges the partial triangles pairwise. Pushing
+  // [A b] gives least squares without keeping A: with R = [R11 z; 0 rho],
+  // x solves R11 x = z and |rho| is the residual norm.
+  typedef struct AxTSQR {
+    AxMatrix* r;
+    musz rows; // Rows pushed so far
+  } AxTSQR;
+
+  bool ax_tsqr_init(AxTSQR* tsqr, musz cols, AxDType dtype, Arena* arena);
+  bool ax_tsqr_push(AxTSQR* tsqr, const AxMatrix* block);
+
+  // One-shot TSQR: r (cols x cols) = R of a, leaving a untouched
+  bool ax_matrix_tsqr(const AxMatrix* a, AxMatrix* r);
+
+  // Mixed-precision solve of A X = B for f64 A and B: A is factored in f32
+  // (LU, or Cholesky for a symmetric positive definite A stored in full),
+  // then X is refined with residuals B - A X computed in f64 until every
+  // column satisfies ||r||_inf <= ||x||_inf * ||A||_inf * eps * sqrt(n).
+  // Refinement stops early, as in LAPACK's xGERFS, once a correction is
+  // not finite or fails to halve ||d||_inf from the step before. If the
+  // f32 factor fails, refinement stalls, or it does not converge within
+  // AX_REFINE_MAX_ITERS steps, A is refactored and solved in f64.
+#define AX_REFINE_MAX_ITERS 30
+  typedef enum AxRefineMethod {
+    AX_REFINE_LU,
+    AX_REFINE_CHOLESKY
+  } AxRefineMethod;
+
+  typedef struct AxRefineInfo {
+    int iters;     // Refinement steps taken on the f32 factor
+    bool stalled;  // Refinement stopped before AX_REFINE_MAX_ITERS without converging
+    bool fallback; // The answer came from the f64 factorization
+  } AxRefineInfo;
+
+  // Overwrites b (n x nrhs) with A^-1 * b, leaving `a` untouched. Working
+  // copies (an f32 A, residuals, and an f64 A on fallback) come from
+  // `arena`. Returns false, with b unchanged, if A is singular (or not
+  // positive definite) in f64 too. `info` may be NULL.
+  bool ax_solve_refined(AxRefineMethod method, const AxMatrix* a, AxMatrix* b,
+                        AxRefineInfo* info, Arena* arena);
+
+  // Fills `mat` (f32 or f64) with standard normal entries. Each entry is a
+  // hash of `seed` and its position, so the result does not depend on the
+  // thread count that generated it in parallel.
+  bool ax_matrix_randn(AxMatrix* mat, mu64 seed);
+
+  // Truncated SVD A ~= U * diag(s) * V^T of rank k, or PCA when the columns
+  // of A are centered first: then the rows of vt are the principal axes, s
+  // the singular values of the centered data (s^2 / (rows - 1) are the
+  // explained variances) and U * diag(s) the scores.
+  typedef struct AxSVD {
+    AxMatrix* u;    // rows x k, orthonormal columns
+    AxMatrix* s;    // 1 x k, in descending order
+    AxMatrix* vt;   // k x cols, orthonormal rows; each row's largest entry is positive
+    AxMatrix* mean; // 1 x cols, the column means removed, or NULL
+  } AxSVD;
+
+  // Randomized SVD (Halko, Martinsson and Tropp): A is sampled with rank +
+  // oversample Gaussian vectors, sharpened by power iterations (each a pass
+  // over A with re-orthogonalization), projected onto that range and the
+  // small projection factored exactly.
+  typedef struct AxRsvdParams {
+    musz rank;        // k, at most min(rows, cols)
+    musz oversample;  // Extra samples beyond k; 10 is typical
+    musz power_iters; // 1 or 2 for slowly decaying spectra, 0 for one pass
+    mu64 seed;
+    bool center;      // Subtract column means first (PCA)
+  } AxRsvdParams;
+
+  // Factors of a (f32 or f64, left untouched) in its dtype, allocated from
+  // `arena`; working memory is released before returning.
+  bool ax_matrix_rsvd(const AxMatrix* a, const AxRsvdParams* params, AxSVD* svd, Arena* arena);
+
+  // Single-pass randomized SVD over row blocks pushed in order (Tropp et
+  // al., 2017), for data read once: each push updates a range sketch
+  // A * Omega (rows x (rank + oversample), kept whole) and a co-range sketch
+  // Psi * A, with Psi regenerated from its seed instead of stored. Power
+  // iterations need a second pass and are ignored, so accuracy depends on
+  // how fast the spectrum decays past the rank. Centering is applied to
+  // the sketches at the end.
+  typedef struct AxRsvdStream {
+    AxRsvdParams params;
+    musz rows, cols;
+    musz pushed;      // Rows pushed so far
+    AxMatrix* omega;  // cols x l
+    AxMatrix* y;      // rows x l, A * Omega
+    AxMatrix* w;      // (2l + 1) x cols, Psi * A
+    AxMatrix* psum;   // 1 x (2l + 1), f64: Psi * 1, for centering
+    AxMatrix* colsum; // 1 x cols, f64
+  } AxRsvdStream;
+
+  // Sketches of dtype `dtype` (f32 or f64) come from `arena`
+  bool ax_rsvd_stream_init(AxRsvdStream* st, musz rows, musz cols, AxDType dtype,
+                           const AxRsvdParams* params, Arena* arena);
+  bool ax_rsvd_stream_push(AxRsvdStream* st, const AxMatrix* block);
+  // After all `rows` rows have been pushed; consumes the sketches. Returns
+  // false, with a warning, when the sketched range is rank deficient (e.g.
+  // rank exceeds the rank of the data).
+  bool ax_rsvd_stream_finish(AxRsvdStream* st, AxSVD* svd, Arena* arena);
+
+  // Symmetric eigendecomposition A = Z diag(w) Z^T of a square f32 or f64
+  // matrix, read from its lower triangle and overwritten. A is reduced to
+  // tridiagonal form by blocked Householder reflectors (half the work in
+  // GEMM updates); the tridiagonal problem is solved by divide and conquer
+  // for all pairs, by implicit QL for eigenvalues alone, or by bisection
+  // and inverse iteration for a range, and eigenvectors are transformed
+  // back with block reflectors.
+  // w (1 x n, any floating-point dtype) receives the eigenvalues in
+  // ascending order and z (n x n, the dtype of a), if not NULL, the
+  // orthonormal eigenvectors as columns.
+  bool ax_matrix_eigh(AxMatrix* a, AxMatrix* w, AxMatrix* z);
+
+  // Only eigenpairs il..iu-1 of the ascending order: w is 1 x (iu - il) and
+  // z, if not NULL, n x (iu - il). The k largest are [n - k, n), the k
+  // smallest [0, k).
+  bool ax_matrix_eigh_range(AxMatrix* a, musz il, musz iu, AxMatrix* w, AxMatrix* z);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+   ------------------------------------------------------------------------------
+   Implementation
+   ------------------------------------------------------------------------------
+*/
+#ifdef AXLINALG_IMPLEMENTATION
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Columns per block of the right-looking loop; panels recurse down to leaves
+// of AX_LINALG_LEAF columns factored one column at a time
+#define AX_LINALG_NB 128
+#define AX_LINALG_LEAF 16
+// Rows per diagonal block of the triangular solves
+#define AX_LINALG_TB 64
+// Right-hand-side columns per parallel chunk of a diagonal block solve
+#define AX_LINALG_GRAIN 256
+
+static bool ax__linalg_dtype_check(const char* fn, AxDType dtype) {
+  switch (dtype) {
+#define AX__LINALG_DTYPE_CASE(T, s, ct) case AX_##T: return true;
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_DTYPE_CASE)
+#undef AX__LINALG_DTYPE_CASE
+  default: break;
+  }
+  AX_LOG(AX_LOG_FATAL, "%s: unsupported dtype %s", fn, ax_dtype_name(dtype));
+  return false;
+}
+
+static void ax__linalg_zero(AxMatrix* mat) {
+  musz esz = ax_dtype_size(mat->dtype);
+  for (musz i = 0; i < mat->rows; i++) {
+    mu8* row = (mu8*)mat->data + i * mat->stride * esz;
+    if (ax__unit_cols(mat)) {
+      memset(row, 0, mat->cols * esz);
+    } else {
+      for (musz j = 0; j < mat->cols; j++) memset(row + j * mat->col_stride * esz, 0, esz);
+    }
+  }
+}
+
+static inline AxMatrix ax__linalg_view(const AxMatrix* m, musz r0, musz r1, musz c0, musz c1) {
+  return AX_MATRIX_SLICE(*m, AX_RANGE(r0, r1), AX_RANGE(c0, c1));
+}
+
+// c -= op(a) * op(b), skipping empty products
+static void ax__linalg_update(const AxMatrix* a, AxTranspose ta, const AxMatrix* b, AxTranspose tb,
+                              AxMatrix* c) {
+  if (c->rows == 0 || c->cols == 0 || (ta == AX_TRANS ? a->rows : a->cols) == 0) return;
+  ax_matrix_gemm(-1.0, a, ta, b, tb, 1.0, c);
+}
+
+// Typed kernels. Triangles are addressed through (rs, cs) strides so the
+// same loops serve a triangle and its transpose.
+#define AX__LINALG_DEFINE(T, s, ct)                                     \
+  /* Solves op(A) X = B for one kb x kb diagonal block, over columns */ \
+  /* [c0, c1) of B, row by row so the inner loop runs along B's rows */ \
+  static void ax__trsm_block_##s(const ct* a, musz rs, musz cs, musz kb, \
+                                 bool lower, bool unit,                 \
+                                 ct* b, musz bs, musz c0, musz c1) {    \
+    for (musz step = 0; step < kb; step++) {                            \
+      musz i = lower ? step : kb - 1 - step;                            \
+      ct* bi = b + i * bs;                                              \
+      musz p0 = lower ? 0 : i + 1, p1 = lower ? i : kb;                 \
+      for (musz p = p0; p < p1; p++) {                                  \
+        ct l = a[i * rs + p * cs];                                      \
+        if (l == 0) continue;                                           \
+        const ct* bp = b + p * bs;                                      \
+        for (musz c = c0; c < c1; c++) bi[c] -= l * bp[c];              \
+      }                                                                 \
+      if (!unit) {                                                      \
+        ct d = a[i * rs + i * cs];                                      \
+        for (musz c = c0; c < c1; c++) bi[c] /= d;                      \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Solves X op(A) = B for one kb x kb diagonal block, over rows */   \
+  /* [r0, r1) of B; each row is an independent solve */                \
+  static void ax__trsm_right_block_##s(const ct* a, musz rs, musz cs, musz kb, \
+                                       bool upper, bool unit,           \
+                                       ct* b, musz bs, musz r0, musz r1) { \
+    for (musz r = r0; r < r1; r++) {                                    \
+      ct* x = b + r * bs;                                               \
+      for (musz step = 0; step < kb; step++) {                          \
+        musz p = upper ? step : kb - 1 - step;                          \
+        if (!unit) x[p] /= a[p * rs + p * cs];                          \
+        ct xp = x[p];                                                   \
+        if (xp == 0) continue;                                          \
+        musz j0 = upper ? p + 1 : 0, j1 = upper ? kb : p;               \
+        for (musz j = j0; j < j1; j++) x[j] -= xp * a[p * rs + j * cs]; \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Solves op(A) x = b for one contiguous vector over a whole n x n */ \
+  /* triangle: by dot products along rows of op(A) when they are */    \
+  /* contiguous (cs == 1), else by updates down its columns */         \
+  static void ax__trsv_##s(const ct* a, musz rs, musz cs, musz n,       \
+                           bool lower, bool unit, ct* x) {              \
+    for (musz step = 0; step < n; step++) {                             \
+      musz i = lower ? step : n - 1 - step;                             \
+      if (cs == 1) {                                                    \
+        const ct* ai = a + i * rs;                                      \
+        musz p = lower ? 0 : i + 1, p1 = lower ? i : n;                 \
+        ct acc[4] = { 0 };                                              \
+        for (; p + 4 <= p1; p += 4) {                                   \
+          for (musz q = 0; q < 4; q++) acc[q] += ai[p + q] * x[p + q];  \
+        }                                                               \
+        for (; p < p1; p++) acc[0] += ai[p] * x[p];                     \
+        x[i] -= (acc[0] + acc[1]) + (acc[2] + acc[3]);                  \
+        if (!unit) x[i] /= ai[i];                                       \
+      } else {                                                          \
+        if (!unit) x[i] /= a[i * rs + i * cs];                          \
+        ct xi = x[i];                                                   \
+        if (xi == 0) continue;                                          \
+        const ct* ac = a + i * cs;                                      \
+        musz p0 = lower ? i + 1 : 0, p1 = lower ? n : i;                \
+        for (musz p = p0; p < p1; p++) x[p] -= xi * ac[p * rs];         \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Unblocked LU of columns [j0, j0 + w) over rows [j0, m). Whole */   \
+  /* rows are exchanged so earlier and later columns follow along. */   \
+  static void ax__lu_leaf_##s(AxMatrix* mat, musz j0, musz w, musz* piv, \
+                              int* sign, bool* singular) {              \
+    ct* a = (ct*)mat->data;                                             \
+    musz ld = mat->stride, m = mat->rows, n = mat->cols;                \
+    for (musz j = j0; j < j0 + w; j++) {                                \
+      musz p = j;                                                       \
+      ct best = (ct)fabs((double)a[j * ld + j]);                        \
+      for (musz i = j + 1; i < m; i++) {                                \
+        ct v = (ct)fabs((double)a[i * ld + j]);                         \
+        if (v > best) { best = v; p = i; }                              \
+      }                                                                 \
+      piv[j] = p;                                                       \
+      if (p != j) {                                                     \
+        ct* rj = a + j * ld;                                            \
+        ct* rp = a + p * ld;                                            \
+        for (musz c = 0; c < n; c++) { ct t = rj[c]; rj[c] = rp[c]; rp[c] = t; } \
+        *sign = -*sign;                                                 \
+      }                                                                 \
+      ct d = a[j * ld + j];                                             \
+      if (d == 0) { *singular = true; continue; }                       \
+      const ct* uj = a + j * ld;                                        \
+      for (musz i = j + 1; i < m; i++) {                                \
+        ct* ri = a + i * ld;                                            \
+        ct l = ri[j] /= d;                                              \
+        if (l == 0) continue;                                           \
+        for (musz c = j + 1; c < j0 + w; c++) ri[c] -= l * uj[c];       \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static double ax__lu_diag_prod_##s(const AxMatrix* mat) {             \
+    const ct* a = (const ct*)mat->data;                                 \
+    double det = 1.0;                                                   \
+    for (musz i = 0; i < mat->rows; i++) det *= (double)a[i * (mat->stride + mat->col_stride)]; \
+    return det;                                                         \
+  }                                                                     \
+                                                                        \
+  static void ax__lu_swap_rows_##s(AxMatrix* mat, musz i, musz p) {     \
+    ct* ri = (ct*)mat->data + i * mat->stride;                          \
+    ct* rp = (ct*)mat->data + p * mat->stride;                          \
+    for (musz c = 0; c < mat->cols; c++) { ct t = ri[c]; ri[c] = rp[c]; rp[c] = t; } \
+  }                                                                     \
+                                                                        \
+  /* One triangle of the diagonal block [i0, i1) of a SYRK, by dot */   \
+  /* products of rows i and j of op(A) */                               \
+  static void ax__syrk_leaf_##s(const ct* a, musz rs, musz cs, musz k,  \
+                                musz i0, musz i1, bool upper,           \
+                                ct alpha, ct beta, ct* c, musz ldc) {   \
+    for (musz i = i0; i < i1; i++) {                                    \
+      musz j0 = upper ? i : i0, j1 = upper ? i1 : i + 1;                \
+      for (musz j = j0; j < j1; j++) {                                  \
+        ct sum = 0;                                                     \
+        for (musz p = 0; p < k; p++) sum += a[i * rs + p * cs] * a[j * rs + p * cs]; \
+        ct* cij = c + i * ldc + j;                                      \
+        *cij = alpha * sum + (beta == 0 ? (ct)0 : beta * *cij);         \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Unblocked Cholesky of an n x n block, as L with L[i][p] at */      \
+  /* a[i * rs + p * cs]; false when a pivot is not positive */          \
+  static bool ax__chol_leaf_##s(ct* a, musz rs, musz cs, musz n) {      \
+    for (musz j = 0; j < n; j++) {                                      \
+      ct d = a[j * rs + j * cs];                                        \
+      for (musz p = 0; p < j; p++) d -= a[j * rs + p * cs] * a[j * rs + p * cs]; \
+      if (!(d > 0)) return false;                                       \
+      ct ljj = (ct)sqrt((double)d);                                     \
+      a[j * rs + j * cs] = ljj;                                         \
+      for (musz i = j + 1; i < n; i++) {                                \
+        ct v = a[i * rs + j * cs];                                      \
+        for (musz p = 0; p < j; p++) v -= a[i * rs + p * cs] * a[j * rs + p * cs]; \
+        a[i * rs + j * cs] = v / ljj;                                   \
+      }                                                                 \
+    }                                                                   \
+    return true;                                                        \
+  }                                                                     \
+                                                                        \
+  static void ax__linalg_pack_##s(const ct* a, musz rs, musz cs, musz kb, ct* out) { \
+    for (musz i = 0; i < kb; i++) {                                     \
+      for (musz j = 0; j < kb; j++) out[i * kb + j] = a[i * rs + j * cs]; \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static void ax__linalg_scale_##s(AxMatrix* mat, ct alpha) {           \
+    for (musz i = 0; i < mat->rows; i++) {                              \
+      ct* r = (ct*)mat->data + i * mat->stride;                         \
+      for (musz j = 0; j < mat->cols; j++) r[j] = alpha == 0 ? (ct)0 : alpha * r[j]; \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__LINALG_DEFINE)
+#undef AX__LINALG_DEFINE
+
+typedef struct AxTrsmTask {
+  const AxMatrix* a; // Diagonal block of the triangle
+  AxMatrix* b;       // Matching block rows of the right-hand sides
+  musz rs, cs;       // Element strides of op(a)
+  bool lower, unit;
+} AxTrsmTask;
+
+static void ax__trsm_block_task(void* ctx, musz begin, musz end) {
+  const AxTrsmTask* t = (const AxTrsmTask*)ctx;
+  musz c0 = begin * AX_LINALG_GRAIN;
+  musz c1 = end * AX_LINALG_GRAIN < t->b->cols ? end * AX_LINALG_GRAIN : t->b->cols;
+  switch (t->a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+    case AX_##T:                                                        \
+      ax__trsm_block_##s((const ct*)t->a->data, t->rs, t->cs, t->a->rows, t->lower, \
+                         t->unit, (ct*)t->b->data, t->b->stride, c0, c1); \
+      break;
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+}
+
+// One column of B at a time, through a contiguous copy
+static void ax__trsv_task(void* ctx, musz begin, musz end) {
+  const AxTrsmTask* t = (const AxTrsmTask*)ctx;
+  musz n = t->a->rows, esz = ax_dtype_size(t->b->dtype);
+  mu8* x = (mu8*)malloc(n * esz);
+  if (!x) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_trsm: failed to allocate a column buffer");
+    return;
+  }
+  for (musz c = begin; c < end; c++) {
+    switch (t->a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+    case AX_##T: {                                                      \
+      ct* xs = (ct*)x;                                                  \
+      ct* bc = (ct*)t->b->data + c;                                     \
+      for (musz i = 0; i < n; i++) xs[i] = bc[i * t->b->stride];        \
+      ax__trsv_##s((const ct*)t->a->data, t->rs, t->cs, n, t->lower, t->unit, xs); \
+      for (musz i = 0; i < n; i++) bc[i * t->b->stride] = xs[i];        \
+      break;                                                            \
+    }
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+  }
+  free(x);
+}
+
+// Solves op(A) X = B in place for a square triangle A (lower or upper as
+// stored, before op): diagonal blocks are solved directly, in parallel over
+// columns of B, and the remaining rows are updated with GEMM. Fewer than
+// AX_LINALG_NARROW columns are substituted directly over the whole
+// triangle, as GEMM updates a few columns wide cost more than they save.
+#define AX_LINALG_NARROW 8
+static void ax__trsm_left(bool lower, AxTranspose trans, bool unit, const AxMatrix* a, AxMatrix* b) {
+  musz n = a->rows;
+  if (n == 0 || b->cols == 0) return;
+  bool fwd = lower != (trans == AX_TRANS); // op(A) is lower triangular
+  if (b->cols < AX_LINALG_NARROW) {
+    AxTrsmTask t = { a, b, trans == AX_TRANS ? 1 : a->stride, trans == AX_TRANS ? a->stride : 1,
+                     fwd, unit };
+    ax_parallel_for(b->cols, 1, ax__trsv_task, &t);
+    return;
+  }
+  musz chunks = (b->cols + AX_LINALG_GRAIN - 1) / AX_LINALG_GRAIN;
+  for (musz step = 0; step < n; step += AX_LINALG_TB) {
+    musz kb = n - step < AX_LINALG_TB ? n - step : AX_LINALG_TB;
+    musz k0 = fwd ? step : n - step - kb;
+    AxMatrix akk = ax__linalg_view(a, k0, k0 + kb, k0, k0 + kb);
+    AxMatrix bk = ax__linalg_view(b, k0, k0 + kb, 0, b->cols);
+    AxTrsmTask t = { &akk, &bk, trans == AX_TRANS ? 1 : a->stride, trans == AX_TRANS ? a->stride : 1,
+                     fwd, unit };
+    ax_parallel_for(chunks, 1, ax__trsm_block_task, &t);
+    // Rows still to solve: below the block going forward, above it going back
+    musz r0 = fwd ? k0 + kb : 0, r1 = fwd ? n : k0;
+    if (r0 == r1) continue;
+    AxMatrix rest = ax__linalg_view(b, r0, r1, 0, b->cols);
+    AxMatrix ark = (trans == AX_TRANS) ? ax__linalg_view(a, k0, k0 + kb, r0, r1)
+                                       : ax__linalg_view(a, r0, r1, k0, k0 + kb);
+    ax__linalg_update(&ark, trans, &bk, AX_NO_TRANS, &rest);
+  }
+}
+
+static void ax__trsm_right_block_task(void* ctx, musz begin, musz end) {
+  const AxTrsmTask* t = (const AxTrsmTask*)ctx;
+  switch (t->a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+    case AX_##T:                                                        \
+      ax__trsm_right_block_##s((const ct*)t->a->data, t->rs, t->cs, t->a->rows, !t->lower, \
+                               t->unit, (ct*)t->b->data, t->b->stride, begin, end); \
+      break;
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+}
+
+// Solves X op(A) = B in place, by blocks of columns of B: forward when
+// op(A) is upper triangular, backward when lower
+static void ax__trsm_right(bool lower, AxTranspose trans, bool unit, const AxMatrix* a, AxMatrix* b) {
+  musz n = a->rows;
+  if (n == 0 || b->rows == 0) return;
+  bool fwd = lower == (trans == AX_TRANS); // op(A) is upper triangular
+  double pack[AX_LINALG_TB * AX_LINALG_TB];
+  for (musz step = 0; step < n; step += AX_LINALG_TB) {
+    musz kb = n - step < AX_LINALG_TB ? n - step : AX_LINALG_TB;
+    musz k0 = fwd ? step : n - step - kb;
+    AxMatrix akk = ax__linalg_view(a, k0, k0 + kb, k0, k0 + kb);
+    AxMatrix bk = ax__linalg_view(b, 0, b->rows, k0, k0 + kb);
+    // The kernel walks rows of op(A_kk), so pack it row-major first
+    AxMatrix packed = { kb, kb, kb, 1, pack, a->dtype, false };
+    switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+      case AX_##T:                                                      \
+        ax__linalg_pack_##s((const ct*)akk.data, trans == AX_TRANS ? 1 : a->stride, \
+                            trans == AX_TRANS ? a->stride : 1, kb, (ct*)pack); \
+        break;
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+    AxTrsmTask t = { &packed, &bk, kb, 1, !fwd, unit };
+    ax_parallel_for(b->rows, AX_LINALG_GRAIN * 16 / kb + 1, ax__trsm_right_block_task, &t);
+    musz c0 = fwd ? k0 + kb : 0, c1 = fwd ? n : k0;
+    if (c0 == c1) continue;
+    AxMatrix rest = ax__linalg_view(b, 0, b->rows, c0, c1);
+    AxMatrix akr = (trans == AX_TRANS) ? ax__linalg_view(a, c0, c1, k0, k0 + kb)
+                                       : ax__linalg_view(a, k0, k0 + kb, c0, c1);
+    ax__linalg_update(&bk, AX_NO_TRANS, &akr, trans, &rest);
+  }
+}
+
+static bool ax__linalg_pair_check(const char* fn, const AxMatrix* a, const AxMatrix* b) {
+  if (!a || !b || !a->data || !b->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null matrix", fn);
+    return false;
+  }
+  if (!ax__linalg_dtype_check(fn, a->dtype)) return false;
+  if (a->dtype != b->dtype) {
+    AX_LOG(AX_LOG_FATAL, "%s: dtypes differ (%s, %s)", fn, ax_dtype_name(a->dtype),
+           ax_dtype_name(b->dtype));
+    return false;
+  }
+  return true;
+}
+
+static void ax__linalg_scale(AxMatrix* mat, double alpha) {
+  switch (mat->dtype) {
+#define AX__LINALG_CASE(T, s, ct) case AX_##T: ax__linalg_scale_##s(mat, (ct)alpha); break;
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+}
+
+bool ax_matrix_trsm(AxSide side, AxUplo uplo, AxTranspose ta, AxDiag diag, double alpha,
+                    const AxMatrix* a, AxMatrix* b) {
+  if (!ax__linalg_pair_check("ax_matrix_trsm", a, b)) return false;
+  musz nb = (side == AX_LEFT) ? b->rows : b->cols;
+  if (a->rows != a->cols || a->rows != nb) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_trsm: triangle is %zux%zu, right-hand sides are %zux%zu",
+           a->rows, a->cols, b->rows, b->cols);
+    return false;
+  }
+  // The kernels walk rows through pointers. A transposed triangle is solved
+  // as its storage, other column-strided views on contiguous copies.
+  if (!ax__unit_cols(a) && ax__unit_cols(b)) {
+    AxMatrix v = ax_matrix_transpose_view(a);
+    if (ax__unit_cols(&v)) {
+      return ax_matrix_trsm(side, uplo == AX_LOWER ? AX_UPPER : AX_LOWER,
+                            ta == AX_TRANS ? AX_NO_TRANS : AX_TRANS, diag, alpha, &v, b);
+    }
+  }
+  if (!ax__unit_cols(a) || !ax__unit_cols(b)) {
+    AxMatrix as, bs;
+    const AxMatrix* au = ax__unit_stage(a, &as, true);
+    AxMatrix* bu = ax__unit_stage(b, &bs, true);
+    bool ok = au && bu && ax_matrix_trsm(side, uplo, ta, diag, alpha, au, bu);
+    ax__unit_release(&as, NULL);
+    ax__unit_release(&bs, ok ? b : NULL);
+    return ok;
+  }
+  if (alpha != 1.0) ax__linalg_scale(b, alpha);
+  if (alpha == 0.0) return true;
+  if (side == AX_LEFT) ax__trsm_left(uplo == AX_LOWER, ta, diag == AX_UNIT, a, b);
+  else ax__trsm_right(uplo == AX_LOWER, ta, diag == AX_UNIT, a, b);
+  return true;
+}
+
+// Rows/columns of op(A) with rank AX_LINALG_SYRK_LEAF or less are summed
+// directly; larger triangles split in two halves plus one GEMM block
+#define AX_LINALG_SYRK_LEAF 32
+
+static void ax__syrk_rec(bool upper, AxTranspose trans, double alpha, const AxMatrix* a, double beta,
+                         AxMatrix* c, musz i0, musz i1) {
+  if (i1 - i0 <= AX_LINALG_SYRK_LEAF) {
+    bool tr = (trans == AX_TRANS);
+    musz k = tr ? a->rows : a->cols;
+    switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+      case AX_##T:                                                      \
+        ax__syrk_leaf_##s((const ct*)a->data, tr ? 1 : a->stride, tr ? a->stride : 1, k, \
+                          i0, i1, upper, (ct)alpha, (ct)beta, (ct*)c->data, c->stride); \
+        break;
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+    return;
+  }
+  musz h = i0 + (i1 - i0) / 2;
+  ax__syrk_rec(upper, trans, alpha, a, beta, c, i0, h);
+  ax__syrk_rec(upper, trans, alpha, a, beta, c, h, i1);
+  // Off-diagonal block: rows r of c against columns q
+  musz r0 = upper ? i0 : h, r1 = upper ? h : i1;
+  musz q0 = upper ? h : i0, q1 = upper ? i1 : h;
+  AxMatrix cb = ax__linalg_view(c, r0, r1, q0, q1);
+  if (trans == AX_TRANS) {
+    AxMatrix ar = ax__linalg_view(a, 0, a->rows, r0, r1);
+    AxMatrix aq = ax__linalg_view(a, 0, a->rows, q0, q1);
+    ax_matrix_gemm(alpha, &ar, AX_TRANS, &aq, AX_NO_TRANS, beta, &cb);
+  } else {
+    AxMatrix ar = ax__linalg_view(a, r0, r1, 0, a->cols);
+    AxMatrix aq = ax__linalg_view(a, q0, q1, 0, a->cols);
+    ax_matrix_gemm(alpha, &ar, AX_NO_TRANS, &aq, AX_TRANS, beta, &cb);
+  }
+}
+
+bool ax_matrix_syrk(AxUplo uplo, AxTranspose trans, double alpha, const AxMatrix* a,
+                    double beta, AxMatrix* c) {
+  if (!ax__linalg_pair_check("ax_matrix_syrk", a, c)) return false;
+  musz n = (trans == AX_TRANS) ? a->cols : a->rows;
+  if (c->rows != c->cols || c->rows != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_syrk: result is %zux%zu, expected %zux%zu",
+           c->rows, c->cols, n, n);
+    return false;
+  }
+  // A transposed `a` is read as its storage, other column-strided views
+  // through contiguous copies
+  if (!ax__unit_cols(a)) {
+    AxMatrix v = ax_matrix_transpose_view(a);
+    if (ax__unit_cols(&v)) {
+      return ax_matrix_syrk(uplo, trans == AX_TRANS ? AX_NO_TRANS : AX_TRANS, alpha, &v, beta, c);
+    }
+  }
+  if (!ax__unit_cols(a) || !ax__unit_cols(c)) {
+    AxMatrix as, cs;
+    const AxMatrix* au = ax__unit_stage(a, &as, true);
+    AxMatrix* cu = ax__unit_stage(c, &cs, true); // Keeps the other triangle
+    bool ok = au && cu && ax_matrix_syrk(uplo, trans, alpha, au, beta, cu);
+    ax__unit_release(&as, NULL);
+    ax__unit_release(&cs, ok ? c : NULL);
+    return ok;
+  }
+  ax__syrk_rec(uplo == AX_UPPER, trans, alpha, a, beta, c, 0, n);
+  return true;
+}
+
+static void ax__lu_leaf(AxMatrix* a, musz j0, musz w, AxLU* lu) {
+  switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct) case AX_##T: ax__lu_leaf_##s(a, j0, w, lu->piv, &lu->sign, &lu->singular); break;
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+}
+
+// Recursive LU of the panel of columns [j0, j0 + w) over rows [j0, m): the
+// left half is factored, its U row block solved and the right half updated
+// with one GEMM before recursing into it.
+static void ax__lu_panel(AxMatrix* a, musz j0, musz w, AxLU* lu) {
+  if (w <= AX_LINALG_LEAF) {
+    ax__lu_leaf(a, j0, w, lu);
+    return;
+  }
+  musz w1 = w / 2;
+  ax__lu_panel(a, j0, w1, lu);
+  musz j1 = j0 + w1;
+  if (j1 >= a->rows) return;
+  AxMatrix l11 = ax__linalg_view(a, j0, j1, j0, j1);
+  AxMatrix a12 = ax__linalg_view(a, j0, j1, j1, j0 + w);
+  ax__trsm_left(true, AX_NO_TRANS, true, &l11, &a12);
+  AxMatrix a21 = ax__linalg_view(a, j1, a->rows, j0, j1);
+  AxMatrix a22 = ax__linalg_view(a, j1, a->rows, j1, j0 + w);
+  ax__linalg_update(&a21, AX_NO_TRANS, &a12, AX_NO_TRANS, &a22);
+  ax__lu_panel(a, j1, w - w1, lu);
+}
+
+static bool ax__lu_factor(AxMatrix* a, AxLU* lu, Arena* arena) {
+  if (!a || !lu || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_lu_factor: null matrix");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_lu_factor: arena is NULL");
+    return false;
+  }
+  if (!ax__linalg_dtype_check("ax_lu_factor", a->dtype)) return false;
+  musz k = a->rows < a->cols ? a->rows : a->cols;
+  lu->lu = a;
+  lu->piv = (musz*)ax_alloc(arena, (k ? k : 1) * sizeof(musz));
+  lu->sign = 1;
+  lu->singular = false;
+  if (!lu->piv) {
+    AX_LOG(AX_LOG_FATAL, "ax_lu_factor: failed to allocate pivots");
+    return false;
+  }
+  for (musz j0 = 0; j0 < k; j0 += AX_LINALG_NB) {
+    musz jb = k - j0 < AX_LINALG_NB ? k - j0 : AX_LINALG_NB;
+    musz j1 = j0 + jb;
+    ax__lu_panel(a, j0, jb, lu);
+    if (j1 >= a->cols) continue;
+    // U12 = L11^-1 A12, then the trailing update A22 -= L21 U12
+    AxMatrix l11 = ax__linalg_view(a, j0, j1, j0, j1);
+    AxMatrix a12 = ax__linalg_view(a, j0, j1, j1, a->cols);
+    ax__trsm_left(true, AX_NO_TRANS, true, &l11, &a12);
+    AxMatrix a21 = ax__linalg_view(a, j1, a->rows, j0, j1);
+    AxMatrix a22 = ax__linalg_view(a, j1, a->rows, j1, a->cols);
+    ax__linalg_update(&a21, AX_NO_TRANS, &a12, AX_NO_TRANS, &a22);
+  }
+  return true;
+}
+
+bool ax_lu_factor(AxMatrix* a, AxLU* lu, Arena* arena) {
+  if (a && a->data && !ax__unit_cols(a)) {
+    // Column-strided views are factored on a contiguous copy, written back
+    // (also when it fails); the factor still refers to `a`
+    AxMatrix as;
+    AxMatrix* au = ax__unit_stage(a, &as, true);
+    bool ok = au && ax_lu_factor(au, lu, arena);
+    ax__unit_release(&as, a);
+    if (ok) lu->lu = a;
+    return ok;
+  }
+  if (!ax__lu_factor(a, lu, arena)) return false;
+  if (lu->singular) AX_LOG(AX_LOG_WARN, "ax_lu_factor: matrix is singular");
+  return true;
+}
+
+static bool ax__lu_check(const char* fn, const AxLU* lu, const AxMatrix* b) {
+  if (!lu || !lu->lu || !b || !b->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null matrix", fn);
+    return false;
+  }
+  if (lu->lu->rows != lu->lu->cols || b->rows != lu->lu->rows) {
+    AX_LOG(AX_LOG_FATAL, "%s: factor is %zux%zu, right-hand side has %zu rows", fn,
+           lu->lu->rows, lu->lu->cols, b->rows);
+    return false;
+  }
+  if (b->dtype != lu->lu->dtype) {
+    AX_LOG(AX_LOG_FATAL, "%s: dtype %s does not match the factor's %s", fn,
+           ax_dtype_name(b->dtype), ax_dtype_name(lu->lu->dtype));
+    return false;
+  }
+  return true;
+}
+
+// A singular factor is a property of the data: warn and leave the output as is
+static bool ax__lu_nonsingular(const char* fn, const AxLU* lu) {
+  if (lu->singular) {
+    AX_LOG(AX_LOG_WARN, "%s: matrix is singular", fn);
+    return false;
+  }
+  return true;
+}
+
+static void ax__lu_apply(const AxLU* lu, AxMatrix* b) {
+  for (musz i = 0; i < b->rows; i++) {
+    if (lu->piv[i] == i) continue;
+    switch (b->dtype) {
+#define AX__LINALG_CASE(T, s, ct) case AX_##T: ax__lu_swap_rows_##s(b, i, lu->piv[i]); break;
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+  }
+  ax__trsm_left(true, AX_NO_TRANS, true, lu->lu, b);
+  ax__trsm_left(false, AX_NO_TRANS, false, lu->lu, b);
+}
+
+// ax__lu_apply on contiguous stand-ins for a column-strided factor or
+// right-hand side; `b` is written back
+static bool ax__lu_apply_staged(const AxLU* lu, AxMatrix* b) {
+  AxMatrix fs, bs;
+  AxLU f = *lu;
+  f.lu = ax__unit_stage(lu->lu, &fs, true);
+  AxMatrix* bu = ax__unit_stage(b, &bs, true);
+  bool ok = f.lu && bu;
+  if (ok) ax__lu_apply(&f, bu);
+  ax__unit_release(&fs, NULL);
+  ax__unit_release(&bs, ok ? b : NULL);
+  return ok;
+}
+
+bool ax_lu_solve(const AxLU* lu, AxMatrix* b) {
+  if (!ax__lu_check("ax_lu_solve", lu, b) || !ax__lu_nonsingular("ax_lu_solve", lu)) return false;
+  return ax__lu_apply_staged(lu, b);
+}
+
+double ax_lu_det(const AxLU* lu) {
+  if (!lu || !lu->lu || lu->lu->rows != lu->lu->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_lu_det: factor is not square");
+    return NAN;
+  }
+  if (lu->singular) return 0.0;
+  switch (lu->lu->dtype) {
+#define AX__LINALG_CASE(T, s, ct) case AX_##T: return lu->sign * ax__lu_diag_prod_##s(lu->lu);
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+  return NAN;
+}
+
+bool ax_lu_inverse(const AxLU* lu, AxMatrix* inv) {
+  if (!ax__lu_check("ax_lu_inverse", lu, inv)) return false;
+  if (inv->cols != inv->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_lu_inverse: inverse must be %zux%zu", inv->rows, inv->rows);
+    return false;
+  }
+  if (!ax__lu_nonsingular("ax_lu_inverse", lu)) return false;
+  ax__linalg_zero(inv);
+  for (musz i = 0; i < inv->rows; i++) ax_matrix_set(inv, i, i, 1.0);
+  return ax__lu_apply_staged(lu, inv);
+}
+
+static bool ax__chol_leaf(AxMatrix* a, bool upper) {
+  musz rs = upper ? 1 : a->stride, cs = upper ? a->stride : 1;
+  switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct) case AX_##T: return ax__chol_leaf_##s((ct*)a->data, rs, cs, a->rows);
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+  return false;
+}
+
+// Factors a checked square f32/f64 matrix; false if it is not positive
+// definite
+static bool ax__cholesky_factor(AxMatrix* a, AxUplo uplo, AxCholesky* chol) {
+  chol->factor = a;
+  chol->uplo = uplo;
+  musz n = a->rows;
+  for (musz j0 = 0; j0 < n; j0 += AX_LINALG_NB) {
+    musz j1 = n - j0 < AX_LINALG_NB ? n : j0 + AX_LINALG_NB;
+    AxMatrix a11 = ax__linalg_view(a, j0, j1, j0, j1);
+    if (!ax__chol_leaf(&a11, uplo == AX_UPPER)) return false;
+    if (j1 == n) break;
+    if (uplo == AX_LOWER) {
+      // L21 = A21 L11^-T, then A22 -= L21 L21^T
+      AxMatrix a21 = ax__linalg_view(a, j1, n, j0, j1);
+      AxMatrix a22 = ax__linalg_view(a, j1, n, j1, n);
+      ax__trsm_right(true, AX_TRANS, false, &a11, &a21);
+      ax_matrix_syrk(AX_LOWER, AX_NO_TRANS, -1.0, &a21, 1.0, &a22);
+    } else {
+      // U12 = U11^-T A12, then A22 -= U12^T U12
+      AxMatrix a12 = ax__linalg_view(a, j0, j1, j1, n);
+      AxMatrix a22 = ax__linalg_view(a, j1, n, j1, n);
+      ax__trsm_left(false, AX_TRANS, false, &a11, &a12);
+      ax_matrix_syrk(AX_UPPER, AX_TRANS, -1.0, &a12, 1.0, &a22);
+    }
+  }
+  return true;
+}
+
+bool ax_cholesky_factor(AxMatrix* a, AxUplo uplo, AxCholesky* chol) {
+  if (!a || !chol || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_cholesky_factor: null matrix");
+    return false;
+  }
+  if (!ax__linalg_dtype_check("ax_cholesky_factor", a->dtype)) return false;
+  if (a->rows != a->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_cholesky_factor: matrix is %zux%zu, not square", a->rows, a->cols);
+    return false;
+  }
+  if (!ax__unit_cols(a)) {
+    // Column-strided views are factored on a contiguous copy, written back
+    // (also when it fails); the factor still refers to `a`
+    AxMatrix as;
+    AxMatrix* au = ax__unit_stage(a, &as, true);
+    bool ok = au && ax_cholesky_factor(au, uplo, chol);
+    ax__unit_release(&as, a);
+    chol->factor = a;
+    return ok;
+  }
+  if (!ax__cholesky_factor(a, uplo, chol)) {
+    AX_LOG(AX_LOG_WARN, "ax_cholesky_factor: matrix is not positive definite");
+    return false;
+  }
+  return true;
+}
+
+bool ax_cholesky_solve(const AxCholesky* chol, AxMatrix* b) {
+  if (!chol || !chol->factor) {
+    AX_LOG(AX_LOG_FATAL, "ax_cholesky_solve: null factor");
+    return false;
+  }
+  if (!ax__linalg_pair_check("ax_cholesky_solve", chol->factor, b)) return false;
+  if (b->rows != chol->factor->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_cholesky_solve: factor is %zux%zu, right-hand side has %zu rows",
+           chol->factor->rows, chol->factor->cols, b->rows);
+    return false;
+  }
+  // Column-strided factors and right-hand sides are solved on contiguous copies
+  AxMatrix fs, bs;
+  const AxMatrix* f = ax__unit_stage(chol->factor, &fs, true);
+  AxMatrix* bu = ax__unit_stage(b, &bs, true);
+  bool ok = f && bu;
+  if (ok) {
+    bool lower = (chol->uplo == AX_LOWER);
+    ax__trsm_left(lower, lower ? AX_NO_TRANS : AX_TRANS, false, f, bu);
+    ax__trsm_left(lower, lower ? AX_TRANS : AX_NO_TRANS, false, f, bu);
+  }
+  ax__unit_release(&fs, NULL);
+  ax__unit_release(&bs, ok ? b : NULL);
+  return ok;
+}
+
+// Householder QR. The reflector kernel works on column-major copies, so
+// its dot products and updates run along contiguous columns.
+#define AX__QR_DEFINE(T, s, ct)                                         \
+  static ct ax__qr_dot_##s(const ct* x, const ct* y, musz n) {          \
+    ct acc[8] = { 0 };                                                  \
+    musz i = 0;                                                         \
+    for (; i + 8 <= n; i += 8) {                                        \
+      for (musz q = 0; q < 8; q++) acc[q] += x[i + q] * y[i + q];       \
+    }                                                                   \
+    for (; i < n; i++) acc[0] += x[i] * y[i];                           \
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7])); \
+  }                                                                     \
+                                                                        \
+  /* Reflects column j of [r_j; b] onto r_j for each j < n, updating */ \
+  /* columns (j, n). Entry (j, c) of the top part is r[j * rs + c * cs]; */ \
+  /* column c of the tail is b + c * ldb, rows [shift ? j : 0, rows), */ \
+  /* overwritten by the reflector (leading one implied). tau may be */  \
+  /* NULL. */                                                           \
+  static void ax__house_##s(ct* r, musz rs, musz cs, ct* b, musz ldb, musz rows, \
+                            bool shift, musz n, ct* tau) {              \
+    for (musz j = 0; j < n; j++) {                                      \
+      musz i0 = shift ? j : 0;                                          \
+      musz len = rows > i0 ? rows - i0 : 0;                             \
+      ct* vj = b + j * ldb + i0;                                        \
+      double ss = (double)ax__qr_dot_##s(vj, vj, len);                  \
+      if (tau) tau[j] = 0;                                              \
+      if (ss == 0.0) continue;                                          \
+      ct* rjj = r + j * rs + j * cs;                                    \
+      double alpha = (double)*rjj;                                      \
+      double norm = sqrt(alpha * alpha + ss);                           \
+      double beta = alpha >= 0.0 ? -norm : norm;                        \
+      ct tj = (ct)((beta - alpha) / beta);                              \
+      ct scale = (ct)(1.0 / (alpha - beta));                            \
+      for (musz i = 0; i < len; i++) vj[i] *= scale;                    \
+      *rjj = (ct)beta;                                                  \
+      if (tau) tau[j] = tj;                                             \
+      for (musz c = j + 1; c < n; c++) {                                \
+        ct* rjc = r + j * rs + c * cs;                                  \
+        ct* vc = b + c * ldb + i0;                                      \
+        ct w = tj * (*rjc + ax__qr_dot_##s(vj, vc, len));               \
+        *rjc -= w;                                                      \
+        for (musz i = 0; i < len; i++) vc[i] -= w * vj[i];              \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Column-major copy of a rows x cols block and back */               \
+  /* Entry (i, c) of `a` is a[i * lda + c * acs] */                     \
+  static void ax__qr_to_cols_##s(const ct* a, musz lda, musz acs, musz rows, musz cols, \
+                                 ct* b, musz ldb) {                     \
+    for (musz i = 0; i < rows; i++) {                                   \
+      for (musz c = 0; c < cols; c++) b[c * ldb + i] = a[i * lda + c * acs]; \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static void ax__qr_from_cols_##s(const ct* b, musz ldb, musz rows, musz cols, \
+                                   ct* a, musz lda) {                   \
+    for (musz i = 0; i < rows; i++) {                                   \
+      for (musz c = 0; c < cols; c++) a[i * lda + c] = b[c * ldb + i];  \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* T of the block reflector from tau and G = V^T V (forward, */       \
+  /* columnwise: T[0:i, i] = -tau_i T[0:i, 0:i] G[0:i, i]) */           \
+  static void ax__qr_form_t_##s(const ct* g, musz ldg, const ct* tau, musz nb, \
+                                ct* t, musz ldt) {                      \
+    for (musz i = 0; i < nb; i++) {                                     \
+      for (musz r = 0; r < nb; r++) t[r * ldt + i] = 0;                 \
+      t[i * ldt + i] = tau[i];                                          \
+      for (musz r = 0; r < i; r++) {                                    \
+        ct sum = 0;                                                     \
+        for (musz q = r; q < i; q++) sum += t[r * ldt + q] * g[q * ldg + i]; \
+        t[r * ldt + i] = -tau[i] * sum;                                 \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Top nb x nb block of V with its implied unit diagonal and zeros */ \
+  static void ax__qr_unit_lower_##s(const ct* a, musz lda, musz nb, ct* v) { \
+    for (musz i = 0; i < nb; i++) {                                     \
+      for (musz j = 0; j < nb; j++) v[i * nb + j] = i > j ? a[i * lda + j] : (ct)(i == j); \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Partial R (row-major n x n) of rows [r0, r1) of a (any column */  \
+  /* stride), streamed through buf in column-major chunks */            \
+  static void ax__tsqr_fold_##s(ct* r, ct* buf, const AxMatrix* a,      \
+                                musz r0, musz r1, musz chunk) {         \
+    musz n = a->cols;                                                   \
+    for (musz i = r0; i < r1; i += chunk) {                             \
+      musz rows = r1 - i < chunk ? r1 - i : chunk;                      \
+      ax__qr_to_cols_##s((const ct*)a->data + i * a->stride, a->stride, a->col_stride, rows, n, \
+                         buf, chunk);                                   \
+      ax__house_##s(r, n, 1, buf, chunk, rows, false, n, NULL);         \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* ri = R of [ri; rj], both row-major n x n */                        \
+  static void ax__tsqr_merge_##s(ct* ri, const ct* rj, musz n, ct* buf, musz chunk) { \
+    ax__qr_to_cols_##s(rj, n, 1, n, n, buf, chunk);                     \
+    ax__house_##s(ri, n, 1, buf, chunk, n, false, n, NULL);             \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__QR_DEFINE)
+#undef AX__QR_DEFINE
+
+// Scratch for applying one block reflector to `cols` columns: the unit
+// lower block of V, G = V^T V, and two AX_QR_NB x cols products
+typedef struct AxQrScratch {
+  AxMatrix v1, g, w, w2;
+  void* cols; // Column-major copy of a panel leaf, when factoring
+  void* mem;
+} AxQrScratch;
+
+// Columns per leaf of the recursive panel factorization
+#define AX_QR_LEAF 8
+
+static bool ax__qr_scratch(AxQrScratch* sc, AxDType dtype, musz cols, musz leaf_rows) {
+  musz esz = ax_dtype_size(dtype);
+  musz nb = AX_QR_NB;
+  sc->mem = malloc((2 * nb * nb + 2 * nb * (cols ? cols : 1) + leaf_rows * AX_QR_LEAF) * esz);
+  if (!sc->mem) {
+    AX_LOG(AX_LOG_FATAL, "ax_qr: failed to allocate scratch");
+    return false;
+  }
+  mu8* p = (mu8*)sc->mem;
+  sc->v1 = (AxMatrix){ nb, nb, nb, 1, p, dtype, false };
+  sc->g = (AxMatrix){ nb, nb, nb, 1, p + nb * nb * esz, dtype, false };
+  sc->w = (AxMatrix){ nb, cols, cols, 1, p + 2 * nb * nb * esz, dtype, false };
+  sc->w2 = (AxMatrix){ nb, cols, cols, 1, p + (2 * nb * nb + nb * cols) * esz, dtype, false };
+  sc->cols = p + (2 * nb * nb + 2 * nb * (cols ? cols : 1)) * esz;
+  return true;
+}
+
+// Unit lower top block of the reflectors in columns [j0, j0 + jb) of a,
+// copied into sc->v1
+static AxMatrix ax__qr_v1(const AxMatrix* a, musz j0, musz jb, AxQrScratch* sc) {
+  AxMatrix v1 = { jb, jb, jb, 1, sc->v1.data, a->dtype, false };
+  AxMatrix top = ax__linalg_view(a, j0, j0 + jb, j0, j0 + jb);
+  switch (top.dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+    case AX_##T: ax__qr_unit_lower_##s((const ct*)top.data, top.stride, jb, (ct*)v1.data); break;
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+  return v1;
+}
+
+// T of reflectors [j0, j0 + jb) inside the panel starting at column p0
+static inline AxMatrix ax__qr_t(const AxQR* qr, musz p0, musz j0, musz jb) {
+  return ax__linalg_view(qr->t, j0 - p0, j0 - p0 + jb, j0, j0 + jb);
+}
+
+// c (rows j0 onward of the target) = (I - V op(t) V^T) * c for the
+// reflectors in columns [j0, j0 + jb) of a; op(t) = t^T applies Q^T
+static void ax__qr_apply_block(const AxMatrix* a, musz j0, musz jb, const AxMatrix* t, bool trans,
+                               AxMatrix* c, AxQrScratch* sc) {
+  if (c->cols == 0) return;
+  AxMatrix v1 = ax__qr_v1(a, j0, jb, sc);
+  AxMatrix v2 = ax__linalg_view(a, j0 + jb, a->rows, j0, j0 + jb);
+  AxMatrix c1 = ax__linalg_view(c, 0, jb, 0, c->cols);
+  AxMatrix c2 = ax__linalg_view(c, jb, c->rows, 0, c->cols);
+  AxMatrix w = { jb, c->cols, c->cols, 1, sc->w.data, c->dtype, false };
+  AxMatrix w2 = { jb, c->cols, c->cols, 1, sc->w2.data, c->dtype, false };
+  ax_matrix_gemm(1.0, &v1, AX_TRANS, &c1, AX_NO_TRANS, 0.0, &w);
+  if (v2.rows) ax_matrix_gemm(1.0, &v2, AX_TRANS, &c2, AX_NO_TRANS, 1.0, &w);
+  ax_matrix_gemm(1.0, t, trans ? AX_TRANS : AX_NO_TRANS, &w, AX_NO_TRANS, 0.0, &w2);
+  ax__linalg_update(&v1, AX_NO_TRANS, &w2, AX_NO_TRANS, &c1);
+  ax__linalg_update(&v2, AX_NO_TRANS, &w2, AX_NO_TRANS, &c2);
+}
+
+// Factors columns [j0, j0 + w) over rows [j0, m) recursively, building the
+// T of those reflectors in place within the panel starting at p0: the left
+// half is factored and applied to the right half with GEMM, the right half
+// recurses, and the halves' T combine as [T1, -T1 V1^T V2 T2; 0, T2].
+static void ax__qr_panel(const AxQR* qr, musz p0, musz j0, musz w, AxQrScratch* sc) {
+  AxMatrix* a = qr->qr;
+  musz m = a->rows;
+  AxMatrix t = ax__qr_t(qr, p0, j0, w);
+  if (w <= AX_QR_LEAF) {
+    AxMatrix g = { w, w, w, 1, sc->g.data, a->dtype, false };
+    AxMatrix v2 = ax__linalg_view(a, j0 + w, m, j0, j0 + w);
+    AxMatrix top = ax__linalg_view(a, j0, m, j0, j0 + w);
+    switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+      case AX_##T: {                                                    \
+        ct tau[AX_QR_LEAF];                                             \
+        ct* col = (ct*)sc->cols;                                        \
+        ax__qr_to_cols_##s((const ct*)top.data, top.stride, 1, top.rows, w, col, top.rows); \
+        ax__house_##s(col, 1, top.rows, col + 1, top.rows, top.rows - 1, true, w, tau); \
+        ax__qr_from_cols_##s(col, top.rows, top.rows, w, (ct*)top.data, top.stride); \
+        AxMatrix v1 = ax__qr_v1(a, j0, w, sc);                          \
+        ax_matrix_gemm(1.0, &v1, AX_TRANS, &v1, AX_NO_TRANS, 0.0, &g);  \
+        if (v2.rows) ax_matrix_gemm(1.0, &v2, AX_TRANS, &v2, AX_NO_TRANS, 1.0, &g); \
+        ax__qr_form_t_##s((const ct*)g.data, w, tau, w, (ct*)t.data, t.stride); \
+        break;                                                          \
+      }
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+    return;
+  }
+  musz h = w / 2, j1 = j0 + h, w2 = w - h;
+  ax__qr_panel(qr, p0, j0, h, sc);
+  AxMatrix t1 = ax__qr_t(qr, p0, j0, h);
+  AxMatrix right = ax__linalg_view(a, j0, m, j1, j0 + w);
+  ax__qr_apply_block(a, j0, h, &t1, true, &right, sc);
+  ax__qr_panel(qr, p0, j1, w2, sc);
+  // V1^T V2: V2 is zero above row j1 and unit lower in rows [j1, j0 + w)
+  AxMatrix t2 = ax__qr_t(qr, p0, j1, w2);
+  AxMatrix t12 = ax__linalg_view(qr->t, j0 - p0, j1 - p0, j1, j0 + w);
+  AxMatrix x = { h, w2, w2, 1, sc->g.data, a->dtype, false };
+  AxMatrix tmp = { h, w2, w2, 1, sc->w.data, a->dtype, false };
+  AxMatrix v2top = ax__qr_v1(a, j1, w2, sc);
+  AxMatrix v1mid = ax__linalg_view(a, j1, j0 + w, j0, j1);
+  ax_matrix_gemm(1.0, &v1mid, AX_TRANS, &v2top, AX_NO_TRANS, 0.0, &x);
+  AxMatrix v1low = ax__linalg_view(a, j0 + w, m, j0, j1);
+  AxMatrix v2low = ax__linalg_view(a, j0 + w, m, j1, j0 + w);
+  if (v1low.rows) ax_matrix_gemm(1.0, &v1low, AX_TRANS, &v2low, AX_NO_TRANS, 1.0, &x);
+  ax_matrix_gemm(1.0, &t1, AX_NO_TRANS, &x, AX_NO_TRANS, 0.0, &tmp);
+  ax_matrix_gemm(-1.0, &tmp, AX_NO_TRANS, &t2, AX_NO_TRANS, 0.0, &t12);
+}
+
+bool ax_qr_factor(AxMatrix* a, AxQR* qr, Arena* arena) {
+  if (!a || !qr || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_qr_factor: null matrix");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_qr_factor: arena is NULL");
+    return false;
+  }
+  if (!ax__linalg_dtype_check("ax_qr_factor", a->dtype)) return false;
+  if (!ax__unit_cols(a)) {
+    // Column-strided views are factored on a contiguous copy, written back;
+    // the factor still refers to `a`
+    AxMatrix as;
+    AxMatrix* au = ax__unit_stage(a, &as, true);
+    bool ok = au && ax_qr_factor(au, qr, arena);
+    ax__unit_release(&as, ok ? a : NULL);
+    qr->qr = a;
+    return ok;
+  }
+  musz m = a->rows, n = a->cols;
+  musz k = m < n ? m : n;
+  qr->qr = a;
+  qr->t = ax_matrix_create_dtype(AX_QR_NB, k ? k : 1, a->dtype, arena);
+  if (!qr->t) return false;
+  ax__linalg_zero(qr->t);
+  AxQrScratch sc;
+  if (!ax__qr_scratch(&sc, a->dtype, n, m)) return false;
+  for (musz j0 = 0; j0 < k; j0 += AX_QR_NB) {
+    musz jb = k - j0 < AX_QR_NB ? k - j0 : AX_QR_NB;
+    ax__qr_panel(qr, j0, j0, jb, &sc);
+    // Trailing columns: A[j0:, j0 + jb:] = Q_panel^T A[j0:, j0 + jb:]
+    AxMatrix t = ax__qr_t(qr, j0, j0, jb);
+    AxMatrix c = ax__linalg_view(a, j0, m, j0 + jb, n);
+    ax__qr_apply_block(a, j0, jb, &t, true, &c, &sc);
+  }
+  free(sc.mem);
+  return true;
+}
+
+static bool ax__qr_check(const char* fn, const AxQR* qr, const AxMatrix* b) {
+  if (!qr || !qr->qr || !qr->t) {
+    AX_LOG(AX_LOG_FATAL, "%s: null factor", fn);
+    return false;
+  }
+  if (!ax__linalg_pair_check(fn, qr->qr, b)) return false;
+  if (b->rows != qr->qr->rows) {
+    AX_LOG(AX_LOG_FATAL, "%s: factor has %zu rows, operand has %zu", fn, qr->qr->rows, b->rows);
+    return false;
+  }
+  return true;
+}
+
+static bool ax__qr_apply(const AxQR* qr, AxTranspose trans, AxMatrix* b) {
+  if (!ax__unit_cols(qr->qr) || !ax__unit_cols(b)) {
+    // Column-strided factors and operands are applied as contiguous copies
+    AxMatrix fs, bs;
+    AxQR f = *qr;
+    f.qr = ax__unit_stage(qr->qr, &fs, true);
+    AxMatrix* bu = ax__unit_stage(b, &bs, true);
+    bool ok = f.qr && bu && ax__qr_apply(&f, trans, bu);
+    ax__unit_release(&fs, NULL);
+    ax__unit_release(&bs, ok ? b : NULL);
+    return ok;
+  }
+  musz m = qr->qr->rows;
+  musz k = m < qr->qr->cols ? m : qr->qr->cols;
+  AxQrScratch sc;
+  if (!ax__qr_scratch(&sc, b->dtype, b->cols, 0)) return false;
+  musz panels = (k + AX_QR_NB - 1) / AX_QR_NB;
+  for (musz p = 0; p < panels; p++) {
+    // Q^T applies the panels first to last, Q last to first
+    musz j0 = (trans == AX_TRANS ? p : panels - 1 - p) * AX_QR_NB;
+    musz jb = k - j0 < AX_QR_NB ? k - j0 : AX_QR_NB;
+    AxMatrix t = ax__qr_t(qr, j0, j0, jb);
+    AxMatrix c = ax__linalg_view(b, j0, m, 0, b->cols);
+    ax__qr_apply_block(qr->qr, j0, jb, &t, trans == AX_TRANS, &c, &sc);
+  }
+  free(sc.mem);
+  return true;
+}
+
+bool ax_qr_apply(const AxQR* qr, AxTranspose trans, AxMatrix* b) {
+  if (!ax__qr_check("ax_qr_apply", qr, b)) return false;
+  return ax__qr_apply(qr, trans, b);
+}
+
+bool ax_qr_form_q(const AxQR* qr, AxMatrix* q) {
+  if (!ax__qr_check("ax_qr_form_q", qr, q)) return false;
+  if (q->cols > q->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_qr_form_q: Q has %zu columns at most, asked for %zu", q->rows, q->cols);
+    return false;
+  }
+  ax__linalg_zero(q);
+  for (musz i = 0; i < q->cols; i++) ax_matrix_set(q, i, i, 1.0);
+  return ax__qr_apply(qr, AX_NO_TRANS, q);
+}
+
+bool ax_qr_solve(const AxQR* qr, AxMatrix* b) {
+  if (!ax__qr_check("ax_qr_solve", qr, b)) return false;
+  musz n = qr->qr->cols;
+  if (qr->qr->rows < n) {
+    AX_LOG(AX_LOG_FATAL, "ax_qr_solve: %zux%zu is underdetermined", qr->qr->rows, n);
+    return false;
+  }
+  for (musz i = 0; i < n; i++) {
+    if (ax_matrix_get(qr->qr, i, i) == 0.0) {
+      AX_LOG(AX_LOG_WARN, "ax_qr_solve: matrix is rank deficient");
+      return false;
+    }
+  }
+  if (!ax__qr_apply(qr, AX_TRANS, b)) return false;
+  AxMatrix r = ax__linalg_view(qr->qr, 0, n, 0, n);
+  AxMatrix x = ax__linalg_view(b, 0, n, 0, b->cols);
+  return ax_matrix_trsm(AX_LEFT, AX_UPPER, AX_NO_TRANS, AX_NON_UNIT, 1.0, &r, &x);
+}
+
+// TSQR. Row blocks per leaf are streamed through buffers of about
+// AX_TSQR_CHUNK elements; leaf triangles then merge pairwise, level by
+// level, each level in parallel.
+#define AX_TSQR_CHUNK 32768
+
+typedef struct AxTsqrTask {
+  const AxMatrix* a;
+  musz leaves, chunk, step;
+  mu8* r;   // One row-major n x n triangle per leaf
+  mu8* buf; // One column-major chunk x n buffer per leaf
+} AxTsqrTask;
+
+static void ax__tsqr_leaf_task(void* ctx, musz begin, musz end) {
+  const AxTsqrTask* t = (const AxTsqrTask*)ctx;
+  musz n = t->a->cols, m = t->a->rows;
+  musz esz = ax_dtype_size(t->a->dtype);
+  for (musz l = begin; l < end; l++) {
+    musz r0 = m * l / t->leaves, r1 = m * (l + 1) / t->leaves;
+    void* r = t->r + l * n * n * esz;
+    void* buf = t->buf + l * t->chunk * n * esz;
+    switch (t->a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+      case AX_##T: ax__tsqr_fold_##s((ct*)r, (ct*)buf, t->a, r0, r1, t->chunk); break;
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+  }
+}
+
+static void ax__tsqr_merge_task(void* ctx, musz begin, musz end) {
+  const AxTsqrTask* t = (const AxTsqrTask*)ctx;
+  musz n = t->a->cols;
+  musz esz = ax_dtype_size(t->a->dtype);
+  for (musz p = begin; p < end; p++) {
+    musz i = p * 2 * t->step, j = i + t->step;
+    if (j >= t->leaves) continue;
+    void* ri = t->r + i * n * n * esz;
+    void* rj = t->r + j * n * n * esz;
+    void* buf = t->buf + i * t->chunk * n * esz;
+    switch (t->a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+      case AX_##T: ax__tsqr_merge_##s((ct*)ri, (const ct*)rj, n, (ct*)buf, t->chunk); break;
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+  }
+}
+
+// r = R of [r; a]
+static bool ax__tsqr_fold(AxMatrix* r, const AxMatrix* a) {
+  musz m = a->rows, n = a->cols;
+  if (m == 0 || n == 0) return true;
+  musz esz = ax_dtype_size(a->dtype);
+  musz leaves = ax_thread_count();
+  if (leaves > m / n) leaves = m / n ? m / n : 1;
+  musz chunk = AX_TSQR_CHUNK / n > n ? AX_TSQR_CHUNK / n : n;
+  mu8* mem = (mu8*)calloc(leaves * (n * n + chunk * n), esz);
+  if (!mem) {
+    AX_LOG(AX_LOG_FATAL, "ax_tsqr: failed to allocate workspace");
+    return false;
+  }
+  AxTsqrTask t = { a, leaves, chunk, 0, mem, mem + leaves * n * n * esz };
+  // Leaf 0 continues from the triangle so far
+  for (musz i = 0; i < n; i++) memcpy(t.r + i * n * esz, (mu8*)r->data + i * r->stride * esz, n * esz);
+  ax_parallel_for(leaves, 1, ax__tsqr_leaf_task, &t);
+  for (t.step = 1; t.step < leaves; t.step *= 2) {
+    ax_parallel_for((leaves + 2 * t.step - 1) / (2 * t.step), 1, ax__tsqr_merge_task, &t);
+  }
+  for (musz i = 0; i < n; i++) memcpy((mu8*)r->data + i * r->stride * esz, t.r + i * n * esz, n * esz);
+  free(mem);
+  return true;
+}
+
+bool ax_tsqr_init(AxTSQR* tsqr, musz cols, AxDType dtype, Arena* arena) {
+  if (!tsqr) {
+    AX_LOG(AX_LOG_FATAL, "ax_tsqr_init: null state");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_tsqr_init: arena is NULL");
+    return false;
+  }
+  if (!ax__linalg_dtype_check("ax_tsqr_init", dtype)) return false;
+  tsqr->r = ax_matrix_create_dtype(cols, cols, dtype, arena);
+  tsqr->rows = 0;
+  if (!tsqr->r) return false;
+  ax__linalg_zero(tsqr->r);
+  return true;
+}
+
+bool ax_tsqr_push(AxTSQR* tsqr, const AxMatrix* block) {
+  if (!tsqr || !tsqr->r) {
+    AX_LOG(AX_LOG_FATAL, "ax_tsqr_push: null state");
+    return false;
+  }
+  if (!ax__linalg_pair_check("ax_tsqr_push", tsqr->r, block)) return false;
+  if (block->cols != tsqr->r->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_tsqr_push: block has %zu columns, expected %zu", block->cols, tsqr->r->cols);
+    return false;
+  }
+  if (!ax__tsqr_fold(tsqr->r, block)) return false;
+  tsqr->rows += block->rows;
+  return true;
+}
+
+bool ax_matrix_tsqr(const AxMatrix* a, AxMatrix* r) {
+  if (!ax__linalg_pair_check("ax_matrix_tsqr", a, r)) return false;
+  if (r->rows != a->cols || r->cols != a->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_tsqr: r is %zux%zu, expected %zux%zu", r->rows, r->cols, a->cols, a->cols);
+    return false;
+  }
+  // The triangle is merged row by row, so a column-strided `r` is staged
+  AxMatrix rs;
+  AxMatrix* ru = ax__unit_stage(r, &rs, false);
+  if (!ru) return false;
+  ax__linalg_zero(ru);
+  bool ok = ax__tsqr_fold(ru, a);
+  ax__unit_release(&rs, ok ? r : NULL);
+  return ok;
+}
+
+// Mixed-precision refinement, after LAPACK's dsgesv/dsposv. Either factor
+// type is held in one struct so both methods share the loop.
+typedef struct AxRefineFactor {
+  AxRefineMethod method;
+  AxLU lu;
+  AxCholesky chol;
+} AxRefineFactor;
+
+// r -= A x row by row, for x narrower than AX_LINALG_NARROW, given as
+// rows of xt (nrhs x n), where GEMM would pack A for little
+// work
+typedef struct AxResidualTask {
+  const AxMatrix* a;
+  const AxMatrix* xt;
+  AxMatrix* r;
+} AxResidualTask;
+
+static void ax__refine_residual_task(void* ctx, musz begin, musz end) {
+  const AxResidualTask* t = (const AxResidualTask*)ctx;
+  musz n = t->a->cols;
+  for (musz i = begin; i < end; i++) {
+    const double* ai = (const double*)t->a->data + i * t->a->stride;
+    double* ri = (double*)t->r->data + i * t->r->stride;
+    for (musz c = 0; c < t->r->cols; c++) {
+      const double* x = (const double*)t->xt->data + c * t->xt->stride;
+      double acc[4] = { 0 };
+      musz p = 0;
+      for (; p + 4 <= n; p += 4) {
+        for (musz q = 0; q < 4; q++) acc[q] += ai[p + q] * x[p + q];
+      }
+      for (; p < n; p++) acc[0] += ai[p] * x[p];
+      ri[c] -= (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+  }
+}
+
+static bool ax__refine_factor(AxRefineFactor* f, AxMatrix* a, Arena* arena) {
+  if (f->method == AX_REFINE_CHOLESKY) return ax__cholesky_factor(a, AX_LOWER, &f->chol);
+  return ax__lu_factor(a, &f->lu, arena) && !f->lu.singular;
+}
+
+static void ax__refine_solve(const AxRefineFactor* f, AxMatrix* b) {
+  if (f->method == AX_REFINE_CHOLESKY) {
+    ax__trsm_left(true, AX_NO_TRANS, false, f->chol.factor, b);
+    ax__trsm_left(true, AX_TRANS, false, f->chol.factor, b);
+  } else {
+    ax__lu_apply(&f->lu, b);
+  }
+}
+
+// Whether ||r_j||_inf <= ||x_j||_inf * tol for every column j (false on NaN)
+static bool ax__refine_converged(const AxMatrix* r, const AxMatrix* x, double tol) {
+  for (musz j = 0; j < r->cols; j++) {
+    double rn = 0.0, xn = 0.0;
+    for (musz i = 0; i < r->rows; i++) {
+      rn = fmax(rn, fabs(((const double*)r->data)[i * r->stride + j]));
+      xn = fmax(xn, fabs(((const double*)x->data)[i * x->stride + j]));
+    }
+    if (!(rn <= xn * tol)) return false;
+  }
+  return true;
+}
+
+bool ax_solve_refined(AxRefineMethod method, const AxMatrix* a, AxMatrix* b,
+                      AxRefineInfo* info, Arena* arena) {
+  if (!a || !b || !a->data || !b->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_solve_refined: null matrix");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_solve_refined: arena is NULL");
+    return false;
+  }
+  if (a->dtype != AX_F64 || b->dtype != AX_F64) {
+    AX_LOG(AX_LOG_FATAL, "ax_solve_refined: expected f64 operands, got %s and %s",
+           ax_dtype_name(a->dtype), ax_dtype_name(b->dtype));
+    return false;
+  }
+  if (a->rows != a->cols || b->rows != a->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_solve_refined: matrix is %zux%zu, right-hand side has %zu rows",
+           a->rows, a->cols, b->rows);
+    return false;
+  }
+  if (!ax__unit_cols(a) || !ax__unit_cols(b)) {
+    // The residual and norm loops walk rows, so strided views are staged
+    AxMatrix as, bs;
+    const AxMatrix* au = ax__unit_stage(a, &as, true);
+    AxMatrix* bu = ax__unit_stage(b, &bs, true);
+    bool ok = au && bu && ax_solve_refined(method, au, bu, info, arena);
+    ax__unit_release(&as, NULL);
+    ax__unit_release(&bs, ok ? b : NULL);
+    return ok;
+  }
+  musz n = a->rows, nrhs = b->cols;
+  AxRefineInfo dummy;
+  if (!info) info = &dummy;
+  info->iters = 0;
+  info->stalled = false;
+  info->fallback = false;
+  if (n == 0 || nrhs == 0) return true;
+
+  double anorm = 0.0;
+  for (musz i = 0; i < n; i++) {
+    const double* row = (const double*)a->data + i * a->stride;
+    double sum = 0.0;
+    for (musz j = 0; j < n; j++) sum += fabs(row[j]);
+    anorm = fmax(anorm, sum);
+  }
+  double tol = anorm * DBL_EPSILON * sqrt((double)n);
+
+  AxRefineFactor f = { method, { 0 }, { 0 } };
+  AxMatrix* a32 = ax_matrix_create_dtype(n, n, AX_F32, arena);
+  AxMatrix* x = ax_matrix_create_dtype(n, nrhs, AX_F64, arena);
+  AxMatrix* r = ax_matrix_create_dtype(n, nrhs, AX_F64, arena);
+  AxMatrix* d = ax_matrix_create_dtype(n, nrhs, AX_F32, arena);
+  AxMatrix* xt = ax_matrix_create_dtype(nrhs, n, AX_F64, arena);
+  if (!a32 || !x || !r || !d || !xt) {
+    AX_LOG(AX_LOG_FATAL, "ax_solve_refined: failed to allocate workspace");
+    return false;
+  }
+  ax_matrix_copy(a32, a);
+  if (ax__refine_factor(&f, a32, arena)) {
+    ax_matrix_copy(d, b);
+    ax__refine_solve(&f, d);
+    ax_matrix_copy(x, d);
+    double dprev = INFINITY;
+    for (;;) {
+      // r = b - A x in f64; the correction solves A d = r on the f32 factor
+      ax_matrix_copy(r, b);
+      if (nrhs < AX_LINALG_NARROW) {
+        ax_matrix_transpose_into(xt, x);
+        AxResidualTask t = { a, xt, r };
+        ax_parallel_for(n, 64, ax__refine_residual_task, &t);
+      } else {
+        ax_matrix_gemm(-1.0, a, AX_NO_TRANS, x, AX_NO_TRANS, 1.0, r);
+      }
+      if (ax__refine_converged(r, x, tol)) {
+        ax_matrix_copy(b, x);
+        return true;
+      }
+      if (info->iters == AX_REFINE_MAX_ITERS) break;
+      ax_matrix_copy(d, r);
+      ax__refine_solve(&f, d);
+      double dnorm = 0.0;
+      bool finite = true;
+      for (musz i = 0; i < n; i++) {
+        double* xr = (double*)x->data + i * x->stride;
+        const float* dr = (const float*)d->data + i * d->stride;
+        for (musz j = 0; j < nrhs; j++) {
+          finite = finite && isfinite(dr[j]);
+          dnorm = fmax(dnorm, fabs((double)dr[j]));
+          xr[j] += (double)dr[j];
+        }
+      }
+      info->iters++;
+      if (!finite || !(dnorm <= 0.5 * dprev)) {
+        info->stalled = true;
+        break;
+      }
+      dprev = dnorm;
+    }
+  }
+
+  info->fallback = true;
+  AxMatrix* a64 = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  if (!a64) {
+    AX_LOG(AX_LOG_FATAL, "ax_solve_refined: failed to allocate workspace");
+    return false;
+  }
+  ax_matrix_copy(a64, a);
+  if (!ax__refine_factor(&f, a64, arena)) {
+    AX_LOG(AX_LOG_WARN, "ax_solve_refined: matrix is %s",
+           method == AX_REFINE_CHOLESKY ? "not positive definite" : "singular");
+    return false;
+  }
+  ax__refine_solve(&f, b);
+  return true;
+}
+
+// Randomized SVD. Gaussian entries come from a splitmix64 hash of the seed
+// and the entry's index, through Box-Muller.
+static inline mu64 ax__rand_mix(mu64 x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+static inline double ax__randn_at(mu64 key, mu64 index) {
+  mu64 h1 = ax__rand_mix(key ^ (2 * index)), h2 = ax__rand_mix(key ^ (2 * index + 1));
+  double u1 = (double)((h1 >> 11) + 1) * 0x1.0p-53; // (0, 1]
+  double u2 = (double)(h2 >> 11) * 0x1.0p-53;
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+typedef struct AxRandnTask {
+  AxMatrix* mat;
+  mu64 key;
+  musz row0; // Global index of the first row, for generating in pieces
+} AxRandnTask;
+
+static void ax__randn_task(void* ctx, musz begin, musz end) {
+  const AxRandnTask* t = (const AxRandnTask*)ctx;
+  musz cols = t->mat->cols, cs = t->mat->col_stride;
+  for (musz i = begin; i < end; i++) {
+    mu64 base = (mu64)(t->row0 + i) * cols;
+    switch (t->mat->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+    case AX_##T: {                                                      \
+      ct* r = (ct*)t->mat->data + i * t->mat->stride;                   \
+      for (musz j = 0; j < cols; j++) r[j * cs] = (ct)ax__randn_at(t->key, base + j); \
+      break;                                                            \
+    }
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+  }
+}
+
+static void ax__randn_fill(AxMatrix* mat, mu64 seed, musz row0) {
+  AxRandnTask t = { mat, ax__rand_mix(seed), row0 };
+  ax_parallel_for(mat->rows, 4096 / (mat->cols + 1) + 1, ax__randn_task, &t);
+}
+
+bool ax_matrix_randn(AxMatrix* mat, mu64 seed) {
+  if (!mat || !mat->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_randn: null matrix");
+    return false;
+  }
+  if (!ax__linalg_dtype_check("ax_matrix_randn", mat->dtype)) return false;
+  ax__randn_fill(mat, seed, 0);
+  return true;
+}
+
+// Seed of the co-range test matrix Psi, distinct from Omega's
+#define AX__RSVD_PSI_SEED(seed) ((seed) ^ 0x5851F42D4C957F2DULL)
+
+// One-sided Jacobi on the l columns of m (column-major, l x l): rotates
+// pairs until all are orthogonal, accumulating the rotations in v, so that
+// M_in = M_out * V^T with the columns of M_out scaled singular vectors.
+static void ax__svd_jacobi(double* m, double* v, musz l) {
+  for (int sweep = 0; sweep < 64; sweep++) {
+    bool rotated = false;
+    for (musz p = 0; p + 1 < l; p++) {
+      for (musz q = p + 1; q < l; q++) {
+        double* mp = m + p * l;
+        double* mq = m + q * l;
+        double alpha = 0.0, beta = 0.0, gamma = 0.0;
+        for (musz i = 0; i < l; i++) {
+          alpha += mp[i] * mp[i];
+          beta += mq[i] * mq[i];
+          gamma += mp[i] * mq[i];
+        }
+        if (!(fabs(gamma) > DBL_EPSILON * sqrt(alpha * beta))) continue;
+        rotated = true;
+        double zeta = (beta - alpha) / (2.0 * gamma);
+        double t = (zeta >= 0 ? 1.0 : -1.0) / (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+        double c = 1.0 / sqrt(1.0 + t * t), sn = c * t;
+        double* vp = v + p * l;
+        double* vq = v + q * l;
+        for (musz i = 0; i < l; i++) {
+          double x = mp[i], y = mq[i];
+          mp[i] = c * x - sn * y;
+          mq[i] = sn * x + c * y;
+          x = vp[i];
+          y = vq[i];
+          vp[i] = c * x - sn * y;
+          vq[i] = sn * x + c * y;
+        }
+      }
+    }
+    if (!rotated) break;
+  }
+}
+
+// Overwrites y with its QR factor and q (same shape) with the orthonormal Q
+static void ax__rsvd_orth(AxMatrix* y, AxMatrix* q, Arena* scratch) {
+  AxQR qr;
+  ax_qr_factor(y, &qr, scratch);
+  ax_qr_form_q(&qr, q);
+}
+
+// y = (A - 1 mean) x
+static void ax__rsvd_mul(const AxMatrix* a, const AxMatrix* mean, const AxMatrix* x, AxMatrix* y,
+                         Arena* scratch) {
+  ax_matrix_gemm(1.0, a, AX_NO_TRANS, x, AX_NO_TRANS, 0.0, y);
+  if (!mean) return;
+  AxMatrix* mx = ax_matrix_create_dtype(1, x->cols, a->dtype, scratch);
+  AxMatrix* ones = ax_matrix_create_dtype(a->rows, 1, a->dtype, scratch);
+  for (musz i = 0; i < a->rows; i++) ax_matrix_set(ones, i, 0, 1.0);
+  ax_matrix_gemm(1.0, mean, AX_NO_TRANS, x, AX_NO_TRANS, 0.0, mx);
+  ax_matrix_gemm(-1.0, ones, AX_NO_TRANS, mx, AX_NO_TRANS, 1.0, y);
+}
+
+// z = (A - 1 mean)^T y
+static void ax__rsvd_mul_t(const AxMatrix* a, const AxMatrix* mean, const AxMatrix* y, AxMatrix* z,
+                           Arena* scratch) {
+  ax_matrix_gemm(1.0, a, AX_TRANS, y, AX_NO_TRANS, 0.0, z);
+  if (!mean) return;
+  AxMatrix* cs = ax_matrix_create_dtype(1, y->cols, a->dtype, scratch);
+  ax_matrix_sum(y, AX_AXIS_0, cs);
+  ax_matrix_gemm(-1.0, mean, AX_TRANS, cs, AX_NO_TRANS, 1.0, z);
+}
+
+static bool ax__rsvd_alloc(AxSVD* svd, musz rows, musz cols, musz k, AxDType dtype, Arena* arena) {
+  svd->u = ax_matrix_create_dtype(rows, k, dtype, arena);
+  svd->s = ax_matrix_create_dtype(1, k, dtype, arena);
+  svd->vt = ax_matrix_create_dtype(k, cols, dtype, arena);
+  svd->mean = NULL;
+  if (!svd->u || !svd->s || !svd->vt) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_rsvd: failed to allocate factors");
+    return false;
+  }
+  return true;
+}
+
+// Given Q (rows x l) with orthonormal columns and bt = (Q^T A)^T (cols x l,
+// overwritten), fills svd with the top k triplets of Q Q^T A. The small
+// SVD goes through bt = Q2 R: Jacobi on R^T = Ur S Vr^T gives U = Q Ur and
+// V = Q2 Vr.
+static bool ax__rsvd_project(const AxMatrix* q, AxMatrix* bt, musz k, AxSVD* svd, Arena* scratch) {
+  musz l = bt->cols, n = bt->rows;
+  AxQR qr2;
+  if (!ax_qr_factor(bt, &qr2, scratch)) return false;
+  double* m = (double*)ax_alloc(scratch, 2 * l * l * sizeof(double));
+  musz* order = (musz*)ax_alloc(scratch, l * sizeof(musz));
+  double* sig = (double*)ax_alloc(scratch, l * sizeof(double));
+  if (!m || !order || !sig) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_rsvd: failed to allocate workspace");
+    return false;
+  }
+  double* v = m + l * l;
+  for (musz p = 0; p < l; p++) {
+    for (musz i = 0; i < l; i++) {
+      m[p * l + i] = i >= p ? ax_matrix_get(bt, p, i) : 0.0; // Column p of R^T
+      v[p * l + i] = (i == p) ? 1.0 : 0.0;
+    }
+  }
+  ax__svd_jacobi(m, v, l);
+  for (musz p = 0; p < l; p++) {
+    double ss = 0.0;
+    for (musz i = 0; i < l; i++) ss += m[p * l + i] * m[p * l + i];
+    sig[p] = sqrt(ss);
+    order[p] = p;
+  }
+  for (musz p = 1; p < l; p++) { // Insertion sort, descending
+    musz o = order[p], j = p;
+    for (; j > 0 && sig[order[j - 1]] < sig[o]; j--) order[j] = order[j - 1];
+    order[j] = o;
+  }
+
+  AxMatrix* ur = ax_matrix_create_dtype(l, k, q->dtype, scratch);
+  AxMatrix* vk = ax_matrix_create_dtype(n, k, q->dtype, scratch);
+  if (!ur || !vk) return false;
+  ax__linalg_zero(vk);
+  for (musz c = 0; c < k; c++) {
+    musz o = order[c];
+    double inv = sig[o] > 0 ? 1.0 / sig[o] : 0.0;
+    for (musz i = 0; i < l; i++) {
+      ax_matrix_set(ur, i, c, m[o * l + i] * inv);
+      ax_matrix_set(vk, i, c, v[o * l + i]);
+    }
+    ax_matrix_set(svd->s, 0, c, sig[o]);
+  }
+  ax_matrix_gemm(1.0, q, AX_NO_TRANS, ur, AX_NO_TRANS, 0.0, svd->u);
+  ax_qr_apply(&qr2, AX_NO_TRANS, vk);
+  ax_matrix_transpose_into(svd->vt, vk);
+
+  // Fix signs so each row of vt has its largest entry positive
+  for (musz c = 0; c < k; c++) {
+    double big = 0.0;
+    for (musz j = 0; j < n; j++) {
+      double x = ax_matrix_get(svd->vt, c, j);
+      if (fabs(x) > fabs(big)) big = x;
+    }
+    if (big >= 0) continue;
+    for (musz j = 0; j < n; j++) ax_matrix_set(svd->vt, c, j, -ax_matrix_get(svd->vt, c, j));
+    for (musz i = 0; i < svd->u->rows; i++) ax_matrix_set(svd->u, i, c, -ax_matrix_get(svd->u, i, c));
+  }
+  return true;
+}
+
+// Sample count l = rank + oversample, capped by the shape
+static bool ax__rsvd_check(const char* fn, musz rows, musz cols, AxDType dtype,
+                           const AxRsvdParams* params, musz* l) {
+  if (!params) {
+    AX_LOG(AX_LOG_FATAL, "%s: null parameters", fn);
+    return false;
+  }
+  if (!ax__linalg_dtype_check(fn, dtype)) return false;
+  musz lim = rows < cols ? rows : cols;
+  if (params->rank == 0 || params->rank > lim) {
+    AX_LOG(AX_LOG_FATAL, "%s: rank %zu is outside [1, %zu]", fn, params->rank, lim);
+    return false;
+  }
+  *l = params->rank + params->oversample;
+  if (*l > lim) *l = lim;
+  return true;
+}
+
+bool ax_matrix_rsvd(const AxMatrix* a, const AxRsvdParams* params, AxSVD* svd, Arena* arena) {
+  if (!a || !a->data || !svd) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_rsvd: null matrix");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_rsvd: arena is NULL");
+    return false;
+  }
+  musz l;
+  if (!ax__rsvd_check("ax_matrix_rsvd", a->rows, a->cols, a->dtype, params, &l)) return false;
+  musz m = a->rows, n = a->cols;
+  if (!ax__rsvd_alloc(svd, m, n, params->rank, a->dtype, arena)) return false;
+  if (params->center) {
+    svd->mean = ax_matrix_create_dtype(1, n, a->dtype, arena);
+    if (!svd->mean) return false;
+    ax_matrix_mean(a, AX_AXIS_0, svd->mean);
+  }
+
+  Arena* scratch = ax_arena_create(1 << 20);
+  AxMatrix* omega = ax_matrix_create_dtype(n, l, a->dtype, scratch);
+  AxMatrix* y = ax_matrix_create_dtype(m, l, a->dtype, scratch);
+  AxMatrix* q = ax_matrix_create_dtype(m, l, a->dtype, scratch);
+  AxMatrix* z = ax_matrix_create_dtype(n, l, a->dtype, scratch);
+  AxMatrix* qz = ax_matrix_create_dtype(n, l, a->dtype, scratch);
+  bool ok = omega && y && q && z && qz;
+  if (ok) {
+    // Range of A Omega, refined by power iterations (A A^T)^p A Omega with
+    // each product re-orthogonalized to keep small directions
+    ax__randn_fill(omega, params->seed, 0);
+    ax__rsvd_mul(a, svd->mean, omega, y, scratch);
+    ax__rsvd_orth(y, q, scratch);
+    for (musz it = 0; it < params->power_iters; it++) {
+      ax__rsvd_mul_t(a, svd->mean, q, z, scratch);
+      ax__rsvd_orth(z, qz, scratch);
+      ax__rsvd_mul(a, svd->mean, qz, y, scratch);
+      ax__rsvd_orth(y, q, scratch);
+    }
+    ax__rsvd_mul_t(a, svd->mean, q, z, scratch);
+    ok = ax__rsvd_project(q, z, params->rank, svd, scratch);
+  } else {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_rsvd: failed to allocate workspace");
+  }
+  ax_arena_destroy(scratch);
+  return ok;
+}
+
+bool ax_rsvd_stream_init(AxRsvdStream* st, musz rows, musz cols, AxDType dtype,
+                         const AxRsvdParams* params, Arena* arena) {
+  if (!st) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_init: null stream");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_init: arena is NULL");
+    return false;
+  }
+  musz l;
+  if (!ax__rsvd_check("ax_rsvd_stream_init", rows, cols, dtype, params, &l)) return false;
+  musz l2 = 2 * l + 1 < rows ? 2 * l + 1 : rows;
+  st->params = *params;
+  st->rows = rows;
+  st->cols = cols;
+  st->pushed = 0;
+  st->omega = ax_matrix_create_dtype(cols, l, dtype, arena);
+  st->y = ax_matrix_create_dtype(rows, l, dtype, arena);
+  st->w = ax_matrix_create_dtype(l2, cols, dtype, arena);
+  st->psum = ax_matrix_create_dtype(1, l2, AX_F64, arena);
+  st->colsum = ax_matrix_create_dtype(1, cols, AX_F64, arena);
+  if (!st->omega || !st->y || !st->w || !st->psum || !st->colsum) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_init: failed to allocate sketches");
+    return false;
+  }
+  ax__randn_fill(st->omega, params->seed, 0);
+  ax__linalg_zero(st->w);
+  ax__linalg_zero(st->psum);
+  ax__linalg_zero(st->colsum);
+  return true;
+}
+
+// out (1 x n, f64) += column sums of a
+static void ax__rsvd_accumulate_sums(AxMatrix* out, const AxMatrix* a, Arena* scratch) {
+  AxMatrix* cs = ax_matrix_create_dtype(1, a->cols, AX_F64, scratch);
+  ax_matrix_sum(a, AX_AXIS_0, cs);
+  for (musz j = 0; j < a->cols; j++) ((double*)out->data)[j] += ((const double*)cs->data)[j];
+}
+
+bool ax_rsvd_stream_push(AxRsvdStream* st, const AxMatrix* block) {
+  if (!st || !st->y || !block || !block->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_push: null matrix");
+    return false;
+  }
+  if (block->dtype != st->y->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_push: dtype %s does not match the stream's %s",
+           ax_dtype_name(block->dtype), ax_dtype_name(st->y->dtype));
+    return false;
+  }
+  if (block->cols != st->cols || block->rows > st->rows - st->pushed) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_push: %zux%zu block does not fit, %zu of %zux%zu rows pushed",
+           block->rows, block->cols, st->pushed, st->rows, st->cols);
+    return false;
+  }
+  if (block->rows == 0) return true;
+  musz r0 = st->pushed, l2 = st->w->rows;
+  AxMatrix yb = ax__linalg_view(st->y, r0, r0 + block->rows, 0, st->y->cols);
+  ax_matrix_gemm(1.0, block, AX_NO_TRANS, st->omega, AX_NO_TRANS, 0.0, &yb);
+
+  // Psi's columns for these rows, generated by global row index
+  Arena* scratch = ax_arena_create(1 << 20);
+  AxMatrix* psit = ax_matrix_create_dtype(block->rows, l2, block->dtype, scratch);
+  if (!psit) {
+    ax_arena_destroy(scratch);
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_push: failed to allocate workspace");
+    return false;
+  }
+  ax__randn_fill(psit, AX__RSVD_PSI_SEED(st->params.seed), r0);
+  ax_matrix_gemm(1.0, psit, AX_TRANS, block, AX_NO_TRANS, 1.0, st->w);
+  if (st->params.center) {
+    ax__rsvd_accumulate_sums(st->psum, psit, scratch);
+    ax__rsvd_accumulate_sums(st->colsum, block, scratch);
+  }
+  ax_arena_destroy(scratch);
+  st->pushed += block->rows;
+  return true;
+}
+
+// Rows of Psi^T regenerated per step of ax_rsvd_stream_finish
+#define AX_RSVD_STREAM_BLOCK 4096
+
+bool ax_rsvd_stream_finish(AxRsvdStream* st, AxSVD* svd, Arena* arena) {
+  if (!st || !st->y || !svd) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_finish: null stream");
+    return false;
+  }
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_finish: arena is NULL");
+    return false;
+  }
+  if (st->pushed != st->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_finish: %zu of %zu rows pushed", st->pushed, st->rows);
+    return false;
+  }
+  AxDType dtype = st->y->dtype;
+  musz m = st->rows, n = st->cols, l = st->y->cols, l2 = st->w->rows;
+  if (!ax__rsvd_alloc(svd, m, n, st->params.rank, dtype, arena)) return false;
+  musz nb = m < AX_RSVD_STREAM_BLOCK ? m : AX_RSVD_STREAM_BLOCK;
+  Arena* scratch = ax_arena_create(1 << 20);
+  AxMatrix* q = ax_matrix_create_dtype(m, l, dtype, scratch);
+  AxMatrix* psiq = ax_matrix_create_dtype(l2, l, dtype, scratch);
+  AxMatrix* psit = ax_matrix_create_dtype(nb, l2, dtype, scratch);
+  AxMatrix* xt = ax_matrix_create_dtype(n, l, dtype, scratch);
+  bool ok = q && psiq && psit && xt;
+  if (ok && st->params.center) {
+    // (A - 1 mean) Omega = Y - 1 (mean Omega), Psi (A - 1 mean) = W - (Psi 1) mean
+    svd->mean = ax_matrix_create_dtype(1, n, dtype, arena);
+    AxMatrix* psum = ax_matrix_create_dtype(1, l2, dtype, scratch);
+    AxMatrix* mo = ax_matrix_create_dtype(1, l, dtype, scratch);
+    AxMatrix* ones = ax_matrix_create_dtype(m, 1, dtype, scratch);
+    ok = svd->mean && psum && mo && ones;
+    if (ok) {
+      for (musz j = 0; j < n; j++) ax_matrix_set(svd->mean, 0, j, ax_matrix_get(st->colsum, 0, j) / (double)m);
+      for (musz i = 0; i < m; i++) ax_matrix_set(ones, i, 0, 1.0);
+      ax_matrix_copy(psum, st->psum);
+      ax_matrix_gemm(1.0, svd->mean, AX_NO_TRANS, st->omega, AX_NO_TRANS, 0.0, mo);
+      ax_matrix_gemm(-1.0, ones, AX_NO_TRANS, mo, AX_NO_TRANS, 1.0, st->y);
+      ax_matrix_gemm(-1.0, psum, AX_TRANS, svd->mean, AX_NO_TRANS, 1.0, st->w);
+    }
+  }
+  if (ok) {
+    // Q spans the range sketch, and X = (Psi Q)^+ W is the least-squares
+    // fit of Psi Q X = Psi A, approximating Q^T A
+    ax__rsvd_orth(st->y, q, scratch);
+    ax__linalg_zero(psiq);
+    for (musz r0 = 0; r0 < m; r0 += nb) {
+      musz r1 = m - r0 < nb ? m : r0 + nb;
+      AxMatrix pv = ax__linalg_view(psit, 0, r1 - r0, 0, l2);
+      AxMatrix qv = ax__linalg_view(q, r0, r1, 0, l);
+      ax__randn_fill(&pv, AX__RSVD_PSI_SEED(st->params.seed), r0);
+      ax_matrix_gemm(1.0, &pv, AX_TRANS, &qv, AX_NO_TRANS, 1.0, psiq);
+    }
+    AxQR qr;
+    ok = ax_qr_factor(psiq, &qr, scratch) && ax_qr_solve(&qr, st->w);
+    if (ok) {
+      AxMatrix x = ax__linalg_view(st->w, 0, l, 0, n);
+      ax_matrix_transpose_into(xt, &x);
+      ok = ax__rsvd_project(q, xt, st->params.rank, svd, scratch);
+    }
+  } else {
+    AX_LOG(AX_LOG_FATAL, "ax_rsvd_stream_finish: failed to allocate workspace");
+  }
+  ax_arena_destroy(scratch);
+  return ok;
+}
+
+// Symmetric eigensolver. The reduction to tridiagonal form follows
+// LAPACK's sytrd/latrd: within a panel each column is brought up to date
+// from the panel's reflectors V and their companions W, and the trailing
+// matrix then takes A -= V W^T + W V^T through GEMM. Both triangles are
+// kept so rows can stand in for columns. The reflector for column j acts
+// on rows j+1 onward and is stored below the subdiagonal, the layout of a
+// QR factor of A[1:, :n-1], so the back-transformation reuses the QR block
+// reflectors.
+
+// Columns per panel of the tridiagonal reduction
+#define AX_EIG_NB 32
+// Largest tridiagonal block solved by implicit QL in divide and conquer
+#define AX_EIG_DC_LEAF 32
+
+// y = A v for the symmetric trailing block, reading only its lower
+// triangle: each row contributes a dot product to its own entry and an
+// update to the entries left of the diagonal. Chunks of rows of about
+// equal area accumulate into their own partial vectors.
+typedef struct AxSymvTask {
+  const AxMatrix* a;
+  const void* v;
+  void* part;  // chunks x a->rows partial sums
+  musz chunks;
+} AxSymvTask;
+
+static inline musz ax__symv_bound(musz n, musz chunks, musz c) {
+  return c == chunks ? n : (musz)((double)n * sqrt((double)c / (double)chunks));
+}
+
+#define AX__EIG_DEFINE(T, s, ct)                                        \
+  static void ax__eig_mirror_##s(ct* a, musz lda, musz n) {             \
+    for (musz i = 0; i < n; i++) {                                      \
+      for (musz j = 0; j < i; j++) a[j * lda + i] = a[i * lda + j];     \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static void ax__symv_task_##s(void* ctx, musz begin, musz end) {      \
+    const AxSymvTask* t = (const AxSymvTask*)ctx;                       \
+    musz n = t->a->rows;                                                \
+    const ct* v = (const ct*)t->v;                                      \
+    for (musz ch = begin; ch < end; ch++) {                             \
+      musz r0 = ax__symv_bound(n, t->chunks, ch), r1 = ax__symv_bound(n, t->chunks, ch + 1); \
+      ct* y = (ct*)t->part + ch * n;                                    \
+      memset(y, 0, (ch == 0 ? n : r1) * sizeof(ct));                    \
+      for (musz r = r0; r < r1; r++) {                                  \
+        const ct* row = (const ct*)t->a->data + r * t->a->stride;       \
+        ct vr = v[r], acc[8] = { 0 };                                   \
+        musz c = 0;                                                     \
+        for (; c + 8 <= r; c += 8) {                                    \
+          for (musz q = 0; q < 8; q++) {                                \
+            acc[q] += row[c + q] * v[c + q];                            \
+            y[c + q] += row[c + q] * vr;                                \
+          }                                                             \
+        }                                                               \
+        for (; c < r; c++) {                                            \
+          acc[0] += row[c] * v[c];                                      \
+          y[c] += row[c] * vr;                                          \
+        }                                                               \
+        y[r] += ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7])) \
+                + row[r] * vr;                                          \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Reduces am (n x n, both triangles) to tridiagonal (d, e) with */   \
+  /* reflectors H_j = I - tau_j v_j v_j^T. vp and wp hold n x nb */     \
+  /* panels of V and W, part `chunks` vectors of n for the products. */ \
+  static void ax__sytrd_##s(AxMatrix* am, double* d, double* e, ct* tau, \
+                            ct* vp, ct* wp, ct* part, musz chunks) {    \
+    ct* a = (ct*)am->data;                                              \
+    musz lda = am->stride, n = am->rows, nb = AX_EIG_NB;                \
+    for (musz p0 = 0; p0 < n; p0 += nb) {                               \
+      musz pb = n - p0 < nb ? n - p0 : nb, p1 = p0 + pb;                \
+      memset(vp, 0, n * nb * sizeof(ct));                               \
+      memset(wp, 0, n * nb * sizeof(ct));                               \
+      for (musz i = 0; i < pb; i++) {                                   \
+        musz j = p0 + i;                                                \
+        ct* x = a + j * lda;                                            \
+        /* Row j (= column j) minus this panel's earlier updates */     \
+        for (musz r = j; r < n; r++) {                                  \
+          ct acc = 0;                                                   \
+          for (musz c = 0; c < i; c++) acc += vp[r * nb + c] * wp[j * nb + c] + wp[r * nb + c] * vp[j * nb + c]; \
+          x[r] -= acc;                                                  \
+        }                                                               \
+        d[j] = (double)x[j];                                            \
+        if (j + 1 == n) break;                                          \
+        musz len = n - j - 1;                                           \
+        ct* v = x + j + 1;                                              \
+        double alpha = (double)v[0];                                    \
+        double ss = len > 1 ? (double)ax__qr_dot_##s(v + 1, v + 1, len - 1) : 0.0; \
+        ct tj = 0;                                                      \
+        e[j] = alpha;                                                   \
+        if (ss != 0.0) {                                                \
+          double norm = sqrt(alpha * alpha + ss);                       \
+          double beta = alpha >= 0.0 ? -norm : norm;                    \
+          tj = (ct)((beta - alpha) / beta);                             \
+          ct scale = (ct)(1.0 / (alpha - beta));                        \
+          for (musz r = 1; r < len; r++) v[r] *= scale;                 \
+          e[j] = beta;                                                  \
+        }                                                               \
+        v[0] = 1;                                                       \
+        tau[j] = tj;                                                    \
+        for (musz r = 0; r < len; r++) {                                \
+          vp[(j + 1 + r) * nb + i] = v[r];                              \
+          if (r > 0) a[(j + 1 + r) * lda + j] = v[r];                   \
+        }                                                               \
+        if (tj == 0) continue;                                          \
+        /* w = tau (A22 v - V W^T v - W V^T v), then w -= tau/2 (w.v) v */ \
+        AxMatrix a22 = { len, len, lda, 1, a + (j + 1) * lda + j + 1, AX_##T, false }; \
+        musz ch = len / 256 + 1 < chunks ? len / 256 + 1 : chunks;      \
+        AxSymvTask st = { &a22, v, part, ch };                          \
+        ax_parallel_for(ch, 1, ax__symv_task_##s, &st);                 \
+        ct* y = part;                                                   \
+        for (musz c = 1; c < ch; c++) {                                 \
+          const ct* pc = part + c * len;                                \
+          for (musz r = 0; r < ax__symv_bound(len, ch, c + 1); r++) y[r] += pc[r]; \
+        }                                                               \
+        for (musz c = 0; c < i; c++) {                                  \
+          ct wv = 0, vv = 0;                                            \
+          for (musz r = 0; r < len; r++) {                              \
+            wv += wp[(j + 1 + r) * nb + c] * v[r];                      \
+            vv += vp[(j + 1 + r) * nb + c] * v[r];                      \
+          }                                                             \
+          for (musz r = 0; r < len; r++) {                              \
+            y[r] -= vp[(j + 1 + r) * nb + c] * wv + wp[(j + 1 + r) * nb + c] * vv; \
+          }                                                             \
+        }                                                               \
+        for (musz r = 0; r < len; r++) y[r] *= tj;                      \
+        ct half = (ct)(-0.5) * tj * ax__qr_dot_##s(y, v, len);          \
+        for (musz r = 0; r < len; r++) wp[(j + 1 + r) * nb + i] = y[r] + half * v[r]; \
+      }                                                                 \
+      if (p1 >= n) break;                                               \
+      AxMatrix a22 = { n - p1, n - p1, lda, 1, a + p1 * lda + p1, AX_##T, false }; \
+      AxMatrix v2 = { n - p1, pb, nb, 1, vp + p1 * nb, AX_##T, false };       \
+      AxMatrix w2 = { n - p1, pb, nb, 1, wp + p1 * nb, AX_##T, false };       \
+      ax_matrix_gemm(-1.0, &v2, AX_NO_TRANS, &w2, AX_TRANS, 1.0, &a22); \
+      ax_matrix_gemm(-1.0, &w2, AX_NO_TRANS, &v2, AX_TRANS, 1.0, &a22); \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__EIG_DEFINE)
+#undef AX__EIG_DEFINE
+
+// Implicit QL with Wilkinson shifts on (d, e), e[i] coupling i and i + 1.
+// Rotations are accumulated into the columns of z (n rows, row stride
+// ldz) when it is not NULL. False if some eigenvalue takes over 60 sweeps.
+static bool ax__tql(double* d, double* e, musz n, double* z, musz ldz) {
+  if (n == 0) return true;
+  e[n - 1] = 0.0;
+  for (musz l = 0; l < n; l++) {
+    int iter = 0;
+    for (;;) {
+      musz m = l;
+      for (; m + 1 < n; m++) {
+        double dd = fabs(d[m]) + fabs(d[m + 1]);
+        if (fabs(e[m]) <= DBL_EPSILON * dd) break;
+      }
+      if (m == l) break;
+      if (iter++ == 60) return false;
+      double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+      double r = hypot(g, 1.0);
+      g = d[m] - d[l] + e[l] / (g + (g >= 0 ? r : -r));
+      double s = 1.0, c = 1.0, p = 0.0;
+      bool underflow = false;
+      for (musz i = m; i-- > l;) {
+        double f = s * e[i], b = c * e[i];
+        r = hypot(f, g);
+        e[i + 1] = r;
+        if (r == 0.0) {
+          d[i + 1] -= p;
+          e[m] = 0.0;
+          underflow = true;
+          break;
+        }
+        s = f / r;
+        c = g / r;
+        g = d[i + 1] - p;
+        r = (d[i] - g) * s + 2.0 * c * b;
+        p = s * r;
+        d[i + 1] = g + p;
+        g = c * r - b;
+        if (z) {
+          for (musz k = 0; k < n; k++) {
+            double* zk = z + k * ldz;
+            f = zk[i + 1];
+            zk[i + 1] = s * zk[i] + c * f;
+            zk[i] = c * zk[i] - s * f;
+          }
+        }
+      }
+      if (underflow) continue;
+      d[l] -= p;
+      e[l] = g;
+      e[m] = 0.0;
+    }
+  }
+  return true;
+}
+
+// Sorts d ascending, carrying the columns of z (n rows) along
+static void ax__eig_sort(double* d, musz n, double* z, musz ldz) {
+  for (musz i = 0; i + 1 < n; i++) {
+    musz k = i;
+    for (musz j = i + 1; j < n; j++) {
+      if (d[j] < d[k]) k = j;
+    }
+    if (k == i) continue;
+    double t = d[i];
+    d[i] = d[k];
+    d[k] = t;
+    if (!z) continue;
+    for (musz r = 0; r < n; r++) {
+      t = z[r * ldz + i];
+      z[r * ldz + i] = z[r * ldz + k];
+      z[r * ldz + k] = t;
+    }
+  }
+}
+
+// Root i of the secular equation 1/beta + sum_j z_j^2 / (d_j - x) = 0 for
+// sorted d (K entries), as x = d[org] + mu with org the nearer pole, so
+// differences d_j - x stay accurate. Iterates on a two-pole rational model
+// of the equation (Bunch, Nielsen and Sorensen) inside a shrinking bracket.
+static void ax__secular_root(const double* d, const double* z, musz k, double beta, musz i,
+                             musz* org, double* mu) {
+  double inv = 1.0 / beta;
+  musz o = i;
+  double lo, hi;
+  if (i + 1 < k) {
+    double mid = 0.5 * (d[i + 1] - d[i]);
+    double f = inv;
+    for (musz j = 0; j < k; j++) f += z[j] * z[j] / ((d[j] - d[i]) - mid);
+    if (f >= 0) {
+      lo = 0.0;
+      hi = mid;
+    } else {
+      o = i + 1;
+      lo = -mid;
+      hi = 0.0;
+    }
+  } else {
+    double zz = 0.0;
+    for (musz j = 0; j < k; j++) zz += z[j] * z[j];
+    lo = 0.0;
+    hi = beta * zz;
+  }
+  double m = 0.5 * (lo + hi);
+  for (int it = 0; it < 100; it++) {
+    double psi = 0.0, dpsi = 0.0, phi = 0.0, dphi = 0.0;
+    for (musz j = 0; j <= i; j++) {
+      double t = z[j] / ((d[j] - d[o]) - m);
+      psi += z[j] * t;
+      dpsi += t * t;
+    }
+    for (musz j = i + 1; j < k; j++) {
+      double t = z[j] / ((d[j] - d[o]) - m);
+      phi += z[j] * t;
+      dphi += t * t;
+    }
+    double f = inv + psi + phi;
+    if (f == 0.0) break;
+    if (f > 0) hi = m;
+    else lo = m;
+    if (fabs(f) <= 8.0 * (double)k * DBL_EPSILON * (inv + fabs(psi) + fabs(phi))) break;
+    if (hi - lo <= 2.0 * DBL_EPSILON * fmax(fabs(lo), fabs(hi))) break;
+    // f ~ c + s / (di - eta) + S / (di1 - eta) around m, solved for the step
+    double di = (d[i] - d[o]) - m;
+    double s = di * di * dpsi;
+    double eta;
+    if (i + 1 < k) {
+      double di1 = (d[i + 1] - d[o]) - m;
+      double big = di1 * di1 * dphi;
+      double c = f - di * dpsi - di1 * dphi;
+      double qa = c, qb = -(c * (di + di1) + s + big), qc = c * di * di1 + s * di1 + big * di;
+      if (qa == 0.0) {
+        eta = -qc / qb;
+      } else {
+        double disc = fmax(qb * qb - 4.0 * qa * qc, 0.0);
+        double q = -0.5 * (qb + (qb >= 0 ? sqrt(disc) : -sqrt(disc)));
+        double r1 = q / qa, r2 = q != 0.0 ? qc / q : r1;
+        eta = (r1 > di && r1 < di1) ? r1 : r2;
+      }
+    } else {
+      double c = f - di * dpsi;
+      eta = di + s / c;
+    }
+    double next = m + eta;
+    m = (next > lo && next < hi) ? next : 0.5 * (lo + hi);
+  }
+  *org = o;
+  *mu = m;
+}
+
+typedef struct AxSecularTask {
+  const double* d;
+  const double* z;
+  double* zhat;
+  double* u;  // k x k, row-major: column i is eigenvector i
+  musz* org;
+  double* mu;
+  musz k;
+  double beta;
+} AxSecularTask;
+
+static void ax__secular_roots_task(void* ctx, musz begin, musz end) {
+  const AxSecularTask* t = (const AxSecularTask*)ctx;
+  for (musz i = begin; i < end; i++) ax__secular_root(t->d, t->z, t->k, t->beta, i, &t->org[i], &t->mu[i]);
+}
+
+// d_j - lambda_i, accurate through lambda_i's pole offset
+static inline double ax__secular_gap(const AxSecularTask* t, musz j, musz i) {
+  return (t->d[j] - t->d[t->org[i]]) - t->mu[i];
+}
+
+// z recomputed from the roots (Gu and Eisenstat), so the eigenvectors
+// z_j / (d_j - lambda_i) come out orthogonal to working precision
+static void ax__secular_zhat_task(void* ctx, musz begin, musz end) {
+  const AxSecularTask* t = (const AxSecularTask*)ctx;
+  musz k = t->k;
+  for (musz j = begin; j < end; j++) {
+    double p = -ax__secular_gap(t, j, k - 1) / t->beta;
+    for (musz i = 0; i < j; i++) p *= ax__secular_gap(t, j, i) / (t->d[j] - t->d[i]);
+    for (musz i = j; i + 1 < k; i++) p *= ax__secular_gap(t, j, i) / (t->d[j] - t->d[i + 1]);
+    double zh = sqrt(fabs(p));
+    t->zhat[j] = t->z[j] >= 0 ? zh : -zh;
+  }
+}
+
+static void ax__secular_vectors_task(void* ctx, musz begin, musz end) {
+  const AxSecularTask* t = (const AxSecularTask*)ctx;
+  musz k = t->k;
+  for (musz i = begin; i < end; i++) {
+    double ss = 0.0;
+    for (musz j = 0; j < k; j++) {
+      double v = t->zhat[j] / ax__secular_gap(t, j, i);
+      t->u[j * k + i] = v;
+      ss += v * v;
+    }
+    double inv = 1.0 / sqrt(ss);
+    for (musz j = 0; j < k; j++) t->u[j * k + i] *= inv;
+  }
+}
+
+typedef struct AxEigEntry {
+  double value;
+  musz src;
+} AxEigEntry;
+
+static int ax__eig_entry_cmp(const void* x, const void* y) {
+  double a = ((const AxEigEntry*)x)->value, b = ((const AxEigEntry*)y)->value;
+  return (a > b) - (a < b);
+}
+
+// Merges two solved halves (d sorted within [0, m) and [m, n), their
+// eigenvectors in the diagonal blocks of q) across the rank-one coupling
+// beta * u u^T, u = [last row of Q1, sign * first row of Q2]. Deflation
+// (Cuppen, as in LAPACK's laed2) drops components with tiny weight or
+// nearly equal poles; the rest go through the secular equation and one
+// GEMM with the stacked eigenvectors.
+static bool ax__dc_merge(double* d, musz n, musz m, double beta, double sign, double* q, musz ldq) {
+  musz* idx = (musz*)malloc(n * sizeof(musz));
+  double* z = (double*)malloc(4 * n * sizeof(double));
+  AxEigEntry* ent = (AxEigEntry*)malloc(n * sizeof(AxEigEntry));
+  if (!idx || !z || !ent) {
+    free(idx);
+    free(z);
+    free(ent);
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_eigh: failed to allocate merge workspace");
+    return false;
+  }
+  double* ds = z + n;  // Sorted poles
+  double* zs = z + 2 * n;
+  double* zhat = z + 3 * n;
+  for (musz j = 0; j < m; j++) z[j] = q[(m - 1) * ldq + j] * 0.7071067811865476;
+  for (musz j = m; j < n; j++) z[j] = sign * q[m * ldq + j] * 0.7071067811865476;
+  beta *= 2.0;
+  for (musz a = 0, b = m, k = 0; k < n; k++) {
+    idx[k] = (b >= n || (a < m && d[a] <= d[b])) ? a++ : b++;
+  }
+  double dmax = 0.0;
+  for (musz k = 0; k < n; k++) {
+    ds[k] = d[idx[k]];
+    zs[k] = z[idx[k]];
+    dmax = fmax(dmax, fabs(ds[k]));
+  }
+  double tol = 8.0 * DBL_EPSILON * fmax(dmax, beta);
+
+  // Kept poles are compacted to the front of (ds, zs, idx); deflated ones
+  // are recorded in ent with their column
+  musz kept = 0, ndef = 0, pj = n;
+  for (musz k = 0; k < n; k++) {
+    if (beta * fabs(zs[k]) <= tol) {
+      ent[ndef++] = (AxEigEntry){ ds[k], idx[k] };
+      continue;
+    }
+    if (pj == n) {
+      pj = k;
+      continue;
+    }
+    double s = zs[pj], c = zs[k], tau = hypot(c, s), t = ds[k] - ds[pj];
+    c /= tau;
+    s = -s / tau;
+    if (fabs(t * c * s) <= tol) {
+      // Rotate the two columns so z[pj] vanishes, then deflate pj
+      zs[k] = tau;
+      zs[pj] = 0.0;
+      for (musz r = 0; r < n; r++) {
+        double* x = q + r * ldq + idx[pj];
+        double* y = q + r * ldq + idx[k];
+        double xv = *x, yv = *y;
+        *x = c * xv + s * yv;
+        *y = c * yv - s * xv;
+      }
+      double dp = ds[pj] * c * c + ds[k] * s * s;
+      ds[k] = ds[pj] * s * s + ds[k] * c * c;
+      ent[ndef++] = (AxEigEntry){ dp, idx[pj] };
+    } else {
+      ds[kept] = ds[pj];
+      zs[kept] = zs[pj];
+      idx[kept++] = idx[pj];
+    }
+    pj = k;
+  }
+  if (pj != n) {
+    ds[kept] = ds[pj];
+    zs[kept] = zs[pj];
+    idx[kept++] = idx[pj];
+  }
+
+  // Columns of q feeding the kept poles and the deflated eigenvectors,
+  // copied out before q is overwritten
+  double* qk = (double*)malloc((n * (kept + ndef) + kept * kept + 1) * sizeof(double) + 2 * kept * sizeof(double) + kept * sizeof(musz));
+  if (!qk) {
+    free(idx);
+    free(z);
+    free(ent);
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_eigh: failed to allocate merge workspace");
+    return false;
+  }
+  double* qd = qk + n * kept;
+  double* u = qd + n * ndef;
+  double* mu = u + kept * kept;
+  musz* org = (musz*)(mu + kept);
+  for (musz r = 0; r < n; r++) {
+    const double* row = q + r * ldq;
+    for (musz j = 0; j < kept; j++) qk[r * kept + j] = row[idx[j]];
+    for (musz j = 0; j < ndef; j++) qd[r * ndef + j] = row[ent[j].src];
+  }
+  if (kept > 0) {
+    AxSecularTask st = { ds, zs, zhat, u, org, mu, kept, beta };
+    ax_parallel_for(kept, 16, ax__secular_roots_task, &st);
+    ax_parallel_for(kept, 16, ax__secular_zhat_task, &st);
+    ax_parallel_for(kept, 16, ax__secular_vectors_task, &st);
+    AxMatrix am = { n, kept, kept, 1, qk, AX_F64, false };
+    AxMatrix bm = { kept, kept, kept, 1, u, AX_F64, false };
+    AxMatrix cm = { n, kept, ldq, 1, q, AX_F64, false };
+    ax_matrix_gemm(1.0, &am, AX_NO_TRANS, &bm, AX_NO_TRANS, 0.0, &cm);
+  }
+  // Columns [0, kept) now hold the secular eigenvectors and [kept, n) the
+  // deflated ones; sort the lot by eigenvalue
+  for (musz j = 0; j < ndef; j++) {
+    for (musz r = 0; r < n; r++) q[r * ldq + kept + j] = qd[r * ndef + j];
+    ent[j].src = kept + j;
+  }
+  for (musz i = 0; i < kept; i++) ent[ndef + i] = (AxEigEntry){ ds[org[i]] + mu[i], i };
+  qsort(ent, n, sizeof(AxEigEntry), ax__eig_entry_cmp);
+  for (musz r = 0; r < n; r++) {
+    double* row = q + r * ldq;
+    for (musz j = 0; j < n; j++) zhat[j] = row[ent[j].src];
+    memcpy(row, zhat, n * sizeof(double));
+  }
+  for (musz j = 0; j < n; j++) d[j] = ent[j].value;
+  free(qk);
+  free(idx);
+  free(z);
+  free(ent);
+  return true;
+}
+
+// Divide and conquer on (d, e): q (n x n block of a zeroed matrix with row
+// stride ldq) receives the eigenvectors, d the eigenvalues ascending
+static bool ax__dc(double* d, double* e, musz n, double* q, musz ldq) {
+  if (n <= AX_EIG_DC_LEAF) {
+    for (musz i = 0; i < n; i++) q[i * ldq + i] = 1.0;
+    if (!ax__tql(d, e, n, q, ldq)) return false;
+    ax__eig_sort(d, n, q, ldq);
+    return true;
+  }
+  musz m = n / 2;
+  double rho = e[m - 1], beta = fabs(rho);
+  d[m - 1] -= beta;
+  d[m] -= beta;
+  if (!ax__dc(d, e, m, q, ldq)) return false;
+  if (!ax__dc(d + m, e + m, n - m, q + m * ldq + m, ldq)) return false;
+  return ax__dc_merge(d, n, m, beta, rho >= 0 ? 1.0 : -1.0, q, ldq);
+}
+
+// Eigenvalues of T below x: the negative pivots of T - x I = L D L^T
+static musz ax__sturm_count(const double* d, const double* e2, musz n, double x, double pivmin) {
+  musz count = 0;
+  double q = 1.0;
+  for (musz i = 0; i < n; i++) {
+    q = d[i] - x - (i ? e2[i - 1] / q : 0.0);
+    if (fabs(q) < pivmin) q = -pivmin;
+    if (q < 0) count++;
+  }
+  return count;
+}
+
+typedef struct AxBisectTask {
+  const double* d;
+  const double* e2;
+  musz n, il;
+  double lo, hi, pivmin;
+  double* w;
+} AxBisectTask;
+
+static void ax__bisect_task(void* ctx, musz begin, musz end) {
+  const AxBisectTask* t = (const AxBisectTask*)ctx;
+  for (musz i = begin; i < end; i++) {
+    double lo = t->lo, hi = t->hi;
+    for (int it = 0; it < 200; it++) {
+      if (hi - lo <= 2.0 * DBL_EPSILON * fmax(fabs(lo), fabs(hi)) + 2.0 * t->pivmin) break;
+      double mid = 0.5 * (lo + hi);
+      if (ax__sturm_count(t->d, t->e2, t->n, mid, t->pivmin) > t->il + i) hi = mid;
+      else lo = mid;
+    }
+    t->w[i] = 0.5 * (lo + hi);
+  }
+}
+
+// Eigenvalues il..iu-1 of (d, e) by bisection on Sturm counts, in parallel;
+// returns the norm bound used for tolerances
+static double ax__stebz(const double* d, const double* e, musz n, musz il, musz iu, double* w) {
+  double* e2 = (double*)malloc((n ? n : 1) * sizeof(double));
+  double lo = d[0], hi = d[0], emax = 0.0;
+  for (musz i = 0; i < n; i++) {
+    double off = (i > 0 ? fabs(e[i - 1]) : 0.0) + (i + 1 < n ? fabs(e[i]) : 0.0);
+    lo = fmin(lo, d[i] - off);
+    hi = fmax(hi, d[i] + off);
+    if (i + 1 < n) {
+      e2[i] = e[i] * e[i];
+      emax = fmax(emax, e2[i]);
+    }
+  }
+  double tnorm = fmax(fabs(lo), fabs(hi));
+  lo -= 2.0 * DBL_EPSILON * tnorm * (double)n + DBL_MIN;
+  hi += 2.0 * DBL_EPSILON * tnorm * (double)n + DBL_MIN;
+  AxBisectTask t = { d, e2, n, il, lo, hi, DBL_MIN * fmax(1.0, emax), w };
+  ax_parallel_for(iu - il, 1, ax__bisect_task, &t);
+  free(e2);
+  return tnorm;
+}
+
+// One solve of (T - x I) y = b in place, by Gaussian elimination with
+// partial pivoting on the tridiagonal; tiny pivots are replaced by `tiny`
+static void ax__tri_solve(const double* d, const double* e, musz n, double x, double tiny,
+                          double* u0, double* u1, double* u2, double* l, bool* piv, double* b) {
+  u0[0] = d[0] - x;
+  u1[0] = n > 1 ? e[0] : 0.0;
+  for (musz i = 0; i + 1 < n; i++) {
+    double sub = e[i], diag = d[i + 1] - x, sup = i + 2 < n ? e[i + 1] : 0.0;
+    if (fabs(u0[i]) >= fabs(sub)) {
+      if (u0[i] == 0.0) u0[i] = tiny;
+      l[i] = sub / u0[i];
+      u0[i + 1] = diag - l[i] * u1[i];
+      u1[i + 1] = sup;
+      u2[i] = 0.0;
+      piv[i] = false;
+    } else {
+      l[i] = u0[i] / sub;
+      double t = u1[i];
+      u0[i] = sub;
+      u1[i] = diag;
+      u2[i] = sup;
+      u0[i + 1] = t - l[i] * diag;
+      u1[i + 1] = -l[i] * sup;
+      piv[i] = true;
+    }
+  }
+  for (musz i = 0; i < n; i++) {
+    if (fabs(u0[i]) < tiny) u0[i] = u0[i] >= 0 ? tiny : -tiny;
+  }
+  for (musz i = 0; i + 1 < n; i++) {
+    if (piv[i]) {
+      double t = b[i];
+      b[i] = b[i + 1];
+      b[i + 1] = t - l[i] * b[i];
+    } else {
+      b[i + 1] -= l[i] * b[i];
+    }
+  }
+  for (musz i = n; i-- > 0;) {
+    double v = b[i];
+    if (i + 1 < n) v -= u1[i] * b[i + 1];
+    if (i + 2 < n) v -= u2[i] * b[i + 2];
+    b[i] = v / u0[i];
+  }
+}
+
+// Eigenvectors of (d, e) for ascending eigenvalues w[0..k) by inverse
+// iteration (as LAPACK's stein): z is n x k, row-major. Vectors of
+// eigenvalues closer than 1e-3 |T| form a cluster and are kept orthogonal
+// to each other by Gram-Schmidt.
+static bool ax__stein(const double* d, const double* e, musz n, const double* w, musz k,
+                      double tnorm, double* z) {
+  double* work = (double*)malloc(5 * n * sizeof(double) + n * sizeof(bool));
+  if (!work) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_eigh: failed to allocate inverse iteration workspace");
+    return false;
+  }
+  double *u0 = work, *u1 = work + n, *u2 = work + 2 * n, *l = work + 3 * n;
+  double* b = work + 4 * n;
+  bool* piv = (bool*)(work + 5 * n);
+  double tiny = DBL_EPSILON * fmax(tnorm, DBL_MIN);
+  double sep = 1e-3 * tnorm, pert = 10.0 * DBL_EPSILON * tnorm;
+  musz c0 = 0;
+  double prev = 0.0;
+  for (musz j = 0; j < k; j++) {
+    double x = w[j];
+    if (j > 0 && w[j] - w[j - 1] > sep) c0 = j;
+    if (j > 0 && x - prev < pert) x = prev + pert; // Separate equal shifts
+    prev = x;
+    mu64 key = ax__rand_mix(0x243F6A8885A308D3ULL + j);
+    for (musz i = 0; i < n; i++) b[i] = ax__randn_at(key, i);
+    for (int it = 0; it < 5; it++) {
+      ax__tri_solve(d, e, n, x, tiny, u0, u1, u2, l, piv, b);
+      for (musz c = c0; c < j; c++) {
+        double dot = 0.0;
+        for (musz i = 0; i < n; i++) dot += z[i * k + c] * b[i];
+        for (musz i = 0; i < n; i++) b[i] -= dot * z[i * k + c];
+      }
+      double ss = 0.0;
+      for (musz i = 0; i < n; i++) ss += b[i] * b[i];
+      double inv = 1.0 / sqrt(ss);
+      for (musz i = 0; i < n; i++) b[i] *= inv;
+    }
+    for (musz i = 0; i < n; i++) z[i * k + j] = b[i];
+  }
+  free(work);
+  return true;
+}
+
+// Block reflectors T of the tridiagonal reduction, panel by panel as in
+// ax_qr_factor, then Z[1:, :] = Q Z[1:, :]
+static bool ax__eig_back(const AxMatrix* a, const void* tau, AxMatrix* z) {
+  musz n = a->rows;
+  if (n < 2) return true;
+  musz esz = ax_dtype_size(a->dtype);
+  AxMatrix s = ax__linalg_view(a, 1, n, 0, n - 1);
+  void* tmem = calloc(AX_QR_NB * (n - 1), esz);
+  AxQrScratch sc;
+  if (!tmem || !ax__qr_scratch(&sc, a->dtype, 0, 0)) {
+    free(tmem);
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_eigh: failed to allocate back-transformation workspace");
+    return false;
+  }
+  AxMatrix t = { AX_QR_NB, n - 1, n - 1, 1, tmem, a->dtype, false };
+  AxQR qr = { &s, &t };
+  for (musz j0 = 0; j0 < n - 1; j0 += AX_QR_NB) {
+    musz jb = n - 1 - j0 < AX_QR_NB ? n - 1 - j0 : AX_QR_NB;
+    AxMatrix v1 = ax__qr_v1(&s, j0, jb, &sc);
+    AxMatrix v2 = ax__linalg_view(&s, j0 + jb, n - 1, j0, j0 + jb);
+    AxMatrix g = { jb, jb, jb, 1, sc.g.data, a->dtype, false };
+    AxMatrix tj = ax__qr_t(&qr, j0, j0, jb);
+    ax_matrix_gemm(1.0, &v1, AX_TRANS, &v1, AX_NO_TRANS, 0.0, &g);
+    if (v2.rows) ax_matrix_gemm(1.0, &v2, AX_TRANS, &v2, AX_NO_TRANS, 1.0, &g);
+    switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+    case AX_##T:                                                        \
+      ax__qr_form_t_##s((const ct*)g.data, jb, (const ct*)tau + j0, jb, (ct*)tj.data, tj.stride); \
+      break;
+      AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+    default: break;
+    }
+  }
+  free(sc.mem);
+  AxMatrix zs = ax__linalg_view(z, 1, n, 0, z->cols);
+  bool ok = ax__qr_apply(&qr, AX_NO_TRANS, &zs);
+  free(tmem);
+  return ok;
+}
+
+static bool ax__eigh(const char* fn, AxMatrix* a, musz il, musz iu, AxMatrix* w, AxMatrix* z) {
+  if (!a || !a->data || !w || !w->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null matrix", fn);
+    return false;
+  }
+  if (!ax__linalg_dtype_check(fn, a->dtype)) return false;
+  musz n = a->rows;
+  if (a->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "%s: matrix is %zux%zu, not square", fn, a->rows, a->cols);
+    return false;
+  }
+  if (il > iu || iu > n) {
+    AX_LOG(AX_LOG_FATAL, "%s: range [%zu, %zu) is outside [0, %zu]", fn, il, iu, n);
+    return false;
+  }
+  musz k = iu - il;
+  if (w->rows != 1 || w->cols != k) {
+    AX_LOG(AX_LOG_FATAL, "%s: w is %zux%zu, expected 1x%zu", fn, w->rows, w->cols, k);
+    return false;
+  }
+  if (z && (z->rows != n || z->cols != k || z->dtype != a->dtype)) {
+    AX_LOG(AX_LOG_FATAL, "%s: z must be %zux%zu %s", fn, n, k, ax_dtype_name(a->dtype));
+    return false;
+  }
+  if (k == 0) return true;
+  if (!ax__unit_cols(a) || !ax__unit_cols(w) || (z && !ax__unit_cols(z))) {
+    // The reduction walks rows through pointers, so strided views are staged
+    AxMatrix as, ws, zs;
+    zs.data = NULL;
+    AxMatrix* au = ax__unit_stage(a, &as, true);
+    AxMatrix* wu = ax__unit_stage(w, &ws, false);
+    AxMatrix* zu = z ? ax__unit_stage(z, &zs, false) : NULL;
+    bool ok = au && wu && (!z || zu) && ax__eigh(fn, au, il, iu, wu, zu);
+    ax__unit_release(&as, a);
+    ax__unit_release(&ws, ok ? w : NULL);
+    ax__unit_release(&zs, ok ? z : NULL);
+    return ok;
+  }
+
+  musz esz = ax_dtype_size(a->dtype);
+  double* d = (double*)malloc((2 * n + k) * sizeof(double));
+  void* tau = malloc(n * esz);
+  musz chunks = ax_thread_count();
+  void* panels = malloc((2 * n * AX_EIG_NB + chunks * n) * esz);
+  if (!d || !tau || !panels) {
+    free(d);
+    free(tau);
+    free(panels);
+    AX_LOG(AX_LOG_FATAL, "%s: failed to allocate workspace", fn);
+    return false;
+  }
+  double* e = d + n;
+  double* wv = d + 2 * n;
+  switch (a->dtype) {
+#define AX__LINALG_CASE(T, s, ct)                                       \
+  case AX_##T: {                                                        \
+    ct* vp = (ct*)panels;                                               \
+    ax__eig_mirror_##s((ct*)a->data, a->stride, n);                     \
+    ax__sytrd_##s(a, d, e, (ct*)tau, vp, vp + n * AX_EIG_NB, vp + 2 * n * AX_EIG_NB, chunks); \
+    break;                                                              \
+  }
+    AX_DTYPE_FLOAT_LIST(AX__LINALG_CASE)
+#undef AX__LINALG_CASE
+  default: break;
+  }
+  free(panels);
+
+  bool ok = true;
+  double* zt = NULL;
+  if (k == n) {
+    // All eigenvalues, with vectors by divide and conquer
+    if (z) {
+      zt = (double*)calloc(n * n, sizeof(double));
+      ok = zt && ax__dc(d, e, n, zt, n);
+    } else {
+      ok = ax__tql(d, e, n, NULL, 0);
+      ax__eig_sort(d, n, NULL, 0);
+    }
+    memcpy(wv, d, n * sizeof(double));
+  } else {
+    double tnorm = ax__stebz(d, e, n, il, iu, wv);
+    if (z) {
+      zt = (double*)malloc(n * k * sizeof(double));
+      ok = zt && ax__stein(d, e, n, wv, k, tnorm, zt);
+    }
+  }
+  if (!ok) {
+    AX_LOG(AX_LOG_WARN, "%s: tridiagonal eigensolver failed", fn);
+  } else {
+    for (musz i = 0; i < k; i++) ax_matrix_set(w, 0, i, wv[i]);
+    if (z) {
+      AxMatrix zm = { n, k, k, 1, zt, AX_F64, false };
+      ax_matrix_copy(z, &zm);
+      ok = ax__eig_back(a, tau, z);
+    }
+  }
+  free(zt);
+  free(tau);
+  free(d);
+  return ok;
+}
+
+bool ax_matrix_eigh(AxMatrix* a, AxMatrix* w, AxMatrix* z) {
+  return ax__eigh("ax_matrix_eigh", a, 0, a ? a->rows : 0, w, z);
+}
+
+bool ax_matrix_eigh_range(AxMatrix* a, musz il, musz iu, AxMatrix* w, AxMatrix* z) {
+  return ax__eigh("ax_matrix_eigh_range", a, il, iu, w, z);
+}
+
+#endif /* AXLINALG_IMPLEMENTATION */
+
+#endif /* AXLINALG_H_ */
@@ -1,10 +1,45 @@
+/*
+  ================================================================================
+  AxMatrix: Dense Matrices and Kernels (STB-Style Single-Header Library)
+  ================================================================================
+  - AxMatrix is a strided 2-d view over elements of one AxDType; slices and
+  transposed views share their parent's storage.
+  - Element-wise, broadcast, reduction, transpose and GEMM kernels are
+  instantiated per dtype and split their work across the axthread.h pool.
+  - Dependencies:
+  - "axtypes.h"     (defines musz, etc.)
+  - "axlog.h"       (for AX_LOG(...) macros)
+  - "axalloc.h"     (arena allocation of matrices and scratch)
+  - "axthread.h"    (ax_parallel_for thread pool)
+  - <pthread.h>     (frees per-thread packing buffers as threads exit)
+  - <math.h>        (link with -lm)
+  ================================================================================
+  USAGE:
+  1) In **one** C or C++ file where you want the implementation, do:
+  #define AXALLOC_IMPLEMENTATION
+  #define AXTHREAD_IMPLEMENTATION
+  #define AXMATRIX_IMPLEMENTATION
+  #include "axmatrix.h"
+  The axalloc.h and axthread.h implementations must be compiled in exactly
+  one translation unit, the same one or another.
+
+  2) In any other files that need to use the library, just include "axmatrix.h"
+  without defining AXMATRIX_IMPLEMENTATION.
+
+  3) Link with -pthread.
+  ================================================================================
+*/
+
 #ifndef AXMATRIX_H_
 #define AXMATRIX_H_
 
 #include "axlog.h"
 #include "axalloc.h"
+#include "axthread.h"
 #include "axtypes.h"
 #include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,8 +49,130 @@ extern "C" {
 #define AX_MATRIX_ELEMENT_TYPE double
 #endif
 
+  // Default element type of this translation unit. It only selects the dtype
+  // used by ax_matrix_create, AX_MATRIX_AT and ax_matrix_map; matrices of
+  // every dtype can live side by side.
   typedef AX_MATRIX_ELEMENT_TYPE axm_type;
 
+  // Element types: X(TAG, suffix, C type). Kernels are instantiated once per
+  // entry and selected by a single switch per call.
+#define AX_DTYPE_FLOAT_LIST(X)                  \
+  X(F32, f32, mf32)                             \
+  X(F64, f64, mf64)
+
+#define AX_DTYPE_INT_LIST(X)                    \
+  X(I32, i32, mi32)                             \
+  X(I64, i64, mi64)                             \
+  X(U8,  u8,  mu8)                              \
+  X(I8,  i8,  mi8)
+
+#define AX_DTYPE_LIST(X) AX_DTYPE_FLOAT_LIST(X) AX_DTYPE_INT_LIST(X)
+
+  // Half-precision storage types: X(TAG, suffix, storage type). Elements are
+  // raw IEEE binary16 / bfloat16 bits; kernels widen them to f32, compute and
+  // accumulate there, and round back (to nearest even) on store.
+#define AX_DTYPE_HALF_LIST(X)                   \
+  X(F16,  f16,  mu16)                           \
+  X(BF16, bf16, mu16)
+
+  typedef enum AxDType {
+#define AX__DTYPE_ENUM(T, s, ct) AX_##T,
+    AX_DTYPE_LIST(AX__DTYPE_ENUM)
+    AX_DTYPE_HALF_LIST(AX__DTYPE_ENUM)
+#undef AX__DTYPE_ENUM
+  } AxDType;
+
+  // Maps a C type to its dtype tag at compile time
+#define AX_DTYPE_OF(type)                                               \
+  _Generic((type)0, mf32: AX_F32, mf64: AX_F64, mi32: AX_I32, mi64: AX_I64, mu8: AX_U8, mi8: AX_I8)
+
+#define AX_DTYPE_DEFAULT AX_DTYPE_OF(axm_type)
+
+  static inline musz ax_dtype_size(AxDType dtype) {
+    switch (dtype) {
+#define AX__DTYPE_SIZE(T, s, ct) case AX_##T: return sizeof(ct);
+      AX_DTYPE_LIST(AX__DTYPE_SIZE)
+      AX_DTYPE_HALF_LIST(AX__DTYPE_SIZE)
+#undef AX__DTYPE_SIZE
+    }
+    return 0;
+  }
+
+  static inline const char* ax_dtype_name(AxDType dtype) {
+    switch (dtype) {
+#define AX__DTYPE_NAME(T, s, ct) case AX_##T: return #s;
+      AX_DTYPE_LIST(AX__DTYPE_NAME)
+      AX_DTYPE_HALF_LIST(AX__DTYPE_NAME)
+#undef AX__DTYPE_NAME
+    }
+    return "unknown";
+  }
+
+  // Scalar half-precision conversions (round to nearest even). Matrices of
+  // f16/bf16 hold mu16 bits, so AX_MATRIX_AT_T(mu16, ...) pairs with these.
+  typedef union AxBits32 {
+    mf32 f;
+    mu32 u;
+  } AxBits32;
+
+  static inline mf32 ax_f16_to_f32(mu16 h) {
+    mu32 sign = (mu32)(h & 0x8000u) << 16;
+    mu32 exp = (h >> 10) & 0x1Fu;
+    mu32 man = h & 0x3FFu;
+    AxBits32 b;
+    if (exp == 0x1F) {
+      b.u = sign | 0x7F800000u | (man << 13); // Inf or NaN
+    } else if (exp != 0) {
+      b.u = sign | ((exp + 112) << 23) | (man << 13);
+    } else if (man == 0) {
+      b.u = sign;
+    } else {
+      // Subnormal: renormalize into the wider exponent range
+      exp = 113;
+      while (!(man & 0x400u)) {
+        man <<= 1;
+        exp--;
+      }
+      b.u = sign | (exp << 23) | ((man & 0x3FFu) << 13);
+    }
+    return b.f;
+  }
+
+  static inline mu16 ax_f32_to_f16(mf32 f) {
+    AxBits32 b = { .f = f };
+    mu32 sign = (b.u >> 16) & 0x8000u;
+    mu32 abs = b.u & 0x7FFFFFFFu;
+    if (abs >= 0x7F800000u) { // Inf or NaN (kept quiet)
+      return (mu16)(sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0));
+    }
+    if (abs >= 0x477FF000u) return (mu16)(sign | 0x7C00u); // Rounds past 65504
+    if (abs >= 0x38800000u) {
+      // Normal: rebias the exponent and round the dropped 13 bits
+      mu32 r = abs - (112u << 23);
+      r += 0xFFFu + ((r >> 13) & 1u);
+      return (mu16)(sign | (r >> 13));
+    }
+    if (abs < 0x33000000u) return (mu16)sign; // Below half the smallest subnormal
+    mu32 man = (abs & 0x7FFFFFu) | 0x800000u;
+    mu32 shift = 126 - (abs >> 23);
+    mu32 q = man >> shift;
+    mu32 rem = man & ((1u << shift) - 1);
+    mu32 half = 1u << (shift - 1);
+    if (rem > half || (rem == half && (q & 1u))) q++;
+    return (mu16)(sign | q);
+  }
+
+  static inline mf32 ax_bf16_to_f32(mu16 h) {
+    AxBits32 b = { .u = (mu32)h << 16 };
+    return b.f;
+  }
+
+  static inline mu16 ax_f32_to_bf16(mf32 f) {
+    AxBits32 b = { .f = f };
+    if ((b.u & 0x7FFFFFFFu) > 0x7F800000u) return (mu16)((b.u >> 16) | 0x40u); // Quiet NaN
+    return (mu16)((b.u + 0x7FFFu + ((b.u >> 16) & 1u)) >> 16);
+  }
+
   typedef struct AxRange {
     musz start;
     musz end; // exclusive
@@ -27,17 +184,34 @@ extern "C" {
     musz rows;
     musz cols;
     musz stride; // Number of elements between rows
-    axm_type* data;
+    musz col_stride; // Number of elements between columns (1 unless a strided view)
+    void* data;
+    AxDType dtype;
     bool data_owner; // Whether to free data on destroy
   } AxMatrix;
 
   // Matrix initialization and creation
-  bool ax_matrix_init(AxMatrix* mat, musz rows, musz cols, Arena* arena);
-  AxMatrix* ax_matrix_create(musz rows, musz cols, Arena* arena);
+  bool ax_matrix_init_dtype(AxMatrix* mat, musz rows, musz cols, AxDType dtype, Arena* arena);
+  AxMatrix* ax_matrix_create_dtype(musz rows, musz cols, AxDType dtype, Arena* arena);
   void ax_matrix_destroy(AxMatrix* mat);
 
-  // Element access
-#define AX_MATRIX_AT(mat, i, j) ((mat).data[(i) * (mat).stride + (j)])
+  // Shorthands for the default dtype (inline, so they follow the caller's axm_type)
+  static inline bool ax_matrix_init(AxMatrix* mat, musz rows, musz cols, Arena* arena) {
+    return ax_matrix_init_dtype(mat, rows, cols, AX_DTYPE_DEFAULT, arena);
+  }
+
+  static inline AxMatrix* ax_matrix_create(musz rows, musz cols, Arena* arena) {
+    return ax_matrix_create_dtype(rows, cols, AX_DTYPE_DEFAULT, arena);
+  }
+
+  // Element access: AX_MATRIX_AT assumes the default dtype, AX_MATRIX_AT_T
+  // takes the C type explicitly (e.g. AX_MATRIX_AT_T(mf32, m, i, j))
+#define AX_MATRIX_AT_T(type, mat, i, j) (((type*)(mat).data)[(i) * (mat).stride + (j) * (mat).col_stride])
+#define AX_MATRIX_AT(mat, i, j) AX_MATRIX_AT_T(axm_type, mat, i, j)
+
+  // Dtype-agnostic scalar access (converts through double)
+  double ax_matrix_get(const AxMatrix* mat, musz i, musz j);
+  void ax_matrix_set(AxMatrix* mat, musz i, musz j, double value);
 
   // Slicing
 #define AX_MATRIX_SLICE(mat, row_range, col_range)                      \
@@ -45,43 +219,632 @@ extern "C" {
     .rows = (row_range.end) - (row_range.start),                        \
     .cols = (col_range.end) - (col_range.start),                        \
     .stride = (mat).stride,                                             \
-    .data = &(mat).data[(row_range.start) * (mat).stride + (col_range.start)], \
+    .col_stride = (mat).col_stride,                                     \
+    .data = (mu8*)(mat).data + ((row_range.start) * (mat).stride + (col_range.start) * (mat).col_stride) * ax_dtype_size((mat).dtype), \
+    .dtype = (mat).dtype,                                               \
+    .data_owner = false                                                 \
+  })
+
+  // Slicing that keeps every row_step-th row and col_step-th column of the
+  // ranges (steps >= 1), e.g. the even columns of `m` are
+  // AX_MATRIX_SLICE_STEP(m, AX_RANGE(0, m.rows), AX_RANGE(0, m.cols), 1, 2)
+#define AX_MATRIX_SLICE_STEP(mat, row_range, col_range, row_step, col_step) \
+  ((AxMatrix){                                                          \
+    .rows = ((row_range.end) - (row_range.start) + (row_step) - 1) / (row_step), \
+    .cols = ((col_range.end) - (col_range.start) + (col_step) - 1) / (col_step), \
+    .stride = (mat).stride * (row_step),                                \
+    .col_stride = (mat).col_stride * (col_step),                        \
+    .data = (mu8*)(mat).data + ((row_range.start) * (mat).stride + (col_range.start) * (mat).col_stride) * ax_dtype_size((mat).dtype), \
+    .dtype = (mat).dtype,                                               \
     .data_owner = false                                                 \
   })
 
-  // Copy data from src to dest (must have same dimensions)
+  // Transpose of `mat` without copying: swaps the dimensions and strides,
+  // so element (i, j) of the view is element (j, i) of `mat`. Every
+  // operation accepts such views; GEMM reads them at full speed, the
+  // element-wise kernels tile them through cache.
+  static inline AxMatrix ax_matrix_transpose_view(const AxMatrix* mat) {
+    AxMatrix t = *mat;
+    t.rows = mat->cols;
+    t.cols = mat->rows;
+    t.stride = mat->col_stride;
+    t.col_stride = mat->stride;
+    t.data_owner = false;
+    return t;
+  }
+
+  // Main diagonal of `mat` as a min(rows, cols) x 1 view
+  static inline AxMatrix ax_matrix_diagonal_view(const AxMatrix* mat) {
+    AxMatrix d = *mat;
+    d.rows = mat->rows < mat->cols ? mat->rows : mat->cols;
+    d.cols = 1;
+    d.stride = mat->stride + mat->col_stride;
+    d.col_stride = 1;
+    d.data_owner = false;
+    return d;
+  }
+
+  // Copy data from src to dest (must have same dimensions). Converts with C
+  // conversion rules when the dtypes differ; conversions to or from f16/bf16
+  // go through f32.
   bool ax_matrix_copy(AxMatrix* dest, const AxMatrix* src);
 
-  // Print matrix
+  // Print matrix (`fmt` receives a double)
   void ax_matrix_print(const AxMatrix *mat, const char* fmt);
 
-  // Matrix operations
+  // Matrix operations (operands and result share one dtype)
   AxMatrix* ax_matrix_add(const AxMatrix* a, const AxMatrix* b, Arena* arena);
   AxMatrix* ax_matrix_elementwise_multiply(const AxMatrix* a, const AxMatrix* b, Arena* arena);
   AxMatrix* ax_matrix_multiply(const AxMatrix* a, const AxMatrix* b, Arena* arena);
 
-  // In-place map function
-  void ax_matrix_map(AxMatrix* mat, axm_type (*f)(AxMatrix* self, musz i, musz j));
+  // General matrix product c = alpha * op(a) * op(b) + beta * c, where op()
+  // optionally transposes. Floating-point dtypes only: f16, bf16 and f32
+  // operands may be mixed freely and are computed in f32, f64 is computed in
+  // f64. With beta == 0, `c` is not read. `c` must not overlap `a` or `b`.
+  typedef enum AxTranspose {
+    AX_NO_TRANS,
+    AX_TRANS
+  } AxTranspose;
+
+  bool ax_matrix_gemm(double alpha, const AxMatrix* a, AxTranspose ta,
+                      const AxMatrix* b, AxTranspose tb, double beta, AxMatrix* c);
+
+  typedef enum AxActivation {
+    AX_ACT_NONE,
+    AX_ACT_RELU,
+    AX_ACT_GELU, // x * Phi(x) with the exact normal CDF
+    AX_ACT_SIGMOID,
+    AX_ACT_TANH
+  } AxActivation;
+
+  // Work done on each output tile while it is still in cache:
+  // c = act(alpha * op(a) * op(b) + beta * c + bias) + residual.
+  // `bias` is 1xN (one value per column) or Mx1 (per row), `residual` MxN;
+  // either may be NULL. Both take the dtypes allowed for the operands and
+  // must not overlap `c`.
+  typedef struct AxGemmEpilogue {
+    const AxMatrix* bias;
+    AxActivation activation;
+    const AxMatrix* residual;
+  } AxGemmEpilogue;
+
+  bool ax_matrix_gemm_fused(double alpha, const AxMatrix* a, AxTranspose ta,
+                            const AxMatrix* b, AxTranspose tb, double beta, AxMatrix* c,
+                            const AxGemmEpilogue* epilogue);
+
+  // Strassen-Winograd product c = a * b (f32 or f64, one dtype, `c` not
+  // overlapping `a` or `b`). Halves every dimension while all of them are at
+  // least `crossover` (0 selects AX_STRASSEN_CROSSOVER), peeling odd rows and
+  // columns off into GEMM updates, and multiplies the leaves with
+  // ax_matrix_gemm. Each level does 7 half-size products instead of 8. With
+  // more than one thread the top level (two levels past 7 threads) runs its
+  // products as parallel tasks, which holds every product of that level at
+  // once: about 1.75x (two levels: 3x) the size of C, plus operand sums per
+  // thread. With so many threads that those products leave more than half
+  // of them idle (one level past 14 threads, two past 98), this is a plain
+  // ax_matrix_gemm. Single-threaded, the temporaries are about 2/3 of a
+  // half-size product per level. All come from `scratch` (NULL uses a
+  // private arena).
+  //
+  // Error: the bound is normwise rather than componentwise. With n0 the leaf
+  // size and u the unit roundoff, max|C - fl(C)| <= [(n / n0)^log2(18)
+  // (n0^2 + 6 n0) - 6n] u max|A| max|B| + O(u^2) (Higham, Accuracy and
+  // Stability of Numerical Algorithms, 23.2.2), against n u |A||B| entrywise
+  // for the classical product. Each level multiplies the constant by about
+  // 4.5, so entries much smaller than max|A| max|B| lose relative accuracy.
+#define AX_STRASSEN_CROSSOVER 2048
+
+  bool ax_matrix_gemm_strassen(const AxMatrix* a, const AxMatrix* b, AxMatrix* c,
+                               musz crossover, Arena* scratch);
+
+  // Opts ax_matrix_multiply into the Strassen-Winograd path for f32/f64
+  // products whose dimensions all reach `crossover` (0, the default, keeps
+  // the classical product). The setting is atomic, so it may change while
+  // other threads multiply.
+  void ax_matrix_set_strassen_crossover(musz crossover);
+
+  // Semirings (add, multiply) for products beyond arithmetic. Entries with
+  // no terms (k == 0, or absent from a sparse operand) hold the additive
+  // identity.
+  typedef enum AxSemiring {
+    AX_SEMIRING_PLUS_TIMES, // (+, *), identity 0
+    AX_SEMIRING_MIN_PLUS,   // (min, +), identity +inf: shortest paths
+    AX_SEMIRING_MAX_PLUS,   // (max, +), identity -inf: longest paths
+    AX_SEMIRING_MAX_MIN,    // (max, min), identity -inf: bottleneck paths
+    AX_SEMIRING_OR_AND      // (or, and) on nonzero entries, identity 0: results are 0 or 1
+  } AxSemiring;
+
+  // X(TAG, name) per semiring, with scalar identity, add and multiply per
+  // name, for instantiating kernels once per semiring
+#define AX_SEMIRING_LIST(X)                     \
+  X(PLUS_TIMES, plus_times)                     \
+  X(MIN_PLUS,   min_plus)                       \
+  X(MAX_PLUS,   max_plus)                       \
+  X(MAX_MIN,    max_min)                        \
+  X(OR_AND,     or_and)
+
+#define AX_SEMIRING_ZERO_plus_times(ct) ((ct)0)
+#define AX_SEMIRING_ZERO_min_plus(ct)   ((ct)INFINITY)
+#define AX_SEMIRING_ZERO_max_plus(ct)   ((ct)-INFINITY)
+#define AX_SEMIRING_ZERO_max_min(ct)    ((ct)-INFINITY)
+#define AX_SEMIRING_ZERO_or_and(ct)     ((ct)0)
+
+#define AX_SEMIRING_ADD_plus_times(ct, x, y) ((ct)((x) + (y)))
+#define AX_SEMIRING_ADD_min_plus(ct, x, y)   ((y) < (x) ? (y) : (x))
+#define AX_SEMIRING_ADD_max_plus(ct, x, y)   ((y) > (x) ? (y) : (x))
+#define AX_SEMIRING_ADD_max_min(ct, x, y)    ((y) > (x) ? (y) : (x))
+#define AX_SEMIRING_ADD_or_and(ct, x, y)     ((ct)((x) != 0 || (y) != 0))
+
+#define AX_SEMIRING_MUL_plus_times(ct, x, y) ((ct)((x) * (y)))
+#define AX_SEMIRING_MUL_min_plus(ct, x, y)   ((ct)((x) + (y)))
+#define AX_SEMIRING_MUL_max_plus(ct, x, y)   ((ct)((x) + (y)))
+#define AX_SEMIRING_MUL_max_min(ct, x, y)    ((x) < (y) ? (x) : (y))
+#define AX_SEMIRING_MUL_or_and(ct, x, y)     ((ct)((x) != 0 && (y) != 0))
+
+  static inline double ax_semiring_zero(AxSemiring sr) {
+    switch (sr) {
+#define AX__SEMIRING_ZERO_CASE(T, sr_) case AX_SEMIRING_##T: return AX_SEMIRING_ZERO_##sr_(double);
+      AX_SEMIRING_LIST(AX__SEMIRING_ZERO_CASE)
+#undef AX__SEMIRING_ZERO_CASE
+    }
+    return 0;
+  }
+
+  // c = op(a) (x) op(b) over `sr`, or c = c (+) (op(a) (x) op(b)) when
+  // `accumulate`. Operands as for ax_matrix_gemm, and the same blocked,
+  // threaded engine with the semiring's add and multiply in the register
+  // tile. AX_SEMIRING_PLUS_TIMES is ax_matrix_gemm with alpha = 1.
+  bool ax_matrix_semiring_gemm(AxSemiring sr, const AxMatrix* a, AxTranspose ta,
+                               const AxMatrix* b, AxTranspose tb, bool accumulate, AxMatrix* c);
+
+  // Broadcasting: `b` may be MxN, 1xN (row vector), Mx1 (column vector) or
+  // 1x1 against an MxN `a`. The expanded operand is never materialized and
+  // `dest` may be `a` itself for in-place updates.
+  typedef enum AxBinaryOp {
+    AX_BINARY_ADD,
+    AX_BINARY_SUB,
+    AX_BINARY_MUL,
+    AX_BINARY_DIV
+  } AxBinaryOp;
+
+  // Element-wise arithmetic per dtype, shared by the matrix and tensor
+  // kernels. Integer add, sub and mul wrap around: they are computed modulo
+  // 2^64 in mu64 and truncated to the element width. Integer division by 0
+  // gives 0, and the minimum divided by -1 wraps to the minimum.
+#define AX__DEFINE_FLOAT_OPS(T, s, ct)                                  \
+  static inline ct ax__op_add_##s(ct x, ct y) { return x + y; }         \
+  static inline ct ax__op_sub_##s(ct x, ct y) { return x - y; }         \
+  static inline ct ax__op_mul_##s(ct x, ct y) { return x * y; }         \
+  static inline ct ax__op_div_##s(ct x, ct y) { return x / y; }
+
+#define AX__DEFINE_INT_OPS(T, s, ct)                                    \
+  static inline ct ax__op_add_##s(ct x, ct y) { return (ct)((mu64)x + (mu64)y); } \
+  static inline ct ax__op_sub_##s(ct x, ct y) { return (ct)((mu64)x - (mu64)y); } \
+  static inline ct ax__op_mul_##s(ct x, ct y) { return (ct)((mu64)x * (mu64)y); } \
+  static inline ct ax__op_div_##s(ct x, ct y) {                         \
+    if (y == 0) return 0;                                               \
+    if ((ct)-1 < (ct)0 && y == (ct)-1) return (ct)(0 - (mu64)x);        \
+    return (ct)(x / y);                                                 \
+  }
+
+  AX_DTYPE_FLOAT_LIST(AX__DEFINE_FLOAT_OPS)
+  AX_DTYPE_INT_LIST(AX__DEFINE_INT_OPS)
+
+  // ax__op_<name>_<suffix> picked by the operands' type
+#define AX__OP(name, x, y)                                              \
+  _Generic((x), mf32: ax__op_##name##_f32, mf64: ax__op_##name##_f64,   \
+           mi32: ax__op_##name##_i32, mi64: ax__op_##name##_i64,        \
+           mu8: ax__op_##name##_u8, mi8: ax__op_##name##_i8)((x), (y))
+
+  bool ax_matrix_broadcast_into(AxMatrix* dest, const AxMatrix* a, const AxMatrix* b, AxBinaryOp op);
+  AxMatrix* ax_matrix_broadcast(const AxMatrix* a, const AxMatrix* b, AxBinaryOp op, Arena* arena);
+  bool ax_matrix_scalar_into(AxMatrix* dest, const AxMatrix* a, double s, AxBinaryOp op);
+
+  // In-place map function (default dtype only)
+  static inline void ax_matrix_map(AxMatrix* mat, axm_type (*f)(AxMatrix* self, musz i, musz j)) {
+    if (!mat || !mat->data) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_map: invalid matrix");
+      return;
+    }
+    if (mat->dtype != AX_DTYPE_DEFAULT) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_map: matrix dtype is %s", ax_dtype_name(mat->dtype));
+      return;
+    }
+    for (musz i = 0; i < mat->rows; i++) {
+      for (musz j = 0; j < mat->cols; j++) {
+        AX_MATRIX_AT(*mat, i, j) = f(mat, i, j);
+      }
+    }
+  }
+
+  // Transpose (cache-oblivious blocking; `dest` must not overlap `src`)
+  bool ax_matrix_transpose_into(AxMatrix* dest, const AxMatrix* src);
+  AxMatrix* ax_matrix_transpose(const AxMatrix* a, Arena* arena);
+  bool ax_matrix_transpose_inplace(AxMatrix* mat); // Square matrices only
+
+  // Reductions
+  typedef enum AxAxis {
+    AX_AXIS_0 = 0,  // Reduce over rows: one result per column
+    AX_AXIS_1 = 1,  // Reduce over columns: one result per row
+    AX_AXIS_ALL = 2 // Reduce over every element: a single result
+  } AxAxis;
+
+  typedef enum AxNorm {
+    AX_NORM_L1,
+    AX_NORM_L2,
+    AX_NORM_INF
+  } AxNorm;
+
+  // `out` is a caller-supplied 1xN or Nx1 vector with one slot per result; it
+  // may have any dtype. Sums are accumulated pairwise in double precision, and
+  // the work split does not depend on the thread count, so results are
+  // reproducible.
+  bool ax_matrix_sum(const AxMatrix* a, AxAxis axis, AxMatrix* out);
+  bool ax_matrix_mean(const AxMatrix* a, AxAxis axis, AxMatrix* out);
+  bool ax_matrix_var(const AxMatrix* a, AxAxis axis, AxMatrix* out); // Population variance
+  bool ax_matrix_min(const AxMatrix* a, AxAxis axis, AxMatrix* out);
+  bool ax_matrix_max(const AxMatrix* a, AxAxis axis, AxMatrix* out);
+  bool ax_matrix_norm(const AxMatrix* a, AxNorm norm, AxAxis axis, AxMatrix* out);
+  bool ax_matrix_dot(const AxMatrix* a, const AxMatrix* b, AxAxis axis, AxMatrix* out);
+
+  // Indices are rows (axis 0), columns (axis 1) or row-major flat indices
+  // (all). Ties resolve to the first occurrence.
+  bool ax_matrix_argmin(const AxMatrix* a, AxAxis axis, musz* out);
+  bool ax_matrix_argmax(const AxMatrix* a, AxAxis axis, musz* out);
+
+  // Affine quantization of i8/u8 matrices: x ~= (q - zero_point) * scale,
+  // with a single pair for the whole matrix (count == 1) or one pair per row
+  // (count == rows).
+  typedef struct AxQuantParams {
+    musz count;
+    mf32* scale;
+    mi32* zero_point;
+    bool data_owner; // Whether to free the arrays on destroy
+  } AxQuantParams;
+
+  bool ax_quant_params_init(AxQuantParams* q, musz count, Arena* arena);
+  void ax_quant_params_destroy(AxQuantParams* q);
+
+  // Fits `q` (per tensor or per row, as sized by its count) to the range of
+  // `src` extended to include 0, for quantizing to `dtype` (AX_I8 or AX_U8).
+  // Symmetric ranges pin the zero point to 0 (i8) or 128 (u8).
+  bool ax_quant_params_fit(AxQuantParams* q, const AxMatrix* src, AxDType dtype, bool symmetric);
+
+  // dest (i8/u8) = clamp(round(src / scale) + zero_point); src is any
+  // floating-point dtype. Rounds half to even.
+  bool ax_matrix_quantize(AxMatrix* dest, const AxMatrix* src, const AxQuantParams* q);
+  // dest (any floating-point dtype) = (src - zero_point) * scale
+  bool ax_matrix_dequantize(AxMatrix* dest, const AxMatrix* src, const AxQuantParams* q);
+
+  // Integer product c (i32, MxN) = (a - za) * op(b - zb) accumulated exactly
+  // in int32. `a` (MxK) and `b` are i8 or u8; `qa` supplies zero points per
+  // tensor or per row of `a`, `qb` per tensor or per column of op(b), and
+  // either may be NULL for zero. Scales are not applied. Uses AVX512-VNNI
+  // (vpdpbusd) when available, 16-bit multiply-adds otherwise.
+  bool ax_matrix_gemm_q8(const AxMatrix* a, const AxQuantParams* qa,
+                         const AxMatrix* b, const AxQuantParams* qb, AxTranspose tb,
+                         AxMatrix* c);
+
+  // Stacks of small matrices of one shape. Element (i, j) of matrix b lives
+  // `b * batch_stride + i * stride + j * col_stride` elements past `data`.
+  typedef enum AxBatchLayout {
+    AX_BATCH_PACKED,     // Row-major matrices one after another
+    AX_BATCH_INTERLEAVED // Element-major: entry (i, j) of every matrix is contiguous
+  } AxBatchLayout;
+
+  typedef struct AxMatrixBatch {
+    musz count;
+    musz rows;
+    musz cols;
+    musz stride;       // Elements between rows
+    musz col_stride;   // Elements between columns
+    musz batch_stride; // Elements between matrices
+    void* data;
+    AxDType dtype;
+    bool data_owner; // Whether to free data on destroy
+  } AxMatrixBatch;
+
+  bool ax_matrix_batch_init(AxMatrixBatch* batch, musz count, musz rows, musz cols,
+                            AxDType dtype, AxBatchLayout layout, Arena* arena);
+  void ax_matrix_batch_destroy(AxMatrixBatch* batch);
+  double ax_matrix_batch_get(const AxMatrixBatch* batch, musz b, musz i, musz j);
+  void ax_matrix_batch_set(AxMatrixBatch* batch, musz b, musz i, musz j, double value);
+
+#define AX_BATCH_MAX_DIM 16
+
+  // c[b] = a[b] * b[b] for every matrix of the stacks (f32 or f64, all one
+  // dtype, dimensions up to AX_BATCH_MAX_DIM). Each SIMD lane handles a
+  // different matrix; square shapes from 2x2 to 16x16 run fully unrolled
+  // kernels. Interleaved layouts feed the lanes without reshuffling and suit
+  // the smallest shapes best. `c` may be `a` or `b`.
+  bool ax_matrix_batch_multiply(const AxMatrixBatch* a, const AxMatrixBatch* b, AxMatrixBatch* c);
+
+  // Batched general products c[i] = alpha * op(a[i]) * op(b[i]) + beta * c[i],
+  // each as ax_matrix_gemm, for `count` problems of one shape and dtype. The
+  // row blocks of every product share one parallel schedule, so many medium
+  // products keep all threads busy. Either from arrays of matrices or from
+  // strided stacks.
+  bool ax_matrix_gemm_batched(double alpha, const AxMatrix* const* a, AxTranspose ta,
+                              const AxMatrix* const* b, AxTranspose tb, double beta,
+                              AxMatrix* const* c, musz count);
+  bool ax_matrix_gemm_strided_batched(double alpha, const AxMatrixBatch* a, AxTranspose ta,
+                                      const AxMatrixBatch* b, AxTranspose tb, double beta,
+                                      AxMatrixBatch* c);
+
+  // Strided vector view: element i lives `i * inc` elements past `data`
+  typedef struct AxVector {
+    musz len;
+    musz inc;
+    void* data;
+    AxDType dtype;
+    bool data_owner; // Whether to free data on destroy
+  } AxVector;
+
+  bool ax_vector_init(AxVector* v, musz len, AxDType dtype, Arena* arena);
+  void ax_vector_destroy(AxVector* v);
+  double ax_vector_get(const AxVector* v, musz i);
+  void ax_vector_set(AxVector* v, musz i, double value);
+
+  // Views of row i and column j
+  static inline AxVector ax_matrix_row(const AxMatrix* mat, musz i) {
+    return (AxVector){ mat->cols, mat->col_stride, (mu8*)mat->data + i * mat->stride * ax_dtype_size(mat->dtype),
+                       mat->dtype, false };
+  }
+
+  static inline AxVector ax_matrix_col(const AxMatrix* mat, musz j) {
+    return (AxVector){ mat->rows, mat->stride, (mu8*)mat->data + j * mat->col_stride * ax_dtype_size(mat->dtype),
+                       mat->dtype, false };
+  }
+
+  // BLAS-style kernels on f32/f64 vectors (operands share one dtype). They
+  // are vectorized and split over the thread pool on long inputs; dot and
+  // nrm2 accumulate in double over a fixed split, so results do not depend
+  // on the thread count. nrm2 rescales when squares would overflow or
+  // underflow.
+  bool ax_vector_axpy(double alpha, const AxVector* x, AxVector* y); // y += alpha * x
+  bool ax_vector_scal(double alpha, AxVector* x);
+  double ax_vector_dot(const AxVector* x, const AxVector* y);
+  double ax_vector_nrm2(const AxVector* x);
+
+  // y = alpha * op(a) * x + beta * y; with beta == 0, `y` is not read.
+  // `y` must not overlap `a` or `x`.
+  bool ax_matrix_gemv(double alpha, const AxMatrix* a, AxTranspose ta, const AxVector* x,
+                      double beta, AxVector* y);
+  // Rank-1 update a += alpha * x * y^T
+  bool ax_matrix_ger(double alpha, const AxVector* x, const AxVector* y, AxMatrix* a);
+
+  // Whether each row's elements are adjacent, so kernels can walk a row as one
+  // unit-stride run
+  static inline bool ax__unit_cols(const AxMatrix* m) {
+    return m->col_stride == 1 || m->cols <= 1;
+  }
+
+  // Contiguous stand-in for kernels that only walk unit-stride rows: returns
+  // `m` itself when its rows already qualify, otherwise `tmp` holding a
+  // malloc'd copy (only allocated, not filled, unless `load`). Release with
+  // ax__unit_release, which copies `tmp` back into `store` when given. Also
+  // used by the linalg, sparse and bits kernels.
+  static inline AxMatrix* ax__unit_stage(const AxMatrix* m, AxMatrix* tmp, bool load) {
+    tmp->data = NULL;
+    if (ax__unit_cols(m)) return (AxMatrix*)m;
+    musz size = m->rows * m->cols * ax_dtype_size(m->dtype);
+    *tmp = (AxMatrix){ m->rows, m->cols, m->cols, 1, malloc(size ? size : 1), m->dtype, true };
+    if (!tmp->data) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix: failed to allocate %zu bytes of staging", size);
+      return NULL;
+    }
+    if (load) ax_matrix_copy(tmp, m);
+    return tmp;
+  }
+
+  static inline void ax__unit_release(AxMatrix* tmp, AxMatrix* store) {
+    if (!tmp->data) return;
+    if (store) ax_matrix_copy(store, tmp);
+    free(tmp->data);
+    tmp->data = NULL;
+  }
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* AXMATRIX_H_ */
-
 #ifdef AXMATRIX_IMPLEMENTATION
 
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Same entries as AX_DTYPE_LIST and AX_DTYPE_HALF_LIST, forwarding extra
+// arguments to X. Needed to instantiate kernels over pairs of dtypes (a macro
+// cannot nest itself).
+#define AX__DTYPE_LIST_WITH(X, ...)             \
+  X(F32, f32, mf32, __VA_ARGS__)                \
+  X(F64, f64, mf64, __VA_ARGS__)                \
+  X(I32, i32, mi32, __VA_ARGS__)                \
+  X(I64, i64, mi64, __VA_ARGS__)                \
+  X(U8,  u8,  mu8,  __VA_ARGS__)                \
+  X(I8,  i8,  mi8,  __VA_ARGS__)
+
+#define AX__DTYPE_HALF_LIST_WITH(X, ...)        \
+  X(F16,  f16,  mu16, __VA_ARGS__)              \
+  X(BF16, bf16, mu16, __VA_ARGS__)
+
+#define AX_HALF_BLOCK 256 // Elements widened to f32 at a time
+
+// Array conversions between half precision and f32. F16C and AVX512-BF16
+// handle eight elements per instruction; the scalar tails use the header's
+// software conversions. The AVX512-BF16 path flushes subnormals to zero.
+static void ax__f16_to_f32_n(const mu16* src, mf32* dst, musz n) {
+  musz k = 0;
+#if defined(__F16C__)
+  for (; k + 8 <= n; k += 8) {
+    _mm256_storeu_ps(dst + k, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(const void*)(src + k))));
+  }
+#endif
+  for (; k < n; k++) dst[k] = ax_f16_to_f32(src[k]);
+}
+
+static void ax__f32_to_f16_n(const mf32* src, mu16* dst, musz n) {
+  musz k = 0;
+#if defined(__F16C__)
+  for (; k + 8 <= n; k += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + k), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm_storeu_si128((__m128i*)(void*)(dst + k), h);
+  }
+#endif
+  for (; k < n; k++) dst[k] = ax_f32_to_f16(src[k]);
+}
+
+static void ax__bf16_to_f32_n(const mu16* src, mf32* dst, musz n) {
+  musz k = 0;
+#if defined(__AVX2__)
+  for (; k + 8 <= n; k += 8) {
+    __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(const void*)(src + k)));
+    _mm256_storeu_ps(dst + k, _mm256_castsi256_ps(_mm256_slli_epi32(w, 16)));
+  }
+#endif
+  for (; k < n; k++) dst[k] = ax_bf16_to_f32(src[k]);
+}
+
+static void ax__f32_to_bf16_n(const mf32* src, mu16* dst, musz n) {
+  musz k = 0;
+#if defined(__AVX512BF16__) && defined(__AVX512VL__)
+  for (; k + 8 <= n; k += 8) {
+    __m128bh h = _mm256_cvtneps_pbh(_mm256_loadu_ps(src + k));
+    memcpy(dst + k, &h, sizeof(h));
+  }
+#endif
+  for (; k < n; k++) dst[k] = ax_f32_to_bf16(src[k]);
+}
+
+static void ax__half_to_f32_n(AxDType dtype, const mu16* src, mf32* dst, musz n) {
+  if (dtype == AX_F16) {
+    ax__f16_to_f32_n(src, dst, n);
+  } else {
+    ax__bf16_to_f32_n(src, dst, n);
+  }
+}
+
+static void ax__f32_to_half_n(AxDType dtype, const mf32* src, mu16* dst, musz n) {
+  if (dtype == AX_F16) {
+    ax__f32_to_f16_n(src, dst, n);
+  } else {
+    ax__f32_to_bf16_n(src, dst, n);
+  }
+}
+
+static inline mf32 ax__half_get(AxDType dtype, mu16 h) {
+  return dtype == AX_F16 ? ax_f16_to_f32(h) : ax_bf16_to_f32(h);
+}
+
+static inline mu16 ax__half_set(AxDType dtype, mf32 f) {
+  return dtype == AX_F16 ? ax_f32_to_f16(f) : ax_f32_to_bf16(f);
+}
+
+// AX_SEMIRING_LIST forwarding extra arguments to X
+#define AX__SEMIRING_LIST_WITH(X, ...)          \
+  X(PLUS_TIMES, plus_times, __VA_ARGS__)        \
+  X(MIN_PLUS,   min_plus,   __VA_ARGS__)        \
+  X(MAX_PLUS,   max_plus,   __VA_ARGS__)        \
+  X(MAX_MIN,    max_min,    __VA_ARGS__)        \
+  X(OR_AND,     or_and,     __VA_ARGS__)
+
+// One value of any dtype
+typedef union AxScalar {
+#define AX__SCALAR_FIELD(T, s, ct) ct v_##s;
+  AX_DTYPE_LIST(AX__SCALAR_FIELD)
+  AX_DTYPE_HALF_LIST(AX__SCALAR_FIELD)
+#undef AX__SCALAR_FIELD
+} AxScalar;
+
+static AxScalar ax__scalar_from_double(AxDType dtype, double value) {
+  AxScalar s;
+  switch (dtype) {
+#define AX__SCALAR_CASE(T, s_, ct) case AX_##T: s.v_##s_ = (ct)value; break;
+    AX_DTYPE_LIST(AX__SCALAR_CASE)
+#undef AX__SCALAR_CASE
+#define AX__SCALAR_HALF_CASE(T, s_, ct) case AX_##T: s.v_##s_ = ax__half_set(dtype, (mf32)value); break;
+    AX_DTYPE_HALF_LIST(AX__SCALAR_HALF_CASE)
+#undef AX__SCALAR_HALF_CASE
+  }
+  return s;
+}
+
+// Address of element (i, j) for any dtype
+static inline void* ax__at(const AxMatrix* m, musz i, musz j) {
+  return (mu8*)m->data + (i * m->stride + j * m->col_stride) * ax_dtype_size(m->dtype);
+}
+
+// Whether walking down a column touches nearer memory than walking along a
+// row (e.g. a transposed view), and the reverse
+static inline bool ax__col_major(const AxMatrix* m) {
+  return m->rows > 1 && m->cols > 1 && m->stride < m->col_stride;
+}
+
+static inline bool ax__row_major(const AxMatrix* m) {
+  return m->rows > 1 && m->cols > 1 && m->col_stride < m->stride;
+}
+
+// Whether an element-wise problem over `ms` (NULL entries skipped) should
+// run on the transposed views: some operand is column-major, none row-major
+static bool ax__prefer_transpose(const AxMatrix* const* ms, musz n) {
+  bool col = false;
+  for (musz k = 0; k < n; k++) {
+    if (!ms[k]) continue;
+    if (ax__row_major(ms[k])) return false;
+    col = col || ax__col_major(ms[k]);
+  }
+  return col;
+}
+
+#define AX_STAGE_BLOCK 256 // Elements moved per strided run
+#define AX_STAGE_ROWS 32    // Rows per tile of a strided problem, so gathers
+                            // along a far stride reuse their cache lines
+
+// Moves n elements of `size` bytes between a run `inc` elements apart and a
+// unit-stride buffer
+static void ax__gather(void* dst, const void* src, musz inc, musz n, musz size) {
+  switch (size) {
+#define AX__GATHER_CASE(sz, ct)                                          \
+  case sz:                                                              \
+    for (musz k = 0; k < n; k++) ((ct*)dst)[k] = ((const ct*)src)[k * inc]; \
+    break;
+    AX__GATHER_CASE(1, mu8)
+    AX__GATHER_CASE(2, mu16)
+    AX__GATHER_CASE(4, mu32)
+    AX__GATHER_CASE(8, mu64)
+#undef AX__GATHER_CASE
+  }
+}
 
-bool ax_matrix_init(AxMatrix* mat, musz rows, musz cols, Arena* arena) {
+static void ax__scatter(void* dst, musz inc, const void* src, musz n, musz size) {
+  switch (size) {
+#define AX__SCATTER_CASE(sz, ct)                                         \
+  case sz:                                                              \
+    for (musz k = 0; k < n; k++) ((ct*)dst)[k * inc] = ((const ct*)src)[k]; \
+    break;
+    AX__SCATTER_CASE(1, mu8)
+    AX__SCATTER_CASE(2, mu16)
+    AX__SCATTER_CASE(4, mu32)
+    AX__SCATTER_CASE(8, mu64)
+#undef AX__SCATTER_CASE
+  }
+}
+
+bool ax_matrix_init_dtype(AxMatrix* mat, musz rows, musz cols, AxDType dtype, Arena* arena) {
   musz nelem = rows * cols;
-  musz size = nelem * sizeof(axm_type);
+  musz size = nelem * ax_dtype_size(dtype);
   if (arena) {
-    mat->data = (axm_type*) ax_alloc(arena, size);
+    mat->data = ax_alloc(arena, size);
   } else {
     AX_LOG(AX_LOG_INFO, "Arena is NULL, using malloc");
     AX_LOG(AX_LOG_WARN, "DO NOT FORGET TO CALL free");
-    mat->data = (axm_type*) malloc(size);
+    mat->data = malloc(size);
   }
   if (!mat->data) {
     AX_LOG(AX_LOG_FATAL, "ax_matrix_init: failed to allocate data");
@@ -90,11 +853,13 @@ bool ax_matrix_init(AxMatrix* mat, musz rows, musz cols, Arena* arena) {
   mat->rows = rows;
   mat->cols = cols;
   mat->stride = cols;
+  mat->col_stride = 1;
+  mat->dtype = dtype;
   mat->data_owner = (arena == NULL);
   return true;
 }
 
-AxMatrix* ax_matrix_create(musz rows, musz cols, Arena* arena) {
+AxMatrix* ax_matrix_create_dtype(musz rows, musz cols, AxDType dtype, Arena* arena) {
   AxMatrix* mat;
   if (arena) {
     mat = (AxMatrix*) ax_alloc(arena, sizeof(AxMatrix));
@@ -107,7 +872,7 @@ AxMatrix* ax_matrix_create(musz rows, musz cols, Arena* arena) {
     AX_LOG(AX_LOG_FATAL, "ax_matrix_create: failed to allocate matrix struct");
     return NULL;
   }
-  if (!ax_matrix_init(mat, rows, cols, arena)) {
+  if (!ax_matrix_init_dtype(mat, rows, cols, dtype, arena)) {
     if (!arena) {
       free(mat);
     }
@@ -125,8 +890,154 @@ void ax_matrix_destroy(AxMatrix* mat) {
   mat->rows = 0;
   mat->cols = 0;
   mat->stride = 0;
+  mat->col_stride = 0;
+}
+
+// Reads or writes one element of any dtype through double
+static double ax__load_elem(AxDType dtype, const void* p) {
+  switch (dtype) {
+#define AX__GET_CASE(T, s, ct) case AX_##T: return (double)*(const ct*)p;
+    AX_DTYPE_LIST(AX__GET_CASE)
+#undef AX__GET_CASE
+#define AX__GET_HALF_CASE(T, s, ct) case AX_##T: return (double)ax__half_get(dtype, *(const mu16*)p);
+    AX_DTYPE_HALF_LIST(AX__GET_HALF_CASE)
+#undef AX__GET_HALF_CASE
+  }
+  return 0;
+}
+
+static void ax__store_elem(AxDType dtype, void* p, double value) {
+  switch (dtype) {
+#define AX__SET_CASE(T, s, ct) case AX_##T: *(ct*)p = (ct)value; break;
+    AX_DTYPE_LIST(AX__SET_CASE)
+#undef AX__SET_CASE
+#define AX__SET_HALF_CASE(T, s, ct) case AX_##T: *(mu16*)p = ax__half_set(dtype, (mf32)value); break;
+    AX_DTYPE_HALF_LIST(AX__SET_HALF_CASE)
+#undef AX__SET_HALF_CASE
+  }
+}
+
+double ax_matrix_get(const AxMatrix* mat, musz i, musz j) {
+  return ax__load_elem(mat->dtype, ax__at(mat, i, j));
+}
+
+void ax_matrix_set(AxMatrix* mat, musz i, musz j, double value) {
+  ax__store_elem(mat->dtype, ax__at(mat, i, j), value);
+}
+
+// Conversion kernels for every (destination, source) pair
+typedef void (*AxConvertFn)(void* dst, const void* src, musz n);
+
+#define AX__DEFINE_CONVERT(S, ss, sct, D, ds, dct)                      \
+  static void ax__convert_##ds##_##ss(void* dst, const void* src, musz n) { \
+    dct* d = (dct*)dst;                                                 \
+    const sct* x = (const sct*)src;                                     \
+    for (musz k = 0; k < n; k++) d[k] = (dct)x[k];                      \
+  }
+#define AX__DEFINE_CONVERT_TO(D, ds, dct) AX__DTYPE_LIST_WITH(AX__DEFINE_CONVERT, D, ds, dct)
+AX_DTYPE_LIST(AX__DEFINE_CONVERT_TO)
+
+// Widening to and narrowing from f32, uniform over every dtype
+#define AX__DEFINE_F32_IO(T, s, ct)                                     \
+  static inline void ax__to_f32_##s(const void* src, mf32* dst, musz n) { \
+    ax__convert_f32_##s(dst, src, n);                                   \
+  }                                                                     \
+  static inline void ax__from_f32_##s(const mf32* src, void* dst, musz n) { \
+    ax__convert_##s##_f32(dst, src, n);                                 \
+  }
+AX_DTYPE_LIST(AX__DEFINE_F32_IO)
+
+#define AX__DEFINE_F32_IO_HALF(T, s, ct)                                \
+  static inline void ax__to_f32_##s(const void* src, mf32* dst, musz n) { \
+    ax__half_to_f32_n(AX_##T, (const mu16*)src, dst, n);                \
+  }                                                                     \
+  static inline void ax__from_f32_##s(const mf32* src, void* dst, musz n) { \
+    ax__f32_to_half_n(AX_##T, src, (mu16*)dst, n);                      \
+  }
+AX_DTYPE_HALF_LIST(AX__DEFINE_F32_IO_HALF)
+
+// Pairs involving a half-precision dtype go through an f32 block (so f64
+// sources are rounded to f32 first)
+#define AX__DEFINE_CONVERT_VIA_F32(S, ss, sct, D, ds, dct)              \
+  static void ax__convert_##ds##_##ss(void* dst, const void* src, musz n) { \
+    mf32 buf[AX_HALF_BLOCK];                                            \
+    for (musz off = 0; off < n; off += AX_HALF_BLOCK) {                 \
+      musz len = (n - off < AX_HALF_BLOCK) ? n - off : AX_HALF_BLOCK;   \
+      ax__to_f32_##ss((const sct*)src + off, buf, len);                 \
+      ax__from_f32_##ds(buf, (dct*)dst + off, len);                     \
+    }                                                                   \
+  }
+#define AX__DEFINE_CONVERT_TO_HALF(D, ds, dct)                          \
+  AX__DTYPE_LIST_WITH(AX__DEFINE_CONVERT_VIA_F32, D, ds, dct)           \
+  AX__DTYPE_HALF_LIST_WITH(AX__DEFINE_CONVERT_VIA_F32, D, ds, dct)
+#define AX__DEFINE_CONVERT_FROM_HALF(D, ds, dct)                        \
+  AX__DTYPE_HALF_LIST_WITH(AX__DEFINE_CONVERT_VIA_F32, D, ds, dct)
+AX_DTYPE_HALF_LIST(AX__DEFINE_CONVERT_TO_HALF)
+AX_DTYPE_LIST(AX__DEFINE_CONVERT_FROM_HALF)
+
+static AxConvertFn ax__convert_fn(AxDType dst, AxDType src) {
+#define AX__CONVERT_CASE_SRC(S, ss, sct, D, ds, dct) case AX_##S: return ax__convert_##ds##_##ss;
+#define AX__CONVERT_CASE_DST(D, ds, dct)                                \
+  case AX_##D:                                                          \
+    switch (src) {                                                      \
+      AX__DTYPE_LIST_WITH(AX__CONVERT_CASE_SRC, D, ds, dct)             \
+      AX__DTYPE_HALF_LIST_WITH(AX__CONVERT_CASE_SRC, D, ds, dct)        \
+    }                                                                   \
+    break;
+  switch (dst) {
+    AX_DTYPE_LIST(AX__CONVERT_CASE_DST)
+    AX_DTYPE_HALF_LIST(AX__CONVERT_CASE_DST)
+  }
+#undef AX__CONVERT_CASE_DST
+#undef AX__CONVERT_CASE_SRC
+  return NULL;
+}
+
+typedef struct AxCopyTask {
+  AxMatrix* dest;
+  const AxMatrix* src;
+  AxConvertFn fn;
+} AxCopyTask;
+
+static void ax__copy_task(void* ctx, musz begin, musz end) {
+  AxCopyTask* t = (AxCopyTask*)ctx;
+  for (musz i = begin; i < end; i++) {
+    t->fn(ax__at(t->dest, i, 0), ax__at(t->src, i, 0), t->src->cols);
+  }
+}
+
+// Strided operands: AX_STAGE_ROWS x AX_STAGE_BLOCK tiles, converted a row
+// at a time through unit-stride buffers
+static void ax__copy_tile_task(void* ctx, musz begin, musz end) {
+  AxCopyTask* t = (AxCopyTask*)ctx;
+  const AxMatrix* src = t->src;
+  AxMatrix* dest = t->dest;
+  musz ssize = ax_dtype_size(src->dtype), dsize = ax_dtype_size(dest->dtype);
+  musz ntiles = (src->cols + AX_STAGE_BLOCK - 1) / AX_STAGE_BLOCK;
+  mu64 sbuf[AX_STAGE_BLOCK], dbuf[AX_STAGE_BLOCK];
+  for (musz k = begin; k < end; k++) {
+    musz i0 = (k / ntiles) * AX_STAGE_ROWS;
+    musz i1 = (src->rows - i0 < AX_STAGE_ROWS) ? src->rows : i0 + AX_STAGE_ROWS;
+    musz j = (k % ntiles) * AX_STAGE_BLOCK;
+    musz len = (src->cols - j < AX_STAGE_BLOCK) ? src->cols - j : AX_STAGE_BLOCK;
+    for (musz i = i0; i < i1; i++) {
+      const void* x = ax__at(src, i, j);
+      if (!ax__unit_cols(src)) {
+        ax__gather(sbuf, x, src->col_stride, len, ssize);
+        x = sbuf;
+      }
+      if (ax__unit_cols(dest)) {
+        t->fn(ax__at(dest, i, j), x, len);
+      } else {
+        t->fn(dbuf, x, len);
+        ax__scatter(ax__at(dest, i, j), dest->col_stride, dbuf, len, dsize);
+      }
+    }
+  }
 }
 
+static void ax__transpose_run(AxMatrix* dest, const AxMatrix* src); // See Transpose
+
 bool ax_matrix_copy(AxMatrix* dest, const AxMatrix* src) {
   if (!dest || !src) {
     AX_LOG(AX_LOG_FATAL, "ax_matrix_copy: null matrix");
@@ -136,11 +1047,32 @@ bool ax_matrix_copy(AxMatrix* dest, const AxMatrix* src) {
     AX_LOG(AX_LOG_FATAL, "ax_matrix_copy: dimension mismatch");
     return false;
   }
-  for (musz i = 0; i < dest->rows; i++) {
-    for (musz j = 0; j < dest->cols; j++) {
-      AX_MATRIX_AT(*dest, i, j) = AX_MATRIX_AT(*src, i, j);
+  if (src->cols == 0 || src->rows == 0) return true;
+  const AxMatrix* ops[2] = { dest, src };
+  if (ax__prefer_transpose(ops, 2)) {
+    AxMatrix dt = ax_matrix_transpose_view(dest), st = ax_matrix_transpose_view(src);
+    return ax_matrix_copy(&dt, &st);
+  }
+  if (dest->dtype == src->dtype) {
+    // One side row-major, the other its transpose: a blocked transpose
+    AxMatrix dt = ax_matrix_transpose_view(dest), st = ax_matrix_transpose_view(src);
+    if (ax__unit_cols(dest) && !ax__unit_cols(src) && ax__unit_cols(&st)) {
+      ax__transpose_run(dest, &st);
+      return true;
+    }
+    if (!ax__unit_cols(dest) && ax__unit_cols(&dt) && ax__unit_cols(src)) {
+      ax__transpose_run(&dt, src);
+      return true;
     }
   }
+  AxCopyTask t = { dest, src, ax__convert_fn(dest->dtype, src->dtype) };
+  if (!ax__unit_cols(dest) || !ax__unit_cols(src)) {
+    musz tiles = (src->rows + AX_STAGE_ROWS - 1) / AX_STAGE_ROWS *
+                 ((src->cols + AX_STAGE_BLOCK - 1) / AX_STAGE_BLOCK);
+    ax_parallel_for(tiles, 8, ax__copy_tile_task, &t);
+    return true;
+  }
+  ax_parallel_for(src->rows, 65536 / src->cols + 1, ax__copy_task, &t);
   return true;
 }
 
@@ -150,100 +1082,3793 @@ void ax_matrix_print(const AxMatrix* mat, const char* fmt) {
     return;
   }
   if (!fmt) fmt = "% .6g";  // Default format with space for alignment
-    
+
   // First pass to find maximum width per column
   musz *widths = (musz*)calloc(mat->cols, sizeof(musz));
   for (musz j = 0; j < mat->cols; j++) {
     for (musz i = 0; i < mat->rows; i++) {
       char buf[256];
-      musz len = (musz)snprintf(buf, sizeof(buf), fmt, AX_MATRIX_AT(*mat, i, j));
+      musz len = (musz)snprintf(buf, sizeof(buf), fmt, ax_matrix_get(mat, i, j));
       if (len > widths[j]) widths[j] = len;
     }
   }
-    
+
   // Second pass to print with column alignment
   for (musz i = 0; i < mat->rows; i++) {
     for (musz j = 0; j < mat->cols; j++) {
       char buf[256];
-      snprintf(buf, sizeof(buf), fmt, AX_MATRIX_AT(*mat, i, j));
+      snprintf(buf, sizeof(buf), fmt, ax_matrix_get(mat, i, j));
       printf("%*s", (int)widths[j], buf);
       if (j < mat->cols - 1) printf("  ");  // 2 spaces between columns
     }
     printf("\n");
   }
-    
+
   free(widths);
 }
 
-AxMatrix* ax_matrix_add(const AxMatrix* a, const AxMatrix* b, Arena* arena) {
-  if (!a || !b) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_add: null matrix");
-    return NULL;
-  }
-  if (a->rows != b->rows || a->cols != b->cols) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_add: dimension mismatch");
-    return NULL;
-  }
-  AxMatrix* result = ax_matrix_create(a->rows, a->cols, arena);
-  if (!result) return NULL;
-  for (musz i = 0; i < a->rows; i++) {
-    for (musz j = 0; j < a->cols; j++) {
-      AX_MATRIX_AT(*result, i, j) = AX_MATRIX_AT(*a, i, j) + AX_MATRIX_AT(*b, i, j);
-    }
+static bool ax__same_dtype(const char* name, const AxMatrix* a, const AxMatrix* b) {
+  if (a->dtype != b->dtype) {
+    AX_LOG(AX_LOG_FATAL, "%s: dtype mismatch (%s vs %s)", name,
+           ax_dtype_name(a->dtype), ax_dtype_name(b->dtype));
+    return false;
   }
-  return result;
+  return true;
 }
 
-AxMatrix* ax_matrix_elementwise_multiply(const AxMatrix* a, const AxMatrix* b, Arena* arena) {
-  if (!a || !b) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_elementwise_multiply: null matrix");
+// Broadcasting element-wise operations
+
+#define AX_BINARY_CHUNK 16384 // Columns per parallel task
+
+#define AX__OP_ADD(x, y) AX__OP(add, x, y)
+#define AX__OP_SUB(x, y) AX__OP(sub, x, y)
+#define AX__OP_MUL(x, y) AX__OP(mul, x, y)
+#define AX__OP_DIV(x, y) AX__OP(div, x, y)
+
+// Vector-vector and vector-scalar loops for one operator and dtype.
+#define AX__DEFINE_BINARY(name, OP, s, ct)                              \
+  static void ax__##name##_vv_##s(ct* out, const ct* x, const ct* y, musz n) { \
+    for (musz j = 0; j < n; j++) out[j] = (ct)OP(x[j], y[j]);           \
+  }                                                                     \
+  static void ax__##name##_vs_##s(ct* out, const ct* x, ct v, musz n) { \
+    for (musz j = 0; j < n; j++) out[j] = (ct)OP(x[j], v);              \
   }
-  if (a->rows != b->rows || a->cols != b->cols) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_elementwise_multiply: dimension mismatch");
+
+// Applies `op` to a run of n elements; `y` points to n elements, or to a
+// single one when `y_scalar` is set.
+#define AX__DEFINE_BINARY_DTYPE(T, s, ct)                               \
+  AX__DEFINE_BINARY(add, AX__OP_ADD, s, ct)                             \
+  AX__DEFINE_BINARY(sub, AX__OP_SUB, s, ct)                             \
+  AX__DEFINE_BINARY(mul, AX__OP_MUL, s, ct)                             \
+  AX__DEFINE_BINARY(div, AX__OP_DIV, s, ct)                             \
+  static void ax__binary_run_##s(AxBinaryOp op, void* out, const void* x, \
+                                 const void* y, bool y_scalar, musz n) { \
+    ct* o = (ct*)out;                                                   \
+    const ct* a = (const ct*)x;                                         \
+    const ct* b = (const ct*)y;                                         \
+    if (y_scalar) {                                                     \
+      switch (op) {                                                     \
+      case AX_BINARY_ADD: ax__add_vs_##s(o, a, *b, n); break;           \
+      case AX_BINARY_SUB: ax__sub_vs_##s(o, a, *b, n); break;           \
+      case AX_BINARY_MUL: ax__mul_vs_##s(o, a, *b, n); break;           \
+      case AX_BINARY_DIV: ax__div_vs_##s(o, a, *b, n); break;           \
+      }                                                                 \
+    } else {                                                            \
+      switch (op) {                                                     \
+      case AX_BINARY_ADD: ax__add_vv_##s(o, a, b, n); break;            \
+      case AX_BINARY_SUB: ax__sub_vv_##s(o, a, b, n); break;            \
+      case AX_BINARY_MUL: ax__mul_vv_##s(o, a, b, n); break;            \
+      case AX_BINARY_DIV: ax__div_vv_##s(o, a, b, n); break;            \
+      }                                                                 \
+    }                                                                   \
   }
-  AxMatrix* result = ax_matrix_create(a->rows, a->cols, arena);
-  if (!result) return NULL;
-  for (musz i = 0; i < a->rows; i++) {
-    for (musz j = 0; j < a->cols; j++) {
-      AX_MATRIX_AT(*result, i, j) = AX_MATRIX_AT(*a, i, j) * AX_MATRIX_AT(*b, i, j);
-    }
+
+AX_DTYPE_LIST(AX__DEFINE_BINARY_DTYPE)
+
+// Half-precision runs are widened to f32 a block at a time, computed there
+// and rounded back.
+static void ax__binary_run_half(AxBinaryOp op, AxDType dtype, void* out, const void* x,
+                                const void* y, bool y_scalar, musz n) {
+  mf32 bx[AX_HALF_BLOCK];
+  mf32 by[AX_HALF_BLOCK];
+  if (y_scalar) by[0] = ax__half_get(dtype, *(const mu16*)y);
+  for (musz off = 0; off < n; off += AX_HALF_BLOCK) {
+    musz len = (n - off < AX_HALF_BLOCK) ? n - off : AX_HALF_BLOCK;
+    ax__half_to_f32_n(dtype, (const mu16*)x + off, bx, len);
+    if (!y_scalar) ax__half_to_f32_n(dtype, (const mu16*)y + off, by, len);
+    ax__binary_run_f32(op, bx, bx, by, y_scalar, len);
+    ax__f32_to_half_n(dtype, bx, (mu16*)out + off, len);
   }
-  return result;
 }
 
-AxMatrix* ax_matrix_multiply(const AxMatrix* a, const AxMatrix* b, Arena* arena) {
-  if (!a || !b) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_multiply: null matrix");
+static void ax__binary_run(AxBinaryOp op, AxDType dtype, void* out, const void* x,
+                           const void* y, bool y_scalar, musz n) {
+  switch (dtype) {
+#define AX__BINARY_CASE(T, s, ct) case AX_##T: ax__binary_run_##s(op, out, x, y, y_scalar, n); break;
+    AX_DTYPE_LIST(AX__BINARY_CASE)
+#undef AX__BINARY_CASE
+  case AX_F16:
+  case AX_BF16:
+    ax__binary_run_half(op, dtype, out, x, y, y_scalar, n);
+    break;
   }
-  if (a->cols != b->rows) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_multiply: dimension mismatch");
+}
+
+typedef struct AxBinaryTask {
+  AxBinaryOp op;
+  AxMatrix* dest;
+  const AxMatrix* a;
+  const AxMatrix* b;  // NULL when broadcasting `scalar`
+  AxScalar scalar;
+  musz ntiles;        // Column chunks per row
+} AxBinaryTask;
+
+// Run of n <= AX_STAGE_BLOCK elements from (i, j) when an operand is
+// strided: gathered to and scattered from unit-stride buffers around the
+// same kernels
+static void ax__binary_staged(const AxBinaryTask* t, musz i, musz j, musz n) {
+  musz size = ax_dtype_size(t->a->dtype);
+  mu64 xbuf[AX_STAGE_BLOCK], ybuf[AX_STAGE_BLOCK], obuf[AX_STAGE_BLOCK];
+  const AxMatrix* b = t->b;
+  bool y_scalar = !b || b->cols == 1;
+  const void* y = !b ? (const void*)&t->scalar : ax__at(b, b->rows == 1 ? 0 : i, y_scalar ? 0 : j);
+  const void* x = ax__at(t->a, i, j);
+  if (!ax__unit_cols(t->a)) {
+    ax__gather(xbuf, x, t->a->col_stride, n, size);
+    x = xbuf;
   }
-  musz m = a->rows;
-  musz n = a->cols;
-  musz p = b->cols;
-  AxMatrix* result = ax_matrix_create(m, p, arena);
-  if (!result) return NULL;
-  for (musz i = 0; i < m; i++) {
-    for (musz j = 0; j < p; j++) {
-      axm_type sum = 0;
-      for (musz k = 0; k < n; k++) {
-        sum += AX_MATRIX_AT(*a, i, k) * AX_MATRIX_AT(*b, k, j);
-      }
-      AX_MATRIX_AT(*result, i, j) = sum;
-    }
+  if (!y_scalar && !ax__unit_cols(b)) {
+    ax__gather(ybuf, y, b->col_stride, n, size);
+    y = ybuf;
+  }
+  void* out = ax__at(t->dest, i, j);
+  if (ax__unit_cols(t->dest)) {
+    ax__binary_run(t->op, t->a->dtype, out, x, y, y_scalar, n);
+  } else {
+    ax__binary_run(t->op, t->a->dtype, obuf, x, y, y_scalar, n);
+    ax__scatter(out, t->dest->col_stride, obuf, n, size);
   }
-  return result;
 }
 
-void ax_matrix_map(AxMatrix* mat, axm_type (*f)(AxMatrix* self, musz i, musz j)) {
-  if (!mat || !mat->data) {
-    AX_LOG(AX_LOG_FATAL, "ax_matrix_map: invalid matrix");
+// Strided operands: AX_STAGE_ROWS x AX_STAGE_BLOCK tiles (ntiles counts
+// column blocks)
+static void ax__binary_tile_task(void* ctx, musz begin, musz end) {
+  AxBinaryTask* t = (AxBinaryTask*)ctx;
+  musz rows = t->a->rows, cols = t->a->cols;
+  for (musz k = begin; k < end; k++) {
+    musz i0 = (k / t->ntiles) * AX_STAGE_ROWS;
+    musz i1 = (rows - i0 < AX_STAGE_ROWS) ? rows : i0 + AX_STAGE_ROWS;
+    musz j = (k % t->ntiles) * AX_STAGE_BLOCK;
+    musz n = (cols - j < AX_STAGE_BLOCK) ? cols - j : AX_STAGE_BLOCK;
+    for (musz i = i0; i < i1; i++) ax__binary_staged(t, i, j, n);
   }
-  for (musz i = 0; i < mat->rows; i++) {
-    for (musz j = 0; j < mat->cols; j++) {
-      AX_MATRIX_AT(*mat, i, j) = f(mat, i, j);
+}
+
+static void ax__binary_task(void* ctx, musz begin, musz end) {
+  AxBinaryTask* t = (AxBinaryTask*)ctx;
+  musz cols = t->a->cols;
+  for (musz k = begin; k < end; k++) {
+    musz i = k / t->ntiles;
+    musz j = (k % t->ntiles) * AX_BINARY_CHUNK;
+    musz n = (cols - j < AX_BINARY_CHUNK) ? cols - j : AX_BINARY_CHUNK;
+    void* out = ax__at(t->dest, i, j);
+    const void* x = ax__at(t->a, i, j);
+    const AxMatrix* b = t->b;
+    if (!b) {
+      ax__binary_run(t->op, t->a->dtype, out, x, &t->scalar, true, n);
+    } else if (b->cols == 1) {
+      // Column vector or 1x1: one value per row
+      ax__binary_run(t->op, t->a->dtype, out, x, ax__at(b, b->rows == 1 ? 0 : i, 0), true, n);
+    } else {
+      // Full matrix or row vector
+      ax__binary_run(t->op, t->a->dtype, out, x, ax__at(b, b->rows == 1 ? 0 : i, j), false, n);
     }
   }
 }
 
-#endif /* AXMATRIX_IMPLEMENTATION */
+static void ax__binary(AxBinaryOp op, AxMatrix* dest, const AxMatrix* a,
+                       const AxMatrix* b, AxScalar scalar) {
+  if (a->rows == 0 || a->cols == 0) return;
+  const AxMatrix* ops[3] = { dest, a, b };
+  if (ax__prefer_transpose(ops, 3)) {
+    // Column-major operands: the transposed problem walks their columns,
+    // and a row-vector `b` becomes a column vector
+    AxMatrix dt = ax_matrix_transpose_view(dest), at = ax_matrix_transpose_view(a), bt;
+    if (b) bt = ax_matrix_transpose_view(b);
+    ax__binary(op, &dt, &at, b ? &bt : NULL, scalar);
+    return;
+  }
+  if (!ax__unit_cols(dest) || !ax__unit_cols(a) || (b && !ax__unit_cols(b))) {
+    AxBinaryTask t = { op, dest, a, b, scalar, (a->cols + AX_STAGE_BLOCK - 1) / AX_STAGE_BLOCK };
+    musz tiles = (a->rows + AX_STAGE_ROWS - 1) / AX_STAGE_ROWS * t.ntiles;
+    ax_parallel_for(tiles, 2, ax__binary_tile_task, &t);
+    return;
+  }
+  AxBinaryTask t = { op, dest, a, b, scalar, (a->cols + AX_BINARY_CHUNK - 1) / AX_BINARY_CHUNK };
+  musz grain = AX_BINARY_CHUNK / a->cols + 1;
+  ax_parallel_for(a->rows * t.ntiles, grain, ax__binary_task, &t);
+}
+
+bool ax_matrix_broadcast_into(AxMatrix* dest, const AxMatrix* a, const AxMatrix* b, AxBinaryOp op) {
+  if (!dest || !a || !b || !dest->data || !a->data || !b->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_broadcast_into: null matrix");
+    return false;
+  }
+  if ((b->rows != a->rows && b->rows != 1) || (b->cols != a->cols && b->cols != 1)) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_broadcast_into: cannot broadcast %zux%zu against %zux%zu",
+           b->rows, b->cols, a->rows, a->cols);
+    return false;
+  }
+  if (dest->rows != a->rows || dest->cols != a->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_broadcast_into: dimension mismatch");
+    return false;
+  }
+  if (!ax__same_dtype("ax_matrix_broadcast_into", dest, a) ||
+      !ax__same_dtype("ax_matrix_broadcast_into", a, b)) {
+    return false;
+  }
+  ax__binary(op, dest, a, b, ax__scalar_from_double(a->dtype, 0));
+  return true;
+}
+
+AxMatrix* ax_matrix_broadcast(const AxMatrix* a, const AxMatrix* b, AxBinaryOp op, Arena* arena) {
+  if (!a) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_broadcast: null matrix");
+    return NULL;
+  }
+  AxMatrix* result = ax_matrix_create_dtype(a->rows, a->cols, a->dtype, arena);
+  if (!result) return NULL;
+  ax_matrix_broadcast_into(result, a, b, op);
+  return result;
+}
+
+bool ax_matrix_scalar_into(AxMatrix* dest, const AxMatrix* a, double s, AxBinaryOp op) {
+  if (!dest || !a || !dest->data || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_scalar_into: null matrix");
+    return false;
+  }
+  if (dest->rows != a->rows || dest->cols != a->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_scalar_into: dimension mismatch");
+    return false;
+  }
+  if (!ax__same_dtype("ax_matrix_scalar_into", dest, a)) return false;
+  ax__binary(op, dest, a, NULL, ax__scalar_from_double(a->dtype, s));
+  return true;
+}
+
+AxMatrix* ax_matrix_add(const AxMatrix* a, const AxMatrix* b, Arena* arena) {
+  if (!a || !b) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_add: null matrix");
+    return NULL;
+  }
+  if (a->rows != b->rows || a->cols != b->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_add: dimension mismatch");
+    return NULL;
+  }
+  if (!ax__same_dtype("ax_matrix_add", a, b)) return NULL;
+  AxMatrix* result = ax_matrix_create_dtype(a->rows, a->cols, a->dtype, arena);
+  if (!result) return NULL;
+  ax__binary(AX_BINARY_ADD, result, a, b, ax__scalar_from_double(a->dtype, 0));
+  return result;
+}
+
+AxMatrix* ax_matrix_elementwise_multiply(const AxMatrix* a, const AxMatrix* b, Arena* arena) {
+  if (!a || !b) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_elementwise_multiply: null matrix");
+  }
+  if (a->rows != b->rows || a->cols != b->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_elementwise_multiply: dimension mismatch");
+  }
+  if (!ax__same_dtype("ax_matrix_elementwise_multiply", a, b)) return NULL;
+  AxMatrix* result = ax_matrix_create_dtype(a->rows, a->cols, a->dtype, arena);
+  if (!result) return NULL;
+  ax__binary(AX_BINARY_MUL, result, a, b, ax__scalar_from_double(a->dtype, 0));
+  return result;
+}
+
+// Integer matrix product, one row of the result at a time (i-k-j order, so
+// the inner loop streams unit-stride rows of `b` and the result). Floating
+// point dtypes go through the GEMM engine below.
+#define AX__DEFINE_MATMUL(T, s, ct)                                     \
+  static void ax__matmul_rows_##s(const AxMatrix* a, const AxMatrix* b, \
+                                  AxMatrix* c, musz i0, musz i1) {      \
+    for (musz i = i0; i < i1; i++) {                                    \
+      ct* ci = &AX_MATRIX_AT_T(ct, *c, i, 0);                           \
+      for (musz j = 0; j < c->cols; j++) ci[j] = 0;                     \
+      for (musz k = 0; k < a->cols; k++) {                              \
+        ct aik = AX_MATRIX_AT_T(ct, *a, i, k);                          \
+        const ct* bk = &AX_MATRIX_AT_T(ct, *b, k, 0);                   \
+        for (musz j = 0; j < c->cols; j++) ci[j] = (ct)(ci[j] + aik * bk[j]); \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX_DTYPE_INT_LIST(AX__DEFINE_MATMUL)
+
+typedef struct AxMatmulTask {
+  const AxMatrix* a;
+  const AxMatrix* b;
+  AxMatrix* c;
+} AxMatmulTask;
+
+static void ax__matmul_task(void* ctx, musz begin, musz end) {
+  AxMatmulTask* t = (AxMatmulTask*)ctx;
+  switch (t->c->dtype) {
+#define AX__MATMUL_CASE(T, s, ct) case AX_##T: ax__matmul_rows_##s(t->a, t->b, t->c, begin, end); break;
+    AX_DTYPE_INT_LIST(AX__MATMUL_CASE)
+#undef AX__MATMUL_CASE
+  default: break;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// GEMM
+// ---------------------------------------------------------------------------
+//
+// Blocked as in GotoBLAS: for every NC-wide panel of columns and KC-deep
+// slice of k, the slice of B is packed once into NR-wide slivers shared by
+// all threads. Each task then packs an MC x KC block of A into MR-tall
+// slivers and sweeps it over (part of) the panel with an MR x NR register
+// tile. Packing converts storage to the compute type (f32 for f16, bf16 and
+// f32, f64 for f64), so half-precision operands are widened once per block
+// and accumulated in f32.
+
+#define AX_GEMM_KC 256
+#define AX_GEMM_NC 4096
+
+#if defined(__AVX512F__)
+#define AX_GEMM_MR_f32 8
+#define AX_GEMM_NR_f32 32
+#define AX_GEMM_MR_f64 8
+#define AX_GEMM_NR_f64 16
+#elif defined(__AVX2__) && defined(__FMA__)
+#define AX_GEMM_MR_f32 6
+#define AX_GEMM_NR_f32 16
+#define AX_GEMM_MR_f64 6
+#define AX_GEMM_NR_f64 8
+#else
+#define AX_GEMM_MR_f32 4
+#define AX_GEMM_NR_f32 8
+#define AX_GEMM_MR_f64 4
+#define AX_GEMM_NR_f64 4
+#endif
+
+#define AX_GEMM_MC_f32 (AX_GEMM_MR_f32 * 16)
+#define AX_GEMM_MC_f64 (AX_GEMM_MR_f64 * 16)
+
+// Compute types: X(TAG, suffix, C type)
+#define AX__GEMM_TYPES(X)                       \
+  X(F32, f32, mf32)                             \
+  X(F64, f64, mf64)
+
+// Operand view: element (i, j) lives `i * rs + j * cs` elements past `data`,
+// so transposing swaps the two steps.
+typedef struct AxGemmOperand {
+  void* data;
+  AxDType dtype;
+  musz rs;
+  musz cs;
+} AxGemmOperand;
+
+static inline void* ax__gemm_at(const AxGemmOperand* op, musz i, musz j) {
+  return (mu8*)op->data + (i * op->rs + j * op->cs) * ax_dtype_size(op->dtype);
+}
+
+// Loads n elements `inc` apart into the compute type
+static void ax__gemm_load_f32(AxDType dtype, const void* src, musz inc, musz n, mf32* dst) {
+  if (dtype == AX_F32) {
+    const mf32* x = (const mf32*)src;
+    if (inc == 1) {
+      memcpy(dst, x, n * sizeof(mf32));
+    } else {
+      for (musz k = 0; k < n; k++) dst[k] = x[k * inc];
+    }
+  } else if (inc == 1) {
+    ax__half_to_f32_n(dtype, (const mu16*)src, dst, n);
+  } else {
+    const mu16* x = (const mu16*)src;
+    for (musz k = 0; k < n; k++) dst[k] = ax__half_get(dtype, x[k * inc]);
+  }
+}
+
+static void ax__gemm_load_f64(AxDType dtype, const void* src, musz inc, musz n, mf64* dst) {
+  (void)dtype;
+  const mf64* x = (const mf64*)src;
+  if (inc == 1) {
+    memcpy(dst, x, n * sizeof(mf64));
+  } else {
+    for (musz k = 0; k < n; k++) dst[k] = x[k * inc];
+  }
+}
+
+// Vector primitives of the micro-kernels
+#if defined(__AVX512F__)
+#define AX__GEMM_SIMD 1
+typedef __m512 ax__vec_f32;
+typedef __m512d ax__vec_f64;
+#define AX__VLEN_f32 16
+#define AX__VLEN_f64 8
+#define AX__VZERO_f32() _mm512_setzero_ps()
+#define AX__VZERO_f64() _mm512_setzero_pd()
+#define AX__VLOAD_f32(p) _mm512_loadu_ps(p)
+#define AX__VLOAD_f64(p) _mm512_loadu_pd(p)
+#define AX__VSTORE_f32(p, v) _mm512_storeu_ps(p, v)
+#define AX__VSTORE_f64(p, v) _mm512_storeu_pd(p, v)
+#define AX__VSET1_f32(x) _mm512_set1_ps(x)
+#define AX__VSET1_f64(x) _mm512_set1_pd(x)
+#define AX__VFMA_f32(a, b, c) _mm512_fmadd_ps(a, b, c)
+#define AX__VFMA_f64(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define AX__VADD_f32(a, b) _mm512_add_ps(a, b)
+#define AX__VADD_f64(a, b) _mm512_add_pd(a, b)
+#define AX__VMIN_f32(a, b) _mm512_min_ps(a, b)
+#define AX__VMIN_f64(a, b) _mm512_min_pd(a, b)
+#define AX__VMAX_f32(a, b) _mm512_max_ps(a, b)
+#define AX__VMAX_f64(a, b) _mm512_max_pd(a, b)
+#elif defined(__AVX2__) && defined(__FMA__)
+#define AX__GEMM_SIMD 1
+typedef __m256 ax__vec_f32;
+typedef __m256d ax__vec_f64;
+#define AX__VLEN_f32 8
+#define AX__VLEN_f64 4
+#define AX__VZERO_f32() _mm256_setzero_ps()
+#define AX__VZERO_f64() _mm256_setzero_pd()
+#define AX__VLOAD_f32(p) _mm256_loadu_ps(p)
+#define AX__VLOAD_f64(p) _mm256_loadu_pd(p)
+#define AX__VSTORE_f32(p, v) _mm256_storeu_ps(p, v)
+#define AX__VSTORE_f64(p, v) _mm256_storeu_pd(p, v)
+#define AX__VSET1_f32(x) _mm256_set1_ps(x)
+#define AX__VSET1_f64(x) _mm256_set1_pd(x)
+#define AX__VFMA_f32(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define AX__VFMA_f64(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define AX__VADD_f32(a, b) _mm256_add_ps(a, b)
+#define AX__VADD_f64(a, b) _mm256_add_pd(a, b)
+#define AX__VMIN_f32(a, b) _mm256_min_ps(a, b)
+#define AX__VMIN_f64(a, b) _mm256_min_pd(a, b)
+#define AX__VMAX_f32(a, b) _mm256_max_ps(a, b)
+#define AX__VMAX_f64(a, b) _mm256_max_pd(a, b)
+#else
+#define AX__GEMM_SIMD 0
+// Single-lane stand-ins, for kernels that are written against vectors only
+typedef mf32 ax__vec_f32;
+typedef mf64 ax__vec_f64;
+#define AX__VLEN_f32 1
+#define AX__VLEN_f64 1
+#define AX__VZERO_f32() 0.0f
+#define AX__VZERO_f64() 0.0
+#define AX__VLOAD_f32(p) (*(p))
+#define AX__VLOAD_f64(p) (*(p))
+#define AX__VSTORE_f32(p, v) (*(p) = (v))
+#define AX__VSTORE_f64(p, v) (*(p) = (v))
+#define AX__VFMA_f32(a, b, c) ((a) * (b) + (c))
+#define AX__VFMA_f64(a, b, c) ((a) * (b) + (c))
+#define AX__VSET1_f32(x) (x)
+#define AX__VSET1_f64(x) (x)
+#endif
+
+// Register update c = c (+) a (x) b of each semiring. Boolean operands are
+// packed as 0/1, where (or, and) is (max, min).
+#define AX__VUPD_plus_times(s, a, b, c) AX__VFMA_##s(a, b, c)
+#define AX__VUPD_min_plus(s, a, b, c)   AX__VMIN_##s(c, AX__VADD_##s(a, b))
+#define AX__VUPD_max_plus(s, a, b, c)   AX__VMAX_##s(c, AX__VADD_##s(a, b))
+#define AX__VUPD_max_min(s, a, b, c)    AX__VMAX_##s(c, AX__VMIN_##s(a, b))
+#define AX__VUPD_or_and(s, a, b, c)     AX__VMAX_##s(c, AX__VMIN_##s(a, b))
+
+// Micro-kernel: acc (MR x NR, row-major) = sum over p of a[:, p] * b[p, :],
+// with `a` and `b` packed slivers of depth kc, and sum and product taken in
+// the semiring. The tile stays in registers.
+#if AX__GEMM_SIMD
+#define AX__DEFINE_GEMM_MICRO(SRT, sr, T, s, ct)                        \
+  static inline void ax__gemm_micro_##sr##_##s(musz kc, const ct* restrict a, \
+                                               const ct* restrict b, ct* restrict acc) { \
+    enum { MR = AX_GEMM_MR_##s, NR = AX_GEMM_NR_##s, NV = NR / AX__VLEN_##s }; \
+    ax__vec_##s c[MR][NV];                                              \
+    for (int i = 0; i < MR; i++) {                                      \
+      for (int v = 0; v < NV; v++) c[i][v] = AX__VSET1_##s(AX_SEMIRING_ZERO_##sr(ct)); \
+    }                                                                   \
+    for (musz p = 0; p < kc; p++, a += MR, b += NR) {                   \
+      ax__vec_##s bv[NV];                                               \
+      for (int v = 0; v < NV; v++) bv[v] = AX__VLOAD_##s(b + v * AX__VLEN_##s); \
+      for (int i = 0; i < MR; i++) {                                    \
+        ax__vec_##s av = AX__VSET1_##s(a[i]);                           \
+        for (int v = 0; v < NV; v++) c[i][v] = AX__VUPD_##sr(s, av, bv[v], c[i][v]); \
+      }                                                                 \
+    }                                                                   \
+    for (int i = 0; i < MR; i++) {                                      \
+      for (int v = 0; v < NV; v++) AX__VSTORE_##s(acc + i * NR + v * AX__VLEN_##s, c[i][v]); \
+    }                                                                   \
+  }
+#else
+#define AX__DEFINE_GEMM_MICRO(SRT, sr, T, s, ct)                        \
+  static inline void ax__gemm_micro_##sr##_##s(musz kc, const ct* restrict a, \
+                                               const ct* restrict b, ct* restrict acc) { \
+    enum { MR = AX_GEMM_MR_##s, NR = AX_GEMM_NR_##s };                  \
+    ct c[MR][NR];                                                       \
+    for (int i = 0; i < MR; i++) {                                      \
+      for (int j = 0; j < NR; j++) c[i][j] = AX_SEMIRING_ZERO_##sr(ct); \
+    }                                                                   \
+    for (musz p = 0; p < kc; p++, a += MR, b += NR) {                   \
+      for (int i = 0; i < MR; i++) {                                    \
+        for (int j = 0; j < NR; j++) {                                  \
+          c[i][j] = AX_SEMIRING_ADD_##sr(ct, c[i][j], AX_SEMIRING_MUL_##sr(ct, a[i], b[j])); \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    memcpy(acc, c, sizeof(c));                                          \
+  }
+#endif
+
+// Result of a tile element v against the current c: plus-times computes
+// alpha * v + beta * c, the other semirings ignore alpha and combine with
+// their add (beta == 0 overwrites in both cases)
+#define AX__GEMM_OUT_plus_times(ct, c, v, alpha, beta) ((alpha) * (v) + (beta) * (c))
+#define AX__GEMM_OUT_min_plus(ct, c, v, alpha, beta)   AX_SEMIRING_ADD_min_plus(ct, c, v)
+#define AX__GEMM_OUT_max_plus(ct, c, v, alpha, beta)   AX_SEMIRING_ADD_max_plus(ct, c, v)
+#define AX__GEMM_OUT_max_min(ct, c, v, alpha, beta)    AX_SEMIRING_ADD_max_min(ct, c, v)
+#define AX__GEMM_OUT_or_and(ct, c, v, alpha, beta)     AX_SEMIRING_ADD_or_and(ct, c, v)
+#define AX__GEMM_FIRST_plus_times(v, alpha) ((alpha) * (v))
+#define AX__GEMM_FIRST_min_plus(v, alpha)   (v)
+#define AX__GEMM_FIRST_max_plus(v, alpha)   (v)
+#define AX__GEMM_FIRST_max_min(v, alpha)    (v)
+#define AX__GEMM_FIRST_or_and(v, alpha)     (v)
+
+// Per-thread packing buffers, grown on demand and kept for reuse: slot 0
+// holds blocks of A (every thread), slot 1 the shared slice of B (caller).
+// A key destructor frees them when any thread exits; ax_thread_shutdown()
+// also frees the caller's.
+static _Thread_local void* ax__gemm_buf[2];
+static _Thread_local musz ax__gemm_buf_size[2];
+static pthread_key_t ax__gemm_buf_key;
+static pthread_once_t ax__gemm_buf_once = PTHREAD_ONCE_INIT;
+
+static void ax__gemm_buffer_release(void) {
+  for (int slot = 0; slot < 2; slot++) {
+    free(ax__gemm_buf[slot]);
+    ax__gemm_buf[slot] = NULL;
+    ax__gemm_buf_size[slot] = 0;
+  }
+}
+
+static void ax__gemm_buffer_destroy(void* unused) {
+  (void)unused;
+  ax__gemm_buffer_release();
+}
+
+static void ax__gemm_buffer_key_init(void) {
+  pthread_key_create(&ax__gemm_buf_key, ax__gemm_buffer_destroy);
+  ax_thread_on_shutdown(ax__gemm_buffer_release);
+}
+
+static void* ax__gemm_buffer(int slot, musz bytes) {
+  if (ax__gemm_buf_size[slot] < bytes) {
+    free(ax__gemm_buf[slot]);
+    musz size = (bytes + 63) & ~(musz)63;
+    ax__gemm_buf[slot] = aligned_alloc(64, size);
+    ax__gemm_buf_size[slot] = ax__gemm_buf[slot] ? size : 0;
+    // Any non-NULL value arms the destructor for this thread
+    pthread_once(&ax__gemm_buf_once, ax__gemm_buffer_key_init);
+    pthread_setspecific(ax__gemm_buf_key, ax__gemm_buf);
+  }
+  return ax__gemm_buf[slot];
+}
+
+// Fused epilogue with operands in engine form: a row-vector bias repeats
+// with rs == 0, a column-vector bias with cs == 0
+typedef struct AxGemmEpi {
+  bool on;
+  AxGemmOperand bias; // data == NULL when absent
+  AxActivation act;
+  AxGemmOperand residual;
+} AxGemmEpi;
+
+#define AX__GEMM_EPI_CHUNK 64 // Columns per pass of the epilogue
+
+typedef struct AxGemmTask {
+  AxGemmOperand a;
+  AxGemmOperand b;
+  AxGemmOperand c;
+  AxGemmEpi epi; // Applied by the last slice of k only
+  musz m, n, k;
+  double alpha;
+  double beta;   // Applied by the first slice of k only
+  bool boolean;  // Pack operands as 0/1 (or-and semiring)
+  musz jc, nc;   // Current column panel
+  musz pc, kc;   // Current slice of k
+  void* bp;      // Packed slice of B
+  musz nblocks;  // MC-tall row blocks
+  musz ngroups;  // Column groups per panel
+  musz group;    // NR slivers per column group
+  atomic_bool ok;
+} AxGemmTask;
+
+// Packing, shared by every semiring of a compute type
+#define AX__DEFINE_GEMM(T, s, ct)                                       \
+  /* MR-tall slivers of the mc x kc block of A at (i0, p0), zero-padded. */ \
+  static void ax__gemm_pack_a_##s(const AxGemmOperand* A, musz i0, musz mc, \
+                                  musz p0, musz kc, ct* ap) {           \
+    enum { MR = AX_GEMM_MR_##s };                                       \
+    ct tmp[AX_GEMM_KC];                                                 \
+    for (musz ir = 0; ir < mc; ir += MR, ap += MR * kc) {               \
+      musz mr = (mc - ir < MR) ? mc - ir : MR;                          \
+      if (A->rs < A->cs) {                                              \
+        /* Column-major: each step of k reads mr nearby elements */     \
+        for (musz p = 0; p < kc; p++) {                                 \
+          ct* dst = ap + p * MR;                                        \
+          ax__gemm_load_##s(A->dtype, ax__gemm_at(A, i0 + ir, p0 + p), A->rs, mr, dst); \
+          for (musz i = mr; i < MR; i++) dst[i] = 0;                    \
+        }                                                               \
+      } else {                                                          \
+        for (musz i = 0; i < MR; i++) {                                 \
+          if (i < mr) {                                                 \
+            ax__gemm_load_##s(A->dtype, ax__gemm_at(A, i0 + ir + i, p0), A->cs, kc, tmp); \
+            for (musz p = 0; p < kc; p++) ap[p * MR + i] = tmp[p];      \
+          } else {                                                      \
+            for (musz p = 0; p < kc; p++) ap[p * MR + i] = 0;           \
+          }                                                             \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* One NR-wide sliver of the kc x nr block of B at (p0, j0), zero-padded. */ \
+  static void ax__gemm_pack_b_##s(const AxGemmOperand* B, musz p0, musz kc, \
+                                  musz j0, musz nr, ct* bp) {           \
+    enum { NR = AX_GEMM_NR_##s };                                       \
+    if (B->cs <= B->rs) {                                               \
+      for (musz p = 0; p < kc; p++) {                                   \
+        ct* dst = bp + p * NR;                                          \
+        ax__gemm_load_##s(B->dtype, ax__gemm_at(B, p0 + p, j0), B->cs, nr, dst); \
+        for (musz j = nr; j < NR; j++) dst[j] = 0;                      \
+      }                                                                 \
+    } else {                                                            \
+      /* Column-major: each column of the sliver is the nearer run */   \
+      ct tmp[AX_GEMM_KC];                                               \
+      for (musz j = 0; j < NR; j++) {                                   \
+        if (j < nr) {                                                   \
+          ax__gemm_load_##s(B->dtype, ax__gemm_at(B, p0, j0 + j), B->rs, kc, tmp); \
+          for (musz p = 0; p < kc; p++) bp[p * NR + j] = tmp[p];        \
+        } else {                                                        \
+          for (musz p = 0; p < kc; p++) bp[p * NR + j] = 0;             \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static void ax__gemm_bool_##s(ct* x, musz n) {                        \
+    for (musz i = 0; i < n; i++) x[i] = (ct)(x[i] != 0);                \
+  }                                                                     \
+                                                                        \
+  static void ax__gemm_pack_b_task_##s(void* ctx, musz begin, musz end) { \
+    AxGemmTask* t = (AxGemmTask*)ctx;                                   \
+    enum { NR = AX_GEMM_NR_##s };                                       \
+    for (musz q = begin; q < end; q++) {                                \
+      musz j = q * NR;                                                  \
+      musz nr = (t->nc - j < NR) ? t->nc - j : NR;                      \
+      ct* bp = (ct*)t->bp + q * NR * t->kc;                             \
+      ax__gemm_pack_b_##s(&t->b, t->pc, t->kc, t->jc + j, nr, bp);      \
+      if (t->boolean) ax__gemm_bool_##s(bp, NR * t->kc);                \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Fused epilogue over the mr x nr block of C at (i0, j0) */          \
+  static void ax__gemm_epilogue_##s(const AxGemmEpi* e, const AxGemmOperand* C, \
+                                    musz i0, musz j0, musz mr, musz nr) { \
+    enum { W = AX__GEMM_EPI_CHUNK };                                    \
+    ct v[W], bias[W], res[W];                                           \
+    for (musz jb = 0; jb < nr; jb += W) {                               \
+      musz w = (nr - jb < W) ? nr - jb : W;                             \
+      for (musz i = 0; i < mr; i++) {                                   \
+        ct* c = (ct*)ax__gemm_at(C, i0 + i, j0 + jb);                   \
+        for (musz j = 0; j < w; j++) v[j] = c[j * C->cs];               \
+        if (e->bias.data) {                                             \
+          if (i == 0 || e->bias.rs != 0) {                              \
+            ax__gemm_load_##s(e->bias.dtype, ax__gemm_at(&e->bias, i0 + i, j0 + jb), e->bias.cs, w, bias); \
+          }                                                             \
+          for (musz j = 0; j < w; j++) v[j] += bias[j];                 \
+        }                                                               \
+        switch (e->act) {                                               \
+        case AX_ACT_NONE: break;                                        \
+        case AX_ACT_RELU:                                               \
+          for (musz j = 0; j < w; j++) v[j] = v[j] > 0 ? v[j] : 0;      \
+          break;                                                        \
+        case AX_ACT_GELU:                                               \
+          for (musz j = 0; j < w; j++) v[j] = (ct)(0.5 * v[j] * (1.0 + erf(0.7071067811865476 * v[j]))); \
+          break;                                                        \
+        case AX_ACT_SIGMOID:                                            \
+          for (musz j = 0; j < w; j++) v[j] = (ct)(1.0 / (1.0 + exp(-(double)v[j]))); \
+          break;                                                        \
+        case AX_ACT_TANH:                                               \
+          for (musz j = 0; j < w; j++) v[j] = (ct)tanh((double)v[j]);   \
+          break;                                                        \
+        }                                                               \
+        if (e->residual.data) {                                         \
+          ax__gemm_load_##s(e->residual.dtype, ax__gemm_at(&e->residual, i0 + i, j0 + jb), e->residual.cs, w, res); \
+          for (musz j = 0; j < w; j++) v[j] += res[j];                  \
+        }                                                               \
+        for (musz j = 0; j < w; j++) c[j * C->cs] = v[j];               \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  AX__SEMIRING_LIST_WITH(AX__DEFINE_GEMM_SR, T, s, ct)
+
+// The micro-kernel, the store of one register tile, and the parallel
+// driver of one semiring and compute type
+#define AX__DEFINE_GEMM_SR(SRT, sr, T, s, ct)                           \
+  AX__DEFINE_GEMM_MICRO(SRT, sr, T, s, ct)                              \
+                                                                        \
+  /* c = out(c, acc) for the top-left mr x nr of the tile */            \
+  static void ax__gemm_store_##sr##_##s(const AxGemmOperand* C, musz i0, musz j0, \
+                                        musz mr, musz nr, const ct* acc, \
+                                        ct alpha, ct beta) {            \
+    enum { NR = AX_GEMM_NR_##s };                                       \
+    (void)alpha;                                                        \
+    ct* c = (ct*)ax__gemm_at(C, i0, j0);                                \
+    for (musz i = 0; i < mr; i++) {                                     \
+      ct* ci = c + i * C->rs;                                           \
+      const ct* ai = acc + i * NR;                                      \
+      if (C->cs != 1) {                                                 \
+        for (musz j = 0; j < nr; j++) {                                 \
+          ct* cj = ci + j * C->cs;                                      \
+          *cj = (beta == 0) ? AX__GEMM_FIRST_##sr(ai[j], alpha)         \
+                            : AX__GEMM_OUT_##sr(ct, *cj, ai[j], alpha, beta); \
+        }                                                               \
+      } else if (beta == 0) {                                           \
+        for (musz j = 0; j < nr; j++) ci[j] = AX__GEMM_FIRST_##sr(ai[j], alpha); \
+      } else {                                                          \
+        for (musz j = 0; j < nr; j++) ci[j] = AX__GEMM_OUT_##sr(ct, ci[j], ai[j], alpha, beta); \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* One (row block, column group) pair per index */                    \
+  static void ax__gemm_block_task_##sr##_##s(void* ctx, musz begin, musz end) { \
+    AxGemmTask* t = (AxGemmTask*)ctx;                                   \
+    enum { MR = AX_GEMM_MR_##s, NR = AX_GEMM_NR_##s, MC = AX_GEMM_MC_##s }; \
+    ct* ap = (ct*)ax__gemm_buffer(0, MC * AX_GEMM_KC * sizeof(ct));     \
+    if (!ap) {                                                          \
+      atomic_store(&t->ok, false);                                      \
+      return;                                                           \
+    }                                                                   \
+    ct alpha = (ct)t->alpha;                                            \
+    ct beta = (ct)(t->pc == 0 ? t->beta : 1.0);                         \
+    ct acc[MR * NR];                                                    \
+    musz slivers = (t->nc + NR - 1) / NR;                               \
+    for (musz q = begin; q < end; q++) {                                \
+      musz i0 = (q / t->ngroups) * MC;                                  \
+      musz mc = (t->m - i0 < MC) ? t->m - i0 : MC;                      \
+      musz s0 = (q % t->ngroups) * t->group;                            \
+      musz s1 = (s0 + t->group < slivers) ? s0 + t->group : slivers;    \
+      ax__gemm_pack_a_##s(&t->a, i0, mc, t->pc, t->kc, ap);             \
+      if (t->boolean) ax__gemm_bool_##s(ap, (mc + MR - 1) / MR * MR * t->kc); \
+      for (musz sq = s0; sq < s1; sq++) {                               \
+        musz j = sq * NR;                                               \
+        musz nr = (t->nc - j < NR) ? t->nc - j : NR;                    \
+        const ct* bp = (const ct*)t->bp + sq * NR * t->kc;              \
+        for (musz ir = 0; ir < mc; ir += MR) {                          \
+          musz mr = (mc - ir < MR) ? mc - ir : MR;                      \
+          ax__gemm_micro_##sr##_##s(t->kc, ap + ir * t->kc, bp, acc);   \
+          ax__gemm_store_##sr##_##s(&t->c, i0 + ir, t->jc + j, mr, nr, acc, alpha, beta); \
+          if (t->epi.on && t->pc + t->kc == t->k) {                     \
+            ax__gemm_epilogue_##s(&t->epi, &t->c, i0 + ir, t->jc + j, mr, nr); \
+          }                                                             \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static bool ax__gemm_run_##sr##_##s(AxGemmTask* t) {                  \
+    enum { NR = AX_GEMM_NR_##s, MC = AX_GEMM_MC_##s };                  \
+    musz nc_max = t->n < AX_GEMM_NC ? t->n : AX_GEMM_NC;                \
+    musz kc_max = t->k < AX_GEMM_KC ? t->k : AX_GEMM_KC;                \
+    t->bp = ax__gemm_buffer(1, ((nc_max + NR - 1) / NR) * NR * kc_max * sizeof(ct)); \
+    if (!t->bp) return false;                                           \
+    t->nblocks = (t->m + MC - 1) / MC;                                  \
+    musz threads = ax_thread_count();                                   \
+    for (t->jc = 0; t->jc < t->n; t->jc += AX_GEMM_NC) {                \
+      t->nc = (t->n - t->jc < AX_GEMM_NC) ? t->n - t->jc : AX_GEMM_NC;  \
+      /* Split the panel into column groups when there are too few row  \
+         blocks to keep every thread busy */                            \
+      musz slivers = (t->nc + NR - 1) / NR;                             \
+      musz want = (2 * threads + t->nblocks - 1) / t->nblocks;          \
+      if (want > slivers) want = slivers;                               \
+      if (want < 1) want = 1;                                           \
+      t->group = (slivers + want - 1) / want;                           \
+      t->ngroups = (slivers + t->group - 1) / t->group;                 \
+      for (t->pc = 0; t->pc < t->k; t->pc += AX_GEMM_KC) {              \
+        t->kc = (t->k - t->pc < AX_GEMM_KC) ? t->k - t->pc : AX_GEMM_KC; \
+        ax_parallel_for(slivers, 16, ax__gemm_pack_b_task_##s, t);      \
+        ax_parallel_for(t->nblocks * t->ngroups, 1, ax__gemm_block_task_##sr##_##s, t); \
+        if (!atomic_load(&t->ok)) return false;                         \
+      }                                                                 \
+    }                                                                   \
+    return true;                                                        \
+  }
+
+AX__GEMM_TYPES(AX__DEFINE_GEMM)
+
+// Compute type of a floating-point dtype
+static bool ax__gemm_compute_dtype(AxDType dtype, AxDType* compute) {
+  switch (dtype) {
+  case AX_F32:
+  case AX_F16:
+  case AX_BF16:
+    *compute = AX_F32;
+    return true;
+  case AX_F64:
+    *compute = AX_F64;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static AxGemmOperand ax__gemm_operand(const AxMatrix* m, AxTranspose trans) {
+  AxGemmOperand op = { m->data, m->dtype, m->stride, m->col_stride };
+  if (trans == AX_TRANS) {
+    op.rs = m->col_stride;
+    op.cs = m->stride;
+  }
+  return op;
+}
+
+// The same storage read as its transpose
+static inline AxGemmOperand ax__gemm_flip(const AxGemmOperand* op) {
+  AxGemmOperand t = *op;
+  t.rs = op->cs;
+  t.cs = op->rs;
+  return t;
+}
+
+// Result of a product with no terms: scales the m x n operand `c` by beta
+// (zeroing it when beta == 0) for plus-times; other semirings fill it with
+// their identity unless accumulating
+static void ax__gemm_scale(const AxGemmOperand* c, musz m, musz n, AxSemiring sr, double beta) {
+  if (sr != AX_SEMIRING_PLUS_TIMES && beta != 0) return;
+  double zero = ax_semiring_zero(sr);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      void* p = ax__gemm_at(c, i, j);
+      ax__store_elem(c->dtype, p, beta == 0 ? zero : beta * ax__load_elem(c->dtype, p));
+    }
+  }
+}
+
+// Core entry point: c (m x n) = alpha * a (m x k) * b (k x n) + beta * c,
+// with sum and product taken in `sr` (see ax__gemm_store_*), followed by
+// the epilogue `epi` when given
+static bool ax__gemm_epi(AxSemiring sr, musz m, musz n, musz k, double alpha, const AxGemmOperand* a,
+                         const AxGemmOperand* b, double beta, const AxGemmOperand* c,
+                         const AxGemmEpi* epi) {
+  AxDType ta, tb, tc;
+  if (!ax__gemm_compute_dtype(a->dtype, &ta) || !ax__gemm_compute_dtype(b->dtype, &tb) ||
+      !ax__gemm_compute_dtype(c->dtype, &tc) || ta != tb || tb != tc) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm: unsupported dtypes (%s, %s -> %s)",
+           ax_dtype_name(a->dtype), ax_dtype_name(b->dtype), ax_dtype_name(c->dtype));
+    return false;
+  }
+  if (m == 0 || n == 0) return true;
+  if (m > 1 && n > 1 && c->rs < c->cs) {
+    // Column-major C (e.g. a transposed view): computing C^T = op(B)^T op(A)^T
+    // keeps the register tiles storing along unit-stride runs
+    AxGemmOperand at = ax__gemm_flip(a), bt = ax__gemm_flip(b), ct = ax__gemm_flip(c);
+    AxGemmEpi et;
+    if (epi) {
+      et = *epi;
+      et.bias = ax__gemm_flip(&epi->bias);
+      et.residual = ax__gemm_flip(&epi->residual);
+    }
+    return ax__gemm_epi(sr, n, m, k, alpha, &bt, &at, beta, &ct, epi ? &et : NULL);
+  }
+  bool fused = epi && epi->on;
+  if ((k == 0 || (alpha == 0 && sr == AX_SEMIRING_PLUS_TIMES)) && !(fused && c->dtype != tc)) {
+    ax__gemm_scale(c, m, n, sr, beta);
+    if (fused && tc == AX_F32) ax__gemm_epilogue_f32(epi, c, 0, 0, m, n);
+    if (fused && tc == AX_F64) ax__gemm_epilogue_f64(epi, c, 0, 0, m, n);
+    return true;
+  }
+  if (c->dtype != tc) {
+    // Half-precision result: accumulate every slice of k in an f32
+    // workspace and round once at the end
+    mf32* w = (mf32*) malloc(m * n * sizeof(mf32));
+    if (!w) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm: failed to allocate workspace");
+      return false;
+    }
+    AxGemmOperand ow = { w, AX_F32, n, 1 };
+    if (beta != 0) {
+      for (musz i = 0; i < m; i++) ax__gemm_load_f32(c->dtype, ax__gemm_at(c, i, 0), c->cs, n, w + i * n);
+    }
+    bool ok = ax__gemm_epi(sr, m, n, k, alpha, a, b, beta, &ow, epi);
+    for (musz i = 0; ok && i < m; i++) {
+      if (c->cs == 1) {
+        ax__f32_to_half_n(c->dtype, w + i * n, (mu16*)ax__gemm_at(c, i, 0), n);
+      } else {
+        for (musz j = 0; j < n; j++) ax__store_elem(c->dtype, ax__gemm_at(c, i, j), w[i * n + j]);
+      }
+    }
+    free(w);
+    return ok;
+  }
+  AxGemmTask t = { .a = *a, .b = *b, .c = *c, .m = m, .n = n, .k = k,
+                   .alpha = alpha, .beta = beta, .boolean = (sr == AX_SEMIRING_OR_AND) };
+  if (fused) t.epi = *epi;
+  atomic_init(&t.ok, true);
+  bool ok = false;
+  switch (sr) {
+#define AX__GEMM_SR_CASE(SRT, sr_)                                      \
+    case AX_SEMIRING_##SRT:                                             \
+      ok = (tc == AX_F32) ? ax__gemm_run_##sr_##_f32(&t) : ax__gemm_run_##sr_##_f64(&t); \
+      break;
+    AX_SEMIRING_LIST(AX__GEMM_SR_CASE)
+#undef AX__GEMM_SR_CASE
+  }
+  if (!ok) AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm: failed to allocate packing buffers");
+  return ok;
+}
+
+static bool ax__gemm(AxSemiring sr, musz m, musz n, musz k, double alpha, const AxGemmOperand* a,
+                     const AxGemmOperand* b, double beta, const AxGemmOperand* c) {
+  return ax__gemm_epi(sr, m, n, k, alpha, a, b, beta, c, NULL);
+}
+
+bool ax_matrix_gemm(double alpha, const AxMatrix* a, AxTranspose ta,
+                    const AxMatrix* b, AxTranspose tb, double beta, AxMatrix* c) {
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm: null matrix");
+    return false;
+  }
+  musz m = (ta == AX_TRANS) ? a->cols : a->rows;
+  musz k = (ta == AX_TRANS) ? a->rows : a->cols;
+  musz kb = (tb == AX_TRANS) ? b->cols : b->rows;
+  musz n = (tb == AX_TRANS) ? b->rows : b->cols;
+  if (k != kb || c->rows != m || c->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm: dimension mismatch");
+    return false;
+  }
+  AxGemmOperand oa = ax__gemm_operand(a, ta);
+  AxGemmOperand ob = ax__gemm_operand(b, tb);
+  AxGemmOperand oc = ax__gemm_operand(c, AX_NO_TRANS);
+  return ax__gemm(AX_SEMIRING_PLUS_TIMES, m, n, k, alpha, &oa, &ob, beta, &oc);
+}
+
+bool ax_matrix_gemm_fused(double alpha, const AxMatrix* a, AxTranspose ta,
+                          const AxMatrix* b, AxTranspose tb, double beta, AxMatrix* c,
+                          const AxGemmEpilogue* epilogue) {
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_fused: null matrix");
+    return false;
+  }
+  musz m = (ta == AX_TRANS) ? a->cols : a->rows;
+  musz k = (ta == AX_TRANS) ? a->rows : a->cols;
+  musz kb = (tb == AX_TRANS) ? b->cols : b->rows;
+  musz n = (tb == AX_TRANS) ? b->rows : b->cols;
+  if (k != kb || c->rows != m || c->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_fused: dimension mismatch");
+    return false;
+  }
+  AxGemmEpi epi = { .on = false };
+  if (epilogue) {
+    AxDType tc, tx;
+    if (!ax__gemm_compute_dtype(c->dtype, &tc)) tc = c->dtype; // Reported by the engine
+    const AxMatrix* bias = epilogue->bias;
+    const AxMatrix* res = epilogue->residual;
+    if ((bias && !bias->data) || (res && !res->data)) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_fused: null epilogue matrix");
+      return false;
+    }
+    if ((bias && !((bias->rows == 1 && bias->cols == n) || (bias->rows == m && bias->cols == 1))) ||
+        (res && (res->rows != m || res->cols != n))) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_fused: epilogue dimension mismatch");
+      return false;
+    }
+    if ((bias && (!ax__gemm_compute_dtype(bias->dtype, &tx) || tx != tc)) ||
+        (res && (!ax__gemm_compute_dtype(res->dtype, &tx) || tx != tc))) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_fused: epilogue dtypes do not match %s", ax_dtype_name(c->dtype));
+      return false;
+    }
+    epi.on = bias || res || epilogue->activation != AX_ACT_NONE;
+    epi.act = epilogue->activation;
+    if (bias && bias->rows == 1 && bias->cols == n) {
+      epi.bias = (AxGemmOperand){ bias->data, bias->dtype, 0, bias->col_stride };
+    } else if (bias) {
+      epi.bias = (AxGemmOperand){ bias->data, bias->dtype, bias->stride, 0 };
+    }
+    if (res) epi.residual = ax__gemm_operand(res, AX_NO_TRANS);
+  }
+  AxGemmOperand oa = ax__gemm_operand(a, ta);
+  AxGemmOperand ob = ax__gemm_operand(b, tb);
+  AxGemmOperand oc = ax__gemm_operand(c, AX_NO_TRANS);
+  return ax__gemm_epi(AX_SEMIRING_PLUS_TIMES, m, n, k, alpha, &oa, &ob, beta, &oc, &epi);
+}
+
+bool ax_matrix_semiring_gemm(AxSemiring sr, const AxMatrix* a, AxTranspose ta,
+                             const AxMatrix* b, AxTranspose tb, bool accumulate, AxMatrix* c) {
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_semiring_gemm: null matrix");
+    return false;
+  }
+  musz m = (ta == AX_TRANS) ? a->cols : a->rows;
+  musz k = (ta == AX_TRANS) ? a->rows : a->cols;
+  musz kb = (tb == AX_TRANS) ? b->cols : b->rows;
+  musz n = (tb == AX_TRANS) ? b->rows : b->cols;
+  if (k != kb || c->rows != m || c->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_semiring_gemm: dimension mismatch");
+    return false;
+  }
+  AxGemmOperand oa = ax__gemm_operand(a, ta);
+  AxGemmOperand ob = ax__gemm_operand(b, tb);
+  AxGemmOperand oc = ax__gemm_operand(c, AX_NO_TRANS);
+  return ax__gemm(sr, m, n, k, 1.0, &oa, &ob, accumulate ? 1.0 : 0.0, &oc);
+}
+
+// ---------------------------------------------------------------------------
+// Strassen-Winograd
+// ---------------------------------------------------------------------------
+//
+// The top one or two levels run breadth-first: the 7 (or 49) products are
+// pool tasks, each forming its classical Strassen operand sums in scratch of
+// its own, and C is assembled from the products afterwards. Below that, each
+// task recurses depth-first with the two-temporary Winograd schedule of
+// Boyer, Dumas, Pernet and Zhou (2009): X holds the S sums and P1, Y the T
+// sums, and the remaining products land in the quadrants of C. Every call
+// at one depth has the same shape, so each depth owns one X and one Y.
+
+#define AX_STRASSEN_MIN 16    // Smallest crossover honored
+#define AX_STRASSEN_LEVELS 24 // Depth limit (far beyond any feasible size)
+
+static atomic_size_t ax__strassen_crossover;
+
+void ax_matrix_set_strassen_crossover(musz crossover) {
+  atomic_store_explicit(&ax__strassen_crossover, crossover, memory_order_relaxed);
+}
+
+typedef struct AxStrassenAdd {
+  AxMatrix* d;
+  const AxMatrix* x;
+  const AxMatrix* y;
+  bool subtract;
+} AxStrassenAdd;
+
+#define AX__DEFINE_STRASSEN(T, s, ct)                                   \
+  static void ax__strassen_add_##s(const AxStrassenAdd* t, musz r0, musz r1) { \
+    musz n = t->d->cols;                                                \
+    musz dc = t->d->col_stride, xc = t->x->col_stride, yc = t->y->col_stride; \
+    for (musz i = r0; i < r1; i++) {                                    \
+      ct* d = (ct*)t->d->data + i * t->d->stride;                       \
+      const ct* x = (const ct*)t->x->data + i * t->x->stride;           \
+      const ct* y = (const ct*)t->y->data + i * t->y->stride;           \
+      if (dc != 1 || xc != 1 || yc != 1) {                              \
+        /* Quadrants of strided views */                                \
+        for (musz j = 0; j < n; j++) {                                  \
+          d[j * dc] = t->subtract ? x[j * xc] - y[j * yc] : x[j * xc] + y[j * yc]; \
+        }                                                               \
+      } else if (t->subtract) {                                         \
+        for (musz j = 0; j < n; j++) d[j] = x[j] - y[j];                \
+      } else {                                                          \
+        for (musz j = 0; j < n; j++) d[j] = x[j] + y[j];                \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX__GEMM_TYPES(AX__DEFINE_STRASSEN)
+
+static void ax__strassen_add_task(void* ctx, musz begin, musz end) {
+  const AxStrassenAdd* t = (const AxStrassenAdd*)ctx;
+  if (t->d->dtype == AX_F32) {
+    ax__strassen_add_f32(t, begin, end);
+  } else {
+    ax__strassen_add_f64(t, begin, end);
+  }
+}
+
+// d = x + y or x - y, elementwise (d may be x or y)
+static void ax__strassen_add(AxMatrix d, AxMatrix x, AxMatrix y, bool subtract) {
+  AxStrassenAdd t = { &d, &x, &y, subtract };
+  ax_parallel_for(d.rows, 16384 / d.cols + 1, ax__strassen_add_task, &t);
+}
+
+static inline AxMatrix ax__strassen_view(const AxMatrix* m, musz r0, musz r1, musz c0, musz c1) {
+  return AX_MATRIX_SLICE(*m, AX_RANGE(r0, r1), AX_RANGE(c0, c1));
+}
+
+typedef struct AxStrassen {
+  musz levels;
+  AxMatrix x[AX_STRASSEN_LEVELS]; // mh x max(kh, nh) at each depth
+  AxMatrix y[AX_STRASSEN_LEVELS]; // kh x nh
+} AxStrassen;
+
+// Rows and columns past the me x ke by ke x ne top-left product: the
+// remaining columns of A times rows of B, then the remaining columns and
+// rows of C
+static bool ax__strassen_peel(const AxMatrix* a, const AxMatrix* b, AxMatrix* c, musz me, musz ke,
+                              musz ne) {
+  musz m = a->rows, k = a->cols, n = b->cols;
+  bool ok = true;
+  AxMatrix ce = ax__strassen_view(c, 0, me, 0, ne);
+  if (k > ke) {
+    AxMatrix ak = ax__strassen_view(a, 0, me, ke, k), bk = ax__strassen_view(b, ke, k, 0, ne);
+    ok = ok && ax_matrix_gemm(1.0, &ak, AX_NO_TRANS, &bk, AX_NO_TRANS, 1.0, &ce);
+  }
+  if (n > ne) {
+    AxMatrix ae = ax__strassen_view(a, 0, me, 0, k), bn = ax__strassen_view(b, 0, k, ne, n);
+    AxMatrix cn = ax__strassen_view(c, 0, me, ne, n);
+    ok = ok && ax_matrix_gemm(1.0, &ae, AX_NO_TRANS, &bn, AX_NO_TRANS, 0.0, &cn);
+  }
+  if (m > me) {
+    AxMatrix am = ax__strassen_view(a, me, m, 0, k), cm = ax__strassen_view(c, me, m, 0, n);
+    ok = ok && ax_matrix_gemm(1.0, &am, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, &cm);
+  }
+  return ok;
+}
+
+static bool ax__strassen(const AxMatrix* a, const AxMatrix* b, AxMatrix* c, musz depth,
+                         const AxStrassen* w) {
+  if (depth == w->levels) return ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, c);
+  musz m = a->rows, k = a->cols, n = b->cols;
+  musz mh = m / 2, kh = k / 2, nh = n / 2;
+  AxMatrix a11 = ax__strassen_view(a, 0, mh, 0, kh), a12 = ax__strassen_view(a, 0, mh, kh, 2 * kh);
+  AxMatrix a21 = ax__strassen_view(a, mh, 2 * mh, 0, kh), a22 = ax__strassen_view(a, mh, 2 * mh, kh, 2 * kh);
+  AxMatrix b11 = ax__strassen_view(b, 0, kh, 0, nh), b12 = ax__strassen_view(b, 0, kh, nh, 2 * nh);
+  AxMatrix b21 = ax__strassen_view(b, kh, 2 * kh, 0, nh), b22 = ax__strassen_view(b, kh, 2 * kh, nh, 2 * nh);
+  AxMatrix c11 = ax__strassen_view(c, 0, mh, 0, nh), c12 = ax__strassen_view(c, 0, mh, nh, 2 * nh);
+  AxMatrix c21 = ax__strassen_view(c, mh, 2 * mh, 0, nh), c22 = ax__strassen_view(c, mh, 2 * mh, nh, 2 * nh);
+  AxMatrix x = w->x[depth], y = w->y[depth];
+  x.cols = x.stride = kh;
+  AxMatrix xp = x; // P1 (mh x nh) in the same storage
+  xp.cols = xp.stride = nh;
+  bool ok = true;
+  ax__strassen_add(x, a11, a21, true);                      // S3
+  ax__strassen_add(y, b22, b12, true);                      // T3
+  ok = ok && ax__strassen(&x, &y, &c21, depth + 1, w);      // P7
+  ax__strassen_add(x, a21, a22, false);                     // S1
+  ax__strassen_add(y, b12, b11, true);                      // T1
+  ok = ok && ax__strassen(&x, &y, &c22, depth + 1, w);      // P5
+  ax__strassen_add(x, x, a11, true);                        // S2
+  ax__strassen_add(y, b22, y, true);                        // T2
+  ok = ok && ax__strassen(&x, &y, &c12, depth + 1, w);      // P6
+  ax__strassen_add(x, a12, x, true);                        // S4
+  ok = ok && ax__strassen(&x, &b22, &c11, depth + 1, w);    // P3
+  ok = ok && ax__strassen(&a11, &b11, &xp, depth + 1, w);   // P1
+  ax__strassen_add(c12, xp, c12, false);                    // U2 = P1 + P6
+  ax__strassen_add(c21, c12, c21, false);                   // U3 = U2 + P7
+  ax__strassen_add(c12, c12, c22, false);                   // U4 = U2 + P5
+  ax__strassen_add(c22, c21, c22, false);                   // U7 = U3 + P5
+  ax__strassen_add(c12, c12, c11, false);                   // U5 = U4 + P3
+  ax__strassen_add(y, y, b21, true);                        // T4 = T2 - B21
+  ok = ok && ax__strassen(&a22, &y, &c11, depth + 1, w);    // P4
+  ax__strassen_add(c21, c21, c11, true);                    // U6 = U3 - P4
+  ok = ok && ax__strassen(&a12, &b21, &c11, depth + 1, w);  // P2
+  ax__strassen_add(c11, xp, c11, false);                    // U1 = P1 + P2
+  return ok && ax__strassen_peel(a, b, c, 2 * mh, 2 * kh, 2 * nh);
+}
+
+// Classical Strassen coefficients of the breadth-first levels, quadrants in
+// the order 11, 12, 21, 22: product p is (sum_q SA[p][q] A_q) (sum_q SB[p][q]
+// B_q), and quadrant q of C is sum_p SC[p][q] M_p. Every sum has a +1 term
+// to start from.
+static const signed char ax__strassen_sa[7][4] = {
+  { 1, 0, 0, 1 }, { 0, 0, 1, 1 }, { 1, 0, 0, 0 }, { 0, 0, 0, 1 },
+  { 1, 1, 0, 0 }, { -1, 0, 1, 0 }, { 0, 1, 0, -1 },
+};
+static const signed char ax__strassen_sb[7][4] = {
+  { 1, 0, 0, 1 }, { 1, 0, 0, 0 }, { 0, 1, 0, -1 }, { -1, 0, 1, 0 },
+  { 0, 0, 0, 1 }, { 1, 1, 0, 0 }, { 0, 0, 1, 1 },
+};
+static const signed char ax__strassen_sc[7][4] = {
+  { 1, 0, 0, 1 }, { 0, 0, 1, -1 }, { 0, 1, 0, 1 }, { 1, 0, 1, 0 },
+  { -1, 1, 0, 0 }, { 0, 0, 0, 1 }, { 1, 0, 0, 0 },
+};
+
+// Coefficient of block `quad` in product `job` over `par` levels: base-7
+// and base-4 digits, least significant at the deepest level
+static int ax__strassen_coef(const signed char (*tab)[4], musz job, musz quad, musz par) {
+  int coef = 1;
+  for (musz l = 0; l < par; l++, job /= 7, quad /= 4) coef *= tab[job % 7][quad % 4];
+  return coef;
+}
+
+// Block `quad` of x, split `par` times (x's dimensions divide by 2^par)
+static AxMatrix ax__strassen_block(const AxMatrix* x, musz quad, musz par) {
+  musz r = 0, c = 0;
+  for (musz l = par; l > 0; l--, quad /= 4) {
+    r += (quad % 4 / 2) * (x->rows >> l);
+    c += (quad % 4 % 2) * (x->cols >> l);
+  }
+  return ax__strassen_view(x, r, r + (x->rows >> par), c, c + (x->cols >> par));
+}
+
+// Operand of product `job`: a view when it is a single block, otherwise the
+// signed sum of its blocks in d
+static AxMatrix ax__strassen_operand(const AxMatrix* x, const signed char (*tab)[4], musz job,
+                                     musz par, AxMatrix d) {
+  musz quads = (musz)1 << (2 * par), first = quads, terms = 0;
+  for (musz q = 0; q < quads; q++) {
+    int coef = ax__strassen_coef(tab, job, q, par);
+    terms += (coef != 0);
+    if (coef == 1 && first == quads) first = q;
+  }
+  AxMatrix f = ax__strassen_block(x, first, par);
+  if (terms == 1) return f;
+  ax_matrix_copy(&d, &f);
+  for (musz q = 0; q < quads; q++) {
+    int coef = ax__strassen_coef(tab, job, q, par);
+    if (q != first && coef != 0) ax__strassen_add(d, d, ax__strassen_block(x, q, par), coef < 0);
+  }
+  return d;
+}
+
+typedef struct AxStrassenBfs {
+  const AxMatrix* a; // Even top-left parts of the operands
+  const AxMatrix* b;
+  musz par;          // Breadth-first levels
+  musz jobs;         // 7^par products
+  AxMatrix* m;       // Result of each product
+  AxMatrix* s;       // Per slot: A operand sum
+  AxMatrix* t;       // Per slot: B operand sum
+  AxStrassen* w;     // Per slot: depth-first temporaries below `par`
+  atomic_size_t next;
+  atomic_bool ok;
+} AxStrassenBfs;
+
+// Each slot owns one set of scratch and pulls products until none are left
+static void ax__strassen_bfs_task(void* ctx, musz begin, musz end) {
+  AxStrassenBfs* t = (AxStrassenBfs*)ctx;
+  for (musz slot = begin; slot < end; slot++) {
+    for (;;) {
+      musz job = atomic_fetch_add(&t->next, 1);
+      if (job >= t->jobs) break;
+      AxMatrix sa = ax__strassen_operand(t->a, ax__strassen_sa, job, t->par, t->s[slot]);
+      AxMatrix sb = ax__strassen_operand(t->b, ax__strassen_sb, job, t->par, t->t[slot]);
+      if (!ax__strassen(&sa, &sb, &t->m[job], t->par, &t->w[slot])) atomic_store(&t->ok, false);
+    }
+  }
+}
+
+// Breadth-first top `par` levels over `slots` sets of scratch, then the
+// depth-first recursion inside each product. The breadth-first part covers
+// dimensions rounded down to multiples of 2^par; the rest is peeled after.
+static bool ax__strassen_bfs(const AxMatrix* a, const AxMatrix* b, AxMatrix* c, const AxStrassen* w,
+                             musz par, musz slots, Arena* arena) {
+  musz mask = ~(((musz)1 << par) - 1);
+  musz me = a->rows & mask, ke = a->cols & mask, ne = b->cols & mask;
+  AxMatrix ae = ax__strassen_view(a, 0, me, 0, ke), be = ax__strassen_view(b, 0, ke, 0, ne);
+  AxMatrix ce = ax__strassen_view(c, 0, me, 0, ne);
+  musz jobs = par == 1 ? 7 : 49, mp = ae.rows >> par, kp = ae.cols >> par, np = be.cols >> par;
+  musz esz = ax_dtype_size(a->dtype);
+  AxMatrix* m = (AxMatrix*)ax_alloc(arena, jobs * sizeof(AxMatrix));
+  AxMatrix* s = (AxMatrix*)ax_alloc(arena, slots * sizeof(AxMatrix));
+  AxMatrix* t = (AxMatrix*)ax_alloc(arena, slots * sizeof(AxMatrix));
+  AxStrassen* sw = (AxStrassen*)ax_alloc(arena, slots * sizeof(AxStrassen));
+  bool ok = m && s && t && sw;
+  for (musz j = 0; ok && j < jobs; j++) {
+    m[j] = (AxMatrix){ mp, np, np, 1, ax_alloc(arena, mp * np * esz), a->dtype, false };
+    ok = m[j].data != NULL;
+  }
+  for (musz i = 0; ok && i < slots; i++) {
+    s[i] = (AxMatrix){ mp, kp, kp, 1, ax_alloc(arena, mp * kp * esz), a->dtype, false };
+    t[i] = (AxMatrix){ kp, np, np, 1, ax_alloc(arena, kp * np * esz), a->dtype, false };
+    sw[i] = *w;
+    ok = s[i].data && t[i].data;
+    for (musz d = par; ok && d < w->levels; d++) {
+      sw[i].x[d].data = ax_alloc(arena, w->x[d].rows * w->x[d].cols * esz);
+      sw[i].y[d].data = ax_alloc(arena, w->y[d].rows * w->y[d].cols * esz);
+      ok = sw[i].x[d].data && sw[i].y[d].data;
+    }
+  }
+  if (!ok) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strassen: failed to allocate scratch");
+    return false;
+  }
+  AxStrassenBfs task = { .a = &ae, .b = &be, .par = par, .jobs = jobs, .m = m, .s = s, .t = t, .w = sw };
+  atomic_init(&task.next, 0);
+  atomic_init(&task.ok, true);
+  ax_parallel_for(slots, 1, ax__strassen_bfs_task, &task);
+  if (!atomic_load(&task.ok)) return false;
+
+  // Each block of C starts from a +1 product and adds the others
+  musz quads = (musz)1 << (2 * par);
+  for (musz q = 0; q < quads; q++) {
+    AxMatrix cq = ax__strassen_block(&ce, q, par);
+    musz first = 0;
+    while (ax__strassen_coef(ax__strassen_sc, first, q, par) != 1) first++;
+    ax_matrix_copy(&cq, &m[first]);
+    for (musz j = 0; j < jobs; j++) {
+      int coef = ax__strassen_coef(ax__strassen_sc, j, q, par);
+      if (j != first && coef != 0) ax__strassen_add(cq, cq, m[j], coef < 0);
+    }
+  }
+  return ax__strassen_peel(a, b, c, me, ke, ne);
+}
+
+bool ax_matrix_gemm_strassen(const AxMatrix* a, const AxMatrix* b, AxMatrix* c,
+                             musz crossover, Arena* scratch) {
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strassen: null matrix");
+    return false;
+  }
+  if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strassen: dimension mismatch");
+    return false;
+  }
+  if (a->dtype != b->dtype || a->dtype != c->dtype || (a->dtype != AX_F32 && a->dtype != AX_F64)) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strassen: unsupported dtypes (%s, %s -> %s)",
+           ax_dtype_name(a->dtype), ax_dtype_name(b->dtype), ax_dtype_name(c->dtype));
+    return false;
+  }
+  if (crossover == 0) crossover = AX_STRASSEN_CROSSOVER;
+  if (crossover < AX_STRASSEN_MIN) crossover = AX_STRASSEN_MIN;
+  AxStrassen w = { 0 };
+  musz m = a->rows, k = a->cols, n = b->cols, esz = ax_dtype_size(a->dtype), bytes = 0;
+  while (w.levels < AX_STRASSEN_LEVELS && m >= crossover && k >= crossover && n >= crossover) {
+    m /= 2;
+    k /= 2;
+    n /= 2;
+    w.x[w.levels] = (AxMatrix){ m, k > n ? k : n, 0, 1, NULL, a->dtype, false };
+    w.y[w.levels] = (AxMatrix){ k, n, n, 1, NULL, a->dtype, false };
+    bytes += (m * (k > n ? k : n) + k * n) * esz + 128;
+    w.levels++;
+  }
+  if (w.levels == 0) return ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, c);
+  // One breadth-first level feeds up to 7 threads, two up to 49. Products
+  // inside a task run serially, so when they cannot keep at least half the
+  // pool busy the classical GEMM is faster
+  musz threads = ax_thread_count(), par = 0, slots = 0;
+  if (threads > 1) {
+    par = (threads > 7 && w.levels >= 2) ? 2 : 1;
+    musz jobs = par == 1 ? 7 : 49;
+    if (2 * jobs < threads) return ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, c);
+    slots = threads < jobs ? threads : jobs;
+    musz mp = w.x[par - 1].rows, kp = w.y[par - 1].rows, np = w.y[par - 1].cols, deep = 0;
+    for (musz d = par; d < w.levels; d++) deep += (w.x[d].rows * w.x[d].cols + w.y[d].rows * w.y[d].cols) * esz + 128;
+    bytes = jobs * (mp * np * esz + sizeof(AxMatrix) + 64) +
+            slots * ((mp * kp + kp * np) * esz + deep + 2 * sizeof(AxMatrix) + sizeof(AxStrassen) + 256);
+  }
+  Arena* own = scratch ? NULL : ax_arena_create(bytes);
+  Arena* arena = scratch ? scratch : own;
+  if (!arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strassen: failed to allocate scratch");
+    return false;
+  }
+  bool ok = true;
+  if (par > 0) {
+    ok = ax__strassen_bfs(a, b, c, &w, par, slots, arena);
+  } else {
+    for (musz d = 0; ok && d < w.levels; d++) {
+      w.x[d].data = ax_alloc(arena, w.x[d].rows * w.x[d].cols * esz);
+      w.y[d].data = ax_alloc(arena, w.y[d].rows * w.y[d].cols * esz);
+      ok = w.x[d].data && w.y[d].data;
+    }
+    if (!ok) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strassen: failed to allocate scratch");
+    } else {
+      ok = ax__strassen(a, b, c, 0, &w);
+    }
+  }
+  if (own) ax_arena_destroy(own);
+  return ok;
+}
+
+AxMatrix* ax_matrix_multiply(const AxMatrix* a, const AxMatrix* b, Arena* arena) {
+  if (!a || !b) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_multiply: null matrix");
+  }
+  if (a->cols != b->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_multiply: dimension mismatch");
+  }
+  if (!ax__same_dtype("ax_matrix_multiply", a, b)) return NULL;
+  musz m = a->rows;
+  musz n = a->cols;
+  musz p = b->cols;
+  AxMatrix* result = ax_matrix_create_dtype(m, p, a->dtype, arena);
+  if (!result) return NULL;
+  AxDType compute;
+  musz cross = atomic_load_explicit(&ax__strassen_crossover, memory_order_relaxed);
+  if (cross && (a->dtype == AX_F32 || a->dtype == AX_F64) && m >= cross && n >= cross && p >= cross) {
+    if (!ax_matrix_gemm_strassen(a, b, result, cross, NULL)) return NULL;
+    return result;
+  }
+  if (ax__gemm_compute_dtype(a->dtype, &compute)) {
+    if (!ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, result)) return NULL;
+    return result;
+  }
+  // The integer kernel streams rows of `b`, so strided views of it are staged
+  AxMatrix bs;
+  const AxMatrix* bu = ax__unit_stage(b, &bs, true);
+  if (!bu) return NULL;
+  AxMatmulTask t = { a, bu, result };
+  ax_parallel_for(m, 65536 / (n * p + 1) + 1, ax__matmul_task, &t);
+  ax__unit_release(&bs, NULL);
+  return result;
+}
+
+// Batched GEMM. Problems of one shape run the plus-times engine in
+// lockstep: for every panel and slice of k, B is packed for a wave of
+// problems into one shared buffer, then the row blocks of the whole wave are
+// spread over the pool together.
+
+#define AX_GEMM_BATCH_BYTES (1u << 20) // Packed B of one wave (grown to feed every thread)
+
+typedef struct AxGemmBatchTask {
+  AxGemmTask* items;
+  musz per; // Tasks of each problem
+} AxGemmBatchTask;
+
+// Runs fn over flat indices [begin, end), split at problem boundaries
+static void ax__gemm_batch_split(const AxGemmBatchTask* bt, musz begin, musz end, AxTaskFn fn) {
+  while (begin < end) {
+    musz i = begin / bt->per;
+    musz stop = ((i + 1) * bt->per < end) ? (i + 1) * bt->per : end;
+    fn(&bt->items[i], begin - i * bt->per, stop - i * bt->per);
+    begin = stop;
+  }
+}
+
+#define AX__DEFINE_GEMM_BATCH(T, s, ct)                                 \
+  static void ax__gemm_batch_pack_task_##s(void* ctx, musz begin, musz end) { \
+    ax__gemm_batch_split((const AxGemmBatchTask*)ctx, begin, end, ax__gemm_pack_b_task_##s); \
+  }                                                                     \
+                                                                        \
+  static void ax__gemm_batch_block_task_##s(void* ctx, musz begin, musz end) { \
+    ax__gemm_batch_split((const AxGemmBatchTask*)ctx, begin, end, ax__gemm_block_task_plus_times_##s); \
+  }                                                                     \
+                                                                        \
+  /* items[0..count) share m, n and k; their bp, schedule and position  \
+     fields are filled in here */                                       \
+  static bool ax__gemm_batch_run_##s(AxGemmTask* items, musz count, void* bp, musz bp_item) { \
+    enum { NR = AX_GEMM_NR_##s, MC = AX_GEMM_MC_##s };                  \
+    AxGemmTask* t0 = &items[0];                                         \
+    musz nblocks = (t0->m + MC - 1) / MC;                               \
+    musz threads = ax_thread_count();                                   \
+    for (musz jc = 0; jc < t0->n; jc += AX_GEMM_NC) {                   \
+      musz nc = (t0->n - jc < AX_GEMM_NC) ? t0->n - jc : AX_GEMM_NC;    \
+      musz slivers = (nc + NR - 1) / NR;                                \
+      musz want = (2 * threads + nblocks * count - 1) / (nblocks * count); \
+      if (want > slivers) want = slivers;                               \
+      if (want < 1) want = 1;                                           \
+      musz group = (slivers + want - 1) / want;                         \
+      musz ngroups = (slivers + group - 1) / group;                     \
+      for (musz pc = 0; pc < t0->k; pc += AX_GEMM_KC) {                 \
+        musz kc = (t0->k - pc < AX_GEMM_KC) ? t0->k - pc : AX_GEMM_KC;  \
+        for (musz i = 0; i < count; i++) {                              \
+          AxGemmTask* t = &items[i];                                    \
+          t->bp = (ct*)bp + i * bp_item;                                \
+          t->nblocks = nblocks;                                         \
+          t->jc = jc;                                                   \
+          t->nc = nc;                                                   \
+          t->pc = pc;                                                   \
+          t->kc = kc;                                                   \
+          t->group = group;                                             \
+          t->ngroups = ngroups;                                         \
+        }                                                               \
+        AxGemmBatchTask bt = { items, slivers };                        \
+        ax_parallel_for(count * slivers, 16, ax__gemm_batch_pack_task_##s, &bt); \
+        bt.per = nblocks * ngroups;                                     \
+        ax_parallel_for(count * bt.per, 1, ax__gemm_batch_block_task_##s, &bt); \
+        for (musz i = 0; i < count; i++) {                              \
+          if (!atomic_load(&items[i].ok)) return false;                 \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    return true;                                                        \
+  }
+
+AX__GEMM_TYPES(AX__DEFINE_GEMM_BATCH)
+
+// Problem i of a batch, from an array of matrices or a strided stack
+typedef struct AxGemmBatchSource {
+  const AxMatrix* const* pa;
+  const AxMatrix* const* pb;
+  AxMatrix* const* pc;
+  const AxMatrixBatch* sa;
+  const AxMatrixBatch* sb;
+  const AxMatrixBatch* sc;
+  AxTranspose ta;
+  AxTranspose tb;
+} AxGemmBatchSource;
+
+static AxGemmOperand ax__gemm_batch_operand(const AxMatrixBatch* x, musz i, AxTranspose trans) {
+  AxGemmOperand op = { (mu8*)x->data + i * x->batch_stride * ax_dtype_size(x->dtype), x->dtype,
+                       x->stride, x->col_stride };
+  if (trans == AX_TRANS) {
+    op.rs = x->col_stride;
+    op.cs = x->stride;
+  }
+  return op;
+}
+
+static void ax__gemm_batch_get(const AxGemmBatchSource* src, musz i, AxGemmOperand* a,
+                               AxGemmOperand* b, AxGemmOperand* c) {
+  if (src->pa) {
+    *a = ax__gemm_operand(src->pa[i], src->ta);
+    *b = ax__gemm_operand(src->pb[i], src->tb);
+    *c = ax__gemm_operand(src->pc[i], AX_NO_TRANS);
+  } else {
+    *a = ax__gemm_batch_operand(src->sa, i, src->ta);
+    *b = ax__gemm_batch_operand(src->sb, i, src->tb);
+    *c = ax__gemm_batch_operand(src->sc, i, AX_NO_TRANS);
+  }
+}
+
+static bool ax__gemm_batch(const AxGemmBatchSource* src, musz count, musz m, musz n, musz k,
+                           double alpha, double beta) {
+  AxGemmOperand a, b, c;
+  ax__gemm_batch_get(src, 0, &a, &b, &c);
+  AxDType ta, tb, tc;
+  bool lockstep = ax__gemm_compute_dtype(a.dtype, &ta) && ax__gemm_compute_dtype(b.dtype, &tb) &&
+                  ax__gemm_compute_dtype(c.dtype, &tc) && ta == tb && tb == tc && c.dtype == tc &&
+                  m > 0 && n > 0 && k > 0 && alpha != 0;
+  for (musz i = 0; lockstep && i < count; i++) {
+    ax__gemm_batch_get(src, i, &a, &b, &c);
+    lockstep = (c.cs == 1);
+  }
+  if (!lockstep || count == 1) {
+    // Edge cases, half-precision results and C with strided columns (which
+    // the single product may flip to column-major) take the single-product path
+    for (musz i = 0; i < count; i++) {
+      ax__gemm_batch_get(src, i, &a, &b, &c);
+      if (!ax__gemm(AX_SEMIRING_PLUS_TIMES, m, n, k, alpha, &a, &b, beta, &c)) return false;
+    }
+    return true;
+  }
+  musz esz = ax_dtype_size(tc);
+  musz nr = (tc == AX_F32) ? AX_GEMM_NR_f32 : AX_GEMM_NR_f64;
+  musz nc_max = n < AX_GEMM_NC ? n : AX_GEMM_NC;
+  musz kc_max = k < AX_GEMM_KC ? k : AX_GEMM_KC;
+  musz bp_item = (nc_max + nr - 1) / nr * nr * kc_max;
+  musz mc = (tc == AX_F32) ? AX_GEMM_MC_f32 : AX_GEMM_MC_f64;
+  musz feed = (2 * ax_thread_count() + (m + mc - 1) / mc - 1) / ((m + mc - 1) / mc);
+  musz wave = AX_GEMM_BATCH_BYTES / (bp_item * esz);
+  if (wave < feed) wave = feed;
+  if (wave > count) wave = count;
+  AxGemmTask* items = (AxGemmTask*) malloc(wave * sizeof(AxGemmTask));
+  void* bp = ax__gemm_buffer(1, wave * bp_item * esz);
+  if (!items || !bp) {
+    free(items);
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_batched: failed to allocate packing buffers");
+    return false;
+  }
+  bool ok = true;
+  for (musz w0 = 0; ok && w0 < count; w0 += wave) {
+    musz wn = (count - w0 < wave) ? count - w0 : wave;
+    for (musz i = 0; i < wn; i++) {
+      ax__gemm_batch_get(src, w0 + i, &a, &b, &c);
+      items[i] = (AxGemmTask){ .a = a, .b = b, .c = c, .m = m, .n = n, .k = k,
+                               .alpha = alpha, .beta = beta, .boolean = false };
+      atomic_init(&items[i].ok, true);
+    }
+    ok = (tc == AX_F32) ? ax__gemm_batch_run_f32(items, wn, bp, bp_item)
+                        : ax__gemm_batch_run_f64(items, wn, bp, bp_item);
+  }
+  free(items);
+  if (!ok) AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_batched: failed to allocate packing buffers");
+  return ok;
+}
+
+bool ax_matrix_gemm_batched(double alpha, const AxMatrix* const* a, AxTranspose ta,
+                            const AxMatrix* const* b, AxTranspose tb, double beta,
+                            AxMatrix* const* c, musz count) {
+  if (count == 0) return true;
+  if (!a || !b || !c) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_batched: null matrix array");
+    return false;
+  }
+  musz m = 0, n = 0, k = 0;
+  for (musz i = 0; i < count; i++) {
+    if (!a[i] || !b[i] || !c[i] || !a[i]->data || !b[i]->data || !c[i]->data) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_batched: null matrix");
+      return false;
+    }
+    musz mi = (ta == AX_TRANS) ? a[i]->cols : a[i]->rows;
+    musz ki = (ta == AX_TRANS) ? a[i]->rows : a[i]->cols;
+    musz kb = (tb == AX_TRANS) ? b[i]->cols : b[i]->rows;
+    musz ni = (tb == AX_TRANS) ? b[i]->rows : b[i]->cols;
+    if (i == 0) {
+      m = mi;
+      n = ni;
+      k = ki;
+    }
+    if (ki != kb || mi != m || ni != n || ki != k || c[i]->rows != m || c[i]->cols != n) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_batched: dimension mismatch");
+      return false;
+    }
+    if (a[i]->dtype != a[0]->dtype || b[i]->dtype != b[0]->dtype || c[i]->dtype != c[0]->dtype) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_batched: mixed dtypes across the batch");
+      return false;
+    }
+  }
+  AxGemmBatchSource src = { .pa = a, .pb = b, .pc = c, .ta = ta, .tb = tb };
+  return ax__gemm_batch(&src, count, m, n, k, alpha, beta);
+}
+
+bool ax_matrix_gemm_strided_batched(double alpha, const AxMatrixBatch* a, AxTranspose ta,
+                                    const AxMatrixBatch* b, AxTranspose tb, double beta,
+                                    AxMatrixBatch* c) {
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strided_batched: null batch");
+    return false;
+  }
+  musz m = (ta == AX_TRANS) ? a->cols : a->rows;
+  musz k = (ta == AX_TRANS) ? a->rows : a->cols;
+  musz kb = (tb == AX_TRANS) ? b->cols : b->rows;
+  musz n = (tb == AX_TRANS) ? b->rows : b->cols;
+  if (a->count != b->count || a->count != c->count || k != kb || c->rows != m || c->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_strided_batched: dimension mismatch");
+    return false;
+  }
+  if (c->count == 0) return true;
+  AxGemmBatchSource src = { .sa = a, .sb = b, .sc = c, .ta = ta, .tb = tb };
+  return ax__gemm_batch(&src, c->count, m, n, k, alpha, beta);
+}
+
+// ---------------------------------------------------------------------------
+// Vectors
+// ---------------------------------------------------------------------------
+//
+// Strided operands that a kernel streams more than once are gathered into
+// contiguous scratch first, so the inner loops always run on unit stride.
+
+#define AX_VECTOR_CHUNK 65536 // Elements per parallel task and per partial sum
+#define AX_GEMV_TCOLS 2048    // Columns of y kept hot by the transposed kernel
+
+bool ax_vector_init(AxVector* v, musz len, AxDType dtype, Arena* arena) {
+  if (!v || len == 0) {
+    AX_LOG(AX_LOG_FATAL, "ax_vector_init: invalid arguments");
+    return false;
+  }
+  musz size = len * ax_dtype_size(dtype);
+  if (arena) {
+    v->data = ax_alloc(arena, size);
+  } else {
+    AX_LOG(AX_LOG_INFO, "Arena is NULL, using malloc");
+    AX_LOG(AX_LOG_WARN, "DO NOT FORGET TO CALL ax_vector_destroy");
+    v->data = malloc(size);
+  }
+  if (!v->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_vector_init: failed to allocate data");
+    return false;
+  }
+  v->len = len;
+  v->inc = 1;
+  v->dtype = dtype;
+  v->data_owner = (arena == NULL);
+  return true;
+}
+
+void ax_vector_destroy(AxVector* v) {
+  if (!v) return;
+  if (v->data_owner) {
+    free(v->data);
+  }
+  v->data = NULL;
+  v->len = 0;
+}
+
+static inline void* ax__vector_at(const AxVector* v, musz i) {
+  return (mu8*)v->data + i * v->inc * ax_dtype_size(v->dtype);
+}
+
+double ax_vector_get(const AxVector* v, musz i) {
+  return ax__load_elem(v->dtype, ax__vector_at(v, i));
+}
+
+void ax_vector_set(AxVector* v, musz i, double value) {
+  ax__store_elem(v->dtype, ax__vector_at(v, i), value);
+}
+
+static bool ax__vector_valid(const char* name, const AxVector* v) {
+  if (!v || !v->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null vector", name);
+    return false;
+  }
+  if (v->dtype != AX_F32 && v->dtype != AX_F64) {
+    AX_LOG(AX_LOG_FATAL, "%s: unsupported dtype %s", name, ax_dtype_name(v->dtype));
+    return false;
+  }
+  return true;
+}
+
+static bool ax__vector_pair(const char* name, const AxVector* x, const AxVector* y) {
+  if (!ax__vector_valid(name, x) || !ax__vector_valid(name, y)) return false;
+  if (x->len != y->len) {
+    AX_LOG(AX_LOG_FATAL, "%s: length mismatch (%zu vs %zu)", name, (size_t)x->len, (size_t)y->len);
+    return false;
+  }
+  if (x->dtype != y->dtype) {
+    AX_LOG(AX_LOG_FATAL, "%s: dtype mismatch (%s vs %s)", name,
+           ax_dtype_name(x->dtype), ax_dtype_name(y->dtype));
+    return false;
+  }
+  return true;
+}
+
+typedef struct AxVectorTask {
+  const AxVector* x;
+  const AxVector* y;
+  const AxMatrix* a;
+  double alpha;
+  double beta;
+  double scale;    // nrm2: terms are (x * scale)^2
+  double* partial; // One slot per chunk
+  const void* xc;  // Contiguous operands of the level-2 kernels
+  void* yc;
+} AxVectorTask;
+
+#define AX__DEFINE_VECTOR(T, s, ct)                                     \
+  static inline ct ax__vsum_##s(ax__vec_##s v) {                        \
+    ct tmp[AX__VLEN_##s], r = 0;                                        \
+    AX__VSTORE_##s(tmp, v);                                             \
+    for (int l = 0; l < AX__VLEN_##s; l++) r += tmp[l];                 \
+    return r;                                                           \
+  }                                                                     \
+                                                                        \
+  /* Copies n elements `inc` apart to or from unit stride */            \
+  static void ax__vgather_##s(const ct* src, musz inc, musz n, ct alpha, ct* dst) { \
+    for (musz i = 0; i < n; i++) dst[i] = alpha * src[i * inc];         \
+  }                                                                     \
+                                                                        \
+  static void ax__axpy_task_##s(void* ctx, musz begin, musz end) {      \
+    const AxVectorTask* t = (const AxVectorTask*)ctx;                   \
+    const ct* x = (const ct*)t->x->data;                                \
+    ct* y = (ct*)t->y->data;                                            \
+    ct alpha = (ct)t->alpha;                                            \
+    musz ix = t->x->inc, iy = t->y->inc;                                \
+    if (ix == 1 && iy == 1) {                                           \
+      for (musz i = begin; i < end; i++) y[i] += alpha * x[i];          \
+    } else {                                                            \
+      for (musz i = begin; i < end; i++) y[i * iy] += alpha * x[i * ix]; \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static void ax__scal_task_##s(void* ctx, musz begin, musz end) {      \
+    const AxVectorTask* t = (const AxVectorTask*)ctx;                   \
+    ct* x = (ct*)t->x->data;                                            \
+    ct alpha = (ct)t->alpha;                                            \
+    musz ix = t->x->inc;                                                \
+    if (ix == 1) {                                                      \
+      for (musz i = begin; i < end; i++) x[i] *= alpha;                 \
+    } else {                                                            \
+      for (musz i = begin; i < end; i++) x[i * ix] *= alpha;            \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Chunk c of dot (y != NULL), the scaled sum of squares, or the      \
+     largest magnitude (scale == 0) */                                  \
+  static void ax__vreduce_task_##s(void* ctx, musz begin, musz end) {   \
+    const AxVectorTask* t = (const AxVectorTask*)ctx;                   \
+    const ct* x = (const ct*)t->x->data;                                \
+    const ct* y = t->y ? (const ct*)t->y->data : NULL;                  \
+    musz ix = t->x->inc, iy = t->y ? t->y->inc : 0;                     \
+    for (musz c = begin; c < end; c++) {                                \
+      musz i0 = c * AX_VECTOR_CHUNK;                                    \
+      musz i1 = (t->x->len - i0 < AX_VECTOR_CHUNK) ? t->x->len : i0 + AX_VECTOR_CHUNK; \
+      double acc[8] = { 0 };                                            \
+      musz i = i0;                                                      \
+      if (y) {                                                          \
+        if (ix == 1 && iy == 1) {                                       \
+          for (; i + 8 <= i1; i += 8) {                                 \
+            for (musz l = 0; l < 8; l++) acc[l] += (double)x[i + l] * (double)y[i + l]; \
+          }                                                             \
+        }                                                               \
+        for (; i < i1; i++) acc[0] += (double)x[i * ix] * (double)y[i * iy]; \
+      } else if (t->scale != 0) {                                       \
+        double sc = t->scale;                                           \
+        if (ix == 1) {                                                  \
+          for (; i + 8 <= i1; i += 8) {                                 \
+            for (musz l = 0; l < 8; l++) acc[l] += ((double)x[i + l] * sc) * ((double)x[i + l] * sc); \
+          }                                                             \
+        }                                                               \
+        for (; i < i1; i++) acc[0] += ((double)x[i * ix] * sc) * ((double)x[i * ix] * sc); \
+      } else {                                                          \
+        for (; i < i1; i++) acc[0] = fmax(acc[0], fabs((double)x[i * ix])); \
+        t->partial[c] = acc[0];                                         \
+        continue;                                                       \
+      }                                                                 \
+      t->partial[c] = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7])); \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Rows [begin, end) of y = alpha * a * x + beta * y, four rows at a  \
+     time with two accumulators each */                                 \
+  static inline void ax__gemv_out_##s(const AxVectorTask* t, musz i, ct dot) { \
+    ct* y = (ct*)t->y->data + i * t->y->inc;                            \
+    *y = (t->beta == 0) ? (ct)t->alpha * dot : (ct)t->alpha * dot + (ct)t->beta * *y; \
+  }                                                                     \
+                                                                        \
+  static void ax__gemv_n_task_##s(void* ctx, musz begin, musz end) {    \
+    const AxVectorTask* t = (const AxVectorTask*)ctx;                   \
+    enum { L = AX__VLEN_##s };                                          \
+    musz n = t->a->cols, lda = t->a->stride;                            \
+    const ct* x = (const ct*)t->xc;                                     \
+    musz i = begin;                                                     \
+    for (; i + 4 <= end; i += 4) {                                      \
+      const ct* a0 = (const ct*)t->a->data + i * lda;                   \
+      const ct* a1 = a0 + lda;                                          \
+      const ct* a2 = a1 + lda;                                          \
+      const ct* a3 = a2 + lda;                                          \
+      ax__vec_##s c00 = AX__VZERO_##s(), c01 = AX__VZERO_##s(), c10 = AX__VZERO_##s(), c11 = AX__VZERO_##s(); \
+      ax__vec_##s c20 = AX__VZERO_##s(), c21 = AX__VZERO_##s(), c30 = AX__VZERO_##s(), c31 = AX__VZERO_##s(); \
+      musz j = 0;                                                       \
+      for (; j + 2 * L <= n; j += 2 * L) {                              \
+        ax__vec_##s x0 = AX__VLOAD_##s(x + j), x1 = AX__VLOAD_##s(x + j + L); \
+        c00 = AX__VFMA_##s(AX__VLOAD_##s(a0 + j), x0, c00);             \
+        c01 = AX__VFMA_##s(AX__VLOAD_##s(a0 + j + L), x1, c01);         \
+        c10 = AX__VFMA_##s(AX__VLOAD_##s(a1 + j), x0, c10);             \
+        c11 = AX__VFMA_##s(AX__VLOAD_##s(a1 + j + L), x1, c11);         \
+        c20 = AX__VFMA_##s(AX__VLOAD_##s(a2 + j), x0, c20);             \
+        c21 = AX__VFMA_##s(AX__VLOAD_##s(a2 + j + L), x1, c21);         \
+        c30 = AX__VFMA_##s(AX__VLOAD_##s(a3 + j), x0, c30);             \
+        c31 = AX__VFMA_##s(AX__VLOAD_##s(a3 + j + L), x1, c31);         \
+      }                                                                 \
+      ct d0 = ax__vsum_##s(c00) + ax__vsum_##s(c01), d1 = ax__vsum_##s(c10) + ax__vsum_##s(c11); \
+      ct d2 = ax__vsum_##s(c20) + ax__vsum_##s(c21), d3 = ax__vsum_##s(c30) + ax__vsum_##s(c31); \
+      for (; j < n; j++) {                                              \
+        d0 += a0[j] * x[j];                                             \
+        d1 += a1[j] * x[j];                                             \
+        d2 += a2[j] * x[j];                                             \
+        d3 += a3[j] * x[j];                                             \
+      }                                                                 \
+      ax__gemv_out_##s(t, i, d0);                                       \
+      ax__gemv_out_##s(t, i + 1, d1);                                   \
+      ax__gemv_out_##s(t, i + 2, d2);                                   \
+      ax__gemv_out_##s(t, i + 3, d3);                                   \
+    }                                                                   \
+    for (; i < end; i++) {                                              \
+      const ct* a0 = (const ct*)t->a->data + i * lda;                   \
+      ax__vec_##s c0 = AX__VZERO_##s();                                 \
+      musz j = 0;                                                       \
+      for (; j + L <= n; j += L) c0 = AX__VFMA_##s(AX__VLOAD_##s(a0 + j), AX__VLOAD_##s(x + j), c0); \
+      ct d0 = ax__vsum_##s(c0);                                         \
+      for (; j < n; j++) d0 += a0[j] * x[j];                            \
+      ax__gemv_out_##s(t, i, d0);                                       \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Columns [begin, end) of yc = beta * yc + a^T xs, with xs = alpha * x \
+     contiguous: row axpys, four rows per pass over a block of yc */    \
+  static void ax__gemv_t_task_##s(void* ctx, musz begin, musz end) {    \
+    const AxVectorTask* t = (const AxVectorTask*)ctx;                   \
+    enum { L = AX__VLEN_##s };                                          \
+    musz m = t->a->rows, lda = t->a->stride;                            \
+    const ct* xs = (const ct*)t->xc;                                    \
+    ct* y = (ct*)t->yc;                                                 \
+    ct beta = (ct)t->beta;                                              \
+    for (musz j0 = begin; j0 < end; j0 += AX_GEMV_TCOLS) {              \
+      musz j1 = (end - j0 < AX_GEMV_TCOLS) ? end : j0 + AX_GEMV_TCOLS;  \
+      for (musz j = j0; j < j1; j++) y[j] = (beta == 0) ? 0 : beta * y[j]; \
+      musz i = 0;                                                       \
+      for (; i + 4 <= m; i += 4) {                                      \
+        const ct* a0 = (const ct*)t->a->data + i * lda;                 \
+        const ct* a1 = a0 + lda;                                        \
+        const ct* a2 = a1 + lda;                                        \
+        const ct* a3 = a2 + lda;                                        \
+        ax__vec_##s x0 = AX__VSET1_##s(xs[i]), x1 = AX__VSET1_##s(xs[i + 1]); \
+        ax__vec_##s x2 = AX__VSET1_##s(xs[i + 2]), x3 = AX__VSET1_##s(xs[i + 3]); \
+        musz j = j0;                                                    \
+        for (; j + L <= j1; j += L) {                                   \
+          ax__vec_##s acc = AX__VLOAD_##s(y + j);                       \
+          acc = AX__VFMA_##s(x0, AX__VLOAD_##s(a0 + j), acc);           \
+          acc = AX__VFMA_##s(x1, AX__VLOAD_##s(a1 + j), acc);           \
+          acc = AX__VFMA_##s(x2, AX__VLOAD_##s(a2 + j), acc);           \
+          acc = AX__VFMA_##s(x3, AX__VLOAD_##s(a3 + j), acc);           \
+          AX__VSTORE_##s(y + j, acc);                                   \
+        }                                                               \
+        for (; j < j1; j++) {                                           \
+          y[j] += xs[i] * a0[j] + xs[i + 1] * a1[j] + xs[i + 2] * a2[j] + xs[i + 3] * a3[j]; \
+        }                                                               \
+      }                                                                 \
+      for (; i < m; i++) {                                              \
+        const ct* a0 = (const ct*)t->a->data + i * lda;                 \
+        for (musz j = j0; j < j1; j++) y[j] += xs[i] * a0[j];           \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Rows [begin, end) of a += alpha * x * yc^T */                      \
+  static void ax__ger_task_##s(void* ctx, musz begin, musz end) {       \
+    const AxVectorTask* t = (const AxVectorTask*)ctx;                   \
+    enum { L = AX__VLEN_##s };                                          \
+    musz n = t->a->cols;                                                \
+    const ct* x = (const ct*)t->x->data;                                \
+    const ct* y = (const ct*)t->xc;                                     \
+    for (musz i = begin; i < end; i++) {                                \
+      ct* a = (ct*)t->a->data + i * t->a->stride;                       \
+      ct xi = (ct)t->alpha * x[i * t->x->inc];                          \
+      ax__vec_##s xv = AX__VSET1_##s(xi);                               \
+      musz j = 0;                                                       \
+      for (; j + L <= n; j += L) AX__VSTORE_##s(a + j, AX__VFMA_##s(xv, AX__VLOAD_##s(y + j), AX__VLOAD_##s(a + j))); \
+      for (; j < n; j++) a[j] += xi * y[j];                             \
+    }                                                                   \
+  }
+
+AX__GEMM_TYPES(AX__DEFINE_VECTOR)
+
+bool ax_vector_axpy(double alpha, const AxVector* x, AxVector* y) {
+  if (!ax__vector_pair("ax_vector_axpy", x, y)) return false;
+  AxVectorTask t = { .x = x, .y = y, .alpha = alpha };
+  ax_parallel_for(x->len, AX_VECTOR_CHUNK, x->dtype == AX_F32 ? ax__axpy_task_f32 : ax__axpy_task_f64, &t);
+  return true;
+}
+
+bool ax_vector_scal(double alpha, AxVector* x) {
+  if (!ax__vector_valid("ax_vector_scal", x)) return false;
+  AxVectorTask t = { .x = x, .alpha = alpha };
+  ax_parallel_for(x->len, AX_VECTOR_CHUNK, x->dtype == AX_F32 ? ax__scal_task_f32 : ax__scal_task_f64, &t);
+  return true;
+}
+
+// Sum (or maximum when scale == 0) of the per-chunk results
+static double ax__vector_reduce(const AxVector* x, const AxVector* y, double scale) {
+  musz chunks = (x->len + AX_VECTOR_CHUNK - 1) / AX_VECTOR_CHUNK;
+  double stack[64];
+  double* partial = chunks <= 64 ? stack : (double*) malloc(chunks * sizeof(double));
+  if (!partial) {
+    AX_LOG(AX_LOG_FATAL, "ax_vector: failed to allocate partial sums");
+    return NAN;
+  }
+  AxVectorTask t = { .x = x, .y = y, .scale = scale, .partial = partial };
+  ax_parallel_for(chunks, 1, x->dtype == AX_F32 ? ax__vreduce_task_f32 : ax__vreduce_task_f64, &t);
+  double r = 0.0;
+  for (musz c = 0; c < chunks; c++) r = (scale == 0 && !y) ? fmax(r, partial[c]) : r + partial[c];
+  if (partial != stack) free(partial);
+  return r;
+}
+
+double ax_vector_dot(const AxVector* x, const AxVector* y) {
+  if (!ax__vector_pair("ax_vector_dot", x, y)) return NAN;
+  return ax__vector_reduce(x, y, 1.0);
+}
+
+double ax_vector_nrm2(const AxVector* x) {
+  if (!ax__vector_valid("ax_vector_nrm2", x)) return NAN;
+  double ss = ax__vector_reduce(x, NULL, 1.0);
+  if (ss >= 0x1p-1022 && ss <= 0x1p1023) return sqrt(ss);
+  // Squares overflowed or underflowed: scale by the largest magnitude
+  double big = ax__vector_reduce(x, NULL, 0.0);
+  if (isnan(ss) || big == 0.0 || isinf(big)) return isnan(ss) ? ss : big;
+  return big * sqrt(ax__vector_reduce(x, NULL, 1.0 / big));
+}
+
+bool ax_matrix_gemv(double alpha, const AxMatrix* a, AxTranspose ta, const AxVector* x,
+                    double beta, AxVector* y) {
+  if (!a || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemv: null matrix");
+    return false;
+  }
+  if (!ax__vector_valid("ax_matrix_gemv", x) || !ax__vector_valid("ax_matrix_gemv", y)) return false;
+  musz m = a->rows, n = a->cols;
+  if ((ta == AX_TRANS ? m : n) != x->len || (ta == AX_TRANS ? n : m) != y->len) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemv: dimension mismatch");
+    return false;
+  }
+  if (a->dtype != x->dtype || a->dtype != y->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemv: dtype mismatch (%s, %s -> %s)", ax_dtype_name(a->dtype),
+           ax_dtype_name(x->dtype), ax_dtype_name(y->dtype));
+    return false;
+  }
+  if (x->len == 0) {
+    // Empty inner dimension: y = beta * y, cleared when beta == 0 as in BLAS
+    for (musz i = 0; i < y->len; i++) ax_vector_set(y, i, beta == 0 ? 0.0 : beta * ax_vector_get(y, i));
+    return true;
+  }
+  if (y->len == 0) return true;
+  if (!ax__unit_cols(a)) {
+    // A transposed view runs the other kernel on its storage; other strided
+    // views are staged
+    AxMatrix v = ax_matrix_transpose_view(a);
+    if (ax__unit_cols(&v)) return ax_matrix_gemv(alpha, &v, ta == AX_TRANS ? AX_NO_TRANS : AX_TRANS, x, beta, y);
+    AxMatrix as;
+    const AxMatrix* au = ax__unit_stage(a, &as, true);
+    if (!au) return false;
+    bool ok = ax_matrix_gemv(alpha, au, ta, x, beta, y);
+    ax__unit_release(&as, NULL);
+    return ok;
+  }
+  bool f32 = (a->dtype == AX_F32);
+  musz esz = ax_dtype_size(a->dtype);
+  AxVectorTask t = { .x = x, .y = y, .a = a, .alpha = alpha, .beta = beta };
+  if (ta == AX_NO_TRANS) {
+    void* xc = NULL;
+    if (x->inc != 1) {
+      xc = malloc(n * esz);
+      if (!xc) {
+        AX_LOG(AX_LOG_FATAL, "ax_matrix_gemv: failed to allocate workspace");
+        return false;
+      }
+      if (f32) {
+        ax__vgather_f32((const mf32*)x->data, x->inc, n, 1.0f, (mf32*)xc);
+      } else {
+        ax__vgather_f64((const mf64*)x->data, x->inc, n, 1.0, (mf64*)xc);
+      }
+    }
+    t.xc = xc ? xc : x->data;
+    ax_parallel_for(m, AX_VECTOR_CHUNK / n + 1, f32 ? ax__gemv_n_task_f32 : ax__gemv_n_task_f64, &t);
+    free(xc);
+    return true;
+  }
+  // Transposed: scaled x and (when strided) y in one workspace
+  mu8* w = (mu8*) malloc((m + (y->inc != 1 ? n : 0)) * esz);
+  if (!w) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemv: failed to allocate workspace");
+    return false;
+  }
+  void* yc = (y->inc != 1) ? w + m * esz : y->data;
+  if (f32) {
+    ax__vgather_f32((const mf32*)x->data, x->inc, m, (mf32)alpha, (mf32*)w);
+    if (y->inc != 1 && beta != 0) ax__vgather_f32((const mf32*)y->data, y->inc, n, 1.0f, (mf32*)yc);
+  } else {
+    ax__vgather_f64((const mf64*)x->data, x->inc, m, alpha, (mf64*)w);
+    if (y->inc != 1 && beta != 0) ax__vgather_f64((const mf64*)y->data, y->inc, n, 1.0, (mf64*)yc);
+  }
+  t.xc = w;
+  t.yc = yc;
+  ax_parallel_for(n, AX_VECTOR_CHUNK / (m + 1) + AX__VLEN_f64, f32 ? ax__gemv_t_task_f32 : ax__gemv_t_task_f64, &t);
+  if (y->inc != 1) {
+    for (musz j = 0; j < n; j++) memcpy(ax__vector_at(y, j), (mu8*)yc + j * esz, esz);
+  }
+  free(w);
+  return true;
+}
+
+bool ax_matrix_ger(double alpha, const AxVector* x, const AxVector* y, AxMatrix* a) {
+  if (!a || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_ger: null matrix");
+    return false;
+  }
+  if (!ax__vector_valid("ax_matrix_ger", x) || !ax__vector_valid("ax_matrix_ger", y)) return false;
+  if (x->len != a->rows || y->len != a->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_ger: dimension mismatch");
+    return false;
+  }
+  if (a->dtype != x->dtype || a->dtype != y->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_ger: dtype mismatch (%s, %s -> %s)", ax_dtype_name(x->dtype),
+           ax_dtype_name(y->dtype), ax_dtype_name(a->dtype));
+    return false;
+  }
+  if (a->rows == 0 || a->cols == 0) return true;
+  if (!ax__unit_cols(a)) {
+    // A transposed view takes a^T += alpha y x^T; other strided views are staged
+    AxMatrix v = ax_matrix_transpose_view(a);
+    if (ax__unit_cols(&v)) return ax_matrix_ger(alpha, y, x, &v);
+    AxMatrix as;
+    AxMatrix* au = ax__unit_stage(a, &as, true);
+    if (!au) return false;
+    bool ok = ax_matrix_ger(alpha, x, y, au);
+    ax__unit_release(&as, a);
+    return ok;
+  }
+  bool f32 = (a->dtype == AX_F32);
+  void* yc = NULL;
+  if (y->inc != 1) {
+    yc = malloc(y->len * ax_dtype_size(y->dtype));
+    if (!yc) {
+      AX_LOG(AX_LOG_FATAL, "ax_matrix_ger: failed to allocate workspace");
+      return false;
+    }
+    if (f32) {
+      ax__vgather_f32((const mf32*)y->data, y->inc, y->len, 1.0f, (mf32*)yc);
+    } else {
+      ax__vgather_f64((const mf64*)y->data, y->inc, y->len, 1.0, (mf64*)yc);
+    }
+  }
+  AxVectorTask t = { .x = x, .a = a, .alpha = alpha, .xc = yc ? yc : y->data };
+  ax_parallel_for(a->rows, AX_VECTOR_CHUNK / a->cols + 1, f32 ? ax__ger_task_f32 : ax__ger_task_f64, &t);
+  free(yc);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Batched small matrices
+// ---------------------------------------------------------------------------
+//
+// Blocks of one vector width of matrices are transposed into lane-major
+// scratch (entry e of lane l at e * L + l), multiplied with every vector
+// operation spanning the block, and scattered back. The task body is a macro
+// over the dimensions so the fixed-size instances see constants and unroll.
+
+#define AX__BATCH_BLOCKS 64 // Blocks of lanes per parallel task
+
+#define AX__BATCH_SIZES(X, ...)                                         \
+  X(2, __VA_ARGS__) X(3, __VA_ARGS__) X(4, __VA_ARGS__) X(5, __VA_ARGS__) \
+  X(6, __VA_ARGS__) X(7, __VA_ARGS__) X(8, __VA_ARGS__) X(9, __VA_ARGS__) \
+  X(10, __VA_ARGS__) X(11, __VA_ARGS__) X(12, __VA_ARGS__) X(13, __VA_ARGS__) \
+  X(14, __VA_ARGS__) X(15, __VA_ARGS__) X(16, __VA_ARGS__)
+
+bool ax_matrix_batch_init(AxMatrixBatch* batch, musz count, musz rows, musz cols,
+                          AxDType dtype, AxBatchLayout layout, Arena* arena) {
+  if (!batch || count == 0 || rows == 0 || cols == 0) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_batch_init: invalid arguments");
+    return false;
+  }
+  musz size = count * rows * cols * ax_dtype_size(dtype);
+  if (arena) {
+    batch->data = ax_alloc(arena, size);
+  } else {
+    AX_LOG(AX_LOG_INFO, "Arena is NULL, using malloc");
+    AX_LOG(AX_LOG_WARN, "DO NOT FORGET TO CALL ax_matrix_batch_destroy");
+    batch->data = malloc(size);
+  }
+  if (!batch->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_batch_init: failed to allocate data");
+    return false;
+  }
+  batch->count = count;
+  batch->rows = rows;
+  batch->cols = cols;
+  if (layout == AX_BATCH_INTERLEAVED) {
+    batch->stride = cols * count;
+    batch->col_stride = count;
+    batch->batch_stride = 1;
+  } else {
+    batch->stride = cols;
+    batch->col_stride = 1;
+    batch->batch_stride = rows * cols;
+  }
+  batch->dtype = dtype;
+  batch->data_owner = (arena == NULL);
+  return true;
+}
+
+void ax_matrix_batch_destroy(AxMatrixBatch* batch) {
+  if (!batch) return;
+  if (batch->data_owner) {
+    free(batch->data);
+  }
+  batch->data = NULL;
+  batch->count = 0;
+}
+
+static inline void* ax__batch_at(const AxMatrixBatch* batch, musz b, musz i, musz j) {
+  musz offset = b * batch->batch_stride + i * batch->stride + j * batch->col_stride;
+  return (mu8*)batch->data + offset * ax_dtype_size(batch->dtype);
+}
+
+double ax_matrix_batch_get(const AxMatrixBatch* batch, musz b, musz i, musz j) {
+  return ax__load_elem(batch->dtype, ax__batch_at(batch, b, i, j));
+}
+
+void ax_matrix_batch_set(AxMatrixBatch* batch, musz b, musz i, musz j, double value) {
+  ax__store_elem(batch->dtype, ax__batch_at(batch, b, i, j), value);
+}
+
+typedef struct AxBatchTask {
+  const AxMatrixBatch* a;
+  const AxMatrixBatch* b;
+  const AxMatrixBatch* c;
+} AxBatchTask;
+
+// Lane-major view of one block: entry (i, j) of its L matrices starts at
+// data + i * rs + j * cs. Interleaved stacks are viewed in place; anything
+// else (and a partial last block) goes through scratch.
+#define AX__DEFINE_BATCH_IO(T, s, ct)                                   \
+  static inline const ct* ax__batch_load_##s(const AxMatrixBatch* x, musz b0, musz lanes, \
+                                             musz rows, musz cols, ct* buf, \
+                                             musz* rs, musz* cs) {      \
+    enum { L = AX__VLEN_##s };                                          \
+    const ct* base = (const ct*)x->data + b0 * x->batch_stride;         \
+    musz bs = x->batch_stride;                                          \
+    if (lanes == L && bs == 1) {                                        \
+      *rs = x->stride;                                                  \
+      *cs = x->col_stride;                                              \
+      return base;                                                      \
+    }                                                                   \
+    *rs = cols * L;                                                     \
+    *cs = L;                                                            \
+    if (lanes == L) {                                                   \
+      for (musz i = 0; i < rows; i++) {                                 \
+        for (musz j = 0; j < cols; j++) {                               \
+          const ct* src = base + i * x->stride + j * x->col_stride;     \
+          ct* dst = buf + (i * cols + j) * L;                           \
+          for (musz l = 0; l < L; l++) dst[l] = src[l * bs];            \
+        }                                                               \
+      }                                                                 \
+      return buf;                                                       \
+    }                                                                   \
+    for (musz i = 0; i < rows; i++) {                                   \
+      for (musz j = 0; j < cols; j++) {                                 \
+        const ct* src = base + i * x->stride + j * x->col_stride;       \
+        ct* dst = buf + (i * cols + j) * L;                             \
+        for (musz l = 0; l < L; l++) dst[l] = l < lanes ? src[l * bs] : 0; \
+      }                                                                 \
+    }                                                                   \
+    return buf;                                                         \
+  }                                                                     \
+                                                                        \
+  static inline void ax__batch_store_##s(const AxMatrixBatch* x, musz b0, musz lanes, \
+                                         musz rows, musz cols, const ct* buf) { \
+    enum { L = AX__VLEN_##s };                                          \
+    ct* base = (ct*)x->data + b0 * x->batch_stride;                     \
+    musz bs = x->batch_stride;                                          \
+    for (musz i = 0; i < rows; i++) {                                   \
+      for (musz j = 0; j < cols; j++) {                                 \
+        ct* dst = base + i * x->stride + j * x->col_stride;             \
+        const ct* src = buf + (i * cols + j) * L;                       \
+        if (lanes == L) {                                               \
+          for (musz l = 0; l < L; l++) dst[l * bs] = src[l];            \
+        } else {                                                        \
+          for (musz l = 0; l < lanes; l++) dst[l * bs] = src[l];        \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX__GEMM_TYPES(AX__DEFINE_BATCH_IO)
+
+// Task over blocks of L matrices, for dimensions M x K times K x N. Results
+// go through scratch, so `c` may share storage with `a` or `b`.
+#define AX__DEFINE_BATCH_TASK(name, s, ct, M, K, N)                     \
+  static void ax__batch_task_##s##_##name(void* ctx, musz begin, musz end) { \
+    const AxBatchTask* t = (const AxBatchTask*)ctx;                     \
+    enum { L = AX__VLEN_##s, D = AX_BATCH_MAX_DIM };                    \
+    const musz m = (M), k = (K), n = (N);                               \
+    ct abuf[D * D * L], bbuf[D * D * L], cbuf[D * D * L];               \
+    for (musz blk = begin; blk < end; blk++) {                          \
+      musz b0 = blk * L;                                                \
+      musz lanes = (t->c->count - b0 < L) ? t->c->count - b0 : L;       \
+      musz ars, acs, brs, bcs;                                          \
+      const ct* ap = ax__batch_load_##s(t->a, b0, lanes, m, k, abuf, &ars, &acs); \
+      const ct* bp = ax__batch_load_##s(t->b, b0, lanes, k, n, bbuf, &brs, &bcs); \
+      for (musz i = 0; i < m; i++) {                                    \
+        ax__vec_##s acc[D];                                             \
+        for (musz j = 0; j < n; j++) acc[j] = AX__VZERO_##s();          \
+        for (musz p = 0; p < k; p++) {                                  \
+          ax__vec_##s av = AX__VLOAD_##s(ap + i * ars + p * acs);       \
+          for (musz j = 0; j < n; j++) {                                \
+            acc[j] = AX__VFMA_##s(av, AX__VLOAD_##s(bp + p * brs + j * bcs), acc[j]); \
+          }                                                             \
+        }                                                               \
+        for (musz j = 0; j < n; j++) AX__VSTORE_##s(cbuf + (i * n + j) * L, acc[j]); \
+      }                                                                 \
+      ax__batch_store_##s(t->c, b0, lanes, m, n, cbuf);                 \
+    }                                                                   \
+  }
+
+#define AX__DEFINE_BATCH_FIXED(N, s, ct) AX__DEFINE_BATCH_TASK(N, s, ct, N, N, N)
+
+#define AX__DEFINE_BATCH(T, s, ct)                                      \
+  AX__BATCH_SIZES(AX__DEFINE_BATCH_FIXED, s, ct)                        \
+  AX__DEFINE_BATCH_TASK(any, s, ct, t->a->rows, t->a->cols, t->b->cols)
+
+AX__GEMM_TYPES(AX__DEFINE_BATCH)
+
+bool ax_matrix_batch_multiply(const AxMatrixBatch* a, const AxMatrixBatch* b, AxMatrixBatch* c) {
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_batch_multiply: null batch");
+    return false;
+  }
+  if (a->count != b->count || a->count != c->count || a->cols != b->rows ||
+      c->rows != a->rows || c->cols != b->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_batch_multiply: dimension mismatch");
+    return false;
+  }
+  if (a->rows > AX_BATCH_MAX_DIM || a->cols > AX_BATCH_MAX_DIM || b->cols > AX_BATCH_MAX_DIM) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_batch_multiply: dimensions above %d", AX_BATCH_MAX_DIM);
+    return false;
+  }
+  if (a->dtype != b->dtype || a->dtype != c->dtype || (a->dtype != AX_F32 && a->dtype != AX_F64)) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_batch_multiply: unsupported dtypes (%s, %s -> %s)",
+           ax_dtype_name(a->dtype), ax_dtype_name(b->dtype), ax_dtype_name(c->dtype));
+    return false;
+  }
+  AxBatchTask t = { a, b, c };
+  musz n = a->rows;
+  bool square = (a->cols == n && b->cols == n);
+  AxTaskFn fn = NULL;
+  switch (a->dtype) {
+#define AX__BATCH_SIZE_CASE(N, s, ct) case N: fn = ax__batch_task_##s##_##N; break;
+#define AX__BATCH_CASE(T, s, ct)                                        \
+    case AX_##T:                                                        \
+      switch (square ? n : 0) {                                         \
+        AX__BATCH_SIZES(AX__BATCH_SIZE_CASE, s, ct)                     \
+      default: fn = ax__batch_task_##s##_any; break;                    \
+      }                                                                 \
+      ax_parallel_for((c->count + AX__VLEN_##s - 1) / AX__VLEN_##s, AX__BATCH_BLOCKS, fn, &t); \
+      break;
+    AX__GEMM_TYPES(AX__BATCH_CASE)
+#undef AX__BATCH_CASE
+#undef AX__BATCH_SIZE_CASE
+  default: break;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Reductions
+// ---------------------------------------------------------------------------
+
+typedef double axm_acc; // Accumulator type for sums
+
+#define AX_REDUCE_BLOCK 128   // Leaf size of the pairwise recursion
+#define AX_REDUCE_TILE 64     // Columns per tile in the axis-0 kernels
+#define AX_REDUCE_CHUNK 65536 // Elements per parallel task
+
+typedef enum AxReduceOp {
+  AX_REDUCE_SUM,
+  AX_REDUCE_ABS,
+  AX_REDUCE_SQ,
+  AX_REDUCE_SQDEV,
+  AX_REDUCE_DOT,
+  AX_REDUCE_MIN,
+  AX_REDUCE_MAX,
+  AX_REDUCE_MAXABS
+} AxReduceOp;
+
+#define AX_REDUCE_IS_EXTREMUM(op) ((op) >= AX_REDUCE_MIN)
+
+// Per-element terms of the additive reductions; x, y and c are the element of
+// `a`, the element of `b` and the centering value.
+#define AX__TERM_SUM(x, y, c)   ((axm_acc)(x))
+#define AX__TERM_ABS(x, y, c)   fabs((axm_acc)(x))
+#define AX__TERM_SQ(x, y, c)    ((axm_acc)(x) * (axm_acc)(x))
+#define AX__TERM_SQDEV(x, y, c) (((axm_acc)(x) - (c)) * ((axm_acc)(x) - (c)))
+#define AX__TERM_DOT(x, y, c)   ((axm_acc)(x) * (axm_acc)(y))
+
+// Pairwise sum of TERM over a contiguous run. The leaves keep eight
+// independent accumulators so the compiler can vectorize them.
+#define AX__DEFINE_PAIRWISE(name, TERM, s, ct)                          \
+  static axm_acc ax__##name##_run_##s(const ct* x, const ct* y, axm_acc c, musz n) { \
+    (void)y; (void)c;                                                   \
+    if (n > AX_REDUCE_BLOCK) {                                          \
+      musz h = (n / 2) & ~(musz)7;                                      \
+      return ax__##name##_run_##s(x, y, c, h) +                         \
+        ax__##name##_run_##s(x + h, y ? y + h : y, c, n - h);           \
+    }                                                                   \
+    axm_acc acc[8] = {0};                                               \
+    musz i = 0;                                                         \
+    for (; i + 8 <= n; i += 8) {                                        \
+      for (musz l = 0; l < 8; l++) acc[l] += TERM(x[i + l], y[i + l], c); \
+    }                                                                   \
+    for (; i < n; i++) acc[0] += TERM(x[i], y[i], c);                   \
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7])); \
+  }
+
+// Pairwise (over rows) sum of TERM for rows [r0, r1) and the `w` columns
+// starting at j0, written to acc[0..w). Vectorized across columns.
+#define AX__DEFINE_PAIRWISE_COLS(name, TERM, s, ct)                     \
+  static void ax__##name##_cols_##s(const AxMatrix* a, const AxMatrix* b, const axm_acc* c, \
+                                    musz r0, musz r1, musz j0, musz w, axm_acc* acc) { \
+    (void)b; (void)c;                                                   \
+    if (r1 - r0 > AX_REDUCE_BLOCK) {                                    \
+      axm_acc tmp[AX_REDUCE_TILE];                                      \
+      musz mid = r0 + (r1 - r0) / 2;                                    \
+      ax__##name##_cols_##s(a, b, c, r0, mid, j0, w, acc);              \
+      ax__##name##_cols_##s(a, b, c, mid, r1, j0, w, tmp);              \
+      for (musz j = 0; j < w; j++) acc[j] += tmp[j];                    \
+      return;                                                           \
+    }                                                                   \
+    for (musz j = 0; j < w; j++) acc[j] = 0;                            \
+    for (musz i = r0; i < r1; i++) {                                    \
+      const ct* x = &AX_MATRIX_AT_T(ct, *a, i, j0);                     \
+      const ct* y = b ? &AX_MATRIX_AT_T(ct, *b, i, j0) : NULL;          \
+      (void)y;                                                          \
+      for (musz j = 0; j < w; j++) acc[j] += TERM(x[j], y[j], c[j]);    \
+    }                                                                   \
+  }
+
+#define AX__VAL_ID(x)  (x)
+#define AX__VAL_ABS(x) fabs((axm_acc)(x))
+#define AX__LESS(a, b)    ((a) < (b))
+#define AX__GREATER(a, b) ((a) > (b))
+
+// Extremum of VAL (of type vt) over a contiguous run, with eight independent
+// lanes. When the index is requested each lane carries the index of its
+// first best element, so ties (and a leading NaN, which nothing beats)
+// resolve to the first occurrence.
+#define AX__DEFINE_EXTREMUM(name, VAL, BETTER, s, ct, vt)               \
+  static axm_acc ax__##name##_run_##s(const ct* x, musz n, musz* idx) { \
+    vt best[8];                                                         \
+    musz at[8] = { 0 };                                                 \
+    for (musz l = 0; l < 8; l++) best[l] = VAL(x[0]);                   \
+    musz i = 0;                                                         \
+    if (idx) {                                                          \
+      for (; i + 8 <= n; i += 8) {                                      \
+        for (musz l = 0; l < 8; l++) {                                  \
+          vt v = VAL(x[i + l]);                                         \
+          bool better = BETTER(v, best[l]);                             \
+          best[l] = better ? v : best[l];                               \
+          at[l] = better ? i + l : at[l];                               \
+        }                                                               \
+      }                                                                 \
+    } else {                                                            \
+      for (; i + 8 <= n; i += 8) {                                      \
+        for (musz l = 0; l < 8; l++) {                                  \
+          vt v = VAL(x[i + l]);                                         \
+          best[l] = BETTER(v, best[l]) ? v : best[l];                   \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    for (; i < n; i++) {                                                \
+      vt v = VAL(x[i]);                                                 \
+      if (BETTER(v, best[0])) {                                         \
+        best[0] = v;                                                    \
+        at[0] = i;                                                      \
+      }                                                                 \
+    }                                                                   \
+    for (musz l = 1; l < 8; l++) {                                      \
+      if (BETTER(best[l], best[0]) || (best[l] == best[0] && at[l] < at[0])) { \
+        best[0] = best[l];                                              \
+        at[0] = at[l];                                                  \
+      }                                                                 \
+    }                                                                   \
+    if (idx) *idx = at[0];                                              \
+    return (axm_acc)best[0];                                            \
+  }
+
+// Extremum of VAL for rows [r0, r1) and the `w` columns starting at j0.
+#define AX__DEFINE_EXTREMUM_COLS(name, VAL, BETTER, s, ct, vt)          \
+  static void ax__##name##_cols_##s(const AxMatrix* a, musz r0, musz r1, musz j0, \
+                                    musz w, axm_acc* val, musz* idx) {  \
+    vt best[AX_REDUCE_TILE];                                            \
+    const ct* x = &AX_MATRIX_AT_T(ct, *a, r0, j0);                      \
+    for (musz j = 0; j < w; j++) {                                      \
+      best[j] = VAL(x[j]);                                              \
+      idx[j] = r0;                                                      \
+    }                                                                   \
+    for (musz i = r0 + 1; i < r1; i++) {                                \
+      x = &AX_MATRIX_AT_T(ct, *a, i, j0);                               \
+      for (musz j = 0; j < w; j++) {                                    \
+        vt v = VAL(x[j]);                                               \
+        bool better = BETTER(v, best[j]);                               \
+        best[j] = better ? v : best[j];                                 \
+        idx[j] = better ? i : idx[j];                                   \
+      }                                                                 \
+    }                                                                   \
+    for (musz j = 0; j < w; j++) val[j] = (axm_acc)best[j];             \
+  }
+
+// All reduction kernels of one dtype, plus per-op dispatchers. Extrema
+// compare in the element type, except MAXABS which compares magnitudes.
+#define AX__DEFINE_REDUCE_DTYPE(T, s, ct)                               \
+  AX__DEFINE_PAIRWISE(sum, AX__TERM_SUM, s, ct)                         \
+  AX__DEFINE_PAIRWISE(abs, AX__TERM_ABS, s, ct)                         \
+  AX__DEFINE_PAIRWISE(sq, AX__TERM_SQ, s, ct)                           \
+  AX__DEFINE_PAIRWISE(sqdev, AX__TERM_SQDEV, s, ct)                     \
+  AX__DEFINE_PAIRWISE(dot, AX__TERM_DOT, s, ct)                         \
+  AX__DEFINE_PAIRWISE_COLS(sum, AX__TERM_SUM, s, ct)                    \
+  AX__DEFINE_PAIRWISE_COLS(abs, AX__TERM_ABS, s, ct)                    \
+  AX__DEFINE_PAIRWISE_COLS(sq, AX__TERM_SQ, s, ct)                      \
+  AX__DEFINE_PAIRWISE_COLS(sqdev, AX__TERM_SQDEV, s, ct)                \
+  AX__DEFINE_PAIRWISE_COLS(dot, AX__TERM_DOT, s, ct)                    \
+  AX__DEFINE_EXTREMUM(min, AX__VAL_ID, AX__LESS, s, ct, ct)             \
+  AX__DEFINE_EXTREMUM(max, AX__VAL_ID, AX__GREATER, s, ct, ct)          \
+  AX__DEFINE_EXTREMUM(maxabs, AX__VAL_ABS, AX__GREATER, s, ct, axm_acc) \
+  AX__DEFINE_EXTREMUM_COLS(min, AX__VAL_ID, AX__LESS, s, ct, ct)        \
+  AX__DEFINE_EXTREMUM_COLS(max, AX__VAL_ID, AX__GREATER, s, ct, ct)     \
+  AX__DEFINE_EXTREMUM_COLS(maxabs, AX__VAL_ABS, AX__GREATER, s, ct, axm_acc) \
+                                                                        \
+  static axm_acc ax__reduce_run_##s(AxReduceOp op, const void* xv, const void* yv, \
+                                    axm_acc c, musz n, musz* idx) {     \
+    const ct* x = (const ct*)xv;                                        \
+    const ct* y = (const ct*)yv;                                        \
+    switch (op) {                                                       \
+    case AX_REDUCE_SUM:    return ax__sum_run_##s(x, y, c, n);          \
+    case AX_REDUCE_ABS:    return ax__abs_run_##s(x, y, c, n);          \
+    case AX_REDUCE_SQ:     return ax__sq_run_##s(x, y, c, n);           \
+    case AX_REDUCE_SQDEV:  return ax__sqdev_run_##s(x, y, c, n);        \
+    case AX_REDUCE_DOT:    return ax__dot_run_##s(x, y, c, n);          \
+    case AX_REDUCE_MIN:    return ax__min_run_##s(x, n, idx);           \
+    case AX_REDUCE_MAX:    return ax__max_run_##s(x, n, idx);           \
+    case AX_REDUCE_MAXABS: return ax__maxabs_run_##s(x, n, idx);        \
+    }                                                                   \
+    return 0;                                                           \
+  }                                                                     \
+                                                                        \
+  static void ax__reduce_cols_##s(AxReduceOp op, const AxMatrix* a, const AxMatrix* b, \
+                                  const axm_acc* c, musz r0, musz r1, musz j0, musz w, \
+                                  axm_acc* val, musz* idx) {            \
+    switch (op) {                                                       \
+    case AX_REDUCE_SUM:    ax__sum_cols_##s(a, b, c, r0, r1, j0, w, val); break; \
+    case AX_REDUCE_ABS:    ax__abs_cols_##s(a, b, c, r0, r1, j0, w, val); break; \
+    case AX_REDUCE_SQ:     ax__sq_cols_##s(a, b, c, r0, r1, j0, w, val); break; \
+    case AX_REDUCE_SQDEV:  ax__sqdev_cols_##s(a, b, c, r0, r1, j0, w, val); break; \
+    case AX_REDUCE_DOT:    ax__dot_cols_##s(a, b, c, r0, r1, j0, w, val); break; \
+    case AX_REDUCE_MIN:    ax__min_cols_##s(a, r0, r1, j0, w, val, idx); break; \
+    case AX_REDUCE_MAX:    ax__max_cols_##s(a, r0, r1, j0, w, val, idx); break; \
+    case AX_REDUCE_MAXABS: ax__maxabs_cols_##s(a, r0, r1, j0, w, val, idx); break; \
+    }                                                                   \
+  }
+
+AX_DTYPE_LIST(AX__DEFINE_REDUCE_DTYPE)
+
+// Folds `src` into `dst`: adds for sums, keeps the better value for extrema
+// (ties keep `dst`, which always precedes `src`).
+static void ax__reduce_merge(AxReduceOp op, axm_acc* dst, musz* dst_idx,
+                             const axm_acc* src, const musz* src_idx, musz n) {
+  switch (op) {
+  case AX_REDUCE_MIN:
+    for (musz k = 0; k < n; k++) {
+      if (src[k] < dst[k]) { dst[k] = src[k]; dst_idx[k] = src_idx[k]; }
+    }
+    break;
+  case AX_REDUCE_MAX:
+  case AX_REDUCE_MAXABS:
+    for (musz k = 0; k < n; k++) {
+      if (src[k] > dst[k]) { dst[k] = src[k]; dst_idx[k] = src_idx[k]; }
+    }
+    break;
+  default:
+    for (musz k = 0; k < n; k++) dst[k] += src[k];
+    break;
+  }
+}
+
+// Half-precision reductions widen the input to f32 one pairwise leaf at a
+// time and reuse the f32 kernels, so they split exactly like the others.
+static axm_acc ax__reduce_run_half(AxReduceOp op, AxDType dtype, const void* xv, const void* yv,
+                                   axm_acc c, musz n, musz* idx) {
+  const mu16* x = (const mu16*)xv;
+  const mu16* y = (const mu16*)yv;
+  mf32 bx[AX_REDUCE_BLOCK];
+  mf32 by[AX_REDUCE_BLOCK];
+  if (!AX_REDUCE_IS_EXTREMUM(op)) {
+    if (n > AX_REDUCE_BLOCK) {
+      musz h = (n / 2) & ~(musz)7;
+      return ax__reduce_run_half(op, dtype, x, y, c, h, NULL) +
+        ax__reduce_run_half(op, dtype, x + h, y ? y + h : y, c, n - h, NULL);
+    }
+    ax__half_to_f32_n(dtype, x, bx, n);
+    if (y) ax__half_to_f32_n(dtype, y, by, n);
+    return ax__reduce_run_f32(op, bx, y ? by : NULL, c, n, NULL);
+  }
+  axm_acc best = 0;
+  musz best_idx = 0;
+  for (musz off = 0; off < n; off += AX_REDUCE_BLOCK) {
+    musz len = (n - off < AX_REDUCE_BLOCK) ? n - off : AX_REDUCE_BLOCK;
+    musz i = 0;
+    ax__half_to_f32_n(dtype, x + off, bx, len);
+    axm_acc v = ax__reduce_run_f32(op, bx, NULL, 0, len, idx ? &i : NULL);
+    i += off;
+    if (off == 0) {
+      best = v;
+      best_idx = i;
+    } else {
+      ax__reduce_merge(op, &best, &best_idx, &v, &i, 1);
+    }
+  }
+  if (idx) *idx = best_idx;
+  return best;
+}
+
+static void ax__reduce_cols_half(AxReduceOp op, const AxMatrix* a, const AxMatrix* b,
+                                 const axm_acc* c, musz r0, musz r1, musz j0, musz w,
+                                 axm_acc* val, musz* idx) {
+  if (r1 - r0 > AX_REDUCE_BLOCK) {
+    axm_acc tmp[AX_REDUCE_TILE];
+    musz tmp_idx[AX_REDUCE_TILE];
+    musz mid = r0 + (r1 - r0) / 2;
+    ax__reduce_cols_half(op, a, b, c, r0, mid, j0, w, val, idx);
+    ax__reduce_cols_half(op, a, b, c, mid, r1, j0, w, tmp, idx ? tmp_idx : NULL);
+    ax__reduce_merge(op, val, idx, tmp, tmp_idx, w);
+    return;
+  }
+  mf32 bx[AX_REDUCE_BLOCK * AX_REDUCE_TILE];
+  mf32 by[AX_REDUCE_BLOCK * AX_REDUCE_TILE];
+  musz rows = r1 - r0;
+  for (musz i = 0; i < rows; i++) {
+    ax__half_to_f32_n(a->dtype, (const mu16*)ax__at(a, r0 + i, j0), bx + i * w, w);
+    if (b) ax__half_to_f32_n(b->dtype, (const mu16*)ax__at(b, r0 + i, j0), by + i * w, w);
+  }
+  AxMatrix ta = { rows, w, w, 1, bx, AX_F32, false };
+  AxMatrix tb = { rows, w, w, 1, by, AX_F32, false };
+  ax__reduce_cols_f32(op, &ta, b ? &tb : NULL, c, 0, rows, 0, w, val, idx);
+  if (idx) {
+    for (musz j = 0; j < w; j++) idx[j] += r0;
+  }
+}
+
+static axm_acc ax__reduce_run(AxReduceOp op, AxDType dtype, const void* x, const void* y,
+                              axm_acc c, musz n, musz* idx) {
+  switch (dtype) {
+#define AX__REDUCE_RUN_CASE(T, s, ct) case AX_##T: return ax__reduce_run_##s(op, x, y, c, n, idx);
+    AX_DTYPE_LIST(AX__REDUCE_RUN_CASE)
+#undef AX__REDUCE_RUN_CASE
+  case AX_F16:
+  case AX_BF16:
+    return ax__reduce_run_half(op, dtype, x, y, c, n, idx);
+  }
+  return 0;
+}
+
+static void ax__reduce_cols(AxReduceOp op, const AxMatrix* a, const AxMatrix* b,
+                            const axm_acc* c, musz r0, musz r1, musz j0, musz w,
+                            axm_acc* val, musz* idx) {
+  switch (a->dtype) {
+#define AX__REDUCE_COLS_CASE(T, s, ct) case AX_##T: ax__reduce_cols_##s(op, a, b, c, r0, r1, j0, w, val, idx); break;
+    AX_DTYPE_LIST(AX__REDUCE_COLS_CASE)
+#undef AX__REDUCE_COLS_CASE
+  case AX_F16:
+  case AX_BF16:
+    ax__reduce_cols_half(op, a, b, c, r0, r1, j0, w, val, idx);
+    break;
+  }
+}
+
+// Combines `count` partial results of `width` values each (stored back to
+// back) into the first one. Sums use a pairwise tree; extrema merge in order.
+static void ax__reduce_combine(AxReduceOp op, axm_acc* val, musz* idx,
+                               musz count, musz width) {
+  if (AX_REDUCE_IS_EXTREMUM(op)) {
+    for (musz c = 1; c < count; c++) {
+      ax__reduce_merge(op, val, idx, val + c * width, idx + c * width, width);
+    }
+    return;
+  }
+  for (musz step = 1; step < count; step *= 2) {
+    for (musz c = 0; c + step < count; c += 2 * step) {
+      ax__reduce_merge(op, val + c * width, NULL, val + (c + step) * width, NULL, width);
+    }
+  }
+}
+
+typedef struct AxReduceTask {
+  AxReduceOp op;
+  const AxMatrix* a;
+  const AxMatrix* b;
+  const axm_acc* center;
+  musz center_step; // 0 broadcasts center[0]
+  musz chunk;       // Elements (flat) or rows (axis 0) per task
+  musz ntiles;      // Column tiles per chunk (axis 0)
+  axm_acc* val;
+  musz* idx;
+} AxReduceTask;
+
+// One result per row.
+static void ax__reduce_rows_task(void* ctx, musz begin, musz end) {
+  AxReduceTask* t = (AxReduceTask*)ctx;
+  for (musz i = begin; i < end; i++) {
+    axm_acc c = t->center ? t->center[i * t->center_step] : 0;
+    t->val[i] = ax__reduce_run(t->op, t->a->dtype, ax__at(t->a, i, 0),
+                               t->b ? ax__at(t->b, i, 0) : NULL,
+                               c, t->a->cols, t->idx ? &t->idx[i] : NULL);
+  }
+}
+
+// One result per fixed-size chunk of a contiguous matrix.
+static void ax__reduce_flat_task(void* ctx, musz begin, musz end) {
+  AxReduceTask* t = (AxReduceTask*)ctx;
+  musz total = t->a->rows * t->a->cols;
+  for (musz k = begin; k < end; k++) {
+    musz off = k * t->chunk;
+    musz n = (total - off < t->chunk) ? total - off : t->chunk;
+    axm_acc c = t->center ? t->center[0] : 0;
+    t->val[k] = ax__reduce_run(t->op, t->a->dtype, ax__at(t->a, 0, off),
+                               t->b ? ax__at(t->b, 0, off) : NULL,
+                               c, n, t->idx ? &t->idx[k] : NULL);
+    if (t->idx) t->idx[k] += off;
+  }
+}
+
+// One partial row of results per (row chunk, column tile) pair.
+static void ax__reduce_cols_task(void* ctx, musz begin, musz end) {
+  AxReduceTask* t = (AxReduceTask*)ctx;
+  musz cols = t->a->cols;
+  for (musz k = begin; k < end; k++) {
+    musz chunk = k / t->ntiles;
+    musz j0 = (k % t->ntiles) * AX_REDUCE_TILE;
+    musz w = (cols - j0 < AX_REDUCE_TILE) ? cols - j0 : AX_REDUCE_TILE;
+    musz r0 = chunk * t->chunk;
+    musz r1 = (t->a->rows - r0 < t->chunk) ? t->a->rows : r0 + t->chunk;
+    musz off = chunk * cols + j0;
+    ax__reduce_cols(t->op, t->a, t->b, t->center ? t->center + j0 : NULL,
+                    r0, r1, j0, w, t->val + off, t->idx ? t->idx + off : NULL);
+  }
+}
+
+static bool ax__is_contiguous(const AxMatrix* m) {
+  return ax__unit_cols(m) && (m->stride == m->cols || m->rows <= 1);
+}
+
+// Core driver: writes one result per output slot to `res` (and `res_idx` for
+// extrema). `center` holds one value per output slot (used by SQDEV).
+static bool ax__reduce(AxReduceOp op, const AxMatrix* a, const AxMatrix* b,
+                       const axm_acc* center, AxAxis axis, axm_acc* res, musz* res_idx) {
+  bool extremum = AX_REDUCE_IS_EXTREMUM(op);
+  if (!ax__unit_cols(a) || (b && !ax__unit_cols(b))) {
+    const AxMatrix* ops[2] = { a, b };
+    AxMatrix at = ax_matrix_transpose_view(a), bt;
+    if (b) bt = ax_matrix_transpose_view(b);
+    if (ax__prefer_transpose(ops, 2) && ax__unit_cols(&at) && (!b || ax__unit_cols(&bt)) &&
+        !(axis == AX_AXIS_ALL && extremum)) {
+      // A transposed view reduces its storage along the other axis (flat
+      // extrema keep row-major tie-breaking, so they are staged below)
+      AxAxis swapped = (axis == AX_AXIS_0) ? AX_AXIS_1 : (axis == AX_AXIS_1) ? AX_AXIS_0 : axis;
+      return ax__reduce(op, &at, b ? &bt : NULL, center, swapped, res, res_idx);
+    }
+    // Other strided views are reduced from contiguous copies
+    AxMatrix as, bs;
+    bs.data = NULL;
+    const AxMatrix* au = ax__unit_stage(a, &as, true);
+    const AxMatrix* bu = b ? ax__unit_stage(b, &bs, true) : NULL;
+    bool ok = au && (!b || bu) && ax__reduce(op, au, bu, center, axis, res, res_idx);
+    ax__unit_release(&as, NULL);
+    ax__unit_release(&bs, NULL);
+    return ok;
+  }
+  AxReduceTask t = { .op = op, .a = a, .b = b, .center = center };
+  musz rows = a->rows;
+  musz cols = a->cols;
+
+  if (axis == AX_AXIS_1) {
+    t.center_step = 1;
+    t.val = res;
+    t.idx = res_idx;
+    musz grain = AX_REDUCE_CHUNK / cols + 1;
+    ax_parallel_for(rows, grain, ax__reduce_rows_task, &t);
+    return true;
+  }
+
+  musz tasks, width;
+  AxTaskFn fn;
+  if (axis == AX_AXIS_0) {
+    t.chunk = AX_REDUCE_CHUNK / cols;
+    if (t.chunk < AX_REDUCE_BLOCK) t.chunk = AX_REDUCE_BLOCK;
+    t.ntiles = (cols + AX_REDUCE_TILE - 1) / AX_REDUCE_TILE;
+    width = cols;
+    tasks = ((rows + t.chunk - 1) / t.chunk) * t.ntiles;
+    fn = ax__reduce_cols_task;
+  } else if (ax__is_contiguous(a) && (!b || ax__is_contiguous(b))) {
+    t.chunk = AX_REDUCE_CHUNK;
+    width = 1;
+    tasks = (rows * cols + t.chunk - 1) / t.chunk;
+    fn = ax__reduce_flat_task;
+  } else {
+    t.center_step = 0;
+    width = 1;
+    tasks = rows;
+    fn = ax__reduce_rows_task;
+  }
+
+  musz count = (axis == AX_AXIS_0) ? tasks / t.ntiles : tasks;
+  t.val = (axm_acc*) malloc(count * width * sizeof(axm_acc));
+  t.idx = extremum ? (musz*) malloc(count * width * sizeof(musz)) : NULL;
+  if (!t.val || (extremum && !t.idx)) {
+    free(t.val);
+    free(t.idx);
+    AX_LOG(AX_LOG_FATAL, "ax__reduce: failed to allocate partial results");
+    return false;
+  }
+  ax_parallel_for(tasks, 1, fn, &t);
+
+  if (fn == ax__reduce_rows_task && extremum) {
+    // Row-wise partials hold column indices; make them flat.
+    for (musz i = 0; i < rows; i++) t.idx[i] += i * cols;
+  }
+  ax__reduce_combine(op, t.val, t.idx, count, width);
+  for (musz k = 0; k < width; k++) {
+    res[k] = t.val[k];
+    if (res_idx) res_idx[k] = t.idx[k];
+  }
+  free(t.val);
+  free(t.idx);
+  return true;
+}
+
+static musz ax__reduce_len(const AxMatrix* a, AxAxis axis) {
+  switch (axis) {
+  case AX_AXIS_0: return a->cols;
+  case AX_AXIS_1: return a->rows;
+  default:        return 1;
+  }
+}
+
+static bool ax__reduce_check(const char* name, const AxMatrix* a, AxAxis axis) {
+  if (!a || !a->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: invalid matrix", name);
+    return false;
+  }
+  if (a->rows == 0 || a->cols == 0) {
+    AX_LOG(AX_LOG_FATAL, "%s: empty matrix", name);
+    return false;
+  }
+  if (axis != AX_AXIS_0 && axis != AX_AXIS_1 && axis != AX_AXIS_ALL) {
+    AX_LOG(AX_LOG_FATAL, "%s: invalid axis", name);
+    return false;
+  }
+  return true;
+}
+
+static bool ax__reduce_check_out(const char* name, const AxMatrix* out, musz len) {
+  if (!out || !out->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: invalid output vector", name);
+    return false;
+  }
+  if ((out->rows != 1 && out->cols != 1) || out->rows * out->cols != len) {
+    AX_LOG(AX_LOG_FATAL, "%s: output must be a vector of %zu elements", name, len);
+    return false;
+  }
+  return true;
+}
+
+static void ax__vec_store(AxMatrix* out, musz k, axm_acc v) {
+  if (out->rows == 1) {
+    ax_matrix_set(out, 0, k, v);
+  } else {
+    ax_matrix_set(out, k, 0, v);
+  }
+}
+
+// Shared body of the reductions that write values: runs `op`, applies the
+// optional post-processing and stores into `out`.
+typedef enum AxReducePost {
+  AX_REDUCE_POST_NONE,
+  AX_REDUCE_POST_MEAN,
+  AX_REDUCE_POST_SQRT
+} AxReducePost;
+
+static bool ax__reduce_values(const char* name, AxReduceOp op, AxReducePost post,
+                              const AxMatrix* a, const AxMatrix* b,
+                              const axm_acc* center, AxAxis axis, AxMatrix* out) {
+  if (!ax__reduce_check(name, a, axis)) return false;
+  musz len = ax__reduce_len(a, axis);
+  if (!ax__reduce_check_out(name, out, len)) return false;
+  axm_acc* res = (axm_acc*) malloc(len * sizeof(axm_acc));
+  if (!res) {
+    AX_LOG(AX_LOG_FATAL, "%s: failed to allocate results", name);
+    return false;
+  }
+  if (!ax__reduce(op, a, b, center, axis, res, NULL)) {
+    free(res);
+    return false;
+  }
+  axm_acc count = (axm_acc)(a->rows * a->cols / len);
+  for (musz k = 0; k < len; k++) {
+    axm_acc v = res[k];
+    if (post == AX_REDUCE_POST_MEAN) v /= count;
+    if (post == AX_REDUCE_POST_SQRT) v = sqrt(v);
+    ax__vec_store(out, k, v);
+  }
+  free(res);
+  return true;
+}
+
+bool ax_matrix_sum(const AxMatrix* a, AxAxis axis, AxMatrix* out) {
+  return ax__reduce_values("ax_matrix_sum", AX_REDUCE_SUM, AX_REDUCE_POST_NONE,
+                           a, NULL, NULL, axis, out);
+}
+
+bool ax_matrix_mean(const AxMatrix* a, AxAxis axis, AxMatrix* out) {
+  return ax__reduce_values("ax_matrix_mean", AX_REDUCE_SUM, AX_REDUCE_POST_MEAN,
+                           a, NULL, NULL, axis, out);
+}
+
+bool ax_matrix_var(const AxMatrix* a, AxAxis axis, AxMatrix* out) {
+  if (!ax__reduce_check("ax_matrix_var", a, axis)) return false;
+  musz len = ax__reduce_len(a, axis);
+  if (!ax__reduce_check_out("ax_matrix_var", out, len)) return false;
+  // Two passes: the mean first, then the centered sum of squares.
+  axm_acc* mean = (axm_acc*) malloc(len * sizeof(axm_acc));
+  if (!mean) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_var: failed to allocate means");
+    return false;
+  }
+  ax__reduce(AX_REDUCE_SUM, a, NULL, NULL, axis, mean, NULL);
+  axm_acc count = (axm_acc)(a->rows * a->cols / len);
+  for (musz k = 0; k < len; k++) mean[k] /= count;
+  bool ok = ax__reduce_values("ax_matrix_var", AX_REDUCE_SQDEV, AX_REDUCE_POST_MEAN,
+                              a, NULL, mean, axis, out);
+  free(mean);
+  return ok;
+}
+
+bool ax_matrix_min(const AxMatrix* a, AxAxis axis, AxMatrix* out) {
+  return ax__reduce_values("ax_matrix_min", AX_REDUCE_MIN, AX_REDUCE_POST_NONE,
+                           a, NULL, NULL, axis, out);
+}
+
+bool ax_matrix_max(const AxMatrix* a, AxAxis axis, AxMatrix* out) {
+  return ax__reduce_values("ax_matrix_max", AX_REDUCE_MAX, AX_REDUCE_POST_NONE,
+                           a, NULL, NULL, axis, out);
+}
+
+bool ax_matrix_norm(const AxMatrix* a, AxNorm norm, AxAxis axis, AxMatrix* out) {
+  switch (norm) {
+  case AX_NORM_L1:
+    return ax__reduce_values("ax_matrix_norm", AX_REDUCE_ABS, AX_REDUCE_POST_NONE,
+                             a, NULL, NULL, axis, out);
+  case AX_NORM_L2:
+    return ax__reduce_values("ax_matrix_norm", AX_REDUCE_SQ, AX_REDUCE_POST_SQRT,
+                             a, NULL, NULL, axis, out);
+  case AX_NORM_INF:
+    return ax__reduce_values("ax_matrix_norm", AX_REDUCE_MAXABS, AX_REDUCE_POST_NONE,
+                             a, NULL, NULL, axis, out);
+  }
+  AX_LOG(AX_LOG_FATAL, "ax_matrix_norm: invalid norm");
+  return false;
+}
+
+bool ax_matrix_dot(const AxMatrix* a, const AxMatrix* b, AxAxis axis, AxMatrix* out) {
+  if (!b || !b->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_dot: invalid matrix");
+    return false;
+  }
+  if (a && (a->rows != b->rows || a->cols != b->cols)) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_dot: dimension mismatch");
+    return false;
+  }
+  if (a && !ax__same_dtype("ax_matrix_dot", a, b)) return false;
+  return ax__reduce_values("ax_matrix_dot", AX_REDUCE_DOT, AX_REDUCE_POST_NONE,
+                           a, b, NULL, axis, out);
+}
+
+static bool ax__reduce_arg(const char* name, AxReduceOp op, const AxMatrix* a,
+                           AxAxis axis, musz* out) {
+  if (!ax__reduce_check(name, a, axis)) return false;
+  if (!out) {
+    AX_LOG(AX_LOG_FATAL, "%s: NULL output", name);
+    return false;
+  }
+  musz len = ax__reduce_len(a, axis);
+  axm_acc* res = (axm_acc*) malloc(len * sizeof(axm_acc));
+  if (!res) {
+    AX_LOG(AX_LOG_FATAL, "%s: failed to allocate results", name);
+    return false;
+  }
+  bool ok = ax__reduce(op, a, NULL, NULL, axis, res, out);
+  free(res);
+  return ok;
+}
+
+bool ax_matrix_argmin(const AxMatrix* a, AxAxis axis, musz* out) {
+  return ax__reduce_arg("ax_matrix_argmin", AX_REDUCE_MIN, a, axis, out);
+}
+
+bool ax_matrix_argmax(const AxMatrix* a, AxAxis axis, musz* out) {
+  return ax__reduce_arg("ax_matrix_argmax", AX_REDUCE_MAX, a, axis, out);
+}
+
+// ---------------------------------------------------------------------------
+// Transpose
+// ---------------------------------------------------------------------------
+
+#define AX_TRANSPOSE_LEAF 32  // Leaf size of the cache-oblivious recursion
+#define AX_TRANSPOSE_TASK 256 // Tile size handed to each parallel task
+
+// Transposes only move bits, so kernels are instantiated per element width:
+// X(width in bits, C type, micro-block size)
+#define AX__TRANSPOSE_WIDTHS(X)                 \
+  X(8,  mu8,  8)                                \
+  X(16, mu16, 8)                                \
+  X(32, mu32, 8)                                \
+  X(64, mu64, 4)
+
+// Micro-kernels: dst[j][i] = src[i][j] for one micro-block. 8x8 blocks of
+// 2- and 4-byte elements and 4x4 blocks of 8-byte elements stay in SSE/AVX
+// registers.
+static inline void ax__transpose_micro_8(const mu8* src, musz ss, mu8* dst, musz ds) {
+  for (musz i = 0; i < 8; i++) {
+    for (musz j = 0; j < 8; j++) dst[j * ds + i] = src[i * ss + j];
+  }
+}
+
+static inline void ax__transpose_micro_16(const mu16* src, musz ss, mu16* dst, musz ds) {
+#if defined(__SSE2__)
+  __m128i r0 = _mm_loadu_si128((const __m128i*)(const void*)(src + 0 * ss));
+  __m128i r1 = _mm_loadu_si128((const __m128i*)(const void*)(src + 1 * ss));
+  __m128i r2 = _mm_loadu_si128((const __m128i*)(const void*)(src + 2 * ss));
+  __m128i r3 = _mm_loadu_si128((const __m128i*)(const void*)(src + 3 * ss));
+  __m128i r4 = _mm_loadu_si128((const __m128i*)(const void*)(src + 4 * ss));
+  __m128i r5 = _mm_loadu_si128((const __m128i*)(const void*)(src + 5 * ss));
+  __m128i r6 = _mm_loadu_si128((const __m128i*)(const void*)(src + 6 * ss));
+  __m128i r7 = _mm_loadu_si128((const __m128i*)(const void*)(src + 7 * ss));
+  __m128i t0 = _mm_unpacklo_epi16(r0, r1), t1 = _mm_unpackhi_epi16(r0, r1);
+  __m128i t2 = _mm_unpacklo_epi16(r2, r3), t3 = _mm_unpackhi_epi16(r2, r3);
+  __m128i t4 = _mm_unpacklo_epi16(r4, r5), t5 = _mm_unpackhi_epi16(r4, r5);
+  __m128i t6 = _mm_unpacklo_epi16(r6, r7), t7 = _mm_unpackhi_epi16(r6, r7);
+  __m128i u0 = _mm_unpacklo_epi32(t0, t2), u1 = _mm_unpackhi_epi32(t0, t2);
+  __m128i u2 = _mm_unpacklo_epi32(t1, t3), u3 = _mm_unpackhi_epi32(t1, t3);
+  __m128i u4 = _mm_unpacklo_epi32(t4, t6), u5 = _mm_unpackhi_epi32(t4, t6);
+  __m128i u6 = _mm_unpacklo_epi32(t5, t7), u7 = _mm_unpackhi_epi32(t5, t7);
+  _mm_storeu_si128((__m128i*)(void*)(dst + 0 * ds), _mm_unpacklo_epi64(u0, u4));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 1 * ds), _mm_unpackhi_epi64(u0, u4));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 2 * ds), _mm_unpacklo_epi64(u1, u5));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 3 * ds), _mm_unpackhi_epi64(u1, u5));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 4 * ds), _mm_unpacklo_epi64(u2, u6));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 5 * ds), _mm_unpackhi_epi64(u2, u6));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 6 * ds), _mm_unpacklo_epi64(u3, u7));
+  _mm_storeu_si128((__m128i*)(void*)(dst + 7 * ds), _mm_unpackhi_epi64(u3, u7));
+#else
+  for (musz i = 0; i < 8; i++) {
+    for (musz j = 0; j < 8; j++) dst[j * ds + i] = src[i * ss + j];
+  }
+#endif
+}
+
+static inline void ax__transpose_micro_32(const mu32* src, musz ss, mu32* dst, musz ds) {
+#if defined(__AVX__)
+  const float* s = (const float*)(const void*)src;
+  float* d = (float*)(void*)dst;
+  __m256 r0 = _mm256_loadu_ps(s + 0 * ss), r1 = _mm256_loadu_ps(s + 1 * ss);
+  __m256 r2 = _mm256_loadu_ps(s + 2 * ss), r3 = _mm256_loadu_ps(s + 3 * ss);
+  __m256 r4 = _mm256_loadu_ps(s + 4 * ss), r5 = _mm256_loadu_ps(s + 5 * ss);
+  __m256 r6 = _mm256_loadu_ps(s + 6 * ss), r7 = _mm256_loadu_ps(s + 7 * ss);
+  __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+  __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+  __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+  __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+  __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  _mm256_storeu_ps(d + 0 * ds, _mm256_permute2f128_ps(u0, u4, 0x20));
+  _mm256_storeu_ps(d + 1 * ds, _mm256_permute2f128_ps(u1, u5, 0x20));
+  _mm256_storeu_ps(d + 2 * ds, _mm256_permute2f128_ps(u2, u6, 0x20));
+  _mm256_storeu_ps(d + 3 * ds, _mm256_permute2f128_ps(u3, u7, 0x20));
+  _mm256_storeu_ps(d + 4 * ds, _mm256_permute2f128_ps(u0, u4, 0x31));
+  _mm256_storeu_ps(d + 5 * ds, _mm256_permute2f128_ps(u1, u5, 0x31));
+  _mm256_storeu_ps(d + 6 * ds, _mm256_permute2f128_ps(u2, u6, 0x31));
+  _mm256_storeu_ps(d + 7 * ds, _mm256_permute2f128_ps(u3, u7, 0x31));
+#else
+  for (musz i = 0; i < 8; i++) {
+    for (musz j = 0; j < 8; j++) dst[j * ds + i] = src[i * ss + j];
+  }
+#endif
+}
+
+static inline void ax__transpose_micro_64(const mu64* src, musz ss, mu64* dst, musz ds) {
+#if defined(__AVX__)
+  const double* s = (const double*)(const void*)src;
+  double* d = (double*)(void*)dst;
+  __m256d r0 = _mm256_loadu_pd(s + 0 * ss), r1 = _mm256_loadu_pd(s + 1 * ss);
+  __m256d r2 = _mm256_loadu_pd(s + 2 * ss), r3 = _mm256_loadu_pd(s + 3 * ss);
+  __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+  __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+  _mm256_storeu_pd(d + 0 * ds, _mm256_permute2f128_pd(t0, t2, 0x20));
+  _mm256_storeu_pd(d + 1 * ds, _mm256_permute2f128_pd(t1, t3, 0x20));
+  _mm256_storeu_pd(d + 2 * ds, _mm256_permute2f128_pd(t0, t2, 0x31));
+  _mm256_storeu_pd(d + 3 * ds, _mm256_permute2f128_pd(t1, t3, 0x31));
+#else
+  for (musz i = 0; i < 4; i++) {
+    for (musz j = 0; j < 4; j++) dst[j * ds + i] = src[i * ss + j];
+  }
+#endif
+}
+
+#define AX__DEFINE_TRANSPOSE(w, ct, MB)                                 \
+  static void ax__transpose_leaf_##w(ct* dst, musz ds, const ct* src, musz ss, \
+                                     musz rows, musz cols) {            \
+    musz rf = rows - rows % MB;                                         \
+    musz cf = cols - cols % MB;                                         \
+    for (musz i = 0; i < rf; i += MB) {                                 \
+      for (musz j = 0; j < cf; j += MB) {                               \
+        ax__transpose_micro_##w(src + i * ss + j, ss, dst + j * ds + i, ds); \
+      }                                                                 \
+    }                                                                   \
+    /* Ragged edges */                                                  \
+    for (musz i = 0; i < rows; i++) {                                   \
+      for (musz j = (i < rf) ? cf : 0; j < cols; j++) dst[j * ds + i] = src[i * ss + j]; \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Cache-oblivious recursion: halve the longer side until a leaf. */ \
+  static void ax__transpose_rec_##w(ct* dst, musz ds, const ct* src, musz ss, \
+                                    musz rows, musz cols) {             \
+    if (rows <= AX_TRANSPOSE_LEAF && cols <= AX_TRANSPOSE_LEAF) {       \
+      ax__transpose_leaf_##w(dst, ds, src, ss, rows, cols);             \
+    } else if (rows >= cols) {                                          \
+      musz h = (rows / 2) & ~(musz)7;                                   \
+      ax__transpose_rec_##w(dst, ds, src, ss, h, cols);                 \
+      ax__transpose_rec_##w(dst + h, ds, src + h * ss, ss, rows - h, cols); \
+    } else {                                                            \
+      musz h = (cols / 2) & ~(musz)7;                                   \
+      ax__transpose_rec_##w(dst, ds, src, ss, rows, h);                 \
+      ax__transpose_rec_##w(dst + h * ds, ds, src + h, ss, rows, cols - h); \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  /* Swaps block `a` (rows x cols at (r, c)) with the transpose of its  \
+     mirror `b` (cols x rows at (c, r)). Diagonal blocks have a == b. */ \
+  static void ax__transpose_swap_##w(ct* a, ct* b, musz s, musz rows, musz cols) { \
+    ct tmp[MB * MB];                                                    \
+    musz rf = rows - rows % MB;                                         \
+    musz cf = cols - cols % MB;                                         \
+    for (musz i = 0; i < rf; i += MB) {                                 \
+      for (musz j = (a == b) ? i : 0; j < cf; j += MB) {                \
+        ct* pa = a + i * s + j;                                         \
+        ct* pb = b + j * s + i;                                         \
+        ax__transpose_micro_##w(pa, s, tmp, MB);                        \
+        if (pa != pb) ax__transpose_micro_##w(pb, s, pa, s);            \
+        for (musz r = 0; r < MB; r++) {                                 \
+          for (musz q = 0; q < MB; q++) pb[r * s + q] = tmp[r * MB + q]; \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    /* Ragged edges */                                                  \
+    for (musz i = 0; i < rows; i++) {                                   \
+      for (musz j = (i < rf) ? cf : 0; j < cols; j++) {                 \
+        if (a == b && j <= i) continue;                                 \
+        ct v = a[i * s + j];                                            \
+        a[i * s + j] = b[j * s + i];                                    \
+        b[j * s + i] = v;                                               \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX__TRANSPOSE_WIDTHS(AX__DEFINE_TRANSPOSE)
+
+static void ax__transpose_block(void* dst, musz ds, const void* src, musz ss,
+                                musz rows, musz cols, musz size) {
+  switch (size * 8) {
+#define AX__TRANSPOSE_CASE(w, ct, MB)                                   \
+  case w: ax__transpose_rec_##w((ct*)dst, ds, (const ct*)src, ss, rows, cols); return;
+    AX__TRANSPOSE_WIDTHS(AX__TRANSPOSE_CASE)
+#undef AX__TRANSPOSE_CASE
+  }
+  AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose: unsupported element size %zu", size);
+}
+
+static void ax__transpose_swap_block(void* a, void* b, musz s, musz rows, musz cols, musz size) {
+  switch (size * 8) {
+#define AX__TRANSPOSE_SWAP_CASE(w, ct, MB)                              \
+  case w: ax__transpose_swap_##w((ct*)a, (ct*)b, s, rows, cols); return;
+    AX__TRANSPOSE_WIDTHS(AX__TRANSPOSE_SWAP_CASE)
+#undef AX__TRANSPOSE_SWAP_CASE
+  }
+  AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose_inplace: unsupported element size %zu", size);
+}
+
+typedef struct AxTransposeTask {
+  AxMatrix* dest;
+  const AxMatrix* src;
+  musz ntiles; // Tiles per row of `src` (out-of-place) or per side (in-place)
+} AxTransposeTask;
+
+static void ax__transpose_task(void* ctx, musz begin, musz end) {
+  AxTransposeTask* t = (AxTransposeTask*)ctx;
+  for (musz k = begin; k < end; k++) {
+    musz i = (k / t->ntiles) * AX_TRANSPOSE_TASK;
+    musz j = (k % t->ntiles) * AX_TRANSPOSE_TASK;
+    musz rows = (t->src->rows - i < AX_TRANSPOSE_TASK) ? t->src->rows - i : AX_TRANSPOSE_TASK;
+    musz cols = (t->src->cols - j < AX_TRANSPOSE_TASK) ? t->src->cols - j : AX_TRANSPOSE_TASK;
+    ax__transpose_block(ax__at(t->dest, j, i), t->dest->stride,
+                        ax__at(t->src, i, j), t->src->stride, rows, cols,
+                        ax_dtype_size(t->src->dtype));
+  }
+}
+
+static void ax__transpose_run(AxMatrix* dest, const AxMatrix* src) {
+  AxTransposeTask t = { dest, src, (src->cols + AX_TRANSPOSE_TASK - 1) / AX_TRANSPOSE_TASK };
+  musz tasks = ((src->rows + AX_TRANSPOSE_TASK - 1) / AX_TRANSPOSE_TASK) * t.ntiles;
+  ax_parallel_for(tasks, 1, ax__transpose_task, &t);
+}
+
+bool ax_matrix_transpose_into(AxMatrix* dest, const AxMatrix* src) {
+  if (!dest || !src || !dest->data || !src->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose_into: null matrix");
+    return false;
+  }
+  if (dest->rows != src->cols || dest->cols != src->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose_into: dimension mismatch");
+    return false;
+  }
+  if (!ax__same_dtype("ax_matrix_transpose_into", dest, src)) return false;
+  if (!ax__unit_cols(dest) || !ax__unit_cols(src)) {
+    // Strided views: a copy from the transposed view picks the layout
+    AxMatrix v = ax_matrix_transpose_view(src);
+    return ax_matrix_copy(dest, &v);
+  }
+  ax__transpose_run(dest, src);
+  return true;
+}
+
+AxMatrix* ax_matrix_transpose(const AxMatrix* a, Arena* arena) {
+  if (!a) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose: null matrix");
+    return NULL;
+  }
+  AxMatrix* result = ax_matrix_create_dtype(a->cols, a->rows, a->dtype, arena);
+  if (!result) return NULL;
+  ax_matrix_transpose_into(result, a);
+  return result;
+}
+
+static void ax__transpose_inplace_task(void* ctx, musz begin, musz end) {
+  AxTransposeTask* t = (AxTransposeTask*)ctx;
+  AxMatrix* m = t->dest;
+  musz n = m->rows;
+  for (musz ti = begin; ti < end; ti++) {
+    musz i = ti * AX_TRANSPOSE_TASK;
+    musz rows = (n - i < AX_TRANSPOSE_TASK) ? n - i : AX_TRANSPOSE_TASK;
+    for (musz j = i; j < n; j += AX_TRANSPOSE_TASK) {
+      musz cols = (n - j < AX_TRANSPOSE_TASK) ? n - j : AX_TRANSPOSE_TASK;
+      ax__transpose_swap_block(ax__at(m, i, j), ax__at(m, j, i), m->stride, rows, cols,
+                               ax_dtype_size(m->dtype));
+    }
+  }
+}
+
+bool ax_matrix_transpose_inplace(AxMatrix* mat) {
+  if (!mat || !mat->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose_inplace: null matrix");
+    return false;
+  }
+  if (mat->rows != mat->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_transpose_inplace: matrix is not square");
+    return false;
+  }
+  if (!ax__unit_cols(mat)) {
+    // A transposed view swaps the same pairs; other strided views swap
+    // element by element
+    AxMatrix v = ax_matrix_transpose_view(mat);
+    if (ax__unit_cols(&v)) return ax_matrix_transpose_inplace(&v);
+    musz size = ax_dtype_size(mat->dtype);
+    mu8 tmp[8];
+    for (musz i = 0; i < mat->rows; i++) {
+      for (musz j = i + 1; j < mat->cols; j++) {
+        memcpy(tmp, ax__at(mat, i, j), size);
+        memcpy(ax__at(mat, i, j), ax__at(mat, j, i), size);
+        memcpy(ax__at(mat, j, i), tmp, size);
+      }
+    }
+    return true;
+  }
+  AxTransposeTask t = { mat, mat, (mat->rows + AX_TRANSPOSE_TASK - 1) / AX_TRANSPOSE_TASK };
+  ax_parallel_for(t.ntiles, 1, ax__transpose_inplace_task, &t);
+  return true;
+}
+
+
+// ---------------------------------------------------------------------------
+// Quantization
+// ---------------------------------------------------------------------------
+
+bool ax_quant_params_init(AxQuantParams* q, musz count, Arena* arena) {
+  if (!q || count == 0) {
+    AX_LOG(AX_LOG_FATAL, "ax_quant_params_init: invalid arguments");
+    return false;
+  }
+  musz bytes = count * (sizeof(mf32) + sizeof(mi32));
+  mu8* mem;
+  if (arena) {
+    mem = (mu8*) ax_alloc(arena, bytes);
+  } else {
+    AX_LOG(AX_LOG_INFO, "Arena is NULL, using malloc");
+    AX_LOG(AX_LOG_WARN, "DO NOT FORGET TO CALL ax_quant_params_destroy");
+    mem = (mu8*) malloc(bytes);
+  }
+  if (!mem) {
+    AX_LOG(AX_LOG_FATAL, "ax_quant_params_init: failed to allocate parameters");
+    return false;
+  }
+  q->count = count;
+  q->scale = (mf32*)mem;
+  q->zero_point = (mi32*)(mem + count * sizeof(mf32));
+  q->data_owner = (arena == NULL);
+  for (musz k = 0; k < count; k++) {
+    q->scale[k] = 1.0f;
+    q->zero_point[k] = 0;
+  }
+  return true;
+}
+
+void ax_quant_params_destroy(AxQuantParams* q) {
+  if (!q) return;
+  if (q->data_owner) {
+    free(q->scale);
+  }
+  q->scale = NULL;
+  q->zero_point = NULL;
+  q->count = 0;
+}
+
+static bool ax__quant_range(AxDType dtype, mi32* qmin, mi32* qmax) {
+  switch (dtype) {
+  case AX_I8: *qmin = -128; *qmax = 127; return true;
+  case AX_U8: *qmin = 0;    *qmax = 255; return true;
+  default:    return false;
+  }
+}
+
+// Entry of `q` that applies to row (or column) i
+static inline musz ax__quant_index(const AxQuantParams* q, musz i) {
+  return q->count == 1 ? 0 : i;
+}
+
+static bool ax__quant_check(const char* name, const AxQuantParams* q, musz count) {
+  if (!q || !q->scale || !q->zero_point || (q->count != 1 && q->count != count)) {
+    AX_LOG(AX_LOG_FATAL, "%s: quantization parameters must have 1 or %zu entries", name, count);
+    return false;
+  }
+  return true;
+}
+
+bool ax_quant_params_fit(AxQuantParams* q, const AxMatrix* src, AxDType dtype, bool symmetric) {
+  mi32 qmin, qmax;
+  if (!ax__quant_range(dtype, &qmin, &qmax)) {
+    AX_LOG(AX_LOG_FATAL, "ax_quant_params_fit: target dtype must be i8 or u8");
+    return false;
+  }
+  if (!src || !src->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_quant_params_fit: invalid matrix");
+    return false;
+  }
+  if (!ax__quant_check("ax_quant_params_fit", q, src->rows)) return false;
+  musz len = q->count;
+  mf64* bounds = (mf64*) malloc(2 * len * sizeof(mf64));
+  if (!bounds) {
+    AX_LOG(AX_LOG_FATAL, "ax_quant_params_fit: failed to allocate bounds");
+    return false;
+  }
+  AxMatrix lo = { len, 1, 1, 1, bounds, AX_F64, false };
+  AxMatrix hi = { len, 1, 1, 1, bounds + len, AX_F64, false };
+  AxAxis axis = (len == 1) ? AX_AXIS_ALL : AX_AXIS_1;
+  if (!ax_matrix_min(src, axis, &lo) || !ax_matrix_max(src, axis, &hi)) {
+    free(bounds);
+    return false;
+  }
+  for (musz k = 0; k < len; k++) {
+    double l = fmin(bounds[k], 0.0);
+    double h = fmax(bounds[len + k], 0.0);
+    double scale;
+    double zp;
+    if (symmetric) {
+      scale = fmax(-l, h) / 127.0;
+      zp = (qmin + qmax + 1) / 2;
+    } else {
+      scale = (h - l) / (double)(qmax - qmin);
+      zp = (scale > 0) ? (double)qmin - nearbyint(l / scale) : 0.0;
+    }
+    if (!(scale > 0)) scale = 1.0; // All zeros
+    q->scale[k] = (mf32)scale;
+    q->zero_point[k] = (mi32)fmin(fmax(zp, qmin), qmax);
+  }
+  free(bounds);
+  return true;
+}
+
+typedef struct AxQuantTask {
+  AxMatrix* dest;
+  const AxMatrix* src;
+  const AxQuantParams* q;
+  mi32 qmin;
+  mi32 qmax;
+} AxQuantTask;
+
+static void ax__quantize_task(void* ctx, musz begin, musz end) {
+  AxQuantTask* t = (AxQuantTask*)ctx;
+  AxConvertFn load = ax__convert_fn(AX_F32, t->src->dtype);
+  mf32 lo = (mf32)t->qmin;
+  mf32 hi = (mf32)t->qmax;
+  mf32 buf[AX_HALF_BLOCK];
+  for (musz i = begin; i < end; i++) {
+    musz k = ax__quant_index(t->q, i);
+    mf32 scale = t->q->scale[k];
+    mf32 zp = (mf32)t->q->zero_point[k];
+    musz cols = t->src->cols;
+    for (musz off = 0; off < cols; off += AX_HALF_BLOCK) {
+      musz len = (cols - off < AX_HALF_BLOCK) ? cols - off : AX_HALF_BLOCK;
+      load(buf, ax__at(t->src, i, off), len);
+      for (musz j = 0; j < len; j++) {
+        mf32 v = nearbyintf(buf[j] / scale) + zp;
+        buf[j] = (v < lo) ? lo : (v > hi) ? hi : v;
+      }
+      if (t->dest->dtype == AX_U8) {
+        mu8* out = (mu8*)ax__at(t->dest, i, off);
+        for (musz j = 0; j < len; j++) out[j] = (mu8)buf[j];
+      } else {
+        mi8* out = (mi8*)ax__at(t->dest, i, off);
+        for (musz j = 0; j < len; j++) out[j] = (mi8)buf[j];
+      }
+    }
+  }
+}
+
+static void ax__dequantize_task(void* ctx, musz begin, musz end) {
+  AxQuantTask* t = (AxQuantTask*)ctx;
+  AxConvertFn store = ax__convert_fn(t->dest->dtype, AX_F32);
+  mf32 buf[AX_HALF_BLOCK];
+  for (musz i = begin; i < end; i++) {
+    musz k = ax__quant_index(t->q, i);
+    mf32 scale = t->q->scale[k];
+    mi32 zp = t->q->zero_point[k];
+    musz cols = t->src->cols;
+    for (musz off = 0; off < cols; off += AX_HALF_BLOCK) {
+      musz len = (cols - off < AX_HALF_BLOCK) ? cols - off : AX_HALF_BLOCK;
+      if (t->src->dtype == AX_U8) {
+        const mu8* x = (const mu8*)ax__at(t->src, i, off);
+        for (musz j = 0; j < len; j++) buf[j] = (mf32)(x[j] - zp) * scale;
+      } else {
+        const mi8* x = (const mi8*)ax__at(t->src, i, off);
+        for (musz j = 0; j < len; j++) buf[j] = (mf32)(x[j] - zp) * scale;
+      }
+      store(ax__at(t->dest, i, off), buf, len);
+    }
+  }
+}
+
+// Shared checks of quantize/dequantize: `qm` is the i8/u8 side, `fm` the
+// floating-point side.
+static bool ax__quant_io_check(const char* name, const AxMatrix* qm, const AxMatrix* fm,
+                               const AxQuantParams* q, mi32* qmin, mi32* qmax) {
+  if (!qm || !fm || !qm->data || !fm->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null matrix", name);
+    return false;
+  }
+  if (qm->rows != fm->rows || qm->cols != fm->cols) {
+    AX_LOG(AX_LOG_FATAL, "%s: dimension mismatch", name);
+    return false;
+  }
+  AxDType compute;
+  if (!ax__quant_range(qm->dtype, qmin, qmax) || !ax__gemm_compute_dtype(fm->dtype, &compute)) {
+    AX_LOG(AX_LOG_FATAL, "%s: unsupported dtypes (%s, %s)", name,
+           ax_dtype_name(qm->dtype), ax_dtype_name(fm->dtype));
+    return false;
+  }
+  return ax__quant_check(name, q, qm->rows);
+}
+
+bool ax_matrix_quantize(AxMatrix* dest, const AxMatrix* src, const AxQuantParams* q) {
+  AxQuantTask t = { dest, src, q, 0, 0 };
+  if (!ax__quant_io_check("ax_matrix_quantize", dest, src, q, &t.qmin, &t.qmax)) return false;
+  if (src->cols == 0) return true;
+  // The row kernels need unit-stride rows, so strided views are staged
+  AxMatrix ss, ds;
+  t.src = ax__unit_stage(src, &ss, true);
+  t.dest = ax__unit_stage(dest, &ds, false);
+  bool ok = t.src && t.dest;
+  if (ok) ax_parallel_for(src->rows, 65536 / src->cols + 1, ax__quantize_task, &t);
+  ax__unit_release(&ss, NULL);
+  ax__unit_release(&ds, ok ? dest : NULL);
+  return ok;
+}
+
+bool ax_matrix_dequantize(AxMatrix* dest, const AxMatrix* src, const AxQuantParams* q) {
+  AxQuantTask t = { dest, src, q, 0, 0 };
+  if (!ax__quant_io_check("ax_matrix_dequantize", src, dest, q, &t.qmin, &t.qmax)) return false;
+  if (src->cols == 0) return true;
+  // The row kernels need unit-stride rows, so strided views are staged
+  AxMatrix ss, ds;
+  t.src = ax__unit_stage(src, &ss, true);
+  t.dest = ax__unit_stage(dest, &ds, false);
+  bool ok = t.src && t.dest;
+  if (ok) ax_parallel_for(src->rows, 65536 / src->cols + 1, ax__dequantize_task, &t);
+  ax__unit_release(&ss, NULL);
+  ax__unit_release(&ds, ok ? dest : NULL);
+  return ok;
+}
+
+// Int8 GEMM. Same blocking as the float engine: op(b) is packed one
+// KC x NC panel at a time and shared by every task. With AVX512-VNNI, vpdpbusd
+// multiplies unsigned bytes of `a` by signed bytes of `b` four k-steps at a
+// time, so i8 `a` is shifted by +128, u8 `b` by -128, and the shifts and zero
+// points are corrected afterwards from row sums of `a` and column sums of
+// `b`:
+//   sum (a' - alpha_i)(b' - beta_j) = sum a'b' - beta_j rs_i - alpha_i cs_j + k alpha_i beta_j
+// The row sums cover all of k, so they are taken up front; column sums
+// build up over the slices of k of each panel.
+// Without VNNI the zero points are subtracted while packing to 16 bits and
+// pmaddwd handles two k-steps at a time (pmaddubsw would saturate u8*i8 pair
+// sums at 16 bits).
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+#define AX_QGEMM_VNNI 1
+#define AX_QGEMM_MR 8
+#define AX_QGEMM_NR 32
+#define AX_QGEMM_KU 4 // k-steps per 32-bit lane
+typedef mu8 ax__qa_t;
+typedef mi8 ax__qb_t;
+#else
+#define AX_QGEMM_VNNI 0
+#if defined(__AVX2__)
+#define AX_QGEMM_MR 6
+#define AX_QGEMM_NR 16
+#else
+#define AX_QGEMM_MR 4
+#define AX_QGEMM_NR 8
+#endif
+#define AX_QGEMM_KU 2
+typedef mi16 ax__qa_t;
+typedef mi16 ax__qb_t;
+#endif
+
+#define AX_QGEMM_KC 1024 // Multiple of AX_QGEMM_KU
+#define AX_QGEMM_NC 4096 // Multiple of AX_QGEMM_NR
+#define AX_QGEMM_MC (AX_QGEMM_MR * 16)
+
+// acc (MR x NR) = packed a (kq groups of MR x KU) times packed b (kq groups
+// of KU x NR)
+static inline void ax__qgemm_micro(musz kq, const ax__qa_t* a, const ax__qb_t* b, mi32* acc) {
+  enum { MR = AX_QGEMM_MR, NR = AX_QGEMM_NR, KU = AX_QGEMM_KU };
+#if AX_QGEMM_VNNI
+  __m512i c[MR][2];
+  for (int i = 0; i < MR; i++) c[i][0] = c[i][1] = _mm512_setzero_si512();
+  for (musz g = 0; g < kq; g++, a += MR * KU, b += NR * KU) {
+    __m512i b0 = _mm512_loadu_si512((const void*)b);
+    __m512i b1 = _mm512_loadu_si512((const void*)(b + 16 * KU));
+    for (int i = 0; i < MR; i++) {
+      mi32 w;
+      memcpy(&w, a + i * KU, sizeof(w));
+      __m512i av = _mm512_set1_epi32(w);
+      c[i][0] = _mm512_dpbusd_epi32(c[i][0], av, b0);
+      c[i][1] = _mm512_dpbusd_epi32(c[i][1], av, b1);
+    }
+  }
+  for (int i = 0; i < MR; i++) {
+    _mm512_storeu_si512((void*)(acc + i * NR), c[i][0]);
+    _mm512_storeu_si512((void*)(acc + i * NR + 16), c[i][1]);
+  }
+#elif defined(__AVX2__)
+  __m256i c[MR][2];
+  for (int i = 0; i < MR; i++) c[i][0] = c[i][1] = _mm256_setzero_si256();
+  for (musz g = 0; g < kq; g++, a += MR * KU, b += NR * KU) {
+    __m256i b0 = _mm256_loadu_si256((const __m256i*)(const void*)b);
+    __m256i b1 = _mm256_loadu_si256((const __m256i*)(const void*)(b + 8 * KU));
+    for (int i = 0; i < MR; i++) {
+      mi32 w;
+      memcpy(&w, a + i * KU, sizeof(w));
+      __m256i av = _mm256_set1_epi32(w);
+      c[i][0] = _mm256_add_epi32(c[i][0], _mm256_madd_epi16(av, b0));
+      c[i][1] = _mm256_add_epi32(c[i][1], _mm256_madd_epi16(av, b1));
+    }
+  }
+  for (int i = 0; i < MR; i++) {
+    _mm256_storeu_si256((__m256i*)(void*)(acc + i * NR), c[i][0]);
+    _mm256_storeu_si256((__m256i*)(void*)(acc + i * NR + 8), c[i][1]);
+  }
+#else
+  mi32 c[MR][NR] = {{0}};
+  for (musz g = 0; g < kq; g++, a += MR * KU, b += NR * KU) {
+    for (int i = 0; i < MR; i++) {
+      for (int j = 0; j < NR; j++) {
+        c[i][j] += a[i * KU] * b[j * KU] + a[i * KU + 1] * b[j * KU + 1];
+      }
+    }
+  }
+  memcpy(acc, c, sizeof(c));
+#endif
+}
+
+typedef struct AxQGemmTask {
+  const AxMatrix* a;
+  const AxQuantParams* qa;
+  const AxMatrix* b;
+  const AxQuantParams* qb;
+  AxTranspose tb;
+  AxMatrix* c;
+  musz m, n, k;
+  musz jc, nc;     // Current panel of columns
+  musz pc, kc;     // Current slice of k
+  ax__qb_t* bp;    // Packed panel of op(b), one NR-wide sliver after another
+  mi32* csum;      // Column sums of the panel so far (VNNI only)
+  mi32* rsum;      // Row sums of the shifted `a` (VNNI only)
+  musz ngroups;    // Column groups of the panel
+  musz group;      // NR slivers per column group
+  atomic_bool ok;
+} AxQGemmTask;
+
+static inline mi32 ax__q8_load(const AxMatrix* m, musz i, musz j) {
+  const void* p = ax__at(m, i, j);
+  return (m->dtype == AX_I8) ? *(const mi8*)p : *(const mu8*)p;
+}
+
+static inline mi32 ax__quant_zero(const AxQuantParams* q, musz i) {
+  return q ? q->zero_point[ax__quant_index(q, i)] : 0;
+}
+
+// MR-tall slivers of rows [i0, i0 + mc) and k-steps [p0, p0 + kc) of `a`
+static void ax__qgemm_pack_a(const AxQGemmTask* t, musz i0, musz mc, musz p0, musz kc,
+                             ax__qa_t* ap) {
+  enum { MR = AX_QGEMM_MR, KU = AX_QGEMM_KU };
+  musz kcp = (kc + KU - 1) / KU * KU;
+  bool is_signed = t->a->dtype == AX_I8;
+  musz cs = t->a->col_stride;
+  for (musz ir = 0; ir < mc; ir += MR, ap += MR * kcp) {
+    for (musz i = 0; i < MR; i++) {
+      bool valid = ir + i < mc;
+      const mu8* x = valid ? (const mu8*)ax__at(t->a, i0 + ir + i, p0) : NULL;
+#if AX_QGEMM_VNNI
+      for (musz p = 0; p < kcp; p++) {
+        mu8 v = (valid && p < kc) ? (mu8)(is_signed ? x[p * cs] ^ 0x80u : x[p * cs]) : 0;
+        ap[(p / KU) * MR * KU + i * KU + p % KU] = v;
+      }
+#else
+      mi32 z = valid ? ax__quant_zero(t->qa, i0 + ir + i) : 0;
+      for (musz p = 0; p < kcp; p++) {
+        mi32 v = (valid && p < kc) ? (is_signed ? (mi8)x[p * cs] : x[p * cs]) - z : 0;
+        ap[(p / KU) * MR * KU + i * KU + p % KU] = (ax__qa_t)v;
+      }
+#endif
+    }
+  }
+}
+
+// Row sums over all of k of the shifted `a` (VNNI only)
+static void ax__qgemm_rsum_task(void* ctx, musz begin, musz end) {
+  AxQGemmTask* t = (AxQGemmTask*)ctx;
+  bool is_signed = t->a->dtype == AX_I8;
+  musz cs = t->a->col_stride;
+  for (musz i = begin; i < end; i++) {
+    const mu8* x = (const mu8*)ax__at(t->a, i, 0);
+    mi32 sum = 0;
+    for (musz p = 0; p < t->k; p++) sum += (mi32)(is_signed ? x[p * cs] ^ 0x80u : x[p * cs]);
+    t->rsum[i] = sum;
+  }
+}
+
+// Slivers of the current panel over the current slice of k; column sums
+// start on the first slice and add up over the rest
+static void ax__qgemm_pack_b_task(void* ctx, musz begin, musz end) {
+  AxQGemmTask* t = (AxQGemmTask*)ctx;
+  enum { NR = AX_QGEMM_NR, KU = AX_QGEMM_KU };
+  bool is_signed = t->b->dtype == AX_I8;
+  musz kcp = (t->kc + KU - 1) / KU * KU;
+  for (musz q = begin; q < end; q++) {
+    ax__qb_t* bp = t->bp + q * NR * kcp;
+    for (musz j = 0; j < NR; j++) {
+      musz jp = q * NR + j, col = t->jc + jp;
+      bool valid = jp < t->nc;
+#if AX_QGEMM_VNNI
+      mi32 shift = is_signed ? 0 : 128;
+#else
+      mi32 shift = valid ? ax__quant_zero(t->qb, col) : 0;
+#endif
+      mi32 sum = 0;
+      for (musz p = 0; p < kcp; p++) {
+        mi32 v = 0;
+        if (valid && p < t->kc) {
+          musz kk = t->pc + p;
+          v = (t->tb == AX_TRANS ? ax__q8_load(t->b, col, kk) : ax__q8_load(t->b, kk, col)) - shift;
+        }
+        bp[(p / KU) * NR * KU + j * KU + p % KU] = (ax__qb_t)v;
+        sum += v;
+      }
+      if (valid) t->csum[jp] = (t->pc == 0 ? 0 : t->csum[jp]) + sum;
+    }
+  }
+  (void)is_signed;
+}
+
+static void ax__qgemm_store(const AxQGemmTask* t, musz i0, musz j0, musz mr, musz nr,
+                            const mi32* acc, bool first, bool last) {
+  enum { NR = AX_QGEMM_NR };
+  musz cs = t->c->col_stride;
+  for (musz i = 0; i < mr; i++) {
+    mi32* ci = &AX_MATRIX_AT_T(mi32, *t->c, i0 + i, j0);
+#if AX_QGEMM_VNNI
+    mi64 alpha = (t->a->dtype == AX_I8 ? 128 : 0) + ax__quant_zero(t->qa, i0 + i);
+#endif
+    for (musz j = 0; j < nr; j++) {
+      mi64 v = acc[i * NR + j];
+      if (!first) v += ci[j * cs];
+#if AX_QGEMM_VNNI
+      if (last) {
+        mi64 beta = ax__quant_zero(t->qb, j0 + j) - (t->b->dtype == AX_U8 ? 128 : 0);
+        v += -beta * t->rsum[i0 + i] - alpha * t->csum[j0 + j - t->jc] + (mi64)t->k * alpha * beta;
+      }
+#else
+      (void)last;
+#endif
+      ci[j * cs] = (mi32)v;
+    }
+  }
+}
+
+// One (row block, column group) pair of the current panel and slice per index
+static void ax__qgemm_block_task(void* ctx, musz begin, musz end) {
+  AxQGemmTask* t = (AxQGemmTask*)ctx;
+  enum { MR = AX_QGEMM_MR, NR = AX_QGEMM_NR, KU = AX_QGEMM_KU, MC = AX_QGEMM_MC };
+  ax__qa_t* ap = (ax__qa_t*)ax__gemm_buffer(0, MC * AX_QGEMM_KC * sizeof(ax__qa_t));
+  if (!ap) {
+    atomic_store(&t->ok, false);
+    return;
+  }
+  mi32 acc[MR * NR];
+  musz slivers = (t->nc + NR - 1) / NR;
+  musz kcp = (t->kc + KU - 1) / KU * KU;
+  bool first = (t->pc == 0);
+  bool last = (t->pc + t->kc == t->k);
+  for (musz q = begin; q < end; q++) {
+    musz i0 = (q / t->ngroups) * MC;
+    musz mc = (t->m - i0 < MC) ? t->m - i0 : MC;
+    musz s0 = (q % t->ngroups) * t->group;
+    musz s1 = (s0 + t->group < slivers) ? s0 + t->group : slivers;
+    ax__qgemm_pack_a(t, i0, mc, t->pc, t->kc, ap);
+    for (musz sq = s0; sq < s1; sq++) {
+      musz jp = sq * NR;
+      musz nr = (t->nc - jp < NR) ? t->nc - jp : NR;
+      const ax__qb_t* bp = t->bp + sq * NR * kcp;
+      for (musz ir = 0; ir < mc; ir += MR) {
+        musz mr = (mc - ir < MR) ? mc - ir : MR;
+        ax__qgemm_micro(kcp / KU, ap + ir * kcp, bp, acc);
+        ax__qgemm_store(t, i0 + ir, t->jc + jp, mr, nr, acc, first, last);
+      }
+    }
+  }
+}
+
+static bool ax__quant_zero_check(const char* name, const AxQuantParams* q, musz count, AxDType dtype) {
+  if (!q) return true;
+  if (!ax__quant_check(name, q, count)) return false;
+  mi32 qmin = 0, qmax = 0;
+  ax__quant_range(dtype, &qmin, &qmax);
+  for (musz k = 0; k < q->count; k++) {
+    if (q->zero_point[k] < qmin || q->zero_point[k] > qmax) {
+      AX_LOG(AX_LOG_FATAL, "%s: zero point %d out of range for %s", name,
+             (int)q->zero_point[k], ax_dtype_name(dtype));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ax_matrix_gemm_q8(const AxMatrix* a, const AxQuantParams* qa,
+                       const AxMatrix* b, const AxQuantParams* qb, AxTranspose tb,
+                       AxMatrix* c) {
+  enum { NR = AX_QGEMM_NR, KU = AX_QGEMM_KU, MC = AX_QGEMM_MC };
+  if (!a || !b || !c || !a->data || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_q8: null matrix");
+    return false;
+  }
+  mi32 lo, hi;
+  if (!ax__quant_range(a->dtype, &lo, &hi) || !ax__quant_range(b->dtype, &lo, &hi) ||
+      c->dtype != AX_I32) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_q8: unsupported dtypes (%s, %s -> %s)",
+           ax_dtype_name(a->dtype), ax_dtype_name(b->dtype), ax_dtype_name(c->dtype));
+    return false;
+  }
+  musz m = a->rows;
+  musz k = a->cols;
+  musz kb = (tb == AX_TRANS) ? b->cols : b->rows;
+  musz n = (tb == AX_TRANS) ? b->rows : b->cols;
+  if (k != kb || c->rows != m || c->cols != n) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_q8: dimension mismatch");
+    return false;
+  }
+  if (!ax__quant_zero_check("ax_matrix_gemm_q8", qa, m, a->dtype) ||
+      !ax__quant_zero_check("ax_matrix_gemm_q8", qb, n, b->dtype)) {
+    return false;
+  }
+  if (m == 0 || n == 0) return true;
+  if (k == 0) {
+    for (musz i = 0; i < m; i++) {
+      if (ax__unit_cols(c)) {
+        memset(ax__at(c, i, 0), 0, n * sizeof(mi32));
+      } else {
+        for (musz j = 0; j < n; j++) *(mi32*)ax__at(c, i, j) = 0;
+      }
+    }
+    return true;
+  }
+
+  AxQGemmTask t = { .a = a, .qa = qa, .b = b, .qb = qb, .tb = tb, .c = c, .m = m, .n = n, .k = k };
+  atomic_init(&t.ok, true);
+  musz nc_max = n < AX_QGEMM_NC ? n : AX_QGEMM_NC;
+  musz kc_max = k < AX_QGEMM_KC ? (k + KU - 1) / KU * KU : AX_QGEMM_KC;
+  musz packed = (nc_max + NR - 1) / NR * NR * kc_max * sizeof(ax__qb_t);
+  mu8* buf = (mu8*)ax__gemm_buffer(1, packed + nc_max * sizeof(mi32));
+  t.rsum = AX_QGEMM_VNNI ? (mi32*)malloc(m * sizeof(mi32)) : NULL;
+  if (!buf || (AX_QGEMM_VNNI && !t.rsum)) {
+    free(t.rsum);
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_q8: failed to allocate packing buffers");
+    return false;
+  }
+  t.bp = (ax__qb_t*)buf;
+  t.csum = (mi32*)(buf + packed);
+  if (t.rsum) ax_parallel_for(m, 65536 / k + 1, ax__qgemm_rsum_task, &t);
+
+  musz nblocks = (m + MC - 1) / MC;
+  for (t.jc = 0; t.jc < n; t.jc += AX_QGEMM_NC) {
+    t.nc = (n - t.jc < AX_QGEMM_NC) ? n - t.jc : AX_QGEMM_NC;
+    musz slivers = (t.nc + NR - 1) / NR;
+    musz want = (2 * ax_thread_count() + nblocks - 1) / nblocks;
+    if (want > slivers) want = slivers;
+    t.group = (slivers + want - 1) / want;
+    t.ngroups = (slivers + t.group - 1) / t.group;
+    for (t.pc = 0; t.pc < k; t.pc += AX_QGEMM_KC) {
+      t.kc = (k - t.pc < AX_QGEMM_KC) ? k - t.pc : AX_QGEMM_KC;
+      ax_parallel_for(slivers, 4, ax__qgemm_pack_b_task, &t);
+      ax_parallel_for(nblocks * t.ngroups, 1, ax__qgemm_block_task, &t);
+    }
+  }
+  free(t.rsum);
+  if (!atomic_load(&t.ok)) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_gemm_q8: failed to allocate packing buffers");
+    return false;
+  }
+  return true;
+}
+
+#endif /* AXMATRIX_IMPLEMENTATION */
+
+#endif /* AXMATRIX_H_ */
@@ -0,0 +1,1362 @@
+/*
+  ================================================================================
+  AxSparse: Sparse Matrices (STB-Style Single-Header Library)
+  ================================================================================
+  - COO (coordinate) matrices for assembly, CSR and CSC for computation.
+  - Every array is allocated from an Arena and released with it.
+  - Values are f32 or f64. Dense operands are AxMatrix objects of the same
+  dtype, so results can feed straight back into the axmatrix kernels.
+  - Products are split across the thread pool by rows, in chunks holding
+  roughly equal numbers of nonzeros. Each output row is computed by a single
+  thread, so results do not depend on the thread count.
+  - Row and column indices are 32-bit; row/column pointers are musz.
+  - Dependencies:
+  - "axmatrix.h"    (AxMatrix, AxDType; pulls in axalloc.h and axthread.h)
+  - <stdlib.h>      (malloc, free for temporary buffers)
+  - <string.h>      (memcpy, memset)
+  - <stdatomic.h>   (failure flag shared by parallel tasks)
+  - <immintrin.h>   (AVX2 / AVX-512 gathers for SELL-C-sigma, when enabled)
+  ================================================================================
+  USAGE:
+  1) In **one** C or C++ file where you want the implementation, do:
+  #define AXSPARSE_IMPLEMENTATION
+  #include "axsparse.h"
+
+  2) In any other files that need to use the library, just include "axsparse.h"
+  without defining AXSPARSE_IMPLEMENTATION.
+  ================================================================================
+*/
+
+#ifndef AXSPARSE_H_
+#define AXSPARSE_H_
+
+#include "axmatrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // Coordinate format. Entries may be pushed in any order and may repeat;
+  // repeated coordinates are summed when converting to CSR.
+  typedef struct AxSparseCOO {
+    musz rows;
+    musz cols;
+    musz nnz;
+    musz capacity;
+    mu32* row_idx;
+    mu32* col_idx;
+    void* values;
+    AxDType dtype;
+    Arena* arena; // Grows the arrays when a push finds them full
+  } AxSparseCOO;
+
+  // Compressed sparse row: the entries of row i are [row_ptr[i], row_ptr[i + 1]),
+  // sorted by column, without repeats.
+  typedef struct AxSparseCSR {
+    musz rows;
+    musz cols;
+    musz nnz;
+    musz* row_ptr; // rows + 1 entries
+    mu32* col_idx;
+    void* values;
+    AxDType dtype;
+  } AxSparseCSR;
+
+  // Compressed sparse column: the entries of column j are
+  // [col_ptr[j], col_ptr[j + 1]), sorted by row, without repeats.
+  typedef struct AxSparseCSC {
+    musz rows;
+    musz cols;
+    musz nnz;
+    musz* col_ptr; // cols + 1 entries
+    mu32* row_idx;
+    void* values;
+    AxDType dtype;
+  } AxSparseCSC;
+
+  // COO assembly. `capacity` is a hint; the arrays double when full (the
+  // old ones stay in the arena until it is destroyed).
+  bool ax_coo_init(AxSparseCOO* coo, musz rows, musz cols, musz capacity, AxDType dtype, Arena* arena);
+  bool ax_coo_push(AxSparseCOO* coo, musz i, musz j, double value);
+
+  // Conversions. `dest` takes its arrays from `arena`; `src` is unchanged.
+  // COO -> CSR runs in O(nnz + rows + cols): already sorted input is copied
+  // directly, anything else goes through a stable two-pass counting sort.
+  bool ax_csr_from_coo(AxSparseCSR* dest, const AxSparseCOO* src, Arena* arena);
+  bool ax_csc_from_csr(AxSparseCSC* dest, const AxSparseCSR* src, Arena* arena);
+  bool ax_csr_from_csc(AxSparseCSR* dest, const AxSparseCSC* src, Arena* arena);
+  // Keeps the entries of `src` that are not exactly zero
+  bool ax_csr_from_dense(AxSparseCSR* dest, const AxMatrix* src, Arena* arena);
+  // Scatters `src` into `dest` (same shape and dtype), zeroing the rest
+  bool ax_matrix_from_csr(AxMatrix* dest, const AxSparseCSR* src);
+
+  // Zero-copy transposes: the CSC arrays of A are the CSR arrays of A^T and
+  // vice versa
+  static inline AxSparseCSC ax_csr_transpose(const AxSparseCSR* a) {
+    return (AxSparseCSC){ a->cols, a->rows, a->nnz, a->row_ptr, a->col_idx, a->values, a->dtype };
+  }
+
+  static inline AxSparseCSR ax_csc_transpose(const AxSparseCSC* a) {
+    return (AxSparseCSR){ a->cols, a->rows, a->nnz, a->col_ptr, a->row_idx, a->values, a->dtype };
+  }
+
+  // y = alpha * A x + beta * y. `x` and `y` are row or column vectors with
+  // cols and rows elements; y is not read when beta == 0.
+  bool ax_csr_spmv(double alpha, const AxSparseCSR* a, const AxMatrix* x,
+                   double beta, AxMatrix* y);
+  // C = alpha * A B + beta * C, with B (cols x N) and C (rows x N) dense
+  bool ax_csr_spmm(double alpha, const AxSparseCSR* a, const AxMatrix* b,
+                   double beta, AxMatrix* c);
+  // C = A B for sparse A (MxK) and B (KxN) of one dtype, row by row. A
+  // symbolic pass sizes every output row so `c` takes exactly its nonzeros
+  // from `arena`; rows are split across threads by multiply-add count and
+  // accumulate in a hash table, or a dense array when they are dense enough.
+  // Columns come out sorted; sums that cancel to zero are kept.
+  bool ax_csr_spgemm(const AxSparseCSR* a, const AxSparseCSR* b, AxSparseCSR* c, Arena* arena);
+
+  // Semiring products: y = A (x) x and C = A (x) B over `sr`, or combined
+  // into y / C with the semiring's add when `accumulate`. Entries absent from
+  // A stand for the semiring's identity (e.g. +inf, no edge, for min-plus).
+  bool ax_csr_semiring_spmv(AxSemiring sr, const AxSparseCSR* a, const AxMatrix* x,
+                            bool accumulate, AxMatrix* y);
+  bool ax_csr_semiring_spmm(AxSemiring sr, const AxSparseCSR* a, const AxMatrix* b,
+                            bool accumulate, AxMatrix* c);
+
+  // Sliced ELLPACK (SELL-C-sigma). Rows are sorted by length (longest first)
+  // within windows of `sigma` rows and cut into slices of `chunk` rows; each
+  // slice is padded to its longest row and stored column-major, so one SIMD
+  // lane group walks `chunk` rows in lockstep and gathers x. Row r of the
+  // layout is row perm[r] of the matrix.
+  typedef struct AxSparseSELL {
+    musz rows;
+    musz cols;
+    musz nnz;        // Stored entries, excluding padding
+    musz chunk;      // C: rows per slice
+    musz sigma;      // Sorting window in rows
+    musz nslices;
+    musz* slice_ptr; // nslices + 1 offsets into col_idx / values
+    mu32* perm;      // rows entries
+    mu32* col_idx;   // Padding repeats the row's last column (or 0)
+    void* values;    // Padding is 0
+    AxDType dtype;
+  } AxSparseSELL;
+
+  // Rows per slice that fills the widest SIMD register for `dtype`
+  musz ax_sell_default_chunk(AxDType dtype);
+
+  // `chunk` (at most 256) of 0 picks ax_sell_default_chunk(); `sigma` of 0
+  // picks 32 * chunk, and 1 keeps the original row order. Columns must fit
+  // in int32 (the gather index type).
+  bool ax_sell_from_csr(AxSparseSELL* dest, const AxSparseCSR* src, musz chunk, musz sigma,
+                        Arena* arena);
+  // y = alpha * A x + beta * y, as ax_csr_spmv
+  bool ax_sell_spmv(double alpha, const AxSparseSELL* a, const AxMatrix* x,
+                    double beta, AxMatrix* y);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+   ------------------------------------------------------------------------------
+   Implementation
+   ------------------------------------------------------------------------------
+*/
+#ifdef AXSPARSE_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Minimum number of multiply-adds per parallel chunk
+#define AX_SPARSE_GRAIN 16384
+
+static bool ax__sparse_dtype_check(const char* fn, AxDType dtype) {
+  switch (dtype) {
+#define AX__SPARSE_DTYPE_CASE(T, s, ct) case AX_##T: return true;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_DTYPE_CASE)
+#undef AX__SPARSE_DTYPE_CASE
+  default: break;
+  }
+  AX_LOG(AX_LOG_FATAL, "%s: unsupported dtype %s", fn, ax_dtype_name(dtype));
+  return false;
+}
+
+// Arena allocation that also succeeds for empty arrays
+static void* ax__sparse_alloc(Arena* arena, musz size) {
+  void* p = ax_alloc(arena, size ? size : 1);
+  if (!p) AX_LOG(AX_LOG_FATAL, "axsparse: failed to allocate %zu bytes", size);
+  return p;
+}
+
+static void ax__sparse_store(AxDType dtype, void* values, musz k, double value) {
+  switch (dtype) {
+#define AX__SPARSE_STORE_CASE(T, s, ct) case AX_##T: ((ct*)values)[k] = (ct)value; break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_STORE_CASE)
+#undef AX__SPARSE_STORE_CASE
+  default: break;
+  }
+}
+
+bool ax_coo_init(AxSparseCOO* coo, musz rows, musz cols, musz capacity, AxDType dtype, Arena* arena) {
+  if (!coo || !arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_coo_init: null matrix or arena");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_coo_init", dtype)) return false;
+  if (rows > UINT32_MAX || cols > UINT32_MAX) {
+    AX_LOG(AX_LOG_FATAL, "ax_coo_init: %zux%zu exceeds 32-bit indices", rows, cols);
+    return false;
+  }
+  *coo = (AxSparseCOO){ rows, cols, 0, 0, NULL, NULL, NULL, dtype, arena };
+  if (capacity == 0) return true;
+  coo->row_idx = (mu32*)ax__sparse_alloc(arena, capacity * sizeof(mu32));
+  coo->col_idx = (mu32*)ax__sparse_alloc(arena, capacity * sizeof(mu32));
+  coo->values = ax__sparse_alloc(arena, capacity * ax_dtype_size(dtype));
+  if (!coo->row_idx || !coo->col_idx || !coo->values) return false;
+  coo->capacity = capacity;
+  return true;
+}
+
+bool ax_coo_push(AxSparseCOO* coo, musz i, musz j, double value) {
+  if (!coo || !coo->arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_coo_push: uninitialized matrix");
+    return false;
+  }
+  if (i >= coo->rows || j >= coo->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_coo_push: (%zu, %zu) out of bounds for %zux%zu", i, j, coo->rows, coo->cols);
+    return false;
+  }
+  if (coo->nnz == coo->capacity) {
+    musz esz = ax_dtype_size(coo->dtype);
+    musz capacity = coo->capacity ? 2 * coo->capacity : 64;
+    mu32* row_idx = (mu32*)ax__sparse_alloc(coo->arena, capacity * sizeof(mu32));
+    mu32* col_idx = (mu32*)ax__sparse_alloc(coo->arena, capacity * sizeof(mu32));
+    void* values = ax__sparse_alloc(coo->arena, capacity * esz);
+    if (!row_idx || !col_idx || !values) return false;
+    if (coo->nnz) {
+      memcpy(row_idx, coo->row_idx, coo->nnz * sizeof(mu32));
+      memcpy(col_idx, coo->col_idx, coo->nnz * sizeof(mu32));
+      memcpy(values, coo->values, coo->nnz * esz);
+    }
+    coo->row_idx = row_idx;
+    coo->col_idx = col_idx;
+    coo->values = values;
+    coo->capacity = capacity;
+  }
+  coo->row_idx[coo->nnz] = (mu32)i;
+  coo->col_idx[coo->nnz] = (mu32)j;
+  ax__sparse_store(coo->dtype, coo->values, coo->nnz, value);
+  coo->nnz++;
+  return true;
+}
+
+// Typed kernels. The COO merge walks the entries in (row, col) order, given
+// by `perm` or by the input itself, and sums repeats into one slot.
+#define AX__SPARSE_DEFINE(T, s, ct)                                     \
+  static void ax__coo_merge_##s(const AxSparseCOO* src, const musz* perm, \
+                                mu32* col_idx, void* values) {          \
+    const ct* x = (const ct*)src->values;                               \
+    ct* v = (ct*)values;                                                \
+    musz u = 0, prev = 0;                                               \
+    for (musz t = 0; t < src->nnz; t++) {                               \
+      musz k = perm ? perm[t] : t;                                      \
+      if (t > 0 && src->row_idx[k] == src->row_idx[prev] &&             \
+          src->col_idx[k] == src->col_idx[prev]) {                      \
+        v[u - 1] += x[k];                                               \
+      } else {                                                          \
+        col_idx[u] = src->col_idx[k];                                   \
+        v[u++] = x[k];                                                  \
+      }                                                                 \
+      prev = k;                                                         \
+    }                                                                   \
+  }                                                                     \
+  /* Scatters the compressed rows of `src` into compressed columns */   \
+  static void ax__sparse_transpose_##s(musz n, const musz* ptr, const mu32* idx, \
+                                       const void* values, musz* next,  \
+                                       mu32* out_idx, void* out_values) { \
+    const ct* x = (const ct*)values;                                    \
+    ct* y = (ct*)out_values;                                            \
+    for (musz i = 0; i < n; i++) {                                      \
+      for (musz k = ptr[i]; k < ptr[i + 1]; k++) {                      \
+        musz p = next[idx[k]]++;                                        \
+        out_idx[p] = (mu32)i;                                           \
+        y[p] = x[k];                                                    \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+  static musz ax__dense_count_##s(const AxMatrix* m, musz i) {          \
+    const ct* x = (const ct*)m->data + i * m->stride;                   \
+    musz c = 0;                                                         \
+    for (musz j = 0; j < m->cols; j++) c += (x[j] != 0);                \
+    return c;                                                           \
+  }                                                                     \
+  static void ax__dense_gather_##s(const AxMatrix* m, musz i, mu32* col_idx, \
+                                   void* values) {                      \
+    const ct* x = (const ct*)m->data + i * m->stride;                   \
+    ct* v = (ct*)values;                                                \
+    musz u = 0;                                                         \
+    for (musz j = 0; j < m->cols; j++) {                                \
+      if (x[j] != 0) {                                                  \
+        col_idx[u] = (mu32)j;                                           \
+        v[u++] = x[j];                                                  \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+  static void ax__csr_scatter_##s(const AxSparseCSR* a, AxMatrix* m,    \
+                                  musz r0, musz r1) {                   \
+    const ct* v = (const ct*)a->values;                                 \
+    for (musz i = r0; i < r1; i++) {                                    \
+      ct* y = (ct*)m->data + i * m->stride;                             \
+      memset(y, 0, m->cols * sizeof(ct));                               \
+      for (musz k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++) {        \
+        y[a->col_idx[k]] = v[k];                                        \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__SPARSE_DEFINE)
+#undef AX__SPARSE_DEFINE
+
+bool ax_csr_from_coo(AxSparseCSR* dest, const AxSparseCOO* src, Arena* arena) {
+  if (!dest || !src || !arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_from_coo: null matrix or arena");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_csr_from_coo", src->dtype)) return false;
+  musz nnz = src->nnz;
+  const mu32* r = src->row_idx;
+  const mu32* c = src->col_idx;
+
+  bool sorted = true;
+  for (musz k = 1; k < nnz && sorted; k++) {
+    sorted = r[k - 1] < r[k] || (r[k - 1] == r[k] && c[k - 1] <= c[k]);
+  }
+
+  // Sort by column, then stably by row
+  musz* perm = NULL;
+  if (!sorted) {
+    musz ncount = (src->rows > src->cols ? src->rows : src->cols) + 1;
+    perm = (musz*)malloc(nnz * sizeof(musz));
+    musz* tmp = (musz*)malloc(nnz * sizeof(musz));
+    musz* count = (musz*)malloc(ncount * sizeof(musz));
+    if (!perm || !tmp || !count) {
+      AX_LOG(AX_LOG_FATAL, "ax_csr_from_coo: failed to allocate sort buffers");
+      free(perm);
+      free(tmp);
+      free(count);
+      return false;
+    }
+    memset(count, 0, (src->cols + 1) * sizeof(musz));
+    for (musz k = 0; k < nnz; k++) count[c[k] + 1]++;
+    for (musz j = 0; j < src->cols; j++) count[j + 1] += count[j];
+    for (musz k = 0; k < nnz; k++) tmp[count[c[k]]++] = k;
+    memset(count, 0, (src->rows + 1) * sizeof(musz));
+    for (musz k = 0; k < nnz; k++) count[r[k] + 1]++;
+    for (musz i = 0; i < src->rows; i++) count[i + 1] += count[i];
+    for (musz t = 0; t < nnz; t++) perm[count[r[tmp[t]]]++] = tmp[t];
+    free(tmp);
+    free(count);
+  }
+
+  musz* row_ptr = (musz*)ax__sparse_alloc(arena, (src->rows + 1) * sizeof(musz));
+  if (!row_ptr) {
+    free(perm);
+    return false;
+  }
+  memset(row_ptr, 0, (src->rows + 1) * sizeof(musz));
+  musz unique = 0, prev = 0;
+  for (musz t = 0; t < nnz; t++) {
+    musz k = perm ? perm[t] : t;
+    if (t == 0 || r[k] != r[prev] || c[k] != c[prev]) {
+      row_ptr[r[k] + 1]++;
+      unique++;
+    }
+    prev = k;
+  }
+  for (musz i = 0; i < src->rows; i++) row_ptr[i + 1] += row_ptr[i];
+
+  mu32* col_idx = (mu32*)ax__sparse_alloc(arena, unique * sizeof(mu32));
+  void* values = ax__sparse_alloc(arena, unique * ax_dtype_size(src->dtype));
+  if (!col_idx || !values) {
+    free(perm);
+    return false;
+  }
+  switch (src->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__coo_merge_##s(src, perm, col_idx, values); break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+  free(perm);
+  *dest = (AxSparseCSR){ src->rows, src->cols, unique, row_ptr, col_idx, values, src->dtype };
+  return true;
+}
+
+bool ax_csc_from_csr(AxSparseCSC* dest, const AxSparseCSR* src, Arena* arena) {
+  if (!dest || !src || !arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_csc_from_csr: null matrix or arena");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_csc_from_csr", src->dtype)) return false;
+  musz* col_ptr = (musz*)ax__sparse_alloc(arena, (src->cols + 1) * sizeof(musz));
+  mu32* row_idx = (mu32*)ax__sparse_alloc(arena, src->nnz * sizeof(mu32));
+  void* values = ax__sparse_alloc(arena, src->nnz * ax_dtype_size(src->dtype));
+  musz* next = (musz*)malloc((src->cols + 1) * sizeof(musz));
+  if (!col_ptr || !row_idx || !values || !next) {
+    AX_LOG(AX_LOG_FATAL, "ax_csc_from_csr: failed to allocate");
+    free(next);
+    return false;
+  }
+  memset(col_ptr, 0, (src->cols + 1) * sizeof(musz));
+  for (musz k = 0; k < src->nnz; k++) col_ptr[src->col_idx[k] + 1]++;
+  for (musz j = 0; j < src->cols; j++) col_ptr[j + 1] += col_ptr[j];
+  memcpy(next, col_ptr, (src->cols + 1) * sizeof(musz));
+  switch (src->dtype) {
+#define AX__SPARSE_CASE(T, s, ct)                                       \
+    case AX_##T:                                                        \
+      ax__sparse_transpose_##s(src->rows, src->row_ptr, src->col_idx, src->values, \
+                               next, row_idx, values);                  \
+      break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+  free(next);
+  *dest = (AxSparseCSC){ src->rows, src->cols, src->nnz, col_ptr, row_idx, values, src->dtype };
+  return true;
+}
+
+bool ax_csr_from_csc(AxSparseCSR* dest, const AxSparseCSC* src, Arena* arena) {
+  if (!dest || !src) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_from_csc: null matrix");
+    return false;
+  }
+  // CSC(A) is CSR(A^T); its CSC is CSR(A)
+  AxSparseCSR t = ax_csc_transpose(src);
+  AxSparseCSC out;
+  if (!ax_csc_from_csr(&out, &t, arena)) return false;
+  *dest = ax_csc_transpose(&out);
+  return true;
+}
+
+bool ax_csr_from_dense(AxSparseCSR* dest, const AxMatrix* src, Arena* arena) {
+  if (!dest || !src || !arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_from_dense: null matrix or arena");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_csr_from_dense", src->dtype)) return false;
+  if (src->rows > UINT32_MAX || src->cols > UINT32_MAX) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_from_dense: %zux%zu exceeds 32-bit indices", src->rows, src->cols);
+    return false;
+  }
+  if (!ax__unit_cols(src)) {
+    // Rows are scanned through pointers, so column-strided views are staged
+    AxMatrix ss;
+    const AxMatrix* su = ax__unit_stage(src, &ss, true);
+    bool ok = su && ax_csr_from_dense(dest, su, arena);
+    ax__unit_release(&ss, NULL);
+    return ok;
+  }
+  musz* row_ptr = (musz*)ax__sparse_alloc(arena, (src->rows + 1) * sizeof(musz));
+  if (!row_ptr) return false;
+  row_ptr[0] = 0;
+  for (musz i = 0; i < src->rows; i++) {
+    musz c = 0;
+    switch (src->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: c = ax__dense_count_##s(src, i); break;
+      AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+    default: break;
+    }
+    row_ptr[i + 1] = row_ptr[i] + c;
+  }
+  musz nnz = row_ptr[src->rows];
+  musz esz = ax_dtype_size(src->dtype);
+  mu32* col_idx = (mu32*)ax__sparse_alloc(arena, nnz * sizeof(mu32));
+  void* values = ax__sparse_alloc(arena, nnz * esz);
+  if (!col_idx || !values) return false;
+  for (musz i = 0; i < src->rows; i++) {
+    mu32* ci = col_idx + row_ptr[i];
+    void* vi = (mu8*)values + row_ptr[i] * esz;
+    switch (src->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__dense_gather_##s(src, i, ci, vi); break;
+      AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+    default: break;
+    }
+  }
+  *dest = (AxSparseCSR){ src->rows, src->cols, nnz, row_ptr, col_idx, values, src->dtype };
+  return true;
+}
+
+// Splits `rows` rows into chunks of roughly equal work, counting row i as
+// (ptr[i + 1] - ptr[i] + 1) * width for a nondecreasing prefix array `ptr`
+// (row pointers, or running flop counts). Returns the chunk count and a
+// malloc'd array of count + 1 row boundaries, or 0 on allocation failure.
+static musz ax__sparse_partition(const musz* ptr, musz rows, musz width, musz** bounds) {
+  musz total = ptr[rows] - ptr[0] + rows;
+  musz nchunks = total * width / AX_SPARSE_GRAIN + 1;
+  musz limit = 4 * ax_thread_count();
+  if (nchunks > limit) nchunks = limit;
+  if (nchunks > rows) nchunks = rows ? rows : 1;
+  musz* b = (musz*)malloc((nchunks + 1) * sizeof(musz));
+  if (!b) {
+    AX_LOG(AX_LOG_FATAL, "axsparse: failed to allocate row partition");
+    return 0;
+  }
+  b[0] = 0;
+  for (musz c = 1; c < nchunks; c++) {
+    // First row i with ptr[i] - ptr[0] + i >= c * total / nchunks
+    musz target = c * total / nchunks;
+    musz lo = b[c - 1], hi = rows;
+    while (lo < hi) {
+      musz mid = lo + (hi - lo) / 2;
+      if (ptr[mid] - ptr[0] + mid < target) lo = mid + 1;
+      else hi = mid;
+    }
+    b[c] = lo;
+  }
+  b[nchunks] = rows;
+  *bounds = b;
+  return nchunks;
+}
+
+typedef struct AxSpTask {
+  AxSemiring sr;     // Semiring products only
+  const AxSparseCSR* a;
+  const AxMatrix* x; // Dense right-hand side (vector or matrix)
+  AxMatrix* y;       // Dense result
+  musz xinc, yinc;   // Vector element strides (SpMV only)
+  double alpha, beta;
+  const musz* bounds;
+} AxSpTask;
+
+#define AX__SPARSE_DEFINE_PRODUCTS(T, s, ct)                            \
+  static void ax__csr_spmv_##s(const AxSpTask* t, musz r0, musz r1) {   \
+    const AxSparseCSR* a = t->a;                                        \
+    const ct* v = (const ct*)a->values;                                 \
+    const ct* x = (const ct*)t->x->data;                                \
+    ct* y = (ct*)t->y->data;                                            \
+    ct alpha = (ct)t->alpha, beta = (ct)t->beta;                        \
+    musz xinc = t->xinc;                                                \
+    for (musz i = r0; i < r1; i++) {                                    \
+      ct acc = 0;                                                       \
+      for (musz k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++) {        \
+        acc += v[k] * x[a->col_idx[k] * xinc];                          \
+      }                                                                 \
+      ct* yi = y + i * t->yinc;                                         \
+      *yi = (t->beta == 0) ? alpha * acc : alpha * acc + beta * *yi;    \
+    }                                                                   \
+  }                                                                     \
+  static void ax__csr_spmm_##s(const AxSpTask* t, musz r0, musz r1) {   \
+    const AxSparseCSR* a = t->a;                                        \
+    const AxMatrix* b = t->x;                                           \
+    AxMatrix* c = t->y;                                                 \
+    const ct* v = (const ct*)a->values;                                 \
+    ct alpha = (ct)t->alpha, beta = (ct)t->beta;                        \
+    musz n = c->cols;                                                   \
+    for (musz i = r0; i < r1; i++) {                                    \
+      ct* ci = (ct*)c->data + i * c->stride;                            \
+      if (t->beta == 0) memset(ci, 0, n * sizeof(ct));                  \
+      else if (t->beta != 1) for (musz j = 0; j < n; j++) ci[j] *= beta; \
+      for (musz k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++) {        \
+        const ct* bk = (const ct*)b->data + a->col_idx[k] * b->stride;  \
+        ct w = alpha * v[k];                                            \
+        for (musz j = 0; j < n; j++) ci[j] += w * bk[j];                \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__SPARSE_DEFINE_PRODUCTS)
+#undef AX__SPARSE_DEFINE_PRODUCTS
+
+static void ax__csr_spmv_task(void* ctx, musz begin, musz end) {
+  const AxSpTask* t = (const AxSpTask*)ctx;
+  musz r0 = t->bounds[begin], r1 = t->bounds[end];
+  switch (t->a->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__csr_spmv_##s(t, r0, r1); break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+}
+
+static void ax__csr_spmm_task(void* ctx, musz begin, musz end) {
+  const AxSpTask* t = (const AxSpTask*)ctx;
+  musz r0 = t->bounds[begin], r1 = t->bounds[end];
+  switch (t->a->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__csr_spmm_##s(t, r0, r1); break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+}
+
+static void ax__csr_scatter_task(void* ctx, musz begin, musz end) {
+  const AxSpTask* t = (const AxSpTask*)ctx;
+  musz r0 = t->bounds[begin], r1 = t->bounds[end];
+  switch (t->a->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__csr_scatter_##s(t->a, t->y, r0, r1); break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+}
+
+// Runs `fn` over nnz-balanced row chunks of t->a
+static bool ax__csr_run(AxSpTask* t, musz width, AxTaskFn fn) {
+  musz* bounds = NULL;
+  musz nchunks = ax__sparse_partition(t->a->row_ptr, t->a->rows, width, &bounds);
+  if (!nchunks) return false;
+  t->bounds = bounds;
+  ax_parallel_for(nchunks, 1, fn, t);
+  free(bounds);
+  return true;
+}
+
+bool ax_matrix_from_csr(AxMatrix* dest, const AxSparseCSR* src) {
+  if (!dest || !src || !dest->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_from_csr: null matrix");
+    return false;
+  }
+  if (dest->rows != src->rows || dest->cols != src->cols) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_from_csr: dimension mismatch");
+    return false;
+  }
+  if (dest->dtype != src->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_matrix_from_csr: dtype mismatch (%s vs %s)",
+           ax_dtype_name(dest->dtype), ax_dtype_name(src->dtype));
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_matrix_from_csr", src->dtype)) return false;
+  // Rows are filled through pointers, so a column-strided `dest` is staged
+  AxMatrix ds;
+  AxSpTask t = { AX_SEMIRING_PLUS_TIMES, src, NULL, ax__unit_stage(dest, &ds, false), 0, 0, 0, 0, NULL };
+  bool ok = t.y && ax__csr_run(&t, dest->cols / 8 + 1, ax__csr_scatter_task);
+  ax__unit_release(&ds, ok ? dest : NULL);
+  return ok;
+}
+
+// Element stride of a 1xN or Nx1 vector holding `n` elements, or 0 if `v`
+// is not one
+static musz ax__sparse_vector_inc(const AxMatrix* v, musz n) {
+  if (v->rows == 1 && v->cols == n) return v->col_stride;
+  if (v->cols == 1 && v->rows == n) return v->stride;
+  return 0;
+}
+
+// Semiring products. `beta` of the task is 1 when accumulating, else 0.
+
+#define AX__SPARSE_SEMIRING_LIST_WITH(X, ...)   \
+  X(PLUS_TIMES, plus_times, __VA_ARGS__)        \
+  X(MIN_PLUS,   min_plus,   __VA_ARGS__)        \
+  X(MAX_PLUS,   max_plus,   __VA_ARGS__)        \
+  X(MAX_MIN,    max_min,    __VA_ARGS__)        \
+  X(OR_AND,     or_and,     __VA_ARGS__)
+
+#define AX__SPARSE_DEFINE_SR(SRT, sr, T, s, ct)                         \
+  static void ax__csr_spmv_##sr##_##s(const AxSpTask* t, musz r0, musz r1) { \
+    const AxSparseCSR* a = t->a;                                        \
+    const ct* v = (const ct*)a->values;                                 \
+    const ct* x = (const ct*)t->x->data;                                \
+    ct* y = (ct*)t->y->data;                                            \
+    for (musz i = r0; i < r1; i++) {                                    \
+      ct acc = AX_SEMIRING_ZERO_##sr(ct);                               \
+      for (musz k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++) {        \
+        ct term = AX_SEMIRING_MUL_##sr(ct, v[k], x[a->col_idx[k] * t->xinc]); \
+        acc = AX_SEMIRING_ADD_##sr(ct, acc, term);                      \
+      }                                                                 \
+      ct* yi = y + i * t->yinc;                                         \
+      *yi = (t->beta == 0) ? acc : AX_SEMIRING_ADD_##sr(ct, *yi, acc);  \
+    }                                                                   \
+  }                                                                     \
+  static void ax__csr_spmm_##sr##_##s(const AxSpTask* t, musz r0, musz r1) { \
+    const AxSparseCSR* a = t->a;                                        \
+    const AxMatrix* b = t->x;                                           \
+    AxMatrix* c = t->y;                                                 \
+    const ct* v = (const ct*)a->values;                                 \
+    musz n = c->cols;                                                   \
+    for (musz i = r0; i < r1; i++) {                                    \
+      ct* ci = (ct*)c->data + i * c->stride;                            \
+      if (t->beta == 0) {                                               \
+        for (musz j = 0; j < n; j++) ci[j] = AX_SEMIRING_ZERO_##sr(ct); \
+      }                                                                 \
+      for (musz k = a->row_ptr[i]; k < a->row_ptr[i + 1]; k++) {        \
+        const ct* bk = (const ct*)b->data + a->col_idx[k] * b->stride;  \
+        ct w = v[k];                                                    \
+        for (musz j = 0; j < n; j++) {                                  \
+          ci[j] = AX_SEMIRING_ADD_##sr(ct, ci[j], AX_SEMIRING_MUL_##sr(ct, w, bk[j])); \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }
+
+#define AX__SPARSE_DEFINE_SR_TYPES(T, s, ct) AX__SPARSE_SEMIRING_LIST_WITH(AX__SPARSE_DEFINE_SR, T, s, ct)
+AX_DTYPE_FLOAT_LIST(AX__SPARSE_DEFINE_SR_TYPES)
+#undef AX__SPARSE_DEFINE_SR_TYPES
+#undef AX__SPARSE_DEFINE_SR
+
+#define AX__SPARSE_SR_CASE_spmv(SRT, sr)                                \
+  case AX_SEMIRING_##SRT:                                               \
+    if (f64) ax__csr_spmv_##sr##_f64(t, r0, r1);                        \
+    else ax__csr_spmv_##sr##_f32(t, r0, r1);                            \
+    break;
+#define AX__SPARSE_SR_CASE_spmm(SRT, sr)                                \
+  case AX_SEMIRING_##SRT:                                               \
+    if (f64) ax__csr_spmm_##sr##_f64(t, r0, r1);                        \
+    else ax__csr_spmm_##sr##_f32(t, r0, r1);                            \
+    break;
+#define AX__SPARSE_SR_TASK(kind)                                        \
+  static void ax__csr_sr_##kind##_task(void* ctx, musz begin, musz end) { \
+    const AxSpTask* t = (const AxSpTask*)ctx;                           \
+    musz r0 = t->bounds[begin], r1 = t->bounds[end];                    \
+    bool f64 = t->a->dtype == AX_F64;                                   \
+    switch (t->sr) {                                                    \
+      AX_SEMIRING_LIST(AX__SPARSE_SR_CASE_##kind)                       \
+    }                                                                   \
+  }
+
+AX__SPARSE_SR_TASK(spmv)
+AX__SPARSE_SR_TASK(spmm)
+#undef AX__SPARSE_SR_TASK
+#undef AX__SPARSE_SR_CASE_spmv
+#undef AX__SPARSE_SR_CASE_spmm
+
+// Operand checks shared by the SpMV entry points; fills in the vector strides
+static bool ax__csr_spmv_check(const char* fn, AxSpTask* t) {
+  const AxSparseCSR* a = t->a;
+  const AxMatrix* x = t->x;
+  const AxMatrix* y = t->y;
+  if (!a || !x || !y || !x->data || !y->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null operand", fn);
+    return false;
+  }
+  if (!ax__sparse_dtype_check(fn, a->dtype)) return false;
+  if (x->dtype != a->dtype || y->dtype != a->dtype) {
+    AX_LOG(AX_LOG_FATAL, "%s: dtype mismatch (%s, %s, %s)", fn, ax_dtype_name(a->dtype),
+           ax_dtype_name(x->dtype), ax_dtype_name(y->dtype));
+    return false;
+  }
+  t->xinc = ax__sparse_vector_inc(x, a->cols);
+  t->yinc = ax__sparse_vector_inc(y, a->rows);
+  if ((!t->xinc && a->cols) || (!t->yinc && a->rows)) {
+    AX_LOG(AX_LOG_FATAL, "%s: %zux%zu matrix with %zux%zu x and %zux%zu y", fn,
+           a->rows, a->cols, x->rows, x->cols, y->rows, y->cols);
+    return false;
+  }
+  return true;
+}
+
+// Operand checks shared by the SpMM entry points
+static bool ax__csr_spmm_check(const char* fn, const AxSpTask* t) {
+  const AxSparseCSR* a = t->a;
+  const AxMatrix* b = t->x;
+  const AxMatrix* c = t->y;
+  if (!a || !b || !c || !b->data || !c->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null operand", fn);
+    return false;
+  }
+  if (!ax__sparse_dtype_check(fn, a->dtype)) return false;
+  if (b->dtype != a->dtype || c->dtype != a->dtype) {
+    AX_LOG(AX_LOG_FATAL, "%s: dtype mismatch (%s, %s, %s)", fn, ax_dtype_name(a->dtype),
+           ax_dtype_name(b->dtype), ax_dtype_name(c->dtype));
+    return false;
+  }
+  if (b->rows != a->cols || c->rows != a->rows || c->cols != b->cols) {
+    AX_LOG(AX_LOG_FATAL, "%s: %zux%zu times %zux%zu into %zux%zu", fn,
+           a->rows, a->cols, b->rows, b->cols, c->rows, c->cols);
+    return false;
+  }
+  return true;
+}
+
+// Runs an SpMM task on contiguous stand-ins for column-strided operands,
+// since the kernels walk rows of b and c through pointers; c is written back
+static bool ax__csr_spmm_run(AxSpTask* t, AxTaskFn fn) {
+  const AxMatrix* b = t->x;
+  AxMatrix* c = t->y;
+  AxMatrix bs, cs;
+  t->x = ax__unit_stage(b, &bs, true);
+  t->y = ax__unit_stage(c, &cs, t->beta != 0.0);
+  bool ok = t->x && t->y && ax__csr_run(t, c->cols, fn);
+  ax__unit_release(&bs, NULL);
+  ax__unit_release(&cs, ok ? c : NULL);
+  return ok;
+}
+
+bool ax_csr_spmv(double alpha, const AxSparseCSR* a, const AxMatrix* x,
+                 double beta, AxMatrix* y) {
+  AxSpTask t = { AX_SEMIRING_PLUS_TIMES, a, x, y, 0, 0, alpha, beta, NULL };
+  if (!ax__csr_spmv_check("ax_csr_spmv", &t)) return false;
+  if (a->rows == 0) return true;
+  return ax__csr_run(&t, 1, ax__csr_spmv_task);
+}
+
+bool ax_csr_spmm(double alpha, const AxSparseCSR* a, const AxMatrix* b,
+                 double beta, AxMatrix* c) {
+  AxSpTask t = { AX_SEMIRING_PLUS_TIMES, a, b, c, 0, 0, alpha, beta, NULL };
+  if (!ax__csr_spmm_check("ax_csr_spmm", &t)) return false;
+  if (a->rows == 0 || c->cols == 0) return true;
+  return ax__csr_spmm_run(&t, ax__csr_spmm_task);
+}
+
+bool ax_csr_semiring_spmv(AxSemiring sr, const AxSparseCSR* a, const AxMatrix* x,
+                          bool accumulate, AxMatrix* y) {
+  AxSpTask t = { sr, a, x, y, 0, 0, 1.0, accumulate ? 1.0 : 0.0, NULL };
+  if (!ax__csr_spmv_check("ax_csr_semiring_spmv", &t)) return false;
+  if (a->rows == 0) return true;
+  return ax__csr_run(&t, 1, ax__csr_sr_spmv_task);
+}
+
+bool ax_csr_semiring_spmm(AxSemiring sr, const AxSparseCSR* a, const AxMatrix* b,
+                          bool accumulate, AxMatrix* c) {
+  AxSpTask t = { sr, a, b, c, 0, 0, 1.0, accumulate ? 1.0 : 0.0, NULL };
+  if (!ax__csr_spmm_check("ax_csr_semiring_spmm", &t)) return false;
+  if (a->rows == 0 || c->cols == 0) return true;
+  return ax__csr_spmm_run(&t, ax__csr_sr_spmm_task);
+}
+
+// SpGEMM
+
+// Rows whose multiply-add count times this reaches the column count of B
+// accumulate into a dense array; sparser rows use a hash table
+#define AX_SPGEMM_DENSE_RATIO 16
+#define AX_SPGEMM_EMPTY UINT32_MAX
+
+typedef struct AxSpgemmTask {
+  const AxSparseCSR* a;
+  const AxSparseCSR* b;
+  AxSparseCSR* c;
+  const musz* flops;  // Prefix sums of the multiply-adds per output row
+  const musz* bounds;
+  atomic_bool ok;
+} AxSpgemmTask;
+
+// Per-task accumulators, sized for the rows of one chunk
+typedef struct AxSpgemmScratch {
+  mu32* keys;   // Hash slots, AX_SPGEMM_EMPTY when free
+  void* hvals;
+  mu32* marker; // Dense: 1 + the last row that touched each column
+  void* dvals;
+} AxSpgemmScratch;
+
+static inline bool ax__spgemm_dense(const AxSpgemmTask* t, musz i) {
+  return (t->flops[i + 1] - t->flops[i]) * AX_SPGEMM_DENSE_RATIO >= t->b->cols;
+}
+
+// Smallest power of two holding twice the row's multiply-adds
+static inline musz ax__spgemm_slots(const AxSpgemmTask* t, musz i) {
+  musz need = 2 * (t->flops[i + 1] - t->flops[i]), cap = 16;
+  while (cap < need) cap <<= 1;
+  return cap;
+}
+
+static inline musz ax__spgemm_hash(mu32 key, musz mask) {
+  return (musz)(key * 2654435761u) & mask;
+}
+
+static bool ax__spgemm_scratch_init(const AxSpgemmTask* t, AxSpgemmScratch* s, musz r0, musz r1,
+                                    musz esz) {
+  musz slots = 0;
+  bool dense = false;
+  for (musz i = r0; i < r1; i++) {
+    if (ax__spgemm_dense(t, i)) dense = true;
+    else if (ax__spgemm_slots(t, i) > slots) slots = ax__spgemm_slots(t, i);
+  }
+  *s = (AxSpgemmScratch){ NULL, NULL, NULL, NULL };
+  if (slots) {
+    s->keys = (mu32*)malloc(slots * sizeof(mu32));
+    s->hvals = esz ? malloc(slots * esz) : NULL;
+    if (!s->keys || (esz && !s->hvals)) return false;
+  }
+  if (dense) {
+    s->marker = (mu32*)calloc(t->b->cols, sizeof(mu32));
+    s->dvals = esz ? malloc(t->b->cols * esz) : NULL;
+    if (!s->marker || (esz && !s->dvals)) return false;
+  }
+  return true;
+}
+
+static void ax__spgemm_scratch_free(AxSpgemmScratch* s) {
+  free(s->keys);
+  free(s->hvals);
+  free(s->marker);
+  free(s->dvals);
+}
+
+static int ax__u32_cmp(const void* pa, const void* pb) {
+  mu32 a = *(const mu32*)pa, b = *(const mu32*)pb;
+  return (a > b) - (a < b);
+}
+
+static void ax__sort_u32(mu32* x, musz n) {
+  if (n > 32) {
+    qsort(x, n, sizeof(mu32), ax__u32_cmp);
+    return;
+  }
+  for (musz i = 1; i < n; i++) {
+    mu32 v = x[i];
+    musz j = i;
+    for (; j > 0 && x[j - 1] > v; j--) x[j] = x[j - 1];
+    x[j] = v;
+  }
+}
+
+// Number of distinct columns in row i of A B
+static musz ax__spgemm_count(const AxSpgemmTask* t, AxSpgemmScratch* s, musz i) {
+  const AxSparseCSR* a = t->a;
+  const AxSparseCSR* b = t->b;
+  musz n = 0;
+  if (ax__spgemm_dense(t, i)) {
+    mu32 stamp = (mu32)(i + 1);
+    for (musz p = a->row_ptr[i]; p < a->row_ptr[i + 1]; p++) {
+      mu32 r = a->col_idx[p];
+      for (musz q = b->row_ptr[r]; q < b->row_ptr[r + 1]; q++) {
+        mu32 j = b->col_idx[q];
+        if (s->marker[j] != stamp) {
+          s->marker[j] = stamp;
+          n++;
+        }
+      }
+    }
+    return n;
+  }
+  musz mask = ax__spgemm_slots(t, i) - 1;
+  memset(s->keys, 0xff, (mask + 1) * sizeof(mu32));
+  for (musz p = a->row_ptr[i]; p < a->row_ptr[i + 1]; p++) {
+    mu32 r = a->col_idx[p];
+    for (musz q = b->row_ptr[r]; q < b->row_ptr[r + 1]; q++) {
+      mu32 j = b->col_idx[q];
+      musz h = ax__spgemm_hash(j, mask);
+      while (s->keys[h] != AX_SPGEMM_EMPTY && s->keys[h] != j) h = (h + 1) & mask;
+      if (s->keys[h] == AX_SPGEMM_EMPTY) {
+        s->keys[h] = j;
+        n++;
+      }
+    }
+  }
+  return n;
+}
+
+// Row i of A B into its slot of c: accumulate, sort the touched columns and
+// read the sums back in column order
+#define AX__SPGEMM_DEFINE(T, s_, ct)                                    \
+  static void ax__spgemm_row_##s_(const AxSpgemmTask* t, AxSpgemmScratch* s, musz i) { \
+    const AxSparseCSR* a = t->a;                                        \
+    const AxSparseCSR* b = t->b;                                        \
+    const ct* av = (const ct*)a->values;                                \
+    const ct* bv = (const ct*)b->values;                                \
+    mu32* cols = t->c->col_idx + t->c->row_ptr[i];                      \
+    ct* out = (ct*)t->c->values + t->c->row_ptr[i];                     \
+    musz n = 0;                                                         \
+    if (ax__spgemm_dense(t, i)) {                                       \
+      ct* acc = (ct*)s->dvals;                                          \
+      mu32 stamp = (mu32)(i + 1);                                       \
+      for (musz p = a->row_ptr[i]; p < a->row_ptr[i + 1]; p++) {        \
+        mu32 r = a->col_idx[p];                                         \
+        ct w = av[p];                                                   \
+        for (musz q = b->row_ptr[r]; q < b->row_ptr[r + 1]; q++) {      \
+          mu32 j = b->col_idx[q];                                       \
+          if (s->marker[j] != stamp) {                                  \
+            s->marker[j] = stamp;                                       \
+            acc[j] = w * bv[q];                                         \
+            cols[n++] = j;                                              \
+          } else {                                                      \
+            acc[j] += w * bv[q];                                        \
+          }                                                             \
+        }                                                               \
+      }                                                                 \
+      ax__sort_u32(cols, n);                                            \
+      for (musz q = 0; q < n; q++) out[q] = acc[cols[q]];               \
+      return;                                                           \
+    }                                                                   \
+    ct* vals = (ct*)s->hvals;                                           \
+    musz mask = ax__spgemm_slots(t, i) - 1;                             \
+    memset(s->keys, 0xff, (mask + 1) * sizeof(mu32));                   \
+    for (musz p = a->row_ptr[i]; p < a->row_ptr[i + 1]; p++) {          \
+      mu32 r = a->col_idx[p];                                           \
+      ct w = av[p];                                                     \
+      for (musz q = b->row_ptr[r]; q < b->row_ptr[r + 1]; q++) {        \
+        mu32 j = b->col_idx[q];                                         \
+        musz h = ax__spgemm_hash(j, mask);                              \
+        while (s->keys[h] != AX_SPGEMM_EMPTY && s->keys[h] != j) h = (h + 1) & mask; \
+        if (s->keys[h] == AX_SPGEMM_EMPTY) {                            \
+          s->keys[h] = j;                                               \
+          vals[h] = w * bv[q];                                          \
+          cols[n++] = j;                                                \
+        } else {                                                        \
+          vals[h] += w * bv[q];                                         \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    ax__sort_u32(cols, n);                                              \
+    for (musz q = 0; q < n; q++) {                                      \
+      musz h = ax__spgemm_hash(cols[q], mask);                          \
+      while (s->keys[h] != cols[q]) h = (h + 1) & mask;                 \
+      out[q] = vals[h];                                                 \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__SPGEMM_DEFINE)
+#undef AX__SPGEMM_DEFINE
+
+static void ax__spgemm_symbolic_task(void* ctx, musz begin, musz end) {
+  AxSpgemmTask* t = (AxSpgemmTask*)ctx;
+  musz r0 = t->bounds[begin], r1 = t->bounds[end];
+  AxSpgemmScratch s;
+  if (!ax__spgemm_scratch_init(t, &s, r0, r1, 0)) {
+    atomic_store(&t->ok, false);
+  } else {
+    for (musz i = r0; i < r1; i++) t->c->row_ptr[i + 1] = ax__spgemm_count(t, &s, i);
+  }
+  ax__spgemm_scratch_free(&s);
+}
+
+static void ax__spgemm_numeric_task(void* ctx, musz begin, musz end) {
+  AxSpgemmTask* t = (AxSpgemmTask*)ctx;
+  musz r0 = t->bounds[begin], r1 = t->bounds[end];
+  AxSpgemmScratch s;
+  if (!ax__spgemm_scratch_init(t, &s, r0, r1, ax_dtype_size(t->c->dtype))) {
+    atomic_store(&t->ok, false);
+    ax__spgemm_scratch_free(&s);
+    return;
+  }
+  for (musz i = r0; i < r1; i++) {
+    switch (t->c->dtype) {
+#define AX__SPARSE_CASE(T, s_, ct) case AX_##T: ax__spgemm_row_##s_(t, &s, i); break;
+      AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+    default: break;
+    }
+  }
+  ax__spgemm_scratch_free(&s);
+}
+
+bool ax_csr_spgemm(const AxSparseCSR* a, const AxSparseCSR* b, AxSparseCSR* c, Arena* arena) {
+  if (!a || !b || !c || !arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_spgemm: null matrix or arena");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_csr_spgemm", a->dtype)) return false;
+  if (b->dtype != a->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_spgemm: dtype mismatch (%s vs %s)", ax_dtype_name(a->dtype),
+           ax_dtype_name(b->dtype));
+    return false;
+  }
+  if (a->cols != b->rows) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_spgemm: %zux%zu times %zux%zu", a->rows, a->cols, b->rows, b->cols);
+    return false;
+  }
+  musz rows = a->rows;
+  musz* row_ptr = (musz*)ax__sparse_alloc(arena, (rows + 1) * sizeof(musz));
+  musz* flops = (musz*)malloc((rows + 1) * sizeof(musz));
+  if (!row_ptr || !flops) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_spgemm: failed to allocate");
+    free(flops);
+    return false;
+  }
+  flops[0] = 0;
+  for (musz i = 0; i < rows; i++) {
+    musz f = 0;
+    for (musz p = a->row_ptr[i]; p < a->row_ptr[i + 1]; p++) {
+      f += b->row_ptr[a->col_idx[p] + 1] - b->row_ptr[a->col_idx[p]];
+    }
+    flops[i + 1] = flops[i] + f;
+  }
+  *c = (AxSparseCSR){ rows, b->cols, 0, row_ptr, NULL, NULL, a->dtype };
+  row_ptr[0] = 0;
+
+  musz* bounds = NULL;
+  musz nchunks = ax__sparse_partition(flops, rows, 1, &bounds);
+  if (!nchunks) {
+    free(flops);
+    return false;
+  }
+  AxSpgemmTask t = { a, b, c, flops, bounds, true };
+  ax_parallel_for(nchunks, 1, ax__spgemm_symbolic_task, &t);
+  if (atomic_load(&t.ok)) {
+    for (musz i = 0; i < rows; i++) row_ptr[i + 1] += row_ptr[i];
+    c->nnz = row_ptr[rows];
+    c->col_idx = (mu32*)ax__sparse_alloc(arena, c->nnz * sizeof(mu32));
+    c->values = ax__sparse_alloc(arena, c->nnz * ax_dtype_size(a->dtype));
+    if (c->col_idx && c->values) ax_parallel_for(nchunks, 1, ax__spgemm_numeric_task, &t);
+    else atomic_store(&t.ok, false);
+  }
+  free(bounds);
+  free(flops);
+  if (!atomic_load(&t.ok)) {
+    AX_LOG(AX_LOG_FATAL, "ax_csr_spgemm: failed to allocate accumulators");
+    return false;
+  }
+  return true;
+}
+
+// SELL-C-sigma
+
+#define AX_SELL_MAX_CHUNK 256
+
+musz ax_sell_default_chunk(AxDType dtype) {
+#if defined(__AVX512F__)
+  return dtype == AX_F64 ? 8 : 16;
+#else
+  return dtype == AX_F64 ? 4 : 8;
+#endif
+}
+
+typedef struct AxSellRow {
+  musz len;
+  mu32 row;
+} AxSellRow;
+
+// Longest first, ties in row order
+static int ax__sell_row_cmp(const void* pa, const void* pb) {
+  const AxSellRow* a = (const AxSellRow*)pa;
+  const AxSellRow* b = (const AxSellRow*)pb;
+  if (a->len != b->len) return a->len > b->len ? -1 : 1;
+  return (a->row > b->row) - (a->row < b->row);
+}
+
+// Lane l, step st of slice sl lives at slice_ptr[sl] + st * chunk + l
+#define AX__SELL_DEFINE(T, s, ct)                                       \
+  static void ax__sell_fill_##s(const AxSparseSELL* d, const AxSparseCSR* a) { \
+    const ct* v = (const ct*)a->values;                                 \
+    ct* out = (ct*)d->values;                                           \
+    musz C = d->chunk;                                                  \
+    for (musz sl = 0; sl < d->nslices; sl++) {                          \
+      musz base = d->slice_ptr[sl];                                     \
+      musz len = (d->slice_ptr[sl + 1] - base) / C;                     \
+      for (musz l = 0; l < C; l++) {                                    \
+        musz r = sl * C + l, k0 = 0, k1 = 0;                            \
+        mu32 pad = 0;                                                   \
+        if (r < d->rows) {                                              \
+          k0 = a->row_ptr[d->perm[r]];                                  \
+          k1 = a->row_ptr[d->perm[r] + 1];                              \
+          if (k1 > k0) pad = a->col_idx[k1 - 1];                        \
+        }                                                               \
+        for (musz st = 0; st < len; st++) {                             \
+          musz p = base + st * C + l;                                   \
+          bool real = k0 + st < k1;                                     \
+          d->col_idx[p] = real ? a->col_idx[k0 + st] : pad;             \
+          out[p] = real ? v[k0 + st] : 0;                               \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__SELL_DEFINE)
+#undef AX__SELL_DEFINE
+
+bool ax_sell_from_csr(AxSparseSELL* dest, const AxSparseCSR* src, musz chunk, musz sigma,
+                      Arena* arena) {
+  if (!dest || !src || !arena) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_from_csr: null matrix or arena");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_sell_from_csr", src->dtype)) return false;
+  if (src->cols > INT32_MAX) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_from_csr: %zu columns exceed int32 gather indices", src->cols);
+    return false;
+  }
+  if (chunk == 0) chunk = ax_sell_default_chunk(src->dtype);
+  if (sigma == 0) sigma = 32 * chunk;
+  if (chunk > AX_SELL_MAX_CHUNK) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_from_csr: chunk %zu exceeds %d", chunk, AX_SELL_MAX_CHUNK);
+    return false;
+  }
+  musz rows = src->rows;
+  musz nslices = (rows + chunk - 1) / chunk;
+  mu32* perm = (mu32*)ax__sparse_alloc(arena, rows * sizeof(mu32));
+  musz* slice_ptr = (musz*)ax__sparse_alloc(arena, (nslices + 1) * sizeof(musz));
+  AxSellRow* order = (AxSellRow*)malloc((rows ? rows : 1) * sizeof(AxSellRow));
+  if (!perm || !slice_ptr || !order) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_from_csr: failed to allocate");
+    free(order);
+    return false;
+  }
+  for (musz i = 0; i < rows; i++) {
+    order[i] = (AxSellRow){ src->row_ptr[i + 1] - src->row_ptr[i], (mu32)i };
+  }
+  if (sigma > 1) {
+    for (musz w = 0; w < rows; w += sigma) {
+      musz n = rows - w < sigma ? rows - w : sigma;
+      qsort(order + w, n, sizeof(AxSellRow), ax__sell_row_cmp);
+    }
+  }
+  slice_ptr[0] = 0;
+  for (musz sl = 0; sl < nslices; sl++) {
+    musz len = 0;
+    for (musz r = sl * chunk; r < rows && r < (sl + 1) * chunk; r++) {
+      if (order[r].len > len) len = order[r].len;
+    }
+    slice_ptr[sl + 1] = slice_ptr[sl] + len * chunk;
+  }
+  for (musz r = 0; r < rows; r++) perm[r] = order[r].row;
+  free(order);
+
+  musz padded = slice_ptr[nslices];
+  mu32* col_idx = (mu32*)ax__sparse_alloc(arena, padded * sizeof(mu32));
+  void* values = ax__sparse_alloc(arena, padded * ax_dtype_size(src->dtype));
+  if (!col_idx || !values) return false;
+  *dest = (AxSparseSELL){ rows, src->cols, src->nnz, chunk, sigma, nslices, slice_ptr, perm,
+                          col_idx, values, src->dtype };
+  switch (src->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__sell_fill_##s(dest, src); break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+  return true;
+}
+
+typedef struct AxSellTask {
+  const AxSparseSELL* a;
+  const void* x;   // Contiguous copy of x when it is strided
+  AxMatrix* y;
+  musz yinc;
+  double alpha, beta;
+} AxSellTask;
+
+// acc[l] = sum over the steps of slice `sl` of lane l, for every lane.
+// Whole SIMD registers of lanes gather x directly; leftover lanes (chunks
+// that are not a multiple of the register width) run scalar.
+static void ax__sell_slice_f32(const AxSparseSELL* a, musz sl, const mf32* x, mf32* acc) {
+  musz C = a->chunk, base = a->slice_ptr[sl];
+  musz len = (a->slice_ptr[sl + 1] - base) / C;
+  const mu32* col = a->col_idx + base;
+  const mf32* v = (const mf32*)a->values + base;
+  musz l = 0;
+#if defined(__AVX512F__)
+  for (; l + 16 <= C; l += 16) {
+    __m512 s = _mm512_setzero_ps();
+    for (musz st = 0; st < len; st++) {
+      __m512i idx = _mm512_loadu_si512((const void*)(col + st * C + l));
+      s = _mm512_fmadd_ps(_mm512_loadu_ps(v + st * C + l), _mm512_i32gather_ps(idx, x, 4), s);
+    }
+    _mm512_storeu_ps(acc + l, s);
+  }
+#elif defined(__AVX2__) && defined(__FMA__)
+  for (; l + 8 <= C; l += 8) {
+    __m256 s = _mm256_setzero_ps();
+    for (musz st = 0; st < len; st++) {
+      __m256i idx = _mm256_loadu_si256((const __m256i*)(const void*)(col + st * C + l));
+      s = _mm256_fmadd_ps(_mm256_loadu_ps(v + st * C + l), _mm256_i32gather_ps(x, idx, 4), s);
+    }
+    _mm256_storeu_ps(acc + l, s);
+  }
+#endif
+  for (; l < C; l++) {
+    mf32 s = 0;
+    for (musz st = 0; st < len; st++) s += v[st * C + l] * x[col[st * C + l]];
+    acc[l] = s;
+  }
+}
+
+static void ax__sell_slice_f64(const AxSparseSELL* a, musz sl, const mf64* x, mf64* acc) {
+  musz C = a->chunk, base = a->slice_ptr[sl];
+  musz len = (a->slice_ptr[sl + 1] - base) / C;
+  const mu32* col = a->col_idx + base;
+  const mf64* v = (const mf64*)a->values + base;
+  musz l = 0;
+#if defined(__AVX512F__)
+  for (; l + 8 <= C; l += 8) {
+    __m512d s = _mm512_setzero_pd();
+    for (musz st = 0; st < len; st++) {
+      __m256i idx = _mm256_loadu_si256((const __m256i*)(const void*)(col + st * C + l));
+      s = _mm512_fmadd_pd(_mm512_loadu_pd(v + st * C + l), _mm512_i32gather_pd(idx, x, 8), s);
+    }
+    _mm512_storeu_pd(acc + l, s);
+  }
+#elif defined(__AVX2__) && defined(__FMA__)
+  for (; l + 4 <= C; l += 4) {
+    __m256d s = _mm256_setzero_pd();
+    for (musz st = 0; st < len; st++) {
+      __m128i idx = _mm_loadu_si128((const __m128i*)(const void*)(col + st * C + l));
+      s = _mm256_fmadd_pd(_mm256_loadu_pd(v + st * C + l), _mm256_i32gather_pd(x, idx, 8), s);
+    }
+    _mm256_storeu_pd(acc + l, s);
+  }
+#endif
+  for (; l < C; l++) {
+    mf64 s = 0;
+    for (musz st = 0; st < len; st++) s += v[st * C + l] * x[col[st * C + l]];
+    acc[l] = s;
+  }
+}
+
+#define AX__SELL_DEFINE_SPMV(T, s, ct)                                  \
+  static void ax__sell_spmv_##s(const AxSellTask* t, musz s0, musz s1) { \
+    const AxSparseSELL* a = t->a;                                       \
+    ct* y = (ct*)t->y->data;                                            \
+    ct alpha = (ct)t->alpha, beta = (ct)t->beta;                        \
+    ct acc[AX_SELL_MAX_CHUNK];                                                        \
+    for (musz sl = s0; sl < s1; sl++) {                                 \
+      ax__sell_slice_##s(a, sl, (const ct*)t->x, acc);                  \
+      for (musz l = 0; l < a->chunk && sl * a->chunk + l < a->rows; l++) { \
+        ct* yi = y + a->perm[sl * a->chunk + l] * t->yinc;              \
+        *yi = (t->beta == 0) ? alpha * acc[l] : alpha * acc[l] + beta * *yi; \
+      }                                                                 \
+    }                                                                   \
+  }
+
+AX_DTYPE_FLOAT_LIST(AX__SELL_DEFINE_SPMV)
+#undef AX__SELL_DEFINE_SPMV
+
+static void ax__sell_spmv_task(void* ctx, musz begin, musz end) {
+  const AxSellTask* t = (const AxSellTask*)ctx;
+  switch (t->a->dtype) {
+#define AX__SPARSE_CASE(T, s, ct) case AX_##T: ax__sell_spmv_##s(t, begin, end); break;
+    AX_DTYPE_FLOAT_LIST(AX__SPARSE_CASE)
+#undef AX__SPARSE_CASE
+  default: break;
+  }
+}
+
+bool ax_sell_spmv(double alpha, const AxSparseSELL* a, const AxMatrix* x,
+                  double beta, AxMatrix* y) {
+  if (!a || !x || !y || !x->data || !y->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_spmv: null operand");
+    return false;
+  }
+  if (!ax__sparse_dtype_check("ax_sell_spmv", a->dtype)) return false;
+  if (x->dtype != a->dtype || y->dtype != a->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_spmv: dtype mismatch (%s, %s, %s)", ax_dtype_name(a->dtype),
+           ax_dtype_name(x->dtype), ax_dtype_name(y->dtype));
+    return false;
+  }
+  musz xinc = ax__sparse_vector_inc(x, a->cols);
+  musz yinc = ax__sparse_vector_inc(y, a->rows);
+  if ((!xinc && a->cols) || (!yinc && a->rows)) {
+    AX_LOG(AX_LOG_FATAL, "ax_sell_spmv: %zux%zu matrix with %zux%zu x and %zux%zu y",
+           a->rows, a->cols, x->rows, x->cols, y->rows, y->cols);
+    return false;
+  }
+  if (a->rows == 0) return true;
+
+  // The gathers need x contiguous
+  AxSellTask t = { a, x->data, y, yinc, alpha, beta };
+  void* packed = NULL;
+  if (xinc > 1) {
+    musz esz = ax_dtype_size(a->dtype);
+    packed = malloc(a->cols * esz);
+    if (!packed) {
+      AX_LOG(AX_LOG_FATAL, "ax_sell_spmv: failed to allocate x buffer");
+      return false;
+    }
+    for (musz j = 0; j < a->cols; j++) {
+      memcpy((mu8*)packed + j * esz, (const mu8*)x->data + j * xinc * esz, esz);
+    }
+    t.x = packed;
+  }
+  musz work = a->slice_ptr[a->nslices] + a->rows;
+  ax_parallel_for(a->nslices, a->nslices * AX_SPARSE_GRAIN / (work + 1) + 1, ax__sell_spmv_task, &t);
+  free(packed);
+  return true;
+}
+
+#endif /* AXSPARSE_IMPLEMENTATION */
+
+#endif /* AXSPARSE_H_ */
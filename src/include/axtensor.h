@@ -0,0 +1,1834 @@
+/*
+  ================================================================================
+  AxTensor: Strided N-Dimensional Arrays (STB-Style Single-Header Library)
+  ================================================================================
+  - AxTensor holds up to AX_TENSOR_MAX_DIMS dimensions with a signed stride
+  per dimension, in elements. Strides may be zero (broadcast) or negative
+  (reversed), so slicing with a step, permuting, squeezing, expanding and
+  (when the layout allows it) reshaping only rewrite the header.
+  - Element-wise and reduction kernels sort and merge dimensions first:
+  dimensions that are contiguous for every operand collapse into one, so a
+  contiguous N-d operation runs as a single flat loop. The remaining loop
+  nest is split across the thread pool.
+  - Element-wise kernels cover every dtype; f16/bf16 compute in f32.
+  Reductions accumulate in double pairwise, and the work split does not
+  depend on the thread count, so results are reproducible.
+  - ax_einsum parses a subscript spec, searches a pairwise contraction order
+  and runs each contraction as a batched GEMM over strided views.
+  - Dependencies:
+  - "axmatrix.h"    (AxDType, AxBinaryOp, AxMatrix; pulls in axalloc.h and axthread.h)
+  - <stdlib.h>      (malloc, free for partial results)
+  - <string.h>      (memcpy)
+  ================================================================================
+  USAGE:
+  1) In **one** C or C++ file where you want the implementation, do:
+  #define AXTENSOR_IMPLEMENTATION
+  #include "axtensor.h"
+
+  2) In any other files that need to use the library, just include "axtensor.h"
+  without defining AXTENSOR_IMPLEMENTATION.
+  ================================================================================
+*/
+
+#ifndef AXTENSOR_H_
+#define AXTENSOR_H_
+
+#include "axmatrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AX_TENSOR_MAX_DIMS 8
+
+  // Element (i0, ..., i{n-1}) lives `sum(ik * strides[k])` elements past
+  // `data`. A tensor with ndim == 0 is a scalar.
+  typedef struct AxTensor {
+    musz ndim;
+    musz shape[AX_TENSOR_MAX_DIMS];
+    mptrdif strides[AX_TENSOR_MAX_DIMS]; // Elements; 0 for broadcast dimensions
+    void* data;
+    AxDType dtype;
+    bool data_owner; // Whether to free data on destroy
+  } AxTensor;
+
+  // Creation (row-major, uninitialized). A NULL arena falls back to malloc.
+  bool ax_tensor_init(AxTensor* t, musz ndim, const musz* shape, AxDType dtype, Arena* arena);
+  void ax_tensor_destroy(AxTensor* t);
+
+  musz ax_tensor_numel(const AxTensor* t);
+  bool ax_tensor_is_contiguous(const AxTensor* t); // Row-major without gaps
+
+  // Dtype-agnostic scalar access (converts through double); `idx` has ndim entries
+  double ax_tensor_get(const AxTensor* t, const musz* idx);
+  void ax_tensor_set(AxTensor* t, const musz* idx, double value);
+
+  // Views between the two types. A matrix is a 2-d tensor; a tensor is a
+  // matrix when it is 2-d with non-negative strides.
+  static inline AxTensor ax_tensor_from_matrix(const AxMatrix* mat) {
+    AxTensor t = { 0 };
+    t.ndim = 2;
+    t.shape[0] = mat->rows;
+    t.shape[1] = mat->cols;
+    t.strides[0] = (mptrdif)mat->stride;
+    t.strides[1] = (mptrdif)mat->col_stride;
+    t.data = mat->data;
+    t.dtype = mat->dtype;
+    return t;
+  }
+
+  bool ax_tensor_as_matrix(const AxTensor* t, AxMatrix* out);
+
+  // Views. Each writes a header sharing `t`'s data into `out`, which may be
+  // `t` itself; no elements are moved.
+
+  // Python slice semantics: negative start/stop count from the end, bounds
+  // are clamped, and AX_SLICE_NONE omits start or stop. `step` may be
+  // negative but not 0.
+  typedef struct AxSlice {
+    mptrdif start;
+    mptrdif stop; // exclusive
+    mptrdif step;
+  } AxSlice;
+
+#define AX_SLICE_NONE PTRDIFF_MIN
+#define AX_SLICE(start, stop, step) (AxSlice){ (start), (stop), (step) }
+
+  bool ax_tensor_slice(const AxTensor* t, musz dim, AxSlice s, AxTensor* out);
+  // Fixes dimension `dim` at `index`, dropping it
+  bool ax_tensor_select(const AxTensor* t, musz dim, musz index, AxTensor* out);
+  // out dimension k is t's dimension perm[k]
+  bool ax_tensor_permute(const AxTensor* t, const musz* perm, AxTensor* out);
+  bool ax_tensor_transpose(const AxTensor* t, musz dim0, musz dim1, AxTensor* out);
+
+#define AX_TENSOR_ALL_DIMS ((musz)-1)
+
+  // Drops dimension `dim` (which must have size 1), or every size-1
+  // dimension with AX_TENSOR_ALL_DIMS
+  bool ax_tensor_squeeze(const AxTensor* t, musz dim, AxTensor* out);
+  // Inserts a size-1 dimension before `dim` (dim == ndim appends)
+  bool ax_tensor_unsqueeze(const AxTensor* t, musz dim, AxTensor* out);
+  // Broadcasts to `shape`: dimensions are aligned from the right, and those
+  // of size 1 (or missing) get stride 0
+  bool ax_tensor_expand(const AxTensor* t, musz ndim, const musz* shape, AxTensor* out);
+  // Same elements in row-major order under a new shape, without copying.
+  // Returns false (with a warning) when the strides cannot express it; copy
+  // to a contiguous tensor first in that case.
+  bool ax_tensor_reshape(const AxTensor* t, musz ndim, const musz* shape, AxTensor* out);
+
+  // Kernels. `dest` must have no broadcast dimensions. Element-wise kernels
+  // allow `dest` to be one of the operands for in-place updates, but it must
+  // not otherwise overlap them.
+
+  // dest = src, with `src` broadcast against dest's shape (one dtype)
+  bool ax_tensor_copy(AxTensor* dest, const AxTensor* src);
+  // Copies `src` into a new row-major tensor
+  bool ax_tensor_contiguous(const AxTensor* src, AxTensor* out, Arena* arena);
+
+  // dest = a op b, with both operands broadcast against dest's shape (one dtype)
+  bool ax_tensor_binary(AxTensor* dest, const AxTensor* a, const AxTensor* b, AxBinaryOp op);
+  bool ax_tensor_scalar(AxTensor* dest, const AxTensor* a, double s, AxBinaryOp op);
+
+  // Reductions over the dimensions set in `dims` (bit d for dimension d,
+  // AX_TENSOR_ALL_DIMS for every one). `out` has any dtype and either keeps
+  // the reduced dimensions with size 1 or drops them.
+#define AX_TENSOR_DIM(d) ((musz)1 << (d))
+
+  bool ax_tensor_sum(const AxTensor* a, musz dims, AxTensor* out);
+  bool ax_tensor_mean(const AxTensor* a, musz dims, AxTensor* out);
+  bool ax_tensor_min(const AxTensor* a, musz dims, AxTensor* out);
+  bool ax_tensor_max(const AxTensor* a, musz dims, AxTensor* out);
+
+  // Einsum over `count` operands: "ij,jk->ik" (matrix product),
+  // "bij,bjk->bik" (batched), "ii->" (trace), "ij->ji" (transpose). Labels
+  // are letters a-z and A-Z; spaces are ignored and there is no ellipsis.
+  // Without "->" the output takes the labels that appear once, in ASCII
+  // order. `out` already has the output shape (any dtype) and must not
+  // overlap the operands, which are all f64 or all f16/bf16/f32 (computed in
+  // f32).
+  //
+  // Repeated labels of one operand read its diagonal, labels no other term
+  // needs are summed first, and the remaining terms contract pairwise in the
+  // order the path search picks. Each contraction runs as one strided
+  // batched GEMM straight on the operands' views; an operand is copied only
+  // when the strides of one of its label groups do not merge. Intermediates
+  // come from `scratch` (a private arena when NULL).
+#define AX_EINSUM_MAX_OPERANDS 32
+#define AX_EINSUM_OPTIMAL_MAX 12 // Larger specs fall back to the greedy search
+
+  typedef enum AxEinsumPath {
+    AX_EINSUM_GREEDY, // Repeatedly contracts the cheapest pair
+    AX_EINSUM_OPTIMAL // Cheapest order overall (dynamic programming over subsets)
+  } AxEinsumPath;
+
+  typedef struct AxEinsumInfo {
+    musz steps;                                // Pairwise contractions
+    musz pairs[AX_EINSUM_MAX_OPERANDS - 1][2]; // Terms of step s; its result is term count + s
+    double flops;                              // Multiply-adds of the contractions
+    double naive_flops;                        // Multiply-adds of one loop nest over every label
+  } AxEinsumInfo;
+
+  // `info` may be NULL
+  bool ax_einsum(const char* spec, const AxTensor* const* operands, musz count, AxTensor* out,
+                 AxEinsumPath path, AxEinsumInfo* info, Arena* scratch);
+  // Plans the contraction order without computing
+  bool ax_einsum_path(const char* spec, const AxTensor* const* operands, musz count,
+                      AxEinsumPath path, AxEinsumInfo* info);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+   ------------------------------------------------------------------------------
+   Implementation
+   ------------------------------------------------------------------------------
+*/
+#ifdef AXTENSOR_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+
+#define AX_TENSOR_CHUNK 16384 // Elements per parallel task
+#define AX_TENSOR_TILE 64     // Outputs reduced together along a kept dimension
+
+bool ax_tensor_init(AxTensor* t, musz ndim, const musz* shape, AxDType dtype, Arena* arena) {
+  if (!t || ndim > AX_TENSOR_MAX_DIMS || (ndim && !shape)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_init: invalid arguments");
+    return false;
+  }
+  musz numel = 1;
+  for (musz d = ndim; d-- > 0;) {
+    t->shape[d] = shape[d];
+    t->strides[d] = (mptrdif)numel;
+    numel *= shape[d];
+  }
+  musz size = numel * ax_dtype_size(dtype);
+  if (arena) {
+    t->data = ax_alloc(arena, size ? size : 1);
+  } else {
+    AX_LOG(AX_LOG_INFO, "Arena is NULL, using malloc");
+    AX_LOG(AX_LOG_WARN, "DO NOT FORGET TO CALL ax_tensor_destroy");
+    t->data = malloc(size ? size : 1);
+  }
+  if (!t->data) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_init: failed to allocate data");
+    return false;
+  }
+  t->ndim = ndim;
+  t->dtype = dtype;
+  t->data_owner = (arena == NULL);
+  return true;
+}
+
+void ax_tensor_destroy(AxTensor* t) {
+  if (!t) return;
+  if (t->data_owner) free(t->data);
+  t->data = NULL;
+  t->ndim = 0;
+}
+
+musz ax_tensor_numel(const AxTensor* t) {
+  musz n = 1;
+  for (musz d = 0; d < t->ndim; d++) n *= t->shape[d];
+  return n;
+}
+
+bool ax_tensor_is_contiguous(const AxTensor* t) {
+  mptrdif expect = 1;
+  for (musz d = t->ndim; d-- > 0;) {
+    if (t->shape[d] == 1) continue;
+    if (t->strides[d] != expect) return false;
+    expect *= (mptrdif)t->shape[d];
+  }
+  return true;
+}
+
+static inline mu8* ax__tensor_at(const AxTensor* t, const musz* idx) {
+  mptrdif off = 0;
+  for (musz d = 0; d < t->ndim; d++) off += (mptrdif)idx[d] * t->strides[d];
+  return (mu8*)t->data + off * (mptrdif)ax_dtype_size(t->dtype);
+}
+
+// Reads or writes one element of any dtype through double
+static double ax__tensor_load(AxDType dtype, const void* p) {
+  switch (dtype) {
+#define AX__TENSOR_LOAD_CASE(T, s, ct) case AX_##T: return (double)*(const ct*)p;
+    AX_DTYPE_LIST(AX__TENSOR_LOAD_CASE)
+#undef AX__TENSOR_LOAD_CASE
+  case AX_F16: return ax_f16_to_f32(*(const mu16*)p);
+  case AX_BF16: return ax_bf16_to_f32(*(const mu16*)p);
+  }
+  return 0;
+}
+
+static void ax__tensor_store(AxDType dtype, void* p, double v) {
+  switch (dtype) {
+#define AX__TENSOR_STORE_CASE(T, s, ct) case AX_##T: *(ct*)p = (ct)v; break;
+    AX_DTYPE_LIST(AX__TENSOR_STORE_CASE)
+#undef AX__TENSOR_STORE_CASE
+  case AX_F16: *(mu16*)p = ax_f32_to_f16((mf32)v); break;
+  case AX_BF16: *(mu16*)p = ax_f32_to_bf16((mf32)v); break;
+  }
+}
+
+double ax_tensor_get(const AxTensor* t, const musz* idx) {
+  return ax__tensor_load(t->dtype, ax__tensor_at(t, idx));
+}
+
+void ax_tensor_set(AxTensor* t, const musz* idx, double value) {
+  ax__tensor_store(t->dtype, ax__tensor_at(t, idx), value);
+}
+
+static bool ax__tensor_valid(const char* name, const AxTensor* t) {
+  if (!t || !t->data) {
+    AX_LOG(AX_LOG_FATAL, "%s: null tensor", name);
+    return false;
+  }
+  if (t->ndim > AX_TENSOR_MAX_DIMS) {
+    AX_LOG(AX_LOG_FATAL, "%s: %zu dimensions (at most %d)", name, (size_t)t->ndim, AX_TENSOR_MAX_DIMS);
+    return false;
+  }
+  return true;
+}
+
+static bool ax__tensor_dim(const char* name, const AxTensor* t, musz dim) {
+  if (!ax__tensor_valid(name, t)) return false;
+  if (dim >= t->ndim) {
+    AX_LOG(AX_LOG_FATAL, "%s: dimension %zu out of range (ndim %zu)", name, (size_t)dim, (size_t)t->ndim);
+    return false;
+  }
+  return true;
+}
+
+bool ax_tensor_as_matrix(const AxTensor* t, AxMatrix* out) {
+  if (!ax__tensor_valid("ax_tensor_as_matrix", t) || !out) return false;
+  if (t->ndim != 2 || (t->shape[0] > 1 && t->strides[0] < 0) || (t->shape[1] > 1 && t->strides[1] < 0)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_as_matrix: tensor is not a 2-d view with non-negative strides");
+    return false;
+  }
+  out->rows = t->shape[0];
+  out->cols = t->shape[1];
+  out->stride = (t->shape[0] > 1) ? (musz)t->strides[0] : t->shape[1];
+  out->col_stride = (t->shape[1] > 1) ? (musz)t->strides[1] : 1;
+  out->data = t->data;
+  out->dtype = t->dtype;
+  out->data_owner = false;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Views
+// ---------------------------------------------------------------------------
+
+// Copies the header without ownership (for views that start from `t`)
+static inline void ax__tensor_view(const AxTensor* t, AxTensor* out) {
+  if (out != t) *out = *t;
+  out->data_owner = false;
+}
+
+bool ax_tensor_slice(const AxTensor* t, musz dim, AxSlice s, AxTensor* out) {
+  if (!ax__tensor_dim("ax_tensor_slice", t, dim) || !out) return false;
+  if (s.step == 0) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_slice: step is 0");
+    return false;
+  }
+  // As PySlice_AdjustIndices
+  mptrdif len = (mptrdif)t->shape[dim];
+  mptrdif lower = (s.step < 0) ? -1 : 0;
+  mptrdif upper = (s.step < 0) ? len - 1 : len;
+  mptrdif start, stop;
+  if (s.start == AX_SLICE_NONE) {
+    start = (s.step < 0) ? upper : lower;
+  } else {
+    start = (s.start < 0) ? s.start + len : s.start;
+    start = (start < lower) ? lower : (start > upper ? upper : start);
+  }
+  if (s.stop == AX_SLICE_NONE) {
+    stop = (s.step < 0) ? lower : upper;
+  } else {
+    stop = (s.stop < 0) ? s.stop + len : s.stop;
+    stop = (stop < lower) ? lower : (stop > upper ? upper : stop);
+  }
+  musz count = 0;
+  if (s.step > 0 && stop > start) count = (musz)((stop - start - 1) / s.step + 1);
+  if (s.step < 0 && start > stop) count = (musz)((start - stop - 1) / -s.step + 1);
+  ax__tensor_view(t, out);
+  if (count > 0) {
+    out->data = (mu8*)t->data + start * t->strides[dim] * (mptrdif)ax_dtype_size(t->dtype);
+  }
+  out->shape[dim] = count;
+  out->strides[dim] = t->strides[dim] * s.step;
+  return true;
+}
+
+bool ax_tensor_select(const AxTensor* t, musz dim, musz index, AxTensor* out) {
+  if (!ax__tensor_dim("ax_tensor_select", t, dim) || !out) return false;
+  if (index >= t->shape[dim]) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_select: index %zu out of range (size %zu)",
+           (size_t)index, (size_t)t->shape[dim]);
+    return false;
+  }
+  ax__tensor_view(t, out);
+  out->data = (mu8*)t->data + (mptrdif)index * t->strides[dim] * (mptrdif)ax_dtype_size(t->dtype);
+  for (musz d = dim; d + 1 < t->ndim; d++) {
+    out->shape[d] = t->shape[d + 1];
+    out->strides[d] = t->strides[d + 1];
+  }
+  out->ndim = t->ndim - 1;
+  return true;
+}
+
+bool ax_tensor_permute(const AxTensor* t, const musz* perm, AxTensor* out) {
+  if (!ax__tensor_valid("ax_tensor_permute", t) || !out || (t->ndim && !perm)) return false;
+  musz shape[AX_TENSOR_MAX_DIMS];
+  mptrdif strides[AX_TENSOR_MAX_DIMS];
+  musz seen = 0;
+  for (musz k = 0; k < t->ndim; k++) {
+    if (perm[k] >= t->ndim || (seen & AX_TENSOR_DIM(perm[k]))) {
+      AX_LOG(AX_LOG_FATAL, "ax_tensor_permute: not a permutation of %zu dimensions", (size_t)t->ndim);
+      return false;
+    }
+    seen |= AX_TENSOR_DIM(perm[k]);
+    shape[k] = t->shape[perm[k]];
+    strides[k] = t->strides[perm[k]];
+  }
+  ax__tensor_view(t, out);
+  memcpy(out->shape, shape, t->ndim * sizeof(musz));
+  memcpy(out->strides, strides, t->ndim * sizeof(mptrdif));
+  return true;
+}
+
+bool ax_tensor_transpose(const AxTensor* t, musz dim0, musz dim1, AxTensor* out) {
+  if (!ax__tensor_dim("ax_tensor_transpose", t, dim0) ||
+      !ax__tensor_dim("ax_tensor_transpose", t, dim1) || !out) {
+    return false;
+  }
+  musz perm[AX_TENSOR_MAX_DIMS];
+  for (musz d = 0; d < t->ndim; d++) perm[d] = d;
+  perm[dim0] = dim1;
+  perm[dim1] = dim0;
+  return ax_tensor_permute(t, perm, out);
+}
+
+bool ax_tensor_squeeze(const AxTensor* t, musz dim, AxTensor* out) {
+  if (!ax__tensor_valid("ax_tensor_squeeze", t) || !out) return false;
+  if (dim != AX_TENSOR_ALL_DIMS && (dim >= t->ndim || t->shape[dim] != 1)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_squeeze: dimension %zu does not have size 1", (size_t)dim);
+    return false;
+  }
+  ax__tensor_view(t, out);
+  musz n = 0;
+  for (musz d = 0; d < t->ndim; d++) {
+    bool drop = (dim == AX_TENSOR_ALL_DIMS) ? t->shape[d] == 1 : d == dim;
+    if (drop) continue;
+    out->shape[n] = t->shape[d];
+    out->strides[n] = t->strides[d];
+    n++;
+  }
+  out->ndim = n;
+  return true;
+}
+
+bool ax_tensor_unsqueeze(const AxTensor* t, musz dim, AxTensor* out) {
+  if (!ax__tensor_valid("ax_tensor_unsqueeze", t) || !out) return false;
+  if (dim > t->ndim || t->ndim == AX_TENSOR_MAX_DIMS) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_unsqueeze: cannot insert dimension %zu into %zu",
+           (size_t)dim, (size_t)t->ndim);
+    return false;
+  }
+  ax__tensor_view(t, out);
+  for (musz d = t->ndim; d > dim; d--) {
+    out->shape[d] = t->shape[d - 1];
+    out->strides[d] = t->strides[d - 1];
+  }
+  out->shape[dim] = 1;
+  out->strides[dim] = 0;
+  out->ndim = t->ndim + 1;
+  return true;
+}
+
+// Header of `t` broadcast to `shape` (right-aligned), or false if a
+// dimension is neither equal nor 1
+static bool ax__tensor_broadcast(const AxTensor* t, musz ndim, const musz* shape, AxTensor* out) {
+  if (ndim < t->ndim || ndim > AX_TENSOR_MAX_DIMS) return false;
+  AxTensor r = *t;
+  r.ndim = ndim;
+  r.data_owner = false;
+  musz lead = ndim - t->ndim;
+  for (musz d = ndim; d-- > 0;) {
+    musz size = (d >= lead) ? t->shape[d - lead] : 1;
+    mptrdif stride = (d >= lead) ? t->strides[d - lead] : 0;
+    if (size != shape[d] && size != 1) return false;
+    r.shape[d] = shape[d];
+    r.strides[d] = (size == shape[d]) ? stride : 0;
+  }
+  *out = r;
+  return true;
+}
+
+bool ax_tensor_expand(const AxTensor* t, musz ndim, const musz* shape, AxTensor* out) {
+  if (!ax__tensor_valid("ax_tensor_expand", t) || !out) return false;
+  if (!ax__tensor_broadcast(t, ndim, shape, out)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_expand: cannot broadcast %zu dimensions to %zu",
+           (size_t)t->ndim, (size_t)ndim);
+    return false;
+  }
+  return true;
+}
+
+bool ax_tensor_reshape(const AxTensor* t, musz ndim, const musz* shape, AxTensor* out) {
+  if (!ax__tensor_valid("ax_tensor_reshape", t) || !out || ndim > AX_TENSOR_MAX_DIMS) return false;
+  musz numel = 1;
+  for (musz d = 0; d < ndim; d++) numel *= shape[d];
+  if (numel != ax_tensor_numel(t)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_reshape: %zu elements cannot take a shape of %zu",
+           (size_t)ax_tensor_numel(t), (size_t)numel);
+    return false;
+  }
+  mptrdif strides[AX_TENSOR_MAX_DIMS];
+  if (numel == 0) {
+    mptrdif s = 1;
+    for (musz d = ndim; d-- > 0;) {
+      strides[d] = s;
+      s *= (mptrdif)(shape[d] ? shape[d] : 1);
+    }
+  } else {
+    // Groups of old and new dimensions with equal products map onto each
+    // other when the old group is contiguous within itself (as numpy's
+    // attempt_nocopy_reshape). Size-1 old dimensions carry no layout.
+    musz osh[AX_TENSOR_MAX_DIMS];
+    mptrdif ost[AX_TENSOR_MAX_DIMS];
+    musz on = 0;
+    for (musz d = 0; d < t->ndim; d++) {
+      if (t->shape[d] == 1) continue;
+      osh[on] = t->shape[d];
+      ost[on] = t->strides[d];
+      on++;
+    }
+    musz oi = 0, oj = 1, ni = 0, nj = 1;
+    while (ni < ndim && oi < on) {
+      musz np = shape[ni], op = osh[oi];
+      while (np != op) {
+        if (np < op) {
+          np *= shape[nj++];
+        } else {
+          op *= osh[oj++];
+        }
+      }
+      for (musz k = oi; k + 1 < oj; k++) {
+        if (ost[k] != (mptrdif)osh[k + 1] * ost[k + 1]) {
+          AX_LOG(AX_LOG_WARN, "ax_tensor_reshape: strides do not allow a view; copy first");
+          return false;
+        }
+      }
+      strides[nj - 1] = ost[oj - 1];
+      for (musz k = nj - 1; k > ni; k--) strides[k - 1] = strides[k] * (mptrdif)shape[k];
+      ni = nj++;
+      oi = oj++;
+    }
+    // Trailing size-1 dimensions
+    for (musz k = ni; k < ndim; k++) strides[k] = 1;
+  }
+  ax__tensor_view(t, out);
+  out->ndim = ndim;
+  memcpy(out->shape, shape, ndim * sizeof(musz));
+  memcpy(out->strides, strides, ndim * sizeof(mptrdif));
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Loop nests
+// ---------------------------------------------------------------------------
+//
+// The operands of a kernel share one shape. Size-1 dimensions are dropped,
+// reversed dimensions of the first operand are flipped (for every operand),
+// the rest are ordered by the first operand's strides, outermost first, and
+// neighbours that are contiguous for every operand are merged. What remains
+// is an outer nest of `rows` plus one inner dimension that the kernels run
+// as a flat loop.
+
+#define AX__TENSOR_OPS 3
+
+typedef struct AxTensorLoop {
+  musz ndim; // At least 1
+  musz shape[AX_TENSOR_MAX_DIMS];
+  mptrdif strides[AX__TENSOR_OPS][AX_TENSOR_MAX_DIMS];
+  mu8* data[AX__TENSOR_OPS];
+  musz esize[AX__TENSOR_OPS];
+  musz nops;
+  musz rows;  // Product of every dimension but the last
+  musz tiles; // Chunks of the last dimension
+} AxTensorLoop;
+
+static void ax__tensor_loop(AxTensorLoop* l, musz nops, const AxTensor* const* ops) {
+  const AxTensor* t0 = ops[0];
+  l->nops = nops;
+  l->ndim = 0;
+  for (musz k = 0; k < nops; k++) {
+    l->data[k] = (mu8*)ops[k]->data;
+    l->esize[k] = ax_dtype_size(ops[k]->dtype);
+  }
+  for (musz d = 0; d < t0->ndim; d++) {
+    if (t0->shape[d] == 1) continue;
+    musz n = l->ndim++;
+    l->shape[n] = t0->shape[d];
+    bool flip = t0->strides[d] < 0;
+    for (musz k = 0; k < nops; k++) {
+      mptrdif s = ops[k]->strides[d];
+      if (flip) {
+        l->data[k] += (mptrdif)(t0->shape[d] - 1) * s * (mptrdif)l->esize[k];
+        s = -s;
+      }
+      l->strides[k][n] = s;
+    }
+  }
+  // Insertion sort, outermost (largest stride) first
+  for (musz i = 1; i < l->ndim; i++) {
+    for (musz j = i; j > 0; j--) {
+      bool swap = false;
+      for (musz k = 0; k < nops; k++) {
+        mptrdif a = l->strides[k][j - 1], b = l->strides[k][j];
+        a = a < 0 ? -a : a;
+        b = b < 0 ? -b : b;
+        if (a != b) {
+          swap = a < b;
+          break;
+        }
+      }
+      if (!swap) break;
+      musz sh = l->shape[j];
+      l->shape[j] = l->shape[j - 1];
+      l->shape[j - 1] = sh;
+      for (musz k = 0; k < nops; k++) {
+        mptrdif s = l->strides[k][j];
+        l->strides[k][j] = l->strides[k][j - 1];
+        l->strides[k][j - 1] = s;
+      }
+    }
+  }
+  // Merge contiguous neighbours
+  musz n = 0;
+  for (musz d = 0; d < l->ndim; d++) {
+    bool merge = n > 0;
+    for (musz k = 0; merge && k < nops; k++) {
+      merge = l->strides[k][n - 1] == l->strides[k][d] * (mptrdif)l->shape[d];
+    }
+    if (merge) {
+      l->shape[n - 1] *= l->shape[d];
+      for (musz k = 0; k < nops; k++) l->strides[k][n - 1] = l->strides[k][d];
+    } else {
+      l->shape[n] = l->shape[d];
+      for (musz k = 0; k < nops; k++) l->strides[k][n] = l->strides[k][d];
+      n++;
+    }
+  }
+  if (n == 0) {
+    l->shape[0] = 1;
+    for (musz k = 0; k < nops; k++) l->strides[k][0] = 1;
+    n = 1;
+  }
+  l->ndim = n;
+  l->rows = 1;
+  for (musz d = 0; d + 1 < n; d++) l->rows *= l->shape[d];
+  l->tiles = (l->shape[n - 1] + AX_TENSOR_CHUNK - 1) / AX_TENSOR_CHUNK;
+}
+
+// Byte offsets of outer row `row` for every operand, with its index in `idx`
+static void ax__tensor_loop_seek(const AxTensorLoop* l, musz row, musz* idx, mptrdif* off) {
+  for (musz k = 0; k < l->nops; k++) off[k] = 0;
+  for (musz d = l->ndim - 1; d-- > 0;) {
+    idx[d] = row % l->shape[d];
+    row /= l->shape[d];
+    for (musz k = 0; k < l->nops; k++) off[k] += (mptrdif)idx[d] * l->strides[k][d] * (mptrdif)l->esize[k];
+  }
+}
+
+// Advances `idx` and `off` to the next outer row
+static void ax__tensor_loop_next(const AxTensorLoop* l, musz* idx, mptrdif* off) {
+  for (musz d = l->ndim - 1; d-- > 0;) {
+    for (musz k = 0; k < l->nops; k++) off[k] += l->strides[k][d] * (mptrdif)l->esize[k];
+    if (++idx[d] < l->shape[d]) return;
+    for (musz k = 0; k < l->nops; k++) {
+      off[k] -= (mptrdif)l->shape[d] * l->strides[k][d] * (mptrdif)l->esize[k];
+    }
+    idx[d] = 0;
+  }
+}
+
+// Runs `run` over every (row, tile) pair in [begin, end)
+typedef void (*AxTensorRunFn)(const AxTensorLoop* l, const void* ctx, mu8* const* p, musz n);
+
+typedef struct AxTensorTask {
+  const AxTensorLoop* loop;
+  AxTensorRunFn run;
+  const void* ctx;
+} AxTensorTask;
+
+static void ax__tensor_loop_task(void* ctx, musz begin, musz end) {
+  const AxTensorTask* t = (const AxTensorTask*)ctx;
+  const AxTensorLoop* l = t->loop;
+  musz inner = l->shape[l->ndim - 1];
+  musz idx[AX_TENSOR_MAX_DIMS];
+  mptrdif off[AX__TENSOR_OPS];
+  musz row = begin / l->tiles;
+  ax__tensor_loop_seek(l, row, idx, off);
+  for (musz k = begin; k < end; k++) {
+    if (k / l->tiles != row) {
+      row++;
+      ax__tensor_loop_next(l, idx, off);
+    }
+    musz j = (k % l->tiles) * AX_TENSOR_CHUNK;
+    musz n = (inner - j < AX_TENSOR_CHUNK) ? inner - j : AX_TENSOR_CHUNK;
+    mu8* p[AX__TENSOR_OPS];
+    for (musz o = 0; o < l->nops; o++) {
+      p[o] = l->data[o] + off[o] + (mptrdif)j * l->strides[o][l->ndim - 1] * (mptrdif)l->esize[o];
+    }
+    t->run(l, t->ctx, p, n);
+  }
+}
+
+static void ax__tensor_loop_run(const AxTensorLoop* l, AxTensorRunFn run, const void* ctx) {
+  AxTensorTask t = { l, run, ctx };
+  musz inner = l->shape[l->ndim - 1];
+  ax_parallel_for(l->rows * l->tiles, AX_TENSOR_CHUNK / inner + 1, ax__tensor_loop_task, &t);
+}
+
+// Checks that `dest` can be written: no broadcast (or overlapping) dimensions
+static bool ax__tensor_dest(const char* name, const AxTensor* dest) {
+  if (!ax__tensor_valid(name, dest)) return false;
+  for (musz d = 0; d < dest->ndim; d++) {
+    if (dest->shape[d] > 1 && dest->strides[d] == 0) {
+      AX_LOG(AX_LOG_FATAL, "%s: destination dimension %zu is broadcast", name, (size_t)d);
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Element-wise kernels
+// ---------------------------------------------------------------------------
+
+// Copies only move bits: X(width in bits, C type)
+#define AX__TENSOR_WIDTHS(X)                    \
+  X(8, mu8)                                     \
+  X(16, mu16)                                   \
+  X(32, mu32)                                   \
+  X(64, mu64)
+
+#define AX__DEFINE_TENSOR_COPY(w, ct)                                   \
+  static void ax__tensor_copy_run_##w(const AxTensorLoop* l, const void* ctx, mu8* const* p, musz n) { \
+    (void)ctx;                                                          \
+    mptrdif so = l->strides[0][l->ndim - 1], sx = l->strides[1][l->ndim - 1]; \
+    ct* o = (ct*)p[0];                                                  \
+    const ct* x = (const ct*)p[1];                                      \
+    if (so == 1 && sx == 1) {                                           \
+      memcpy(o, x, n * sizeof(ct));                                     \
+    } else if (sx == 0) {                                               \
+      for (musz j = 0; j < n; j++) o[(mptrdif)j * so] = *x;             \
+    } else {                                                            \
+      for (musz j = 0; j < n; j++) o[(mptrdif)j * so] = x[(mptrdif)j * sx]; \
+    }                                                                   \
+  }
+
+AX__TENSOR_WIDTHS(AX__DEFINE_TENSOR_COPY)
+
+bool ax_tensor_copy(AxTensor* dest, const AxTensor* src) {
+  if (!ax__tensor_dest("ax_tensor_copy", dest) || !ax__tensor_valid("ax_tensor_copy", src)) return false;
+  AxTensor s;
+  if (!ax__tensor_broadcast(src, dest->ndim, dest->shape, &s)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_copy: cannot broadcast source to destination shape");
+    return false;
+  }
+  if (dest->dtype != src->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_copy: dtype mismatch (%s vs %s)",
+           ax_dtype_name(dest->dtype), ax_dtype_name(src->dtype));
+    return false;
+  }
+  if (ax_tensor_numel(dest) == 0) return true;
+  const AxTensor* ops[2] = { dest, &s };
+  AxTensorLoop l;
+  ax__tensor_loop(&l, 2, ops);
+  switch (ax_dtype_size(dest->dtype)) {
+#define AX__TENSOR_COPY_CASE(w, ct) case sizeof(ct): ax__tensor_loop_run(&l, ax__tensor_copy_run_##w, NULL); break;
+    AX__TENSOR_WIDTHS(AX__TENSOR_COPY_CASE)
+#undef AX__TENSOR_COPY_CASE
+  }
+  return true;
+}
+
+bool ax_tensor_contiguous(const AxTensor* src, AxTensor* out, Arena* arena) {
+  if (!ax__tensor_valid("ax_tensor_contiguous", src) || !out) return false;
+  AxTensor s = *src; // `out` may be `src`
+  if (!ax_tensor_init(out, s.ndim, s.shape, s.dtype, arena)) return false;
+  return ax_tensor_copy(out, &s);
+}
+
+// Element types of the arithmetic kernels: X(TAG, suffix, storage type,
+// compute type, load, store). f16/bf16 compute in f32.
+#define AX__TENSOR_LD_ID(x) (x)
+#define AX__TENSOR_ST_ID(ct, v) ((ct)(v))
+#define AX__TENSOR_ST_F16(ct, v) ax_f32_to_f16(v)
+#define AX__TENSOR_ST_BF16(ct, v) ax_f32_to_bf16(v)
+
+#define AX__TENSOR_TYPES(X)                                             \
+  X(F32, f32, mf32, mf32, AX__TENSOR_LD_ID, AX__TENSOR_ST_ID)           \
+  X(F64, f64, mf64, mf64, AX__TENSOR_LD_ID, AX__TENSOR_ST_ID)           \
+  X(I32, i32, mi32, mi32, AX__TENSOR_LD_ID, AX__TENSOR_ST_ID)           \
+  X(I64, i64, mi64, mi64, AX__TENSOR_LD_ID, AX__TENSOR_ST_ID)           \
+  X(U8, u8, mu8, mu8, AX__TENSOR_LD_ID, AX__TENSOR_ST_ID)               \
+  X(I8, i8, mi8, mi8, AX__TENSOR_LD_ID, AX__TENSOR_ST_ID)               \
+  X(F16, f16, mu16, mf32, ax_f16_to_f32, AX__TENSOR_ST_F16)             \
+  X(BF16, bf16, mu16, mf32, ax_bf16_to_f32, AX__TENSOR_ST_BF16)
+
+// Integer arithmetic wraps and divides by 0 to 0, as for matrices
+#define AX__TENSOR_OP_ADD(x, y) AX__OP(add, x, y)
+#define AX__TENSOR_OP_SUB(x, y) AX__OP(sub, x, y)
+#define AX__TENSOR_OP_MUL(x, y) AX__OP(mul, x, y)
+#define AX__TENSOR_OP_DIV(x, y) AX__OP(div, x, y)
+
+typedef struct AxTensorBinary {
+  AxBinaryOp op;
+  const void* scalar; // Second operand of ax_tensor_scalar, in the storage type
+} AxTensorBinary;
+
+// One operator over a run: unit strides, a broadcast y or x, or general
+// strides. Operand 0 is the output.
+#define AX__DEFINE_TENSOR_BINARY(name, OP, s, ct, wt, LD, ST)           \
+  static void ax__tensor_##name##_##s(ct* o, mptrdif so, const ct* x, mptrdif sx, \
+                                      const ct* y, mptrdif sy, musz n) { \
+    if (so == 1 && sx == 1 && sy == 1) {                                \
+      for (musz j = 0; j < n; j++) o[j] = ST(ct, OP((wt)LD(x[j]), (wt)LD(y[j]))); \
+    } else if (so == 1 && sx == 1 && sy == 0) {                         \
+      wt v = (wt)LD(*y);                                                \
+      for (musz j = 0; j < n; j++) o[j] = ST(ct, OP((wt)LD(x[j]), v));  \
+    } else if (so == 1 && sx == 0 && sy == 1) {                         \
+      wt v = (wt)LD(*x);                                                \
+      for (musz j = 0; j < n; j++) o[j] = ST(ct, OP(v, (wt)LD(y[j])));  \
+    } else {                                                            \
+      for (musz j = 0; j < n; j++) {                                    \
+        mptrdif jj = (mptrdif)j;                                        \
+        o[jj * so] = ST(ct, OP((wt)LD(x[jj * sx]), (wt)LD(y[jj * sy]))); \
+      }                                                                 \
+    }                                                                   \
+  }
+
+#define AX__DEFINE_TENSOR_BINARY_DTYPE(T, s, ct, wt, LD, ST)            \
+  AX__DEFINE_TENSOR_BINARY(add, AX__TENSOR_OP_ADD, s, ct, wt, LD, ST)   \
+  AX__DEFINE_TENSOR_BINARY(sub, AX__TENSOR_OP_SUB, s, ct, wt, LD, ST)   \
+  AX__DEFINE_TENSOR_BINARY(mul, AX__TENSOR_OP_MUL, s, ct, wt, LD, ST)   \
+  AX__DEFINE_TENSOR_BINARY(div, AX__TENSOR_OP_DIV, s, ct, wt, LD, ST)   \
+  static void ax__tensor_binary_run_##s(const AxTensorLoop* l, const void* ctx, \
+                                        mu8* const* p, musz n) {        \
+    const AxTensorBinary* b = (const AxTensorBinary*)ctx;               \
+    musz d = l->ndim - 1;                                               \
+    ct* o = (ct*)p[0];                                                  \
+    const ct* x = (const ct*)p[1];                                      \
+    const ct* y = b->scalar ? (const ct*)b->scalar : (const ct*)p[2];   \
+    mptrdif so = l->strides[0][d], sx = l->strides[1][d];               \
+    mptrdif sy = b->scalar ? 0 : l->strides[2][d];                      \
+    switch (b->op) {                                                    \
+    case AX_BINARY_ADD: ax__tensor_add_##s(o, so, x, sx, y, sy, n); break; \
+    case AX_BINARY_SUB: ax__tensor_sub_##s(o, so, x, sx, y, sy, n); break; \
+    case AX_BINARY_MUL: ax__tensor_mul_##s(o, so, x, sx, y, sy, n); break; \
+    case AX_BINARY_DIV: ax__tensor_div_##s(o, so, x, sx, y, sy, n); break; \
+    }                                                                   \
+  }
+
+AX__TENSOR_TYPES(AX__DEFINE_TENSOR_BINARY_DTYPE)
+
+static void ax__tensor_binary(AxTensor* dest, const AxTensor* a, const AxTensor* b,
+                              const void* scalar, AxBinaryOp op) {
+  if (ax_tensor_numel(dest) == 0) return;
+  const AxTensor* ops[3] = { dest, a, b };
+  AxTensorLoop l;
+  ax__tensor_loop(&l, b ? 3 : 2, ops);
+  AxTensorBinary ctx = { op, scalar };
+  switch (dest->dtype) {
+#define AX__TENSOR_BINARY_CASE(T, s, ct, wt, LD, ST) case AX_##T: ax__tensor_loop_run(&l, ax__tensor_binary_run_##s, &ctx); break;
+    AX__TENSOR_TYPES(AX__TENSOR_BINARY_CASE)
+#undef AX__TENSOR_BINARY_CASE
+  }
+}
+
+bool ax_tensor_binary(AxTensor* dest, const AxTensor* a, const AxTensor* b, AxBinaryOp op) {
+  if (!ax__tensor_dest("ax_tensor_binary", dest) || !ax__tensor_valid("ax_tensor_binary", a) ||
+      !ax__tensor_valid("ax_tensor_binary", b)) {
+    return false;
+  }
+  AxTensor ea, eb;
+  if (!ax__tensor_broadcast(a, dest->ndim, dest->shape, &ea) ||
+      !ax__tensor_broadcast(b, dest->ndim, dest->shape, &eb)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_binary: cannot broadcast operands to destination shape");
+    return false;
+  }
+  if (a->dtype != dest->dtype || b->dtype != dest->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_binary: dtype mismatch (%s, %s -> %s)", ax_dtype_name(a->dtype),
+           ax_dtype_name(b->dtype), ax_dtype_name(dest->dtype));
+    return false;
+  }
+  ax__tensor_binary(dest, &ea, &eb, NULL, op);
+  return true;
+}
+
+bool ax_tensor_scalar(AxTensor* dest, const AxTensor* a, double s, AxBinaryOp op) {
+  if (!ax__tensor_dest("ax_tensor_scalar", dest) || !ax__tensor_valid("ax_tensor_scalar", a)) {
+    return false;
+  }
+  AxTensor ea;
+  if (!ax__tensor_broadcast(a, dest->ndim, dest->shape, &ea)) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_scalar: cannot broadcast operand to destination shape");
+    return false;
+  }
+  if (a->dtype != dest->dtype) {
+    AX_LOG(AX_LOG_FATAL, "ax_tensor_scalar: dtype mismatch (%s -> %s)", ax_dtype_name(a->dtype),
+           ax_dtype_name(dest->dtype));
+    return false;
+  }
+  mu64 scalar = 0;
+  ax__tensor_store(dest->dtype, &scalar, s);
+  ax__tensor_binary(dest, &ea, NULL, &scalar, op);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Reductions
+// ---------------------------------------------------------------------------
+//
+// Dimensions split into kept (K) and reduced (R) groups, each sorted by the
+// input's strides and merged like a loop nest. If the input's innermost
+// dimension is reduced, every output reduces runs along it ("run" mode);
+// otherwise outputs along the innermost kept dimension are reduced together,
+// AX_TENSOR_TILE lanes at a time, one row of the input per step ("lane"
+// mode). Either way the reduction walks a sequence of rows, summed pairwise
+// from leaves of AX__TENSOR_LEAF rows. Long runs are cut into segments of
+// at most AX_TENSOR_CHUNK elements, which count as rows; rows are split into
+// fixed chunks across tasks and the chunk partials combined pairwise.
+
+#define AX__TENSOR_LEAF 8
+
+typedef enum AxTensorReduceOp {
+  AX_TENSOR_REDUCE_SUM,
+  AX_TENSOR_REDUCE_MIN,
+  AX_TENSOR_REDUCE_MAX
+} AxTensorReduceOp;
+
+typedef struct AxTensorReduce {
+  AxTensorReduceOp op;
+  const mu8* a;
+  musz esize;
+  // Kept dimensions, without the lane dimension
+  musz nk;
+  musz kshape[AX_TENSOR_MAX_DIMS];
+  mptrdif ka[AX_TENSOR_MAX_DIMS]; // Input strides
+  mptrdif ko[AX_TENSOR_MAX_DIMS]; // Output strides
+  bool run_mode;
+  // Lane mode: the innermost kept dimension (lanes == 1 in run mode)
+  musz lanes;
+  mptrdif la, lo;
+  musz tiles; // Lane tiles per kept index
+  // Row dimensions: R, without the run dimension in run mode
+  musz nr;
+  musz rshape[AX_TENSOR_MAX_DIMS];
+  mptrdif ra[AX_TENSOR_MAX_DIMS];
+  // Run mode: the innermost reduced dimension, cut into `segs` segments
+  musz run;
+  mptrdif rs;
+  musz segs;
+  musz nrows; // Rows (times segments) per output
+  musz chunk_rows;
+  musz nchunks;
+  double* partial; // nchunks values per output when nchunks > 1
+  AxTensor* out;
+  mu8* o;
+  musz oesize;
+  double scale; // Applied to sums on store (1 / count for means)
+} AxTensorReduce;
+
+static inline double ax__tensor_reduce_identity(AxTensorReduceOp op) {
+  return op == AX_TENSOR_REDUCE_SUM ? 0.0 : (op == AX_TENSOR_REDUCE_MIN ? INFINITY : -INFINITY);
+}
+
+static inline double ax__tensor_combine(AxTensorReduceOp op, double acc, double v) {
+  switch (op) {
+  case AX_TENSOR_REDUCE_SUM: return acc + v;
+  case AX_TENSOR_REDUCE_MIN: return v < acc ? v : acc;
+  case AX_TENSOR_REDUCE_MAX: return v > acc ? v : acc;
+  }
+  return acc;
+}
+
+// Reduction of one segment (eight lanes, unit stride fast path) and lane
+// updates acc[l] (+)= x[l * la] for one row.
+#define AX__DEFINE_TENSOR_REDUCE(T, s, ct, wt, LD, ST)                  \
+  static double ax__tensor_segment_##s(AxTensorReduceOp op, const ct* x, mptrdif sx, musz n) { \
+    double acc[8];                                                      \
+    double id = ax__tensor_reduce_identity(op);                         \
+    for (musz l = 0; l < 8; l++) acc[l] = id;                           \
+    musz i = 0;                                                         \
+    if (op == AX_TENSOR_REDUCE_SUM && sx == 1) {                        \
+      for (; i + 8 <= n; i += 8) {                                      \
+        for (musz l = 0; l < 8; l++) acc[l] += (double)LD(x[i + l]);    \
+      }                                                                 \
+    } else if (sx == 1) {                                               \
+      for (; i + 8 <= n; i += 8) {                                      \
+        for (musz l = 0; l < 8; l++) acc[l] = ax__tensor_combine(op, acc[l], (double)LD(x[i + l])); \
+      }                                                                 \
+    }                                                                   \
+    for (; i < n; i++) acc[0] = ax__tensor_combine(op, acc[0], (double)LD(x[(mptrdif)i * sx])); \
+    for (musz l = 0; l < 4; l++) acc[l] = ax__tensor_combine(op, acc[l], acc[l + 4]); \
+    return ax__tensor_combine(op, ax__tensor_combine(op, acc[0], acc[2]), \
+                              ax__tensor_combine(op, acc[1], acc[3])); \
+  }                                                                     \
+                                                                        \
+  static void ax__tensor_lanes_##s(AxTensorReduceOp op, const ct* x, mptrdif la, musz w, double* acc) { \
+    if (op == AX_TENSOR_REDUCE_SUM && la == 1) {                        \
+      for (musz l = 0; l < w; l++) acc[l] += (double)LD(x[l]);          \
+    } else {                                                            \
+      for (musz l = 0; l < w; l++) acc[l] = ax__tensor_combine(op, acc[l], (double)LD(x[(mptrdif)l * la])); \
+    }                                                                   \
+  }
+
+AX__TENSOR_TYPES(AX__DEFINE_TENSOR_REDUCE)
+
+static double ax__tensor_segment(AxDType dtype, AxTensorReduceOp op, const void* x, mptrdif sx, musz n) {
+  switch (dtype) {
+#define AX__TENSOR_SEGMENT_CASE(T, s, ct, wt, LD, ST) case AX_##T: return ax__tensor_segment_##s(op, (const ct*)x, sx, n);
+    AX__TENSOR_TYPES(AX__TENSOR_SEGMENT_CASE)
+#undef AX__TENSOR_SEGMENT_CASE
+  }
+  return 0;
+}
+
+static void ax__tensor_lanes(AxDType dtype, AxTensorReduceOp op, const void* x, mptrdif la, musz w, double* acc) {
+  switch (dtype) {
+#define AX__TENSOR_LANES_CASE(T, s, ct, wt, LD, ST) case AX_##T: ax__tensor_lanes_##s(op, (const ct*)x, la, w, acc); break;
+    AX__TENSOR_TYPES(AX__TENSOR_LANES_CASE)
+#undef AX__TENSOR_LANES_CASE
+  }
+}
+
+typedef struct AxTensorReduceTask {
+  const AxTensorReduce* r;
+  AxDType dtype;
+} AxTensorReduceTask;
+
+// Folds rows [v0, v1) (a leaf) into acc[0..w), starting from `base`
+static void ax__tensor_reduce_leaf(const AxTensorReduceTask* t, const mu8* base, musz v0, musz v1,
+                                   musz w, double* acc) {
+  const AxTensorReduce* r = t->r;
+  if (v0 >= v1) return;
+  musz row = v0 / r->segs, seg = v0 % r->segs;
+  musz idx[AX_TENSOR_MAX_DIMS];
+  mptrdif off = 0;
+  musz rem = row;
+  for (musz d = r->nr; d-- > 0;) {
+    idx[d] = rem % r->rshape[d];
+    rem /= r->rshape[d];
+    off += (mptrdif)idx[d] * r->ra[d];
+  }
+  for (musz v = v0; v < v1; v++) {
+    const mu8* x = base + off * (mptrdif)r->esize;
+    if (r->run_mode) {
+      musz j = seg * AX_TENSOR_CHUNK;
+      musz n = (r->run - j < AX_TENSOR_CHUNK) ? r->run - j : AX_TENSOR_CHUNK;
+      double val = ax__tensor_segment(t->dtype, r->op, x + (mptrdif)j * r->rs * (mptrdif)r->esize, r->rs, n);
+      acc[0] = ax__tensor_combine(r->op, acc[0], val);
+    } else {
+      ax__tensor_lanes(t->dtype, r->op, x, r->la, w, acc);
+    }
+    if (++seg < r->segs) continue;
+    seg = 0;
+    for (musz d = r->nr; d-- > 0;) {
+      off += r->ra[d];
+      if (++idx[d] < r->rshape[d]) break;
+      off -= (mptrdif)r->rshape[d] * r->ra[d];
+      idx[d] = 0;
+    }
+  }
+}
+
+// Pairwise over rows [v0, v1): acc starts at the identity
+static void ax__tensor_reduce_rows(const AxTensorReduceTask* t, const mu8* base, musz v0, musz v1,
+                                   musz w, double* acc) {
+  if (v1 - v0 <= AX__TENSOR_LEAF) {
+    ax__tensor_reduce_leaf(t, base, v0, v1, w, acc);
+    return;
+  }
+  musz mid = v0 + (v1 - v0) / 2;
+  double right[AX_TENSOR_TILE];
+  double id = ax__tensor_reduce_identity(t->r->op);
+  for (musz l = 0; l < w; l++) right[l] = id;
+  ax__tensor_reduce_rows(t, base, v0, mid, w, acc);
+  ax__tensor_reduce_rows(t, base, mid, v1, w, right);
+  for (musz l = 0; l < w; l++) acc[l] = ax__tensor_combine(t->r->op, acc[l], right[l]);
+}
+
+static void ax__tensor_reduce_store(const AxTensorReduce* r, mptrdif off, double v) {
+  if (r->op == AX_TENSOR_REDUCE_SUM) v *= r->scale;
+  ax__tensor_store(r->out->dtype, r->o + off * (mptrdif)r->oesize, v);
+}
+
+// Item k: (kept index, lane tile, row chunk)
+static void ax__tensor_reduce_task(void* ctx, musz begin, musz end) {
+  const AxTensorReduceTask* t = (const AxTensorReduceTask*)ctx;
+  const AxTensorReduce* r = t->r;
+  double acc[AX_TENSOR_TILE];
+  for (musz k = begin; k < end; k++) {
+    musz c = k % r->nchunks;
+    musz unit = k / r->nchunks;
+    musz tile = unit % r->tiles;
+    musz rem = unit / r->tiles;
+    mptrdif ia = 0, io = 0;
+    for (musz d = r->nk; d-- > 0;) {
+      musz i = rem % r->kshape[d];
+      rem /= r->kshape[d];
+      ia += (mptrdif)i * r->ka[d];
+      io += (mptrdif)i * r->ko[d];
+    }
+    musz l0 = tile * AX_TENSOR_TILE;
+    musz w = (r->lanes - l0 < AX_TENSOR_TILE) ? r->lanes - l0 : AX_TENSOR_TILE;
+    ia += (mptrdif)l0 * r->la;
+    io += (mptrdif)l0 * r->lo;
+    double id = ax__tensor_reduce_identity(r->op);
+    for (musz l = 0; l < w; l++) acc[l] = id;
+    musz v0 = c * r->chunk_rows;
+    musz v1 = (r->nrows - v0 < r->chunk_rows) ? r->nrows : v0 + r->chunk_rows;
+    ax__tensor_reduce_rows(t, r->a + ia * (mptrdif)r->esize, v0, v1, w, acc);
+    if (r->nchunks == 1) {
+      for (musz l = 0; l < w; l++) ax__tensor_reduce_store(r, io + (mptrdif)l * r->lo, acc[l]);
+    } else {
+      for (musz l = 0; l < w; l++) r->partial[((unit * AX_TENSOR_TILE) + l) * r->nchunks + c] = acc[l];
+    }
+  }
+}
+
+// Pairwise combination of the chunk partials of one output
+static double ax__tensor_reduce_partials(AxTensorReduceOp op, const double* p, musz n) {
+  if (n == 1) return p[0];
+  musz mid = n / 2;
+  return ax__tensor_combine(op, ax__tensor_reduce_partials(op, p, mid),
+                            ax__tensor_reduce_partials(op, p + mid, n - mid));
+}
+
+static void ax__tensor_combine_task(void* ctx, musz begin, musz end) {
+  const AxTensorReduceTask* t = (const AxTensorReduceTask*)ctx;
+  const AxTensorReduce* r = t->r;
+  for (musz unit = begin; unit < end; unit++) {
+    musz tile = unit % r->tiles;
+    musz rem = unit / r->tiles;
+    mptrdif io = 0;
+    for (musz d = r->nk; d-- > 0;) {
+      io += (mptrdif)(rem % r->kshape[d]) * r->ko[d];
+      rem /= r->kshape[d];
+    }
+    musz l0 = tile * AX_TENSOR_TILE;
+    musz w = (r->lanes - l0 < AX_TENSOR_TILE) ? r->lanes - l0 : AX_TENSOR_TILE;
+    for (musz l = 0; l < w; l++) {
+      const double* p = r->partial + ((unit * AX_TENSOR_TILE) + l) * r->nchunks;
+      ax__tensor_reduce_store(r, io + (mptrdif)(l0 + l) * r->lo, ax__tensor_reduce_partials(r->op, p, r->nchunks));
+    }
+  }
+}
+
+// Sorts dimensions [0, n) by |a stride| descending and merges neighbours
+// contiguous in both the input and the output
+static musz ax__tensor_reduce_group(musz n, musz* shape, mptrdif* sa, mptrdif* so) {
+  for (musz i = 1; i < n; i++) {
+    for (musz j = i; j > 0; j--) {
+      mptrdif x = sa[j - 1] < 0 ? -sa[j - 1] : sa[j - 1];
+      mptrdif y = sa[j] < 0 ? -sa[j] : sa[j];
+      if (x >= y) break;
+      musz sh = shape[j];
+      shape[j] = shape[j - 1];
+      shape[j - 1] = sh;
+      mptrdif s = sa[j];
+      sa[j] = sa[j - 1];
+      sa[j - 1] = s;
+      s = so[j];
+      so[j] = so[j - 1];
+      so[j - 1] = s;
+    }
+  }
+  musz m = 0;
+  for (musz d = 0; d < n; d++) {
+    if (m > 0 && sa[m - 1] == sa[d] * (mptrdif)shape[d] && so[m - 1] == so[d] * (mptrdif)shape[d]) {
+      shape[m - 1] *= shape[d];
+      sa[m - 1] = sa[d];
+      so[m - 1] = so[d];
+    } else {
+      shape[m] = shape[d];
+      sa[m] = sa[d];
+      so[m] = so[d];
+      m++;
+    }
+  }
+  return m;
+}
+
+static bool ax__tensor_reduce(const char* name, AxTensorReduceOp op, bool mean,
+                              const AxTensor* a, musz dims, AxTensor* out) {
+  if (!ax__tensor_valid(name, a) || !ax__tensor_dest(name, out)) return false;
+  if (dims == AX_TENSOR_ALL_DIMS) dims = AX_TENSOR_DIM(a->ndim) - 1;
+  if (dims >> a->ndim) {
+    AX_LOG(AX_LOG_FATAL, "%s: reduced dimension out of range (ndim %zu)", name, (size_t)a->ndim);
+    return false;
+  }
+  // Output strides per input dimension (0 for reduced ones), from an `out`
+  // that keeps the reduced dimensions or drops them
+  musz nred = (musz)__builtin_popcountll((unsigned long long)dims);
+  mptrdif ostr[AX_TENSOR_MAX_DIMS];
+  bool keep = out->ndim == a->ndim;
+  if (!keep && out->ndim != a->ndim - nred) {
+    AX_LOG(AX_LOG_FATAL, "%s: output has %zu dimensions", name, (size_t)out->ndim);
+    return false;
+  }
+  musz count = 1;
+  for (musz d = 0, od = 0; d < a->ndim; d++) {
+    bool reduced = dims & AX_TENSOR_DIM(d);
+    if (reduced) count *= a->shape[d];
+    if (reduced && !keep) {
+      ostr[d] = 0;
+      continue;
+    }
+    musz want = reduced ? 1 : a->shape[d];
+    if (out->shape[od] != want) {
+      AX_LOG(AX_LOG_FATAL, "%s: output dimension %zu has size %zu (expected %zu)", name,
+             (size_t)od, (size_t)out->shape[od], (size_t)want);
+      return false;
+    }
+    ostr[d] = reduced ? 0 : out->strides[od];
+    od++;
+  }
+  AxTensorReduce r = { 0 };
+  r.op = op;
+  r.a = (const mu8*)a->data;
+  r.esize = ax_dtype_size(a->dtype);
+  r.out = out;
+  r.o = (mu8*)out->data;
+  r.oesize = ax_dtype_size(out->dtype);
+  r.scale = (mean && count) ? 1.0 / (double)count : 1.0;
+  if (ax_tensor_numel(out) == 0) return true;
+  mptrdif rso[AX_TENSOR_MAX_DIMS];
+  for (musz d = 0; d < a->ndim; d++) {
+    musz n = a->shape[d];
+    mptrdif s = a->strides[d];
+    if (n == 1) continue;
+    if (dims & AX_TENSOR_DIM(d)) {
+      if (s < 0) { // Reversed: walk forwards (kept outputs do not move)
+        r.a += (mptrdif)(n - 1) * s * (mptrdif)r.esize;
+        s = -s;
+      }
+      r.rshape[r.nr] = n;
+      r.ra[r.nr] = s;
+      rso[r.nr] = 0;
+      r.nr++;
+    } else {
+      r.kshape[r.nk] = n;
+      r.ka[r.nk] = s;
+      r.ko[r.nk] = ostr[d];
+      r.nk++;
+    }
+  }
+  r.nk = ax__tensor_reduce_group(r.nk, r.kshape, r.ka, r.ko);
+  r.nr = ax__tensor_reduce_group(r.nr, r.rshape, r.ra, rso);
+  mptrdif kin = r.nk ? (r.ka[r.nk - 1] < 0 ? -r.ka[r.nk - 1] : r.ka[r.nk - 1]) : 0;
+  r.lanes = 1;
+  r.run = 1;
+  r.segs = 1;
+  if (r.nr > 0 && (r.nk == 0 || r.ra[r.nr - 1] <= kin)) {
+    r.run_mode = true;
+    r.nr--;
+    r.run = r.rshape[r.nr];
+    r.rs = r.ra[r.nr];
+    r.segs = r.run ? (r.run + AX_TENSOR_CHUNK - 1) / AX_TENSOR_CHUNK : 1;
+  } else if (r.nk > 0) {
+    r.nk--;
+    r.lanes = r.kshape[r.nk];
+    r.la = r.ka[r.nk];
+    r.lo = r.ko[r.nk];
+  }
+  r.tiles = (r.lanes + AX_TENSOR_TILE - 1) / AX_TENSOR_TILE;
+  musz rows = 1;
+  for (musz d = 0; d < r.nr; d++) rows *= r.rshape[d];
+  r.nrows = rows * r.segs;
+  musz units = r.tiles;
+  for (musz d = 0; d < r.nk; d++) units *= r.kshape[d];
+  // Elements per row decide the fixed row chunks
+  musz row_elems = (r.segs > 1) ? AX_TENSOR_CHUNK : (r.run > 1 ? r.run : (r.lanes < AX_TENSOR_TILE ? r.lanes : AX_TENSOR_TILE));
+  r.chunk_rows = AX_TENSOR_CHUNK / row_elems;
+  if (r.chunk_rows == 0) r.chunk_rows = 1;
+  r.nchunks = (r.nrows + r.chunk_rows - 1) / r.chunk_rows;
+  if (r.nchunks == 0) { // Nothing to reduce: identities
+    r.nrows = 0;
+    r.nchunks = 1;
+  }
+  if (r.nchunks > 1) {
+    r.partial = (double*)malloc(units * AX_TENSOR_TILE * r.nchunks * sizeof(double));
+    if (!r.partial) {
+      AX_LOG(AX_LOG_FATAL, "%s: failed to allocate partial results", name);
+      return false;
+    }
+  }
+  AxTensorReduceTask t = { &r, a->dtype };
+  musz item = (r.nrows < r.chunk_rows ? r.nrows : r.chunk_rows) * row_elems; // Elements per item
+  musz grain = AX_TENSOR_CHUNK / (item ? item : 1) + 1;
+  ax_parallel_for(units * r.nchunks, grain, ax__tensor_reduce_task, &t);
+  if (r.partial) {
+    ax_parallel_for(units, AX_TENSOR_CHUNK / (r.nchunks * AX_TENSOR_TILE) + 1, ax__tensor_combine_task, &t);
+    free(r.partial);
+  }
+  return true;
+}
+
+bool ax_tensor_sum(const AxTensor* a, musz dims, AxTensor* out) {
+  return ax__tensor_reduce("ax_tensor_sum", AX_TENSOR_REDUCE_SUM, false, a, dims, out);
+}
+
+bool ax_tensor_mean(const AxTensor* a, musz dims, AxTensor* out) {
+  return ax__tensor_reduce("ax_tensor_mean", AX_TENSOR_REDUCE_SUM, true, a, dims, out);
+}
+
+bool ax_tensor_min(const AxTensor* a, musz dims, AxTensor* out) {
+  return ax__tensor_reduce("ax_tensor_min", AX_TENSOR_REDUCE_MIN, false, a, dims, out);
+}
+
+bool ax_tensor_max(const AxTensor* a, musz dims, AxTensor* out) {
+  return ax__tensor_reduce("ax_tensor_max", AX_TENSOR_REDUCE_MAX, false, a, dims, out);
+}
+
+// ---------------------------------------------------------------------------
+// Einsum
+// ---------------------------------------------------------------------------
+//
+// Labels are bits 0-51 (a-z, then A-Z). Every term, operand or
+// intermediate, is a strided view with one dimension per distinct label.
+// A pairwise contraction splits the labels of its two terms into batch
+// (both, kept), m (first only), n (second only) and k (summed) groups; when
+// the labels of each group merge into one stride, the pair is a strided
+// batched GEMM over the views as they are.
+
+#define AX_EINSUM_LABELS 52
+#define AX_EINSUM_BLOCK ((musz)1 << 20) // Block size of a private scratch arena
+
+typedef struct AxEinsumSpec {
+  musz count;
+  musz nlab[AX_EINSUM_MAX_OPERANDS];
+  mu8 lab[AX_EINSUM_MAX_OPERANDS][AX_TENSOR_MAX_DIMS];
+  musz nout;
+  mu8 out[AX_TENSOR_MAX_DIMS];
+  mu64 out_mask;
+  mu64 all_mask;
+  mu64 masks[AX_EINSUM_MAX_OPERANDS]; // Labels left after the single-operand sums
+  musz size[AX_EINSUM_LABELS];
+} AxEinsumSpec;
+
+typedef struct AxEinsumTerm {
+  AxTensor t; // Dimension d carries label lab[d]
+  mu8 lab[AX_TENSOR_MAX_DIMS];
+  mu64 mask;
+} AxEinsumTerm;
+
+static inline mu64 ax__einsum_bit(mu8 l) {
+  return (mu64)1 << l;
+}
+
+static inline char ax__einsum_char(mu8 l) {
+  return (char)(l < 26 ? 'a' + l : 'A' + (l - 26));
+}
+
+static double ax__einsum_size(const AxEinsumSpec* s, mu64 mask) {
+  double n = 1.0;
+  for (; mask; mask &= mask - 1) n *= (double)s->size[__builtin_ctzll(mask)];
+  return n;
+}
+
+static musz ax__einsum_popcount(mu64 mask) {
+  return (musz)__builtin_popcountll((unsigned long long)mask);
+}
+
+static bool ax__einsum_parse(const char* name, const char* spec, const AxTensor* const* ops,
+                             musz count, AxEinsumSpec* s) {
+  if (!spec || !ops || count == 0 || count > AX_EINSUM_MAX_OPERANDS) {
+    AX_LOG(AX_LOG_FATAL, "%s: invalid arguments (1 to %d operands)", name, AX_EINSUM_MAX_OPERANDS);
+    return false;
+  }
+  memset(s, 0, sizeof(*s));
+  s->count = count;
+  musz uses[AX_EINSUM_LABELS] = { 0 };
+  musz op = 0;
+  bool arrow = false;
+  for (const char* p = spec; *p; p++) {
+    char ch = *p;
+    if (ch == ' ') continue;
+    if (ch == ',' && !arrow) {
+      if (++op == count) {
+        AX_LOG(AX_LOG_FATAL, "%s: \"%s\" has more terms than the %zu operands", name, spec, (size_t)count);
+        return false;
+      }
+      continue;
+    }
+    if (ch == '-' && p[1] == '>' && !arrow) {
+      arrow = true;
+      p++;
+      continue;
+    }
+    int l = (ch >= 'a' && ch <= 'z') ? ch - 'a' : ((ch >= 'A' && ch <= 'Z') ? ch - 'A' + 26 : -1);
+    if (l < 0) {
+      AX_LOG(AX_LOG_FATAL, "%s: unexpected '%c' in \"%s\" (labels are a-z and A-Z)", name, ch, spec);
+      return false;
+    }
+    musz* n = arrow ? &s->nout : &s->nlab[op];
+    if (*n == AX_TENSOR_MAX_DIMS) {
+      AX_LOG(AX_LOG_FATAL, "%s: a term of \"%s\" has more than %d labels", name, spec, AX_TENSOR_MAX_DIMS);
+      return false;
+    }
+    if (arrow) {
+      if (s->out_mask & ax__einsum_bit((mu8)l)) {
+        AX_LOG(AX_LOG_FATAL, "%s: output label '%c' repeats", name, ch);
+        return false;
+      }
+      s->out[(*n)++] = (mu8)l;
+      s->out_mask |= ax__einsum_bit((mu8)l);
+    } else {
+      s->lab[op][(*n)++] = (mu8)l;
+      uses[l]++;
+    }
+  }
+  if (op + 1 != count) {
+    AX_LOG(AX_LOG_FATAL, "%s: \"%s\" has %zu terms for %zu operands", name, spec, (size_t)(op + 1), (size_t)count);
+    return false;
+  }
+  for (musz i = 0; i < count; i++) {
+    if (!ax__tensor_valid(name, ops[i])) return false;
+    if (ops[i]->ndim != s->nlab[i]) {
+      AX_LOG(AX_LOG_FATAL, "%s: operand %zu has %zu dimensions but %zu labels", name, (size_t)i,
+             (size_t)ops[i]->ndim, (size_t)s->nlab[i]);
+      return false;
+    }
+    for (musz d = 0; d < s->nlab[i]; d++) {
+      mu8 l = s->lab[i][d];
+      if ((s->all_mask & ax__einsum_bit(l)) && s->size[l] != ops[i]->shape[d]) {
+        AX_LOG(AX_LOG_FATAL, "%s: label '%c' has sizes %zu and %zu", name, ax__einsum_char(l),
+               (size_t)s->size[l], (size_t)ops[i]->shape[d]);
+        return false;
+      }
+      s->size[l] = ops[i]->shape[d];
+      s->all_mask |= ax__einsum_bit(l);
+      s->masks[i] |= ax__einsum_bit(l);
+    }
+  }
+  if (!arrow) { // Implicit output: uppercase sorts before lowercase
+    for (musz q = 0; q < AX_EINSUM_LABELS; q++) {
+      mu8 l = (mu8)((q + 26) % AX_EINSUM_LABELS);
+      if (uses[l] != 1) continue;
+      if (s->nout == AX_TENSOR_MAX_DIMS) {
+        AX_LOG(AX_LOG_FATAL, "%s: the output of \"%s\" has more than %d labels", name, spec, AX_TENSOR_MAX_DIMS);
+        return false;
+      }
+      s->out[s->nout++] = l;
+      s->out_mask |= ax__einsum_bit(l);
+    }
+  }
+  if (s->out_mask & ~s->all_mask) {
+    AX_LOG(AX_LOG_FATAL, "%s: output label '%c' is in no operand", name,
+           ax__einsum_char((mu8)__builtin_ctzll(s->out_mask & ~s->all_mask)));
+    return false;
+  }
+  // A label in a single operand and not in the output is summed there first
+  for (musz i = 0; i < count; i++) {
+    mu64 others = s->out_mask;
+    for (musz j = 0; j < count; j++) {
+      if (j != i) others |= s->masks[j];
+    }
+    s->masks[i] &= others;
+  }
+  return true;
+}
+
+// Contracts the cheapest pair (ties: smaller result) until one term is left
+static bool ax__einsum_greedy(const char* name, const AxEinsumSpec* s, AxEinsumInfo* info) {
+  mu64 mask[AX_EINSUM_MAX_OPERANDS];
+  musz id[AX_EINSUM_MAX_OPERANDS];
+  musz n = s->count;
+  for (musz i = 0; i < n; i++) {
+    mask[i] = s->masks[i];
+    id[i] = i;
+  }
+  while (n > 1) {
+    musz bi = 0, bj = 0;
+    double best = -1.0, best_size = 0.0;
+    mu64 best_keep = 0;
+    for (musz i = 0; i < n; i++) {
+      for (musz j = i + 1; j < n; j++) {
+        mu64 rest = s->out_mask;
+        for (musz q = 0; q < n; q++) {
+          if (q != i && q != j) rest |= mask[q];
+        }
+        mu64 keep = (mask[i] | mask[j]) & rest;
+        if (ax__einsum_popcount(keep) > AX_TENSOR_MAX_DIMS) continue;
+        double cost = ax__einsum_size(s, mask[i] | mask[j]);
+        double size = ax__einsum_size(s, keep);
+        if (best < 0 || cost < best || (cost == best && size < best_size)) {
+          bi = i;
+          bj = j;
+          best = cost;
+          best_size = size;
+          best_keep = keep;
+        }
+      }
+    }
+    if (best < 0) {
+      AX_LOG(AX_LOG_FATAL, "%s: every contraction left needs more than %d dimensions", name, AX_TENSOR_MAX_DIMS);
+      return false;
+    }
+    info->pairs[info->steps][0] = id[bi];
+    info->pairs[info->steps][1] = id[bj];
+    info->flops += best;
+    mask[bi] = best_keep;
+    id[bi] = s->count + info->steps++;
+    mask[bj] = mask[n - 1];
+    id[bj] = id[n - 1];
+    n--;
+  }
+  return true;
+}
+
+// Appends the steps that build the terms of `set` (post-order) and returns
+// the id of its result
+static musz ax__einsum_emit(const AxEinsumSpec* s, const musz* split, musz set, AxEinsumInfo* info) {
+  if (!(set & (set - 1))) return (musz)__builtin_ctzll(set);
+  musz a = ax__einsum_emit(s, split, split[set], info);
+  musz b = ax__einsum_emit(s, split, set ^ split[set], info);
+  info->pairs[info->steps][0] = a;
+  info->pairs[info->steps][1] = b;
+  return s->count + info->steps++;
+}
+
+// cost[S] is the cheapest way to contract the operands of subset S into one
+// term, whose labels are those of S still needed outside it
+static bool ax__einsum_optimal(const char* name, const AxEinsumSpec* s, AxEinsumInfo* info) {
+  musz full = ((musz)1 << s->count) - 1;
+  mu64* labels = (mu64*)malloc((full + 1) * sizeof(mu64));
+  mu64* need = (mu64*)malloc((full + 1) * sizeof(mu64));
+  double* cost = (double*)calloc(full + 1, sizeof(double));
+  musz* split = (musz*)malloc((full + 1) * sizeof(musz));
+  bool ok = labels && need && cost && split;
+  if (!ok) {
+    AX_LOG(AX_LOG_FATAL, "%s: failed to allocate the path search tables", name);
+  } else {
+    labels[0] = 0;
+    for (musz set = 1; set <= full; set++) {
+      labels[set] = labels[set & (set - 1)] | s->masks[__builtin_ctzll(set)];
+    }
+    for (musz set = 1; set <= full; set++) {
+      need[set] = labels[set] & (s->out_mask | labels[full ^ set]);
+      cost[set] = (set & (set - 1)) ? -1.0 : 0.0; // -1: no order found
+      if (cost[set] == 0.0 || ax__einsum_popcount(need[set]) > AX_TENSOR_MAX_DIMS) continue;
+      musz low = set & (~set + 1);
+      for (musz sub = (set - 1) & set; sub; sub = (sub - 1) & set) {
+        if (!(sub & low)) continue; // Each split once
+        musz other = set ^ sub;
+        if (cost[sub] < 0 || cost[other] < 0) continue;
+        double c = cost[sub] + cost[other] + ax__einsum_size(s, need[sub] | need[other]);
+        if (cost[set] < 0 || c < cost[set]) {
+          cost[set] = c;
+          split[set] = sub;
+        }
+      }
+    }
+    ok = cost[full] >= 0;
+    if (!ok) {
+      AX_LOG(AX_LOG_FATAL, "%s: every contraction order needs more than %d dimensions", name, AX_TENSOR_MAX_DIMS);
+    } else {
+      ax__einsum_emit(s, split, full, info);
+      info->flops = cost[full];
+    }
+  }
+  free(labels);
+  free(need);
+  free(cost);
+  free(split);
+  return ok;
+}
+
+static bool ax__einsum_plan(const char* name, const AxEinsumSpec* s, AxEinsumPath path, AxEinsumInfo* info) {
+  memset(info, 0, sizeof(*info));
+  info->naive_flops = ax__einsum_size(s, s->all_mask);
+  if (path == AX_EINSUM_OPTIMAL && s->count > AX_EINSUM_OPTIMAL_MAX) {
+    AX_LOG(AX_LOG_WARN, "%s: %zu operands, searching greedily (optimal up to %d)", name,
+           (size_t)s->count, AX_EINSUM_OPTIMAL_MAX);
+    path = AX_EINSUM_GREEDY;
+  }
+  if (s->count == 1) return true;
+  return (path == AX_EINSUM_OPTIMAL) ? ax__einsum_optimal(name, s, info) : ax__einsum_greedy(name, s, info);
+}
+
+bool ax_einsum_path(const char* spec, const AxTensor* const* operands, musz count,
+                    AxEinsumPath path, AxEinsumInfo* info) {
+  AxEinsumSpec s;
+  if (!info) {
+    AX_LOG(AX_LOG_FATAL, "ax_einsum_path: null info");
+    return false;
+  }
+  if (!ax__einsum_parse("ax_einsum_path", spec, operands, count, &s)) return false;
+  return ax__einsum_plan("ax_einsum_path", &s, path, info);
+}
+
+static mptrdif ax__einsum_stride(const AxEinsumTerm* x, mu8 l) {
+  for (musz d = 0; d < x->t.ndim; d++) {
+    if (x->lab[d] == l) return x->t.strides[d];
+  }
+  return 0; // Broadcast along labels the term lacks
+}
+
+// `x` with one dimension per label of `lab`, in that order
+static void ax__einsum_view(const AxEinsumSpec* s, const AxEinsumTerm* x, musz n, const mu8* lab, AxTensor* out) {
+  *out = x->t;
+  out->data_owner = false;
+  out->ndim = n;
+  for (musz d = 0; d < n; d++) {
+    out->shape[d] = s->size[lab[d]];
+    out->strides[d] = ax__einsum_stride(x, lab[d]);
+  }
+}
+
+// Orders a label group by decreasing stride in `x`, the order most likely
+// to merge
+static void ax__einsum_sort(const AxEinsumTerm* x, musz n, mu8* lab) {
+  for (musz i = 1; i < n; i++) {
+    mu8 l = lab[i];
+    mptrdif st = ax__einsum_stride(x, l);
+    musz j = i;
+    for (; j > 0 && ax__einsum_stride(x, lab[j - 1]) < st; j--) lab[j] = lab[j - 1];
+    lab[j] = l;
+  }
+}
+
+// The labels of `lab` as one row-major index of `x`: its extent and stride,
+// when a single non-negative stride walks them all
+static bool ax__einsum_group(const AxEinsumSpec* s, const AxEinsumTerm* x, musz n, const mu8* lab,
+                             musz* size, musz* stride) {
+  musz total = 1;
+  mptrdif inner = 0, expect = 0;
+  bool any = false;
+  for (musz d = n; d-- > 0;) {
+    musz len = s->size[lab[d]];
+    total *= len;
+    if (len == 1) continue;
+    mptrdif st = ax__einsum_stride(x, lab[d]);
+    if (st < 0 || (any && st != expect)) return false;
+    if (!any) inner = st;
+    any = true;
+    expect = st * (mptrdif)len;
+  }
+  *size = total;
+  *stride = (musz)inner;
+  return true;
+}
+
+static bool ax__einsum_groups(const AxEinsumSpec* s, const AxEinsumTerm* x, musz ng, const musz* n,
+                              mu8 (*lab)[AX_TENSOR_MAX_DIMS], musz* size, musz* stride) {
+  for (musz g = 0; g < ng; g++) {
+    if (!ax__einsum_group(s, x, n[g], lab[g], &size[g], &stride[g])) return false;
+  }
+  return true;
+}
+
+// Copies `x` into a row-major term with the labels of `ng` groups in order
+static bool ax__einsum_pack(const AxEinsumSpec* s, const AxEinsumTerm* x, musz ng, const musz* n,
+                            mu8 (*lab)[AX_TENSOR_MAX_DIMS], Arena* arena, AxEinsumTerm* out) {
+  mu8 order[AX_TENSOR_MAX_DIMS];
+  musz nd = 0;
+  for (musz g = 0; g < ng; g++) {
+    for (musz d = 0; d < n[g]; d++) order[nd++] = lab[g][d];
+  }
+  AxTensor v;
+  ax__einsum_view(s, x, nd, order, &v);
+  if (!ax_tensor_contiguous(&v, &out->t, arena)) return false;
+  memcpy(out->lab, order, nd);
+  out->mask = x->mask;
+  return true;
+}
+
+// Operand `i` as a term: repeated labels read one diagonal dimension (their
+// strides add up), and labels no other term needs are summed out
+static bool ax__einsum_operand(const AxEinsumSpec* s, musz i, const AxTensor* op, AxDType cdtype,
+                               Arena* arena, AxEinsumTerm* x) {
+  x->t = *op;
+  x->t.data_owner = false;
+  x->t.ndim = 0;
+  x->mask = 0;
+  for (musz d = 0; d < op->ndim; d++) {
+    mu8 l = s->lab[i][d];
+    musz q = 0;
+    while (q < x->t.ndim && x->lab[q] != l) q++;
+    if (q < x->t.ndim) {
+      x->t.strides[q] += op->strides[d];
+      continue;
+    }
+    x->lab[q] = l;
+    x->t.shape[q] = op->shape[d];
+    x->t.strides[q] = op->strides[d];
+    x->t.ndim++;
+    x->mask |= ax__einsum_bit(l);
+  }
+  if (x->mask == s->masks[i]) return true;
+  musz dims = 0, nr = 0;
+  musz shape[AX_TENSOR_MAX_DIMS];
+  for (musz d = 0; d < x->t.ndim; d++) {
+    if (s->masks[i] & ax__einsum_bit(x->lab[d])) {
+      shape[nr] = x->t.shape[d];
+      x->lab[nr++] = x->lab[d];
+    } else {
+      dims |= AX_TENSOR_DIM(d);
+    }
+  }
+  AxTensor r;
+  if (!ax_tensor_init(&r, nr, shape, cdtype, arena) || !ax_tensor_sum(&x->t, dims, &r)) return false;
+  x->t = r;
+  x->mask = s->masks[i];
+  return true;
+}
+
+// c = the contraction of a and b keeping the labels in `keep`, laid out
+// row-major as [batch, m, n]
+static bool ax__einsum_contract(const AxEinsumSpec* s, const AxEinsumTerm* a, const AxEinsumTerm* b,
+                                mu64 keep, AxDType cdtype, Arena* arena, AxEinsumTerm* c) {
+  mu64 batch = a->mask & b->mask & keep;
+  mu64 masks[4] = { batch, a->mask & keep & ~batch, (a->mask | b->mask) & ~keep, b->mask & keep & ~batch };
+  mu8 lab[4][AX_TENSOR_MAX_DIMS]; // batch, m, k, n
+  musz n[4] = { 0 };
+  for (musz g = 0; g < 4; g++) {
+    for (mu64 m = masks[g]; m; m &= m - 1) lab[g][n[g]++] = (mu8)__builtin_ctzll(m);
+  }
+  // Groups follow a's strides (n follows b's); the shared ones follow b
+  // instead when a needs a copy anyway
+  for (musz g = 0; g < 3; g++) ax__einsum_sort(a, n[g], lab[g]);
+  ax__einsum_sort(b, n[3], lab[3]);
+  musz an[3] = { n[0], n[1], n[2] }, bn[3] = { n[0], n[2], n[3] };
+  musz asz[3], ast[3], bsz[3], bst[3];
+  mu8 blab[3][AX_TENSOR_MAX_DIMS];
+  bool a_ok = ax__einsum_groups(s, a, 3, an, lab, asz, ast);
+  if (!a_ok) {
+    ax__einsum_sort(b, n[0], lab[0]);
+    ax__einsum_sort(b, n[2], lab[2]);
+  }
+  memcpy(blab[0], lab[0], n[0]);
+  memcpy(blab[1], lab[2], n[2]);
+  memcpy(blab[2], lab[3], n[3]);
+  AxEinsumTerm ap, bp;
+  if (!a_ok) {
+    if (!ax__einsum_pack(s, a, 3, an, lab, arena, &ap)) return false;
+    a = &ap;
+    ax__einsum_groups(s, a, 3, an, lab, asz, ast);
+  }
+  if (!ax__einsum_groups(s, b, 3, bn, blab, bsz, bst)) {
+    if (!ax__einsum_pack(s, b, 3, bn, blab, arena, &bp)) return false;
+    b = &bp;
+    ax__einsum_groups(s, b, 3, bn, blab, bsz, bst);
+  }
+  musz count = asz[0], rows = asz[1], inner = asz[2], cols = bsz[2];
+
+  // c: [batch, m, n]
+  mu8 order[AX_TENSOR_MAX_DIMS];
+  musz shape[AX_TENSOR_MAX_DIMS], nd = 0;
+  for (musz g = 0; g < 4; g++) {
+    if (g == 2) continue;
+    for (musz d = 0; d < n[g]; d++) {
+      order[nd] = lab[g][d];
+      shape[nd++] = s->size[lab[g][d]];
+    }
+  }
+  if (!ax_tensor_init(&c->t, nd, shape, cdtype, arena)) return false;
+  memcpy(c->lab, order, nd);
+  c->mask = keep;
+  if (ax_tensor_numel(&c->t) == 0) return true;
+
+  // Nothing summed and a vector per batch item (a Hadamard or scaled
+  // product): one broadcast multiply instead of many 1-wide GEMMs
+  if (inner == 1 && (rows == 1 || cols == 1) && a->t.dtype == cdtype && b->t.dtype == cdtype) {
+    AxTensor av, bv;
+    ax__einsum_view(s, a, nd, order, &av);
+    ax__einsum_view(s, b, nd, order, &bv);
+    return ax_tensor_binary(&c->t, &av, &bv, AX_BINARY_MUL);
+  }
+  AxMatrixBatch ma = { .count = count, .rows = rows, .cols = inner, .stride = ast[1], .col_stride = ast[2],
+                       .batch_stride = ast[0], .data = a->t.data, .dtype = a->t.dtype };
+  AxMatrixBatch mb = { .count = count, .rows = inner, .cols = cols, .stride = bst[1], .col_stride = bst[2],
+                       .batch_stride = bst[0], .data = b->t.data, .dtype = b->t.dtype };
+  AxMatrixBatch mc = { .count = count, .rows = rows, .cols = cols, .stride = cols, .col_stride = 1,
+                       .batch_stride = rows * cols, .data = c->t.data, .dtype = cdtype };
+  return ax_matrix_gemm_strided_batched(1.0, &ma, AX_NO_TRANS, &mb, AX_NO_TRANS, 0.0, &mc);
+}
+
+bool ax_einsum(const char* spec, const AxTensor* const* operands, musz count, AxTensor* out,
+               AxEinsumPath path, AxEinsumInfo* info, Arena* scratch) {
+  AxEinsumSpec s;
+  AxEinsumInfo local;
+  if (!info) info = &local;
+  if (!ax__einsum_parse("ax_einsum", spec, operands, count, &s) || !ax__tensor_dest("ax_einsum", out)) return false;
+  if (out->ndim != s.nout) {
+    AX_LOG(AX_LOG_FATAL, "ax_einsum: output has %zu dimensions, \"%s\" gives %zu", (size_t)out->ndim, spec,
+           (size_t)s.nout);
+    return false;
+  }
+  for (musz d = 0; d < s.nout; d++) {
+    if (out->shape[d] != s.size[s.out[d]]) {
+      AX_LOG(AX_LOG_FATAL, "ax_einsum: output dimension %zu has size %zu (expected %zu)", (size_t)d,
+             (size_t)out->shape[d], (size_t)s.size[s.out[d]]);
+      return false;
+    }
+  }
+  // One compute dtype for every GEMM
+  bool wide = false, narrow = false;
+  for (musz i = 0; i < count; i++) {
+    AxDType dt = operands[i]->dtype;
+    wide |= dt == AX_F64;
+    narrow |= dt == AX_F32 || dt == AX_F16 || dt == AX_BF16;
+    if (dt != AX_F64 && dt != AX_F32 && dt != AX_F16 && dt != AX_BF16) {
+      AX_LOG(AX_LOG_FATAL, "ax_einsum: operand %zu is %s (floating point only)", (size_t)i, ax_dtype_name(dt));
+      return false;
+    }
+  }
+  if (wide && narrow) {
+    AX_LOG(AX_LOG_FATAL, "ax_einsum: f64 operands mix with f32 or half precision ones");
+    return false;
+  }
+  AxDType cdtype = wide ? AX_F64 : AX_F32;
+  if (!ax__einsum_plan("ax_einsum", &s, path, info)) return false;
+
+  Arena* arena = scratch ? scratch : ax_arena_create(AX_EINSUM_BLOCK);
+  if (!arena) return false;
+  musz nterms = count + info->steps;
+  AxEinsumTerm* terms = (AxEinsumTerm*)ax_alloc(arena, nterms * sizeof(AxEinsumTerm));
+  bool alive[2 * AX_EINSUM_MAX_OPERANDS] = { false };
+  bool ok = terms != NULL;
+  for (musz i = 0; ok && i < count; i++) {
+    ok = ax__einsum_operand(&s, i, operands[i], cdtype, arena, &terms[i]);
+    alive[i] = true;
+  }
+  for (musz st = 0; ok && st < info->steps; st++) {
+    musz x = info->pairs[st][0], y = info->pairs[st][1];
+    alive[x] = alive[y] = false;
+    mu64 rest = s.out_mask;
+    for (musz q = 0; q < count + st; q++) {
+      if (alive[q]) rest |= terms[q].mask;
+    }
+    ok = ax__einsum_contract(&s, &terms[x], &terms[y], (terms[x].mask | terms[y].mask) & rest, cdtype, arena,
+                             &terms[count + st]);
+    alive[count + st] = true;
+  }
+  if (ok) { // The last term holds exactly the output labels
+    AxTensor v;
+    ax__einsum_view(&s, &terms[nterms - 1], s.nout, s.out, &v);
+    ok = (out->dtype == v.dtype) ? ax_tensor_copy(out, &v) : ax_tensor_sum(&v, 0, out);
+  }
+  if (!scratch) ax_arena_destroy(arena);
+  return ok;
+}
+
+#endif /* AXTENSOR_IMPLEMENTATION */
+
+#endif /* AXTENSOR_H_ */
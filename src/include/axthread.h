@@ -0,0 +1,328 @@
+/*
+  ================================================================================
+  AxThread: Minimal Thread Pool (STB-Style Single-Header Library)
+  ================================================================================
+  - Provides a lazily started pool of worker threads and a blocking
+  ax_parallel_for() that hands out an index range in chunks of `grain`.
+  - The calling thread takes part in the work, so a pool of N threads spawns
+  N - 1 workers.
+  - Calls made from inside a running task execute serially on the calling
+  thread; concurrent calls from different user threads are serialized.
+  - The thread count defaults to the number of online CPUs. It can be changed
+  with the AX_NUM_THREADS environment variable or ax_thread_set_count().
+  - Dependencies:
+  - "axtypes.h"     (defines musz, etc.)
+  - "axlog.h"       (for AX_LOG(...) macros)
+  - <pthread.h>     (threads, mutexes, condition variables)
+  - <stdatomic.h>   (chunk counter)
+  ================================================================================
+  USAGE:
+  1) In **one** C or C++ file where you want the implementation, do:
+  #define AXTHREAD_IMPLEMENTATION
+  #include "axthread.h"
+
+  2) In any other files that need to use the library, just include "axthread.h"
+  without defining AXTHREAD_IMPLEMENTATION.
+
+  3) Link with -pthread.
+  ================================================================================
+*/
+
+#ifndef AXTHREAD_H_
+#define AXTHREAD_H_
+
+#include "axtypes.h"
+#include "axlog.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /**
+   * @brief Work callback for ax_parallel_for().
+   *
+   * Processes the half-open index range [begin, end). A single call may cover
+   * several grains, so the callback must loop over the whole range.
+   */
+  typedef void (*AxTaskFn)(void* ctx, musz begin, musz end);
+
+  /**
+   * @brief Runs `fn` over [0, n) on the thread pool and waits for completion.
+   *
+   * @param n     Number of indices to process.
+   * @param grain Indices handed out per chunk. If 0, the range is split into
+   *              roughly four chunks per thread.
+   * @param fn    Callback invoked with disjoint sub-ranges.
+   * @param ctx   Opaque pointer forwarded to `fn`.
+   *
+   * @note Runs serially when n <= grain, when the pool has one thread, or
+   *       when called from inside another parallel task.
+   */
+  void ax_parallel_for(musz n, musz grain, AxTaskFn fn, void* ctx);
+
+  /**
+   * @brief Returns the number of threads (including the caller) used by
+   *        ax_parallel_for().
+   */
+  musz ax_thread_count(void);
+
+  /**
+   * @brief Sets the number of threads used by ax_parallel_for().
+   *
+   * @param count Desired thread count. If 0, the default is restored.
+   *
+   * @note Stops any running workers; new ones start on the next parallel call.
+   */
+  void ax_thread_set_count(musz count);
+
+  /**
+   * @brief Stops and joins all worker threads.
+   *
+   * @note Runs the ax_thread_on_shutdown() callbacks on the calling thread
+   *       once the workers are joined.
+   */
+  void ax_thread_shutdown(void);
+
+  /**
+   * @brief Registers a callback that ax_thread_shutdown() runs on the
+   *        calling thread, e.g. to release that thread's cached state early.
+   *
+   * Per-thread state that must go when any thread exits belongs in a
+   * pthread_key_create() destructor instead. Registering the same callback
+   * again has no effect.
+   *
+   * @return false if AX_THREAD_MAX_HOOKS callbacks are already registered.
+   */
+  bool ax_thread_on_shutdown(void (*fn)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+   ------------------------------------------------------------------------------
+   Implementation
+   ------------------------------------------------------------------------------
+*/
+#ifdef AXTHREAD_IMPLEMENTATION
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define AX_THREAD_MAX 256
+#define AX_THREAD_MAX_HOOKS 8
+
+static struct {
+  pthread_mutex_t submit;     /* Serializes callers of ax_parallel_for() */
+  pthread_mutex_t lock;       /* Protects everything below */
+  pthread_cond_t  wake;       /* Signals workers that a job (or quit) is ready */
+  pthread_cond_t  done;       /* Signals the caller that all workers finished */
+  pthread_t       threads[AX_THREAD_MAX];
+  musz            nworkers;   /* Workers currently running */
+  musz            requested;  /* Thread count set by the user, 0 for default */
+  bool            quit;
+  mu64            generation; /* Incremented once per job */
+  musz            active;     /* Workers still inside the current job */
+  AxTaskFn        fn;
+  void*           ctx;
+  musz            n;
+  musz            grain;
+  atomic_size_t   next;       /* Start of the next chunk to hand out */
+} ax__pool = {
+  .submit = PTHREAD_MUTEX_INITIALIZER,
+  .lock   = PTHREAD_MUTEX_INITIALIZER,
+  .wake   = PTHREAD_COND_INITIALIZER,
+  .done   = PTHREAD_COND_INITIALIZER,
+};
+
+static _Thread_local bool ax__in_task = false;
+
+static struct {
+  pthread_mutex_t lock;
+  void (*fn[AX_THREAD_MAX_HOOKS])(void);
+  musz count;
+} ax__hooks = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/*--------------------------------------------------------------------------
+  Runs the shutdown callbacks on the current thread. The list is copied first so
+  a callback may register others without deadlocking.
+  --------------------------------------------------------------------------*/
+static void ax__hooks_run(void) {
+  void (*fn[AX_THREAD_MAX_HOOKS])(void);
+  pthread_mutex_lock(&ax__hooks.lock);
+  musz count = ax__hooks.count;
+  for (musz i = 0; i < count; i++) fn[i] = ax__hooks.fn[i];
+  pthread_mutex_unlock(&ax__hooks.lock);
+  for (musz i = 0; i < count; i++) fn[i]();
+}
+
+/*--------------------------------------------------------------------------
+  Default thread count: AX_NUM_THREADS if set, otherwise the online CPUs.
+  --------------------------------------------------------------------------*/
+static musz ax__thread_default(void) {
+  const char* env = getenv("AX_NUM_THREADS");
+  long count = env ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (count < 1) count = 1;
+  if (count > AX_THREAD_MAX) count = AX_THREAD_MAX;
+  return (musz)count;
+}
+
+/*--------------------------------------------------------------------------
+  Grabs chunks of the current job until the range is exhausted.
+  --------------------------------------------------------------------------*/
+static void ax__pool_drain(void) {
+  for (;;) {
+    musz begin = atomic_fetch_add(&ax__pool.next, ax__pool.grain);
+    if (begin >= ax__pool.n) break;
+    musz end = (ax__pool.n - begin > ax__pool.grain) ? begin + ax__pool.grain : ax__pool.n;
+    ax__pool.fn(ax__pool.ctx, begin, end);
+  }
+}
+
+static void* ax__pool_worker(void* arg) {
+  (void)arg;
+  ax__in_task = true;
+  mu64 seen = 0;
+  pthread_mutex_lock(&ax__pool.lock);
+  for (;;) {
+    while (!ax__pool.quit && ax__pool.generation == seen) {
+      pthread_cond_wait(&ax__pool.wake, &ax__pool.lock);
+    }
+    if (ax__pool.quit) break;
+    seen = ax__pool.generation;
+    pthread_mutex_unlock(&ax__pool.lock);
+
+    ax__pool_drain();
+
+    pthread_mutex_lock(&ax__pool.lock);
+    if (--ax__pool.active == 0) {
+      pthread_cond_signal(&ax__pool.done);
+    }
+  }
+  pthread_mutex_unlock(&ax__pool.lock);
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------
+  Starts the workers if needed. Must be called with `submit` held.
+  --------------------------------------------------------------------------*/
+static void ax__pool_start(void) {
+  if (ax__pool.nworkers > 0) return;
+  musz want = ax_thread_count() - 1;
+  pthread_mutex_lock(&ax__pool.lock);
+  ax__pool.quit = false;
+  ax__pool.generation = 0;
+  pthread_mutex_unlock(&ax__pool.lock);
+  for (musz t = 0; t < want; t++) {
+    if (pthread_create(&ax__pool.threads[t], NULL, ax__pool_worker, NULL) != 0) {
+      AX_LOG(AX_LOG_WARN, "ax_parallel_for: could not start worker %zu", t);
+      break;
+    }
+    ax__pool.nworkers++;
+  }
+}
+
+/*--------------------------------------------------------------------------
+  Stops the workers. Must be called with `submit` held.
+  --------------------------------------------------------------------------*/
+static void ax__pool_stop(void) {
+  pthread_mutex_lock(&ax__pool.lock);
+  ax__pool.quit = true;
+  pthread_cond_broadcast(&ax__pool.wake);
+  pthread_mutex_unlock(&ax__pool.lock);
+  for (musz t = 0; t < ax__pool.nworkers; t++) {
+    pthread_join(ax__pool.threads[t], NULL);
+  }
+  ax__pool.nworkers = 0;
+}
+
+musz ax_thread_count(void) {
+  return ax__pool.requested ? ax__pool.requested : ax__thread_default();
+}
+
+void ax_thread_set_count(musz count) {
+  pthread_mutex_lock(&ax__pool.submit);
+  ax__pool_stop();
+  ax__pool.requested = (count > AX_THREAD_MAX) ? AX_THREAD_MAX : count;
+  pthread_mutex_unlock(&ax__pool.submit);
+}
+
+void ax_thread_shutdown(void) {
+  pthread_mutex_lock(&ax__pool.submit);
+  ax__pool_stop();
+  pthread_mutex_unlock(&ax__pool.submit);
+  ax__hooks_run();
+}
+
+bool ax_thread_on_shutdown(void (*fn)(void)) {
+  if (!fn) {
+    AX_LOG(AX_LOG_FATAL, "ax_thread_on_shutdown: NULL callback");
+    return false;
+  }
+  bool ok = true;
+  pthread_mutex_lock(&ax__hooks.lock);
+  musz i = 0;
+  while (i < ax__hooks.count && ax__hooks.fn[i] != fn) i++;
+  if (i == ax__hooks.count) {
+    if (i < AX_THREAD_MAX_HOOKS) {
+      ax__hooks.fn[ax__hooks.count++] = fn;
+    } else {
+      ok = false;
+    }
+  }
+  pthread_mutex_unlock(&ax__hooks.lock);
+  if (!ok) AX_LOG(AX_LOG_WARN, "ax_thread_on_shutdown: too many callbacks");
+  return ok;
+}
+
+void ax_parallel_for(musz n, musz grain, AxTaskFn fn, void* ctx) {
+  if (n == 0) return;
+  if (!fn) {
+    AX_LOG(AX_LOG_FATAL, "ax_parallel_for: NULL task");
+    return;
+  }
+  musz threads = ax_thread_count();
+  if (grain == 0) {
+    grain = (n + 4 * threads - 1) / (4 * threads);
+  }
+  if (ax__in_task || threads <= 1 || n <= grain) {
+    fn(ctx, 0, n);
+    return;
+  }
+
+  pthread_mutex_lock(&ax__pool.submit);
+  ax__pool_start();
+  if (ax__pool.nworkers == 0) {
+    pthread_mutex_unlock(&ax__pool.submit);
+    fn(ctx, 0, n);
+    return;
+  }
+
+  pthread_mutex_lock(&ax__pool.lock);
+  ax__pool.fn = fn;
+  ax__pool.ctx = ctx;
+  ax__pool.n = n;
+  ax__pool.grain = grain;
+  atomic_store(&ax__pool.next, 0);
+  ax__pool.active = ax__pool.nworkers;
+  ax__pool.generation++;
+  pthread_cond_broadcast(&ax__pool.wake);
+  pthread_mutex_unlock(&ax__pool.lock);
+
+  ax__in_task = true;
+  ax__pool_drain();
+  ax__in_task = false;
+
+  pthread_mutex_lock(&ax__pool.lock);
+  while (ax__pool.active > 0) {
+    pthread_cond_wait(&ax__pool.done, &ax__pool.lock);
+  }
+  pthread_mutex_unlock(&ax__pool.lock);
+  pthread_mutex_unlock(&ax__pool.submit);
+}
+
+#endif /* AXTHREAD_IMPLEMENTATION */
+
+#endif /* AXTHREAD_H_ */
@@ -20,8 +20,18 @@
 /* } */
 #define AXALLOC_IMPLEMENTATION
 #include "include/axalloc.h"
+#define AXTHREAD_IMPLEMENTATION
+#include "include/axthread.h"
 #define AXMATRIX_IMPLEMENTATION
 #include "include/axmatrix.h"
+#define AXSPARSE_IMPLEMENTATION
+#include "include/axsparse.h"
+#define AXBITS_IMPLEMENTATION
+#include "include/axbits.h"
+#define AXLINALG_IMPLEMENTATION
+#include "include/axlinalg.h"
+#define AXTENSOR_IMPLEMENTATION
+#include "include/axtensor.h"
 #include <stdio.h>
 
 int main(void) {
@@ -2,10 +2,19 @@
 #define CLOVE_IMPLEMENTATION
 #include "thirdparty/clove-unit.h"
 #define AXALLOC_IMPLEMENTATION
+#define AXTHREAD_IMPLEMENTATION
 #define AX_MATRIX_ELEMENT_TYPE float
 #include "include/axalloc.h"
 #define AXMATRIX_IMPLEMENTATION
 #include "include/axmatrix.h"
+#define AXSPARSE_IMPLEMENTATION
+#include "include/axsparse.h"
+#define AXBITS_IMPLEMENTATION
+#include "include/axbits.h"
+#define AXLINALG_IMPLEMENTATION
+#include "include/axlinalg.h"
+#define AXTENSOR_IMPLEMENTATION
+#include "include/axtensor.h"
 
 axm_type mat_init(AxMatrix *self, musz i, musz j) {
   return i*10+j;
@@ -89,4 +98,2341 @@ CLOVE_TEST(AxMatrix) {
   ax_arena_destroy(arena);
 }
 
+CLOVE_TEST(AxMatrixReductions) {
+  Arena* arena = ax_arena_create(4096);
+  AxMatrix* mat = ax_matrix_create(5, 5, arena);
+  ax_matrix_map(mat, mat_init);
+  AxMatrix* row = ax_matrix_create(1, 5, arena);
+  AxMatrix* col = ax_matrix_create(5, 1, arena);
+  AxMatrix* one = ax_matrix_create(1, 1, arena);
+
+  ax_matrix_sum(mat, AX_AXIS_ALL, one);
+  CLOVE_FLOAT_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];print(M.sum())"), AX_MATRIX_AT(*one, 0, 0), 2);
+  ax_matrix_sum(mat, AX_AXIS_0, row);
+  CLOVE_FLOAT_EQ_P(115.0, AX_MATRIX_AT(*row, 0, 3), 2);
+  ax_matrix_mean(mat, AX_AXIS_1, col);
+  CLOVE_FLOAT_EQ_P(32.0, AX_MATRIX_AT(*col, 3, 0), 2);
+  ax_matrix_var(mat, AX_AXIS_0, row);
+  CLOVE_FLOAT_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];print(M.var(axis=0)[2])"), AX_MATRIX_AT(*row, 0, 2), 2);
+  ax_matrix_norm(mat, AX_NORM_L2, AX_AXIS_1, col);
+  CLOVE_FLOAT_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];print(np.linalg.norm(M,axis=1)[4])"), AX_MATRIX_AT(*col, 4, 0), 2);
+  ax_matrix_norm(mat, AX_NORM_INF, AX_AXIS_ALL, one);
+  CLOVE_FLOAT_EQ_P(44.0, AX_MATRIX_AT(*one, 0, 0), 2);
+  ax_matrix_dot(mat, mat, AX_AXIS_1, col);
+  CLOVE_FLOAT_EQ_P(30.0, AX_MATRIX_AT(*col, 0, 0), 2);
+
+  AX_MATRIX_AT(*mat, 2, 1) = -7.0;
+  AX_MATRIX_AT(*mat, 3, 4) = -7.0;
+  ax_matrix_min(mat, AX_AXIS_ALL, one);
+  CLOVE_FLOAT_EQ_P(-7.0, AX_MATRIX_AT(*one, 0, 0), 2);
+  musz idx[5];
+  ax_matrix_argmin(mat, AX_AXIS_ALL, idx);
+  CLOVE_ULLONG_EQ(11, idx[0]);
+  ax_matrix_argmax(mat, AX_AXIS_0, idx);
+  CLOVE_ULLONG_EQ(4, idx[1]);
+  CLOVE_ULLONG_EQ(4, idx[4]);
+  ax_matrix_argmax(mat, AX_AXIS_1, idx);
+  CLOVE_ULLONG_EQ(3, idx[3]);
+  // The index travels with the value: a leading NaN, which nothing beats,
+  // is its own position, and ties resolve to the first occurrence
+  AxMatrix* run = ax_matrix_create(1, 37, arena);
+  for (musz j = 0; j < 37; j++) AX_MATRIX_AT(*run, 0, j) = (axm_type)(j % 5);
+  ax_matrix_argmax(run, AX_AXIS_ALL, idx);
+  CLOVE_ULLONG_EQ(4, idx[0]);
+  AX_MATRIX_AT(*run, 0, 0) = (axm_type)NAN;
+  ax_matrix_argmin(run, AX_AXIS_ALL, idx);
+  CLOVE_ULLONG_EQ(0, idx[0]);
+
+  // Large strided column: exercises the parallel, pairwise axis-0 path
+  musz n = 1 << 21;
+  AxMatrix* big = ax_matrix_create(n, 2, arena);
+  for (musz i = 0; i < n; i++) {
+    AX_MATRIX_AT(*big, i, 0) = 0.0f;
+    AX_MATRIX_AT(*big, i, 1) = 0.1f;
+  }
+  AxMatrix column = AX_MATRIX_SLICE(*big, AX_RANGE(0, n), AX_RANGE(1, 2));
+  double expected = (double)0.1f * (double)n;
+  ax_matrix_sum(&column, AX_AXIS_0, one);
+  CLOVE_FLOAT_EQ_P(1.0, (float)(AX_MATRIX_AT(*one, 0, 0) / expected), 6);
+  ax_matrix_sum(&column, AX_AXIS_ALL, one);
+  CLOVE_FLOAT_EQ_P(1.0, (float)(AX_MATRIX_AT(*one, 0, 0) / expected), 6);
+  ax_matrix_mean(big, AX_AXIS_ALL, one);
+  CLOVE_FLOAT_EQ_P(0.05f, AX_MATRIX_AT(*one, 0, 0), 6);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxMatrixTranspose) {
+  Arena* arena = ax_arena_create(4096);
+  AxMatrix* mat = ax_matrix_create(5, 5, arena);
+  ax_matrix_map(mat, mat_init);
+  AxMatrix slice = AX_MATRIX_SLICE(*mat, AX_RANGE(1, 4), AX_RANGE(0, 5));
+  AxMatrix* t = ax_matrix_transpose(&slice, arena);
+  CLOVE_ULLONG_EQ(5, t->rows);
+  CLOVE_FLOAT_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];print(M[1:4,:].T[4,2])"), AX_MATRIX_AT(*t, 4, 2), 2);
+
+  // Sizes that are not multiples of the tiles exercise the ragged edges
+  musz m = 531, n = 300;
+  AxMatrix* big = ax_matrix_create(m, n, arena);
+  AxMatrix* bigt = ax_matrix_create(n, m, arena);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) AX_MATRIX_AT(*big, i, j) = (float)(i * n + j);
+  }
+  ax_matrix_transpose_into(bigt, big);
+  bool ok = true;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) ok &= AX_MATRIX_AT(*bigt, j, i) == AX_MATRIX_AT(*big, i, j);
+  }
+  CLOVE_IS_TRUE(ok);
+
+  AxMatrix square = AX_MATRIX_SLICE(*big, AX_RANGE(3, 294), AX_RANGE(5, 296));
+  ax_matrix_transpose_inplace(&square);
+  ok = true;
+  for (musz i = 0; i < 291; i++) {
+    for (musz j = 0; j < 291; j++) ok &= AX_MATRIX_AT(square, i, j) == (float)((j + 3) * n + i + 5);
+  }
+  CLOVE_IS_TRUE(ok);
+  CLOVE_FLOAT_EQ_P((float)(2 * n + 4), AX_MATRIX_AT(*big, 2, 4), 2);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxMatrixBroadcast) {
+  Arena* arena = ax_arena_create(4096);
+  AxMatrix* mat = ax_matrix_create(5, 5, arena);
+  ax_matrix_map(mat, mat_init);
+  AxMatrix* bias = ax_matrix_create(1, 5, arena);
+  AxMatrix* scale = ax_matrix_create(5, 1, arena);
+  for (musz k = 0; k < 5; k++) {
+    AX_MATRIX_AT(*bias, 0, k) = (float)k;
+    AX_MATRIX_AT(*scale, k, 0) = (float)(k + 1);
+  }
+
+  AxMatrix* res = ax_matrix_broadcast(mat, bias, AX_BINARY_SUB, arena);
+  CLOVE_FLOAT_EQ_P(30.0, AX_MATRIX_AT(*res, 3, 4), 2);
+  ax_matrix_broadcast_into(res, mat, scale, AX_BINARY_MUL);
+  CLOVE_FLOAT_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];print((M*np.arange(1,6)[:,None])[2,3])"), AX_MATRIX_AT(*res, 2, 3), 2);
+
+  // In place, on a view, against a 1x1 matrix and a scalar
+  AxMatrix view = AX_MATRIX_SLICE(*mat, AX_RANGE(1, 3), AX_RANGE(2, 5));
+  AxMatrix two = AX_MATRIX_SLICE(*scale, AX_RANGE(1, 2), AX_RANGE(0, 1));
+  ax_matrix_broadcast_into(&view, &view, &two, AX_BINARY_DIV);
+  CLOVE_FLOAT_EQ_P(6.0, AX_MATRIX_AT(*mat, 1, 2), 2);
+  CLOVE_FLOAT_EQ_P(12.0, AX_MATRIX_AT(*mat, 2, 4), 2);
+  CLOVE_FLOAT_EQ_P(21.0, AX_MATRIX_AT(*mat, 2, 1), 2);
+  ax_matrix_scalar_into(mat, mat, 1.0f, AX_BINARY_ADD);
+  CLOVE_FLOAT_EQ_P(1.0, AX_MATRIX_AT(*mat, 0, 0), 2);
+  // Empty operands are a no-op
+  AxMatrix empty = AX_MATRIX_SLICE(*mat, AX_RANGE(0, 3), AX_RANGE(0, 0));
+  CLOVE_INT_EQ(1, ax_matrix_broadcast_into(&empty, &empty, &empty, AX_BINARY_ADD));
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxMatrixDTypes) {
+  Arena* arena = ax_arena_create(4096);
+  AxMatrix* f32m = ax_matrix_create(5, 5, arena);
+  ax_matrix_map(f32m, mat_init);
+  CLOVE_INT_EQ(AX_F32, f32m->dtype);
+
+  // float32 and float64 matrices side by side, converted with ax_matrix_copy
+  AxMatrix* f64m = ax_matrix_create_dtype(5, 5, AX_F64, arena);
+  ax_matrix_copy(f64m, f32m);
+  AX_MATRIX_AT_T(mf64, *f64m, 0, 0) = 0.1;
+  AxMatrix* f64mul = ax_matrix_multiply(f64m, f64m, arena);
+  CLOVE_INT_EQ(AX_F64, f64mul->dtype);
+  CLOVE_FLOAT_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];M=M.astype(float);M[0,0]=0.1;print(np.matmul(M,M)[0,4])"),
+                   (float)ax_matrix_get(f64mul, 0, 4), 2);
+
+  // Integer kernels keep their own arithmetic
+  AxMatrix* i32m = ax_matrix_create_dtype(5, 5, AX_I32, arena);
+  ax_matrix_copy(i32m, f32m);
+  ax_matrix_scalar_into(i32m, i32m, 3, AX_BINARY_DIV);
+  CLOVE_INT_EQ(14, AX_MATRIX_AT_T(mi32, *i32m, 4, 3));
+  AxMatrix* u8m = ax_matrix_create_dtype(5, 5, AX_U8, arena);
+  ax_matrix_copy(u8m, f32m);
+  AxMatrix* u8sum = ax_matrix_add(u8m, u8m, arena);
+  CLOVE_INT_EQ(88, AX_MATRIX_AT_T(mu8, *u8sum, 4, 4));
+  AxMatrix* u8mul = ax_matrix_elementwise_multiply(u8m, u8m, arena);
+  CLOVE_INT_EQ((44 * 44) % 256, AX_MATRIX_AT_T(mu8, *u8mul, 4, 4));
+  // Signed overflow wraps and division by zero gives 0
+  AxMatrix* edge = ax_matrix_create_dtype(1, 3, AX_I32, arena);
+  AxMatrix* divisor = ax_matrix_create_dtype(1, 3, AX_I32, arena);
+  AX_MATRIX_AT_T(mi32, *edge, 0, 0) = INT32_MAX;
+  AX_MATRIX_AT_T(mi32, *edge, 0, 1) = INT32_MIN;
+  AX_MATRIX_AT_T(mi32, *edge, 0, 2) = 7;
+  AxMatrix* wrapped = ax_matrix_add(edge, edge, arena);
+  CLOVE_INT_EQ(-2, AX_MATRIX_AT_T(mi32, *wrapped, 0, 0));
+  CLOVE_INT_EQ(0, AX_MATRIX_AT_T(mi32, *wrapped, 0, 1));
+  AX_MATRIX_AT_T(mi32, *divisor, 0, 0) = 0;
+  AX_MATRIX_AT_T(mi32, *divisor, 0, 1) = -1;
+  AX_MATRIX_AT_T(mi32, *divisor, 0, 2) = -2;
+  ax_matrix_broadcast_into(edge, edge, divisor, AX_BINARY_DIV);
+  CLOVE_INT_EQ(0, AX_MATRIX_AT_T(mi32, *edge, 0, 0));
+  CLOVE_INT_EQ(INT32_MIN, AX_MATRIX_AT_T(mi32, *edge, 0, 1));
+  CLOVE_INT_EQ(-3, AX_MATRIX_AT_T(mi32, *edge, 0, 2));
+
+  // Reductions accept any input dtype and write to any output dtype
+  AxMatrix* i64row = ax_matrix_create_dtype(1, 5, AX_I64, arena);
+  ax_matrix_sum(u8m, AX_AXIS_0, i64row);
+  CLOVE_LLONG_EQ(115, AX_MATRIX_AT_T(mi64, *i64row, 0, 3));
+  AxMatrix* f64one = ax_matrix_create_dtype(1, 1, AX_F64, arena);
+  ax_matrix_mean(i32m, AX_AXIS_ALL, f64one);
+  CLOVE_DOUBLE_EQ_P(from_np("M=np.mgrid[0:5,0:5][0]*10+np.mgrid[0:5,0:5][1];print((M//3).mean())"),
+                    AX_MATRIX_AT_T(mf64, *f64one, 0, 0), 6);
+  musz idx;
+  ax_matrix_argmax(u8mul, AX_AXIS_ALL, &idx);
+  CLOVE_ULLONG_EQ(12, idx);
+
+  // Transposes of every element width
+  AxMatrix* u8t = ax_matrix_transpose(u8m, arena);
+  AxMatrix* f64t = ax_matrix_transpose(f64m, arena);
+  CLOVE_INT_EQ(31, AX_MATRIX_AT_T(mu8, *u8t, 1, 3));
+  CLOVE_DOUBLE_EQ_P(13.0, AX_MATRIX_AT_T(mf64, *f64t, 3, 1), 9);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxMatrixHalf) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Scalar conversions round to nearest even and saturate to infinity
+  CLOVE_INT_EQ(0x3C00, ax_f32_to_f16(1.0f));
+  CLOVE_INT_EQ(0x7BFF, ax_f32_to_f16(65504.0f));
+  CLOVE_INT_EQ(0x7C00, ax_f32_to_f16(65520.0f));
+  CLOVE_INT_EQ(0x0001, ax_f32_to_f16(5.9604645e-8f));
+  CLOVE_INT_EQ(0x3F80, ax_f32_to_bf16(1.00390625f));
+  CLOVE_INT_EQ(0x3F82, ax_f32_to_bf16(1.01171875f));
+  int roundtrip = 1;
+  for (mu32 h = 0; h < 0x10000; h++) {
+    if ((h & 0x7C00) == 0x7C00 && (h & 0x3FF)) continue; // NaN
+    if (ax_f32_to_f16(ax_f16_to_f32((mu16)h)) != h) roundtrip = 0;
+  }
+  CLOVE_INT_EQ(1, roundtrip);
+
+  // Vectorized conversions (full blocks and tail) match the scalar ones
+  AxMatrix* src = ax_matrix_create_dtype(3, 37, AX_F32, arena);
+  for (musz i = 0; i < 3; i++) {
+    for (musz j = 0; j < 37; j++) AX_MATRIX_AT_T(mf32, *src, i, j) = (mf32)(i * 37 + j) * 0.37f - 20.0f;
+  }
+  AxMatrix* h16 = ax_matrix_create_dtype(3, 37, AX_F16, arena);
+  AxMatrix* b16 = ax_matrix_create_dtype(3, 37, AX_BF16, arena);
+  ax_matrix_copy(h16, src);
+  ax_matrix_copy(b16, src);
+  int same = 1;
+  for (musz i = 0; i < 3; i++) {
+    for (musz j = 0; j < 37; j++) {
+      mf32 v = AX_MATRIX_AT_T(mf32, *src, i, j);
+      if (AX_MATRIX_AT_T(mu16, *h16, i, j) != ax_f32_to_f16(v)) same = 0;
+      if (AX_MATRIX_AT_T(mu16, *b16, i, j) != ax_f32_to_bf16(v)) same = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, same);
+
+  // Element-wise kernels and reductions compute in f32
+  AxMatrix* hsum = ax_matrix_add(h16, h16, arena);
+  CLOVE_FLOAT_EQ_P(2.0f * ax_f16_to_f32(AX_MATRIX_AT_T(mu16, *h16, 2, 5)),
+                   (float)ax_matrix_get(hsum, 2, 5), 6);
+  AxMatrix* total = ax_matrix_create_dtype(1, 1, AX_F64, arena);
+  ax_matrix_sum(b16, AX_AXIS_ALL, total);
+  double expect = 0;
+  for (musz i = 0; i < 3; i++) {
+    for (musz j = 0; j < 37; j++) expect += ax_matrix_get(b16, i, j);
+  }
+  CLOVE_DOUBLE_EQ_P(expect, AX_MATRIX_AT_T(mf64, *total, 0, 0), 6);
+  AxMatrix* colmax = ax_matrix_create_dtype(1, 37, AX_F32, arena);
+  ax_matrix_max(h16, AX_AXIS_0, colmax);
+  CLOVE_FLOAT_EQ_P((float)ax_matrix_get(h16, 2, 30), AX_MATRIX_AT_T(mf32, *colmax, 0, 30), 6);
+
+  // GEMM with mixed storage (bf16 x f16 -> f16) accumulates in f32 across
+  // several k slices, so the only error left is the rounding of the result
+  musz m = 9, k = 600, n = 40;
+  AxMatrix* a = ax_matrix_create_dtype(m, k, AX_BF16, arena);
+  AxMatrix* b = ax_matrix_create_dtype(n, k, AX_F16, arena);
+  for (musz i = 0; i < m; i++) {
+    for (musz p = 0; p < k; p++) ax_matrix_set(a, i, p, (double)((i * 7 + p * 3) % 11) * 0.125 - 0.5);
+  }
+  for (musz j = 0; j < n; j++) {
+    for (musz p = 0; p < k; p++) ax_matrix_set(b, j, p, (double)((j * 5 + p * 2) % 13) * 0.125 - 0.75);
+  }
+  AxMatrix* c = ax_matrix_create_dtype(m, n, AX_F16, arena);
+  ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_TRANS, 0.0, c);
+  int close = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      double ref = 0;
+      for (musz p = 0; p < k; p++) ref += ax_matrix_get(a, i, p) * ax_matrix_get(b, j, p);
+      if (ax_matrix_get(c, i, j) != (double)ax_f16_to_f32(ax_f32_to_f16((mf32)ref))) close = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, close);
+
+  // Transpose moves 16-bit elements
+  AxMatrix* ht = ax_matrix_transpose(h16, arena);
+  CLOVE_INT_EQ(AX_MATRIX_AT_T(mu16, *h16, 2, 33), AX_MATRIX_AT_T(mu16, *ht, 33, 2));
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxMatrixQuant) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Per-row asymmetric u8 round trip stays within half a quantization step
+  AxMatrix* x = ax_matrix_create_dtype(4, 50, AX_F32, arena);
+  for (musz i = 0; i < 4; i++) {
+    for (musz j = 0; j < 50; j++) AX_MATRIX_AT_T(mf32, *x, i, j) = (mf32)((i + 1) * (j % 17)) * 0.3f - 2.0f * (mf32)i;
+  }
+  AxQuantParams qx;
+  ax_quant_params_init(&qx, 4, arena);
+  ax_quant_params_fit(&qx, x, AX_U8, false);
+  AxMatrix* xq = ax_matrix_create_dtype(4, 50, AX_U8, arena);
+  AxMatrix* xd = ax_matrix_create_dtype(4, 50, AX_F32, arena);
+  ax_matrix_quantize(xq, x, &qx);
+  ax_matrix_dequantize(xd, xq, &qx);
+  int within = 1;
+  for (musz i = 0; i < 4; i++) {
+    for (musz j = 0; j < 50; j++) {
+      mf32 err = fabsf(AX_MATRIX_AT_T(mf32, *x, i, j) - AX_MATRIX_AT_T(mf32, *xd, i, j));
+      if (err > qx.scale[i] * 0.5f + 1e-6f) within = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, within);
+  CLOVE_INT_EQ(0, AX_MATRIX_AT_T(mu8, *xq, 3, 0)); // Row minimum maps to 0
+
+  // Symmetric i8 keeps zero exact
+  AxQuantParams qs;
+  ax_quant_params_init(&qs, 1, arena);
+  ax_quant_params_fit(&qs, x, AX_I8, true);
+  CLOVE_INT_EQ(0, qs.zero_point[0]);
+
+  // Int8 GEMM against a direct reference, for every signedness pairing, with
+  // per-row zero points on `a`, per-column ones on op(b) and k spanning
+  // several slices
+  musz m = 13, k = 1500, n = 37;
+  AxDType types[2] = { AX_U8, AX_I8 };
+  AxQuantParams qa, qb;
+  ax_quant_params_init(&qa, m, arena);
+  ax_quant_params_init(&qb, n, arena);
+  AxMatrix* c = ax_matrix_create_dtype(m, n, AX_I32, arena);
+  int exact = 1;
+  for (int ta = 0; ta < 2; ta++) {
+    for (int tb = 0; tb < 2; tb++) {
+      AxMatrix* a = ax_matrix_create_dtype(m, k, types[ta], arena);
+      AxMatrix* b = ax_matrix_create_dtype(n, k, types[tb], arena);
+      double lo_a = types[ta] == AX_U8 ? 0 : -128, lo_b = types[tb] == AX_U8 ? 0 : -128;
+      for (musz i = 0; i < m; i++) {
+        for (musz p = 0; p < k; p++) ax_matrix_set(a, i, p, lo_a + (double)((i * 31 + p * 7) % 256));
+        qa.zero_point[i] = (mi32)(lo_a + (double)(i * 19 % 256));
+      }
+      for (musz j = 0; j < n; j++) {
+        for (musz p = 0; p < k; p++) ax_matrix_set(b, j, p, lo_b + (double)((j * 13 + p * 11) % 256));
+        qb.zero_point[j] = (mi32)(lo_b + (double)(j * 23 % 256));
+      }
+      ax_matrix_gemm_q8(a, &qa, b, &qb, AX_TRANS, c);
+      for (musz i = 0; i < m; i++) {
+        for (musz j = 0; j < n; j++) {
+          mi64 ref = 0;
+          for (musz p = 0; p < k; p++) {
+            ref += ((mi64)ax_matrix_get(a, i, p) - qa.zero_point[i]) *
+                   ((mi64)ax_matrix_get(b, j, p) - qb.zero_point[j]);
+          }
+          if (ref != AX_MATRIX_AT_T(mi32, *c, i, j)) exact = 0;
+        }
+      }
+    }
+  }
+  CLOVE_INT_EQ(1, exact);
+
+  // Non-transposed op(b) with per-tensor zero points
+  AxMatrix* a2 = ax_matrix_create_dtype(3, 5, AX_I8, arena);
+  AxMatrix* b2 = ax_matrix_create_dtype(5, 2, AX_I8, arena);
+  for (musz p = 0; p < 5; p++) {
+    for (musz i = 0; i < 3; i++) AX_MATRIX_AT_T(mi8, *a2, i, p) = (mi8)(p - i);
+    for (musz j = 0; j < 2; j++) AX_MATRIX_AT_T(mi8, *b2, p, j) = (mi8)(p * (j + 1));
+  }
+  AxMatrix* c2 = ax_matrix_create_dtype(3, 2, AX_I32, arena);
+  ax_matrix_gemm_q8(a2, NULL, b2, NULL, AX_NO_TRANS, c2);
+  CLOVE_INT_EQ(2 * (-2 * 0 + -1 * 1 + 0 * 2 + 1 * 3 + 2 * 4), AX_MATRIX_AT_T(mi32, *c2, 2, 1));
+
+  // Wide op(b) spanning two column panels, each across two slices of k
+  musz wn = 4100, wk = 1030;
+  AxMatrix* a3 = ax_matrix_create_dtype(3, wk, AX_U8, arena);
+  AxMatrix* b3 = ax_matrix_create_dtype(wk, wn, AX_I8, arena);
+  for (musz p = 0; p < wk; p++) {
+    for (musz i = 0; i < 3; i++) AX_MATRIX_AT_T(mu8, *a3, i, p) = (mu8)((i * 7 + p * 3) % 256);
+    for (musz j = 0; j < wn; j++) AX_MATRIX_AT_T(mi8, *b3, p, j) = (mi8)((j * 5 + p) % 256 - 128);
+  }
+  AxQuantParams qa3;
+  ax_quant_params_init(&qa3, 1, arena);
+  qa3.zero_point[0] = 100;
+  AxMatrix* c3 = ax_matrix_create_dtype(3, wn, AX_I32, arena);
+  ax_matrix_gemm_q8(a3, &qa3, b3, NULL, AX_NO_TRANS, c3);
+  exact = 1;
+  for (musz i = 0; i < 3; i++) {
+    for (musz j = 0; j < wn; j += 13) {
+      mi64 ref = 0;
+      for (musz p = 0; p < wk; p++) {
+        ref += ((mi64)AX_MATRIX_AT_T(mu8, *a3, i, p) - 100) * AX_MATRIX_AT_T(mi8, *b3, p, j);
+      }
+      if (ref != AX_MATRIX_AT_T(mi32, *c3, i, j)) exact = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, exact);
+
+  ax_arena_destroy(arena);
+}
+
 CLOVE_RUNNER()
+
+CLOVE_TEST(AxSparse) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Unsorted COO with repeats against a dense reference
+  musz m = 57, k = 43, n = 9;
+  AxMatrix* ref = ax_matrix_create_dtype(m, k, AX_F64, arena);
+  memset(ref->data, 0, m * k * sizeof(mf64));
+  AxSparseCOO coo;
+  ax_coo_init(&coo, m, k, 4, AX_F64, arena);
+  for (musz t = 0; t < 400; t++) {
+    musz i = (t * 37 + 11) % m, j = (t * t * 7 + 3) % k;
+    double v = (double)(t % 13) - 6.0;
+    ax_coo_push(&coo, i, j, v);
+    AX_MATRIX_AT_T(mf64, *ref, i, j) += v;
+  }
+  AxSparseCSR a;
+  ax_csr_from_coo(&a, &coo, arena);
+  AxMatrix* dense = ax_matrix_create_dtype(m, k, AX_F64, arena);
+  ax_matrix_from_csr(dense, &a);
+  int same = 1, sorted = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < k; j++) {
+      if (AX_MATRIX_AT_T(mf64, *dense, i, j) != AX_MATRIX_AT_T(mf64, *ref, i, j)) same = 0;
+    }
+    for (musz p = a.row_ptr[i] + 1; p < a.row_ptr[i + 1]; p++) {
+      if (a.col_idx[p - 1] >= a.col_idx[p]) sorted = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, same);
+  CLOVE_INT_EQ(1, sorted);
+  CLOVE_INT_EQ(1, a.nnz < coo.nnz);
+
+  // Dense -> CSR keeps the same structure; CSR -> CSC -> CSR round trips
+  AxSparseCSR b;
+  ax_csr_from_dense(&b, ref, arena);
+  AxSparseCSC ac;
+  AxSparseCSR back;
+  ax_csc_from_csr(&ac, &a, arena);
+  ax_csr_from_csc(&back, &ac, arena);
+  CLOVE_INT_EQ(1, back.nnz == a.nnz && !memcmp(back.row_ptr, a.row_ptr, (m + 1) * sizeof(musz)) &&
+               !memcmp(back.col_idx, a.col_idx, a.nnz * sizeof(mu32)) &&
+               !memcmp(back.values, a.values, a.nnz * sizeof(mf64)));
+  CLOVE_INT_EQ(1, (int)(b.nnz <= a.nnz));
+  CLOVE_INT_EQ(1, ac.col_ptr[k] == a.nnz);
+
+  // SpMM and SpMV against the dense product
+  AxMatrix* x = ax_matrix_create_dtype(k, n, AX_F64, arena);
+  for (musz i = 0; i < k; i++) {
+    for (musz j = 0; j < n; j++) AX_MATRIX_AT_T(mf64, *x, i, j) = (double)((i * 5 + j * 3) % 7) - 3.0;
+  }
+  AxMatrix* yd = ax_matrix_multiply(ref, x, arena);
+  AxMatrix* ys = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  for (musz i = 0; i < m * n; i++) ((mf64*)ys->data)[i] = 1.0;
+  ax_csr_spmm(2.0, &a, x, -1.0, ys);
+  AxMatrix xcol = AX_MATRIX_SLICE(*x, AX_RANGE(0, k), AX_RANGE(4, 5));
+  AxMatrix* yv = ax_matrix_create_dtype(1, m, AX_F64, arena);
+  ax_csr_spmv(1.0, &b, &xcol, 0.0, yv);
+  int close = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      if (fabs(AX_MATRIX_AT_T(mf64, *ys, i, j) - (2.0 * AX_MATRIX_AT_T(mf64, *yd, i, j) - 1.0)) > 1e-9) close = 0;
+    }
+    if (fabs(AX_MATRIX_AT_T(mf64, *yv, 0, i) - AX_MATRIX_AT_T(mf64, *yd, i, 4)) > 1e-9) close = 0;
+  }
+  CLOVE_INT_EQ(1, close);
+
+  // f32 SpMV over a large banded matrix, split across row chunks
+  musz big = 20000;
+  AxSparseCOO band;
+  ax_coo_init(&band, big, big, 3 * big, AX_F32, arena);
+  for (musz i = big; i-- > 0;) {
+    if (i > 0) ax_coo_push(&band, i, i - 1, -1.0);
+    ax_coo_push(&band, i, i, 2.0);
+    if (i + 1 < big) ax_coo_push(&band, i, i + 1, -1.0);
+  }
+  AxSparseCSR lap;
+  ax_csr_from_coo(&lap, &band, arena);
+  AxMatrix* ones = ax_matrix_create_dtype(big, 1, AX_F32, arena);
+  AxMatrix* out = ax_matrix_create_dtype(big, 1, AX_F32, arena);
+  for (musz i = 0; i < big; i++) ((mf32*)ones->data)[i] = 1.0f;
+  ax_csr_spmv(1.0, &lap, ones, 0.0, out);
+  CLOVE_FLOAT_EQ(1.0f, AX_MATRIX_AT_T(mf32, *out, 0, 0));
+  CLOVE_FLOAT_EQ(0.0f, AX_MATRIX_AT_T(mf32, *out, big / 2, 0));
+  CLOVE_FLOAT_EQ(1.0f, AX_MATRIX_AT_T(mf32, *out, big - 1, 0));
+  CLOVE_INT_EQ(1, lap.nnz == 3 * big - 2);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxSparseSell) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Irregular row lengths, rows not a multiple of the chunk, and chunks that
+  // do and do not fill whole SIMD registers, for both float dtypes
+  musz m = 1003, k = 517;
+  AxDType types[2] = { AX_F32, AX_F64 };
+  musz chunks[3] = { 0, 12, 1 };
+  musz sigmas[3] = { 0, 1, 64 };
+  int close = 1, layout = 1;
+  for (int d = 0; d < 2; d++) {
+    AxSparseCOO coo;
+    ax_coo_init(&coo, m, k, 0, types[d], arena);
+    for (musz i = 0; i < m; i++) {
+      musz len = (i * 7919) % 23 == 0 ? 60 : (i * 31) % 5;
+      for (musz p = 0; p < len; p++) ax_coo_push(&coo, i, (i * 13 + p * p * 5) % k, (double)((i + p) % 9) - 4.0);
+    }
+    AxSparseCSR a;
+    ax_csr_from_coo(&a, &coo, arena);
+    AxMatrix* xs = ax_matrix_create_dtype(k, 2, types[d], arena);
+    for (musz j = 0; j < k; j++) {
+      ax_matrix_set(xs, j, 0, 0.0);
+      ax_matrix_set(xs, j, 1, (double)(j % 11) * 0.25);
+    }
+    AxMatrix x = AX_MATRIX_SLICE(*xs, AX_RANGE(0, k), AX_RANGE(1, 2)); // Strided
+    AxMatrix* ref = ax_matrix_create_dtype(m, 1, types[d], arena);
+    AxMatrix* y = ax_matrix_create_dtype(1, m, types[d], arena);
+    for (musz i = 0; i < m; i++) ax_matrix_set(ref, i, 0, 1.0);
+    ax_csr_spmv(0.5, &a, &x, 2.0, ref);
+    for (int c = 0; c < 3; c++) {
+      AxSparseSELL s;
+      ax_sell_from_csr(&s, &a, chunks[c], sigmas[c], arena);
+      if (s.nnz != a.nnz || s.slice_ptr[s.nslices] < a.nnz || s.slice_ptr[s.nslices] % s.chunk) layout = 0;
+      for (musz i = 0; i < m; i++) ax_matrix_set(y, 0, i, 1.0);
+      ax_sell_spmv(0.5, &s, &x, 2.0, y);
+      for (musz i = 0; i < m; i++) {
+        if (fabs(ax_matrix_get(y, 0, i) - ax_matrix_get(ref, i, 0)) > 1e-4) close = 0;
+      }
+    }
+  }
+  CLOVE_INT_EQ(1, close);
+  CLOVE_INT_EQ(1, layout);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxSparseGemm) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Small product against the dense one
+  AxMatrix* ad = ax_matrix_create_dtype(40, 30, AX_F64, arena);
+  AxMatrix* bd = ax_matrix_create_dtype(30, 50, AX_F64, arena);
+  for (musz i = 0; i < 40; i++) {
+    for (musz j = 0; j < 30; j++) ax_matrix_set(ad, i, j, (i * 7 + j * 3) % 5 == 0 ? (double)(i + j) - 30.0 : 0.0);
+  }
+  for (musz i = 0; i < 30; i++) {
+    for (musz j = 0; j < 50; j++) ax_matrix_set(bd, i, j, (i * 11 + j) % 6 == 0 ? (double)(j % 7) - 3.0 : 0.0);
+  }
+  AxSparseCSR a, b, c;
+  ax_csr_from_dense(&a, ad, arena);
+  ax_csr_from_dense(&b, bd, arena);
+  ax_csr_spgemm(&a, &b, &c, arena);
+  AxMatrix* cd = ax_matrix_multiply(ad, bd, arena);
+  AxMatrix* cs = ax_matrix_create_dtype(40, 50, AX_F64, arena);
+  ax_matrix_from_csr(cs, &c);
+  int same = 1;
+  for (musz i = 0; i < 40 * 50; i++) {
+    if (((mf64*)cs->data)[i] != ((mf64*)cd->data)[i]) same = 0;
+  }
+  CLOVE_INT_EQ(1, same);
+
+  // A A^T on a larger matrix with a few dense rows, so both the hash and the
+  // dense accumulators run; checked through (A A^T) x == A (A^T x)
+  musz m = 3000, k = 2000;
+  AxSparseCOO coo;
+  ax_coo_init(&coo, m, k, 0, AX_F32, arena);
+  for (musz i = 0; i < m; i++) {
+    musz len = i % 500 == 0 ? 400 : 1 + i % 4;
+    for (musz p = 0; p < len; p++) ax_coo_push(&coo, i, (i * 17 + p * 131) % k, (double)((i + p) % 5) - 2.0);
+  }
+  AxSparseCSR big, aat;
+  AxSparseCSC bigc;
+  ax_csr_from_coo(&big, &coo, arena);
+  ax_csc_from_csr(&bigc, &big, arena);
+  AxSparseCSR bigt = ax_csc_transpose(&bigc);
+  ax_csr_spgemm(&big, &bigt, &aat, arena);
+  int sorted = aat.rows == m && aat.cols == m;
+  for (musz i = 0; i < m; i++) {
+    for (musz p = aat.row_ptr[i] + 1; p < aat.row_ptr[i + 1]; p++) {
+      if (aat.col_idx[p - 1] >= aat.col_idx[p]) sorted = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, sorted);
+  AxMatrix* x = ax_matrix_create_dtype(m, 1, AX_F32, arena);
+  AxMatrix* tmp = ax_matrix_create_dtype(k, 1, AX_F32, arena);
+  AxMatrix* y1 = ax_matrix_create_dtype(m, 1, AX_F32, arena);
+  AxMatrix* y2 = ax_matrix_create_dtype(m, 1, AX_F32, arena);
+  for (musz i = 0; i < m; i++) ((mf32*)x->data)[i] = (mf32)(i % 3) - 1.0f;
+  ax_csr_spmv(1.0, &aat, x, 0.0, y1);
+  ax_csr_spmv(1.0, &bigt, x, 0.0, tmp);
+  ax_csr_spmv(1.0, &big, tmp, 0.0, y2);
+  int close = 1;
+  for (musz i = 0; i < m; i++) {
+    if (fabsf(((mf32*)y1->data)[i] - ((mf32*)y2->data)[i]) > 1e-3f) close = 0;
+  }
+  CLOVE_INT_EQ(1, close);
+
+  ax_arena_destroy(arena);
+}
+
+static double sr_ref(AxSemiring sr, const AxMatrix* a, const AxMatrix* b, musz i, musz j) {
+  double acc = ax_semiring_zero(sr);
+  for (musz p = 0; p < a->cols; p++) {
+    double x = ax_matrix_get(a, i, p), y = ax_matrix_get(b, p, j);
+    switch (sr) {
+    case AX_SEMIRING_PLUS_TIMES: acc += x * y; break;
+    case AX_SEMIRING_MIN_PLUS: acc = fmin(acc, x + y); break;
+    case AX_SEMIRING_MAX_PLUS: acc = fmax(acc, x + y); break;
+    case AX_SEMIRING_MAX_MIN: acc = fmax(acc, fmin(x, y)); break;
+    case AX_SEMIRING_OR_AND: acc = (acc != 0 || (x != 0 && y != 0)); break;
+    }
+  }
+  return acc;
+}
+
+CLOVE_TEST(AxSemiring) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Dense products of every semiring against a direct loop, with k spanning
+  // several slices and edge tiles in both dimensions
+  musz m = 37, k = 600, n = 45;
+  AxMatrix* a = ax_matrix_create_dtype(m, k, AX_F32, arena);
+  AxMatrix* b = ax_matrix_create_dtype(k, n, AX_F32, arena);
+  AxMatrix* c = ax_matrix_create_dtype(m, n, AX_F32, arena);
+  for (musz i = 0; i < m; i++) {
+    for (musz p = 0; p < k; p++) ax_matrix_set(a, i, p, (i * 7 + p * 3) % 11 == 0 ? 0.0 : (double)((i + p * 5) % 13) - 4.0);
+  }
+  for (musz p = 0; p < k; p++) {
+    for (musz j = 0; j < n; j++) ax_matrix_set(b, p, j, (p + j) % 9 == 0 ? 0.0 : (double)((p * 3 + j) % 17) - 6.0);
+  }
+  int exact = 1;
+  for (int sr = AX_SEMIRING_MIN_PLUS; sr <= AX_SEMIRING_OR_AND; sr++) {
+    ax_matrix_semiring_gemm((AxSemiring)sr, a, AX_NO_TRANS, b, AX_NO_TRANS, false, c);
+    for (musz i = 0; i < m; i++) {
+      for (musz j = 0; j < n; j++) {
+        if (ax_matrix_get(c, i, j) != sr_ref((AxSemiring)sr, a, b, i, j)) exact = 0;
+      }
+    }
+  }
+  CLOVE_INT_EQ(1, exact);
+
+  // Min-plus over a transposed f64 operand, accumulating into c
+  AxMatrix* ad = ax_matrix_create_dtype(m, k, AX_F64, arena);
+  AxMatrix* bt = ax_matrix_create_dtype(n, k, AX_F64, arena);
+  AxMatrix* bd = ax_matrix_create_dtype(k, n, AX_F64, arena);
+  AxMatrix* cd = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  ax_matrix_copy(ad, a);
+  ax_matrix_copy(bd, b);
+  ax_matrix_transpose_into(bt, bd);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) ax_matrix_set(cd, i, j, (double)(i + j) - 20.0);
+  }
+  ax_matrix_semiring_gemm(AX_SEMIRING_MIN_PLUS, ad, AX_NO_TRANS, bt, AX_TRANS, true, cd);
+  int acc_ok = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      double ref = fmin((double)(i + j) - 20.0, sr_ref(AX_SEMIRING_MIN_PLUS, ad, bd, i, j));
+      if (ax_matrix_get(cd, i, j) != ref) acc_ok = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, acc_ok);
+
+  // Sparse shortest paths: one relaxation step of a weighted ring with
+  // chords, where missing edges are +inf, matches the dense product
+  musz nv = 200;
+  AxSparseCOO coo;
+  ax_coo_init(&coo, nv, nv, 0, AX_F64, arena);
+  AxMatrix* w = ax_matrix_create_dtype(nv, nv, AX_F64, arena);
+  for (musz i = 0; i < nv; i++) {
+    for (musz j = 0; j < nv; j++) ax_matrix_set(w, i, j, INFINITY);
+    musz nbr[3] = { i, (i + 1) % nv, (i * 7 + 3) % nv };
+    double wt[3] = { 0.0, 1.0, 2.5 };
+    for (int e = 0; e < 3; e++) {
+      if (ax_matrix_get(w, i, nbr[e]) == INFINITY) {
+        ax_coo_push(&coo, i, nbr[e], wt[e]);
+        ax_matrix_set(w, i, nbr[e], wt[e]);
+      }
+    }
+  }
+  AxSparseCSR g;
+  ax_csr_from_coo(&g, &coo, arena);
+  AxMatrix* d = ax_matrix_create_dtype(nv, 3, AX_F64, arena);
+  for (musz i = 0; i < nv; i++) {
+    for (musz j = 0; j < 3; j++) ax_matrix_set(d, i, j, i == j * 50 ? 0.0 : INFINITY);
+  }
+  AxMatrix* ds = ax_matrix_create_dtype(nv, 3, AX_F64, arena);
+  AxMatrix* dd = ax_matrix_create_dtype(nv, 3, AX_F64, arena);
+  AxMatrix* dv = ax_matrix_create_dtype(nv, 1, AX_F64, arena);
+  int paths = 1;
+  for (int step = 0; step < 4; step++) {
+    ax_csr_semiring_spmm(AX_SEMIRING_MIN_PLUS, &g, d, false, ds);
+    ax_matrix_semiring_gemm(AX_SEMIRING_MIN_PLUS, w, AX_NO_TRANS, d, AX_NO_TRANS, false, dd);
+    AxMatrix col = AX_MATRIX_SLICE(*d, AX_RANGE(0, nv), AX_RANGE(2, 3));
+    ax_csr_semiring_spmv(AX_SEMIRING_MIN_PLUS, &g, &col, false, dv);
+    for (musz i = 0; i < nv; i++) {
+      for (musz j = 0; j < 3; j++) {
+        if (ax_matrix_get(ds, i, j) != ax_matrix_get(dd, i, j)) paths = 0;
+      }
+      if (ax_matrix_get(dv, i, 0) != ax_matrix_get(dd, i, 2)) paths = 0;
+    }
+    ax_matrix_copy(d, ds);
+  }
+  CLOVE_INT_EQ(1, paths);
+  CLOVE_DOUBLE_EQ(1.0, ax_matrix_get(d, nv - 1, 0)); // Ring edge into the source
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxBitMatrix) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Round trip through a dense matrix with a ragged last word
+  musz m = 37, k = 130, n = 70;
+  AxMatrix* da = ax_matrix_create_dtype(m, k, AX_F32, arena);
+  AxMatrix* db = ax_matrix_create_dtype(k, n, AX_F32, arena);
+  for (musz i = 0; i < m; i++) {
+    for (musz p = 0; p < k; p++) ax_matrix_set(da, i, p, (i * 5 + p * 3) % 7 == 0 ? 2.0 : 0.0);
+  }
+  for (musz p = 0; p < k; p++) {
+    for (musz j = 0; j < n; j++) ax_matrix_set(db, p, j, (p * 11 + j) % 23 == 0 ? -1.0 : 0.0);
+  }
+  AxBitMatrix* a = ax_bitmatrix_create(m, k, arena);
+  AxBitMatrix* b = ax_bitmatrix_create(k, n, arena);
+  ax_bitmatrix_from_matrix(a, da);
+  ax_bitmatrix_from_matrix(b, db);
+  AxMatrix* back = ax_matrix_create_dtype(m, k, AX_I32, arena);
+  ax_matrix_from_bitmatrix(back, a);
+  int round = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz p = 0; p < k; p++) {
+      int set = ax_matrix_get(da, i, p) != 0.0;
+      if (ax_bitmatrix_get(a, i, p) != set || ax_matrix_get(back, i, p) != (double)set) round = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, round);
+
+  // Logic ops, with NOT leaving the row padding clear
+  AxBitMatrix* t = ax_bitmatrix_create(m, k, arena);
+  AxBitMatrix* u = ax_bitmatrix_create(m, k, arena);
+  ax_bitmatrix_not(t, a);
+  ax_bitmatrix_and(u, t, a);
+  AxMatrix* counts = ax_matrix_create_dtype(m, 1, AX_I64, arena);
+  AxMatrix* total = ax_matrix_create_dtype(1, 1, AX_F64, arena);
+  ax_bitmatrix_row_counts(u, counts);
+  ax_matrix_sum(counts, AX_AXIS_ALL, total);
+  CLOVE_DOUBLE_EQ(0.0, ax_matrix_get(total, 0, 0));
+  ax_bitmatrix_or(u, t, a);
+  ax_bitmatrix_row_counts(u, counts);
+  ax_matrix_sum(counts, AX_AXIS_ALL, total);
+  CLOVE_DOUBLE_EQ((double)(m * k), ax_matrix_get(total, 0, 0));
+  ax_bitmatrix_xor(u, u, a);
+  int same = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz p = 0; p < k; p++) same &= ax_bitmatrix_get(u, i, p) == ax_bitmatrix_get(t, i, p);
+  }
+  CLOVE_INT_EQ(1, same);
+
+  // Boolean product in both forms against the dense plus-times product
+  AxMatrix* dc = ax_matrix_create_dtype(m, n, AX_F32, arena);
+  ax_matrix_gemm(1.0, da, AX_NO_TRANS, db, AX_NO_TRANS, 0.0, dc);
+  AxBitMatrix* bt = ax_bitmatrix_create(n, k, arena);
+  for (musz p = 0; p < k; p++) {
+    for (musz j = 0; j < n; j++) ax_bitmatrix_set(bt, j, p, ax_bitmatrix_get(b, p, j));
+  }
+  AxBitMatrix* c1 = ax_bitmatrix_create(m, n, arena);
+  AxBitMatrix* c2 = ax_bitmatrix_create(m, n, arena);
+  ax_bitmatrix_multiply(a, b, AX_NO_TRANS, c1);
+  ax_bitmatrix_multiply(a, bt, AX_TRANS, c2);
+  int prod = 1;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      bool ref = ax_matrix_get(dc, i, j) != 0.0;
+      if (ax_bitmatrix_get(c1, i, j) != ref || ax_bitmatrix_get(c2, i, j) != ref) prod = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, prod);
+
+  // Intersection counts over rows wide enough for several vector words
+  musz rows = 23, width = 1500;
+  AxBitMatrix* x = ax_bitmatrix_create(rows, width, arena);
+  AxBitMatrix* y = ax_bitmatrix_create(rows + 6, width, arena);
+  for (musz i = 0; i < rows; i++) {
+    for (musz p = 0; p < width; p++) ax_bitmatrix_set(x, i, p, (i * 13 + p * 7) % 5 == 0);
+  }
+  for (musz j = 0; j < rows + 6; j++) {
+    for (musz p = 0; p < width; p++) ax_bitmatrix_set(y, j, p, (j + p * 3) % (j % 4 + 2) == 0);
+  }
+  AxMatrix* ic = ax_matrix_create_dtype(rows, rows + 6, AX_I32, arena);
+  ax_bitmatrix_intersect(x, y, ic);
+  int inter = 1;
+  for (musz i = 0; i < rows; i++) {
+    for (musz j = 0; j < rows + 6; j++) {
+      musz ref = 0;
+      for (musz p = 0; p < width; p++) ref += ax_bitmatrix_get(x, i, p) && ax_bitmatrix_get(y, j, p);
+      if (ax_matrix_get(ic, i, j) != (double)ref) inter = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, inter);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxLU) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // A = L0 * U0 with a known determinant, then rows shuffled so pivoting
+  // has work to do; n spans several blocks and recursion levels
+  musz n = 300, nrhs = 7;
+  AxMatrix* l0 = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* u0 = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) {
+      double v = ((double)((i * 7 + j * 13) % 17) / 17.0 - 0.5) * 0.05;
+      ax_matrix_set(l0, i, j, i > j ? v : (i == j ? 1.0 : 0.0));
+      ax_matrix_set(u0, i, j, i < j ? v : (i == j ? (i % 3 == 0 ? -1.0 : 1.0) : 0.0));
+    }
+  }
+  AxMatrix* a = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_matrix_gemm(1.0, l0, AX_NO_TRANS, u0, AX_NO_TRANS, 0.0, a);
+  AxMatrix* orig = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  for (musz i = 0; i < n; i++) {
+    AxMatrix src = AX_MATRIX_SLICE(*a, AX_RANGE(i, i + 1), AX_RANGE(0, n));
+    musz r = (i * 101) % n;
+    AxMatrix dst = AX_MATRIX_SLICE(*orig, AX_RANGE(r, r + 1), AX_RANGE(0, n));
+    ax_matrix_copy(&dst, &src);
+  }
+  ax_matrix_copy(a, orig);
+  AxLU lu;
+  CLOVE_INT_EQ(1, ax_lu_factor(a, &lu, arena));
+  CLOVE_INT_EQ(0, lu.singular);
+  // Odd permutation (a product of cycles of even length) or not, |det| is 1
+  CLOVE_DOUBLE_EQ(1.0, fabs(ax_lu_det(&lu)));
+
+  // Multiple right-hand sides: A x = A x_ref
+  AxMatrix* xr = ax_matrix_create_dtype(n, nrhs, AX_F64, arena);
+  AxMatrix* b = ax_matrix_create_dtype(n, nrhs, AX_F64, arena);
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < nrhs; j++) ax_matrix_set(xr, i, j, (double)((i + j * 5) % 11) - 5.0);
+  }
+  ax_matrix_gemm(1.0, orig, AX_NO_TRANS, xr, AX_NO_TRANS, 0.0, b);
+  CLOVE_INT_EQ(1, ax_lu_solve(&lu, b));
+  double err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < nrhs; j++) err = fmax(err, fabs(ax_matrix_get(b, i, j) - ax_matrix_get(xr, i, j)));
+  }
+  CLOVE_IS_TRUE(err < 1e-8);
+
+  // Inverse: A * A^-1 = I
+  AxMatrix* inv = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* id = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  CLOVE_INT_EQ(1, ax_lu_inverse(&lu, inv));
+  ax_matrix_gemm(1.0, orig, AX_NO_TRANS, inv, AX_NO_TRANS, 0.0, id);
+  err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(id, i, j) - (i == j ? 1.0 : 0.0)));
+  }
+  CLOVE_IS_TRUE(err < 1e-8);
+
+  // Small f32 system with a known determinant
+  AxMatrix* s = ax_matrix_create_dtype(3, 3, AX_F32, arena);
+  double sv[9] = { 0, 2, 1, 1, 1, 1, 2, 1, 0 };
+  for (musz i = 0; i < 9; i++) ax_matrix_set(s, i / 3, i % 3, sv[i]);
+  AxMatrix* sb = ax_matrix_create_dtype(3, 1, AX_F32, arena);
+  ax_matrix_set(sb, 0, 0, 3.0);
+  ax_matrix_set(sb, 1, 0, 3.0);
+  ax_matrix_set(sb, 2, 0, 3.0);
+  AxLU slu;
+  ax_lu_factor(s, &slu, arena);
+  CLOVE_FLOAT_EQ(3.0f, (float)ax_lu_det(&slu));
+  ax_lu_solve(&slu, sb);
+  for (musz i = 0; i < 3; i++) CLOVE_FLOAT_EQ(1.0f, (float)ax_matrix_get(sb, i, 0));
+
+  // Singular input is factored and flagged
+  AxMatrix* z = ax_matrix_create_dtype(2, 2, AX_F64, arena);
+  ax_matrix_set(z, 0, 0, 1.0);
+  ax_matrix_set(z, 0, 1, 2.0);
+  ax_matrix_set(z, 1, 0, 2.0);
+  ax_matrix_set(z, 1, 1, 4.0);
+  AxLU zlu;
+  ax_lu_factor(z, &zlu, arena);
+  CLOVE_INT_EQ(1, zlu.singular);
+  CLOVE_DOUBLE_EQ(0.0, ax_lu_det(&zlu));
+  AxMatrix* zb = ax_matrix_create_dtype(2, 2, AX_F64, arena);
+  ax_matrix_set(zb, 0, 0, 5.0);
+  CLOVE_INT_EQ(0, ax_lu_solve(&zlu, zb));
+  CLOVE_INT_EQ(0, ax_lu_inverse(&zlu, zb));
+  CLOVE_DOUBLE_EQ(5.0, ax_matrix_get(zb, 0, 0));
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxCholesky) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // TRSM, every side/uplo/transpose/diag combination: op(a) x = alpha b
+  // and x op(a) = alpha b, checked by multiplying back
+  musz n = 150, nrhs = 70;
+  AxMatrix* t = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) {
+      ax_matrix_set(t, i, j, i == j ? 2.0 + (double)(i % 3) : ((double)((i * 5 + j * 3) % 11) - 5.0) / 40.0);
+    }
+  }
+  int trsm_ok = 1;
+  for (int side = 0; side < 2; side++) {
+    for (int uplo = 0; uplo < 2; uplo++) {
+      for (int ta = 0; ta < 2; ta++) {
+        for (int diag = 0; diag < 2; diag++) {
+          musz br = side == AX_LEFT ? n : nrhs, bc = side == AX_LEFT ? nrhs : n;
+          AxMatrix* b = ax_matrix_create_dtype(br, bc, AX_F64, arena);
+          AxMatrix* x = ax_matrix_create_dtype(br, bc, AX_F64, arena);
+          AxMatrix* r = ax_matrix_create_dtype(br, bc, AX_F64, arena);
+          AxMatrix* tri = ax_matrix_create_dtype(n, n, AX_F64, arena);
+          for (musz i = 0; i < br; i++) {
+            for (musz j = 0; j < bc; j++) ax_matrix_set(b, i, j, (double)((i * 3 + j) % 7) - 3.0);
+          }
+          for (musz i = 0; i < n; i++) {
+            for (musz j = 0; j < n; j++) {
+              bool in = uplo == AX_LOWER ? i >= j : i <= j;
+              double v = (i == j && diag == AX_UNIT) ? 1.0 : ax_matrix_get(t, i, j);
+              ax_matrix_set(tri, i, j, in ? v : 0.0);
+            }
+          }
+          ax_matrix_copy(x, b);
+          ax_matrix_trsm((AxSide)side, (AxUplo)uplo, (AxTranspose)ta, (AxDiag)diag, 0.5, t, x);
+          if (side == AX_LEFT) ax_matrix_gemm(1.0, tri, (AxTranspose)ta, x, AX_NO_TRANS, 0.0, r);
+          else ax_matrix_gemm(1.0, x, AX_NO_TRANS, tri, (AxTranspose)ta, 0.0, r);
+          for (musz i = 0; i < br; i++) {
+            for (musz j = 0; j < bc; j++) {
+              if (fabs(ax_matrix_get(r, i, j) - 0.5 * ax_matrix_get(b, i, j)) > 1e-10) trsm_ok = 0;
+            }
+          }
+        }
+      }
+    }
+  }
+  CLOVE_INT_EQ(1, trsm_ok);
+
+  // SYRK touches one triangle only
+  musz k = 90;
+  AxMatrix* g = ax_matrix_create_dtype(n, k, AX_F64, arena);
+  for (musz i = 0; i < n; i++) {
+    for (musz p = 0; p < k; p++) ax_matrix_set(g, i, p, ((double)((i * 7 + p * 11) % 13) - 6.0) / 13.0);
+  }
+  AxMatrix* gt = ax_matrix_create_dtype(k, n, AX_F64, arena);
+  ax_matrix_transpose_into(gt, g);
+  AxMatrix* full = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_matrix_gemm(1.0, g, AX_NO_TRANS, g, AX_TRANS, 0.0, full);
+  int syrk_ok = 1;
+  for (int uplo = 0; uplo < 2; uplo++) {
+    for (int tr = 0; tr < 2; tr++) {
+      AxMatrix* c = ax_matrix_create_dtype(n, n, AX_F64, arena);
+      for (musz i = 0; i < n; i++) {
+        for (musz j = 0; j < n; j++) ax_matrix_set(c, i, j, 1.0);
+      }
+      ax_matrix_syrk((AxUplo)uplo, (AxTranspose)tr, 2.0, tr ? gt : g, -1.0, c);
+      for (musz i = 0; i < n; i++) {
+        for (musz j = 0; j < n; j++) {
+          bool in = uplo == AX_LOWER ? i >= j : i <= j;
+          double ref = in ? 2.0 * ax_matrix_get(full, i, j) - 1.0 : 1.0;
+          if (fabs(ax_matrix_get(c, i, j) - ref) > 1e-10) syrk_ok = 0;
+        }
+      }
+    }
+  }
+  CLOVE_INT_EQ(1, syrk_ok);
+
+  // SPD a = g g^T + n I, factored both ways across several blocks
+  musz m = 300;
+  AxMatrix* h = ax_matrix_create_dtype(m, m, AX_F64, arena);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < m; j++) ax_matrix_set(h, i, j, ((double)((i * 7 + j * 3) % 19) - 9.0) / 19.0);
+  }
+  AxMatrix* spd = ax_matrix_create_dtype(m, m, AX_F64, arena);
+  ax_matrix_gemm(1.0, h, AX_NO_TRANS, h, AX_TRANS, 0.0, spd);
+  for (musz i = 0; i < m; i++) ax_matrix_set(spd, i, i, ax_matrix_get(spd, i, i) + 1.0);
+  AxMatrix* xr = ax_matrix_create_dtype(m, 5, AX_F64, arena);
+  AxMatrix* rhs = ax_matrix_create_dtype(m, 5, AX_F64, arena);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < 5; j++) ax_matrix_set(xr, i, j, (double)((i + j * 3) % 9) - 4.0);
+  }
+  ax_matrix_gemm(1.0, spd, AX_NO_TRANS, xr, AX_NO_TRANS, 0.0, rhs);
+  int chol_ok = 1;
+  for (int uplo = 0; uplo < 2; uplo++) {
+    AxMatrix* f = ax_matrix_create_dtype(m, m, AX_F64, arena);
+    AxMatrix* b = ax_matrix_create_dtype(m, 5, AX_F64, arena);
+    ax_matrix_copy(f, spd);
+    ax_matrix_copy(b, rhs);
+    AxCholesky chol;
+    CLOVE_INT_EQ(1, ax_cholesky_factor(f, (AxUplo)uplo, &chol));
+    ax_cholesky_solve(&chol, b);
+    for (musz i = 0; i < m; i++) {
+      for (musz j = 0; j < 5; j++) {
+        if (fabs(ax_matrix_get(b, i, j) - ax_matrix_get(xr, i, j)) > 1e-8) chol_ok = 0;
+      }
+      // The other triangle is untouched
+      musz j = uplo == AX_LOWER ? m - 1 : 0;
+      if ((uplo == AX_LOWER ? i < j : i > j) && ax_matrix_get(f, i, j) != ax_matrix_get(spd, i, j)) chol_ok = 0;
+    }
+  }
+  CLOVE_INT_EQ(1, chol_ok);
+
+  // Indefinite input is rejected
+  AxMatrix* ind = ax_matrix_create_dtype(2, 2, AX_F32, arena);
+  ax_matrix_set(ind, 0, 0, 1.0);
+  ax_matrix_set(ind, 0, 1, 2.0);
+  ax_matrix_set(ind, 1, 0, 2.0);
+  ax_matrix_set(ind, 1, 1, 1.0);
+  AxCholesky bad;
+  CLOVE_INT_EQ(0, ax_cholesky_factor(ind, AX_LOWER, &bad));
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxQR) {
+  Arena* arena = ax_arena_create(1 << 20);
+
+  // Tall f64 matrix spanning several panels: Q R = A and Q^T Q = I
+  musz m = 300, n = 75;
+  AxMatrix* a = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  mu64 seed = 42;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      ax_matrix_set(a, i, j, (double)(seed >> 33) / 4294967296.0 - 0.25);
+    }
+  }
+  AxMatrix* f = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  ax_matrix_copy(f, a);
+  AxQR qr;
+  CLOVE_INT_EQ(1, ax_qr_factor(f, &qr, arena));
+  AxMatrix* q = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  AxMatrix* r = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_qr_form_q(&qr, q);
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) ax_matrix_set(r, i, j, i <= j ? ax_matrix_get(f, i, j) : 0.0);
+  }
+  AxMatrix* qrp = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  AxMatrix* qtq = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_matrix_gemm(1.0, q, AX_NO_TRANS, r, AX_NO_TRANS, 0.0, qrp);
+  ax_matrix_gemm(1.0, q, AX_TRANS, q, AX_NO_TRANS, 0.0, qtq);
+  double err = 0.0;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(qrp, i, j) - ax_matrix_get(a, i, j)));
+  }
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(qtq, i, j) - (i == j ? 1.0 : 0.0)));
+  }
+  CLOVE_IS_TRUE(err < 1e-12);
+
+  // Least squares against the normal equations A^T A x = A^T b
+  AxMatrix* b = ax_matrix_create_dtype(m, 2, AX_F64, arena);
+  for (musz i = 0; i < m; i++) {
+    ax_matrix_set(b, i, 0, (double)(i % 5));
+    ax_matrix_set(b, i, 1, sin((double)i));
+  }
+  AxMatrix* ata = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* atb = ax_matrix_create_dtype(n, 2, AX_F64, arena);
+  ax_matrix_gemm(1.0, a, AX_TRANS, a, AX_NO_TRANS, 0.0, ata);
+  ax_matrix_gemm(1.0, a, AX_TRANS, b, AX_NO_TRANS, 0.0, atb);
+  AxCholesky chol;
+  ax_cholesky_factor(ata, AX_LOWER, &chol);
+  ax_cholesky_solve(&chol, atb);
+  AxMatrix* bx = ax_matrix_create_dtype(m, 2, AX_F64, arena);
+  ax_matrix_copy(bx, b);
+  CLOVE_INT_EQ(1, ax_qr_solve(&qr, bx));
+  err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < 2; j++) err = fmax(err, fabs(ax_matrix_get(bx, i, j) - ax_matrix_get(atb, i, j)));
+  }
+  CLOVE_IS_TRUE(err < 1e-8);
+
+  // An all-zero column is rank deficient: reported, not solved
+  AxMatrix* d = ax_matrix_create_dtype(6, 3, AX_F64, arena);
+  for (musz i = 0; i < 6; i++) {
+    ax_matrix_set(d, i, 0, 1.0);
+    ax_matrix_set(d, i, 1, (double)i);
+    ax_matrix_set(d, i, 2, 0.0);
+  }
+  AxQR dqr;
+  CLOVE_INT_EQ(1, ax_qr_factor(d, &dqr, arena));
+  AxMatrix* db = ax_matrix_create_dtype(6, 1, AX_F64, arena);
+  for (musz i = 0; i < 6; i++) ax_matrix_set(db, i, 0, (double)i);
+  CLOVE_INT_EQ(0, ax_qr_solve(&dqr, db));
+  CLOVE_DOUBLE_EQ(5.0, ax_matrix_get(db, 5, 0));
+
+  // Q then Q^T round trip on a wide f32 factor
+  AxMatrix* w = ax_matrix_create_dtype(40, 90, AX_F32, arena);
+  for (musz i = 0; i < 40; i++) {
+    for (musz j = 0; j < 90; j++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      ax_matrix_set(w, i, j, (double)(seed >> 33) / 4294967296.0 - 0.25);
+    }
+  }
+  AxQR wqr;
+  ax_qr_factor(w, &wqr, arena);
+  AxMatrix* v = ax_matrix_create_dtype(40, 3, AX_F32, arena);
+  AxMatrix* v0 = ax_matrix_create_dtype(40, 3, AX_F32, arena);
+  for (musz i = 0; i < 40; i++) {
+    for (musz j = 0; j < 3; j++) ax_matrix_set(v0, i, j, (double)(i + j) / 42.0);
+  }
+  ax_matrix_copy(v, v0);
+  ax_qr_apply(&wqr, AX_NO_TRANS, v);
+  ax_qr_apply(&wqr, AX_TRANS, v);
+  err = 0.0;
+  for (musz i = 0; i < 40; i++) {
+    for (musz j = 0; j < 3; j++) err = fmax(err, fabs(ax_matrix_get(v, i, j) - ax_matrix_get(v0, i, j)));
+  }
+  CLOVE_IS_TRUE(err < 1e-5);
+
+  // TSQR matches R up to row signs, one-shot and streamed in uneven blocks;
+  // streaming [A b] solves the least-squares problem
+  AxMatrix* rt = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_matrix_tsqr(a, rt);
+  AxTSQR ts;
+  ax_tsqr_init(&ts, n + 1, AX_F64, arena);
+  AxMatrix* ab = ax_matrix_create_dtype(m, n + 1, AX_F64, arena);
+  AxMatrix abl = AX_MATRIX_SLICE(*ab, AX_RANGE(0, m), AX_RANGE(0, n));
+  AxMatrix abr = AX_MATRIX_SLICE(*ab, AX_RANGE(0, m), AX_RANGE(n, n + 1));
+  AxMatrix bc = AX_MATRIX_SLICE(*b, AX_RANGE(0, m), AX_RANGE(0, 1));
+  ax_matrix_copy(&abl, a);
+  ax_matrix_copy(&abr, &bc);
+  musz cuts[4] = { 0, 17, 170, m };
+  for (int p = 0; p < 3; p++) {
+    AxMatrix blk = AX_MATRIX_SLICE(*ab, AX_RANGE(cuts[p], cuts[p + 1]), AX_RANGE(0, n + 1));
+    ax_tsqr_push(&ts, &blk);
+  }
+  CLOVE_INT_EQ((int)m, (int)ts.rows);
+  err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) {
+      double ref = fabs(ax_matrix_get(r, i, j));
+      err = fmax(err, fabs(fabs(ax_matrix_get(rt, i, j)) - ref));
+      err = fmax(err, fabs(fabs(ax_matrix_get(ts.r, i, j)) - ref));
+    }
+  }
+  CLOVE_IS_TRUE(err < 1e-10);
+  AxMatrix r11 = AX_MATRIX_SLICE(*ts.r, AX_RANGE(0, n), AX_RANGE(0, n));
+  AxMatrix z = AX_MATRIX_SLICE(*ts.r, AX_RANGE(0, n), AX_RANGE(n, n + 1));
+  ax_matrix_trsm(AX_LEFT, AX_UPPER, AX_NO_TRANS, AX_NON_UNIT, 1.0, &r11, &z);
+  err = 0.0;
+  for (musz i = 0; i < n; i++) err = fmax(err, fabs(ax_matrix_get(&z, i, 0) - ax_matrix_get(atb, i, 0)));
+  CLOVE_IS_TRUE(err < 1e-8);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxSolveRefined) {
+  Arena* arena = ax_arena_create(1 << 24);
+  musz n = 200;
+  AxMatrix* a = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* xt = ax_matrix_create_dtype(n, 2, AX_F64, arena);
+  mu64 seed = 7;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      ax_matrix_set(a, i, j, (double)(seed >> 33) / 4294967296.0 - 0.25);
+    }
+    ax_matrix_set(xt, i, 0, 1.0 + (double)i / 3.0);
+    ax_matrix_set(xt, i, 1, cos((double)i));
+  }
+  AxMatrix* a0 = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_matrix_copy(a0, a);
+  AxMatrix* b = ax_matrix_create_dtype(n, 2, AX_F64, arena);
+  ax_matrix_gemm(1.0, a, AX_NO_TRANS, xt, AX_NO_TRANS, 0.0, b);
+
+  // LU in f32 refined to f64 accuracy, leaving A untouched
+  AxRefineInfo info;
+  CLOVE_INT_EQ(1, ax_solve_refined(AX_REFINE_LU, a, b, &info, arena));
+  CLOVE_INT_EQ(0, info.fallback);
+  CLOVE_INT_EQ(0, info.stalled);
+  CLOVE_IS_TRUE(info.iters > 0 && info.iters < 10);
+  double err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < 2; j++) err = fmax(err, fabs(ax_matrix_get(b, i, j) - ax_matrix_get(xt, i, j)));
+  }
+  CLOVE_IS_TRUE(err < 1e-10);
+  err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(a, i, j) - ax_matrix_get(a0, i, j)));
+  }
+  CLOVE_IS_TRUE(err == 0.0);
+
+  // Cholesky on A^T A + n I
+  AxMatrix* s = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  ax_matrix_gemm(1.0, a, AX_TRANS, a, AX_NO_TRANS, 0.0, s);
+  for (musz i = 0; i < n; i++) ax_matrix_set(s, i, i, ax_matrix_get(s, i, i) + (double)n);
+  ax_matrix_gemm(1.0, s, AX_NO_TRANS, xt, AX_NO_TRANS, 0.0, b);
+  CLOVE_INT_EQ(1, ax_solve_refined(AX_REFINE_CHOLESKY, s, b, &info, arena));
+  CLOVE_INT_EQ(0, info.fallback);
+  err = 0.0;
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < 2; j++) err = fmax(err, fabs(ax_matrix_get(b, i, j) - ax_matrix_get(xt, i, j)));
+  }
+  CLOVE_IS_TRUE(err < 1e-10);
+
+  // The 10x10 Hilbert matrix is too ill-conditioned for f32 and falls
+  // back to f64, which still leaves a small residual
+  musz h = 10;
+  AxMatrix* hm = ax_matrix_create_dtype(h, h, AX_F64, arena);
+  AxMatrix* hb = ax_matrix_create_dtype(h, 1, AX_F64, arena);
+  for (musz i = 0; i < h; i++) {
+    for (musz j = 0; j < h; j++) ax_matrix_set(hm, i, j, 1.0 / (double)(i + j + 1));
+    ax_matrix_set(hb, i, 0, 1.0);
+  }
+  AxMatrix* hx = ax_matrix_create_dtype(h, 1, AX_F64, arena);
+  ax_matrix_copy(hx, hb);
+  CLOVE_INT_EQ(1, ax_solve_refined(AX_REFINE_CHOLESKY, hm, hx, &info, arena));
+  CLOVE_INT_EQ(1, info.fallback);
+  ax_matrix_gemm(-1.0, hm, AX_NO_TRANS, hx, AX_NO_TRANS, 1.0, hb);
+  err = 0.0;
+  for (musz i = 0; i < h; i++) err = fmax(err, fabs(ax_matrix_get(hb, i, 0)));
+  CLOVE_IS_TRUE(err < 1e-6);
+
+  // Through the f32 LU factor, corrections stop shrinking within a few
+  // steps rather than running to the cap
+  for (musz i = 0; i < h; i++) ax_matrix_set(hx, i, 0, 1.0);
+  CLOVE_INT_EQ(1, ax_solve_refined(AX_REFINE_LU, hm, hx, &info, arena));
+  CLOVE_INT_EQ(1, info.fallback);
+  CLOVE_INT_EQ(1, info.stalled);
+  CLOVE_IS_TRUE(info.iters < AX_REFINE_MAX_ITERS);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxRsvd) {
+  Arena* arena = ax_arena_create(1 << 24);
+  // Standard normal samples, identical for identical seeds
+  AxMatrix* g = ax_matrix_create_dtype(200, 200, AX_F64, arena);
+  AxMatrix* g2 = ax_matrix_create_dtype(200, 200, AX_F64, arena);
+  ax_matrix_randn(g, 11);
+  ax_matrix_randn(g2, 11);
+  AxMatrix* st = ax_matrix_create_dtype(1, 1, AX_F64, arena);
+  ax_matrix_mean(g, AX_AXIS_ALL, st);
+  CLOVE_IS_TRUE(fabs(ax_matrix_get(st, 0, 0)) < 0.02);
+  ax_matrix_var(g, AX_AXIS_ALL, st);
+  CLOVE_IS_TRUE(fabs(ax_matrix_get(st, 0, 0) - 1.0) < 0.03);
+  CLOVE_IS_TRUE(memcmp(g->data, g2->data, 200 * 200 * sizeof(double)) == 0);
+
+  // A = U0 diag(s0) V0^T of rank 8 with centered columns, plus offsets mu
+  musz m = 600, n = 120, r = 8;
+  double s0[8] = { 50, 30, 20, 10, 5, 3, 2, 1 };
+  AxMatrix* u0 = ax_matrix_create_dtype(m, r, AX_F64, arena);
+  AxMatrix* v0 = ax_matrix_create_dtype(n, r, AX_F64, arena);
+  AxMatrix* gu = ax_matrix_create_dtype(m, r, AX_F64, arena);
+  AxMatrix* gv = ax_matrix_create_dtype(n, r, AX_F64, arena);
+  ax_matrix_randn(gu, 1);
+  ax_matrix_randn(gv, 2);
+  AxMatrix* cm = ax_matrix_create_dtype(1, r, AX_F64, arena);
+  ax_matrix_mean(gu, AX_AXIS_0, cm);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < r; j++) ax_matrix_set(gu, i, j, ax_matrix_get(gu, i, j) - ax_matrix_get(cm, 0, j));
+  }
+  AxQR qr;
+  ax_qr_factor(gu, &qr, arena);
+  ax_qr_form_q(&qr, u0);
+  ax_qr_factor(gv, &qr, arena);
+  ax_qr_form_q(&qr, v0);
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < r; j++) ax_matrix_set(u0, i, j, ax_matrix_get(u0, i, j) * s0[j]);
+  }
+  AxMatrix* a = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  ax_matrix_gemm(1.0, u0, AX_NO_TRANS, v0, AX_TRANS, 0.0, a);
+
+  AxRsvdParams params = { .rank = 5, .oversample = 5, .power_iters = 1, .seed = 3, .center = false };
+  AxSVD svd;
+  CLOVE_INT_EQ(1, ax_matrix_rsvd(a, &params, &svd, arena));
+  CLOVE_IS_TRUE(svd.mean == NULL);
+  double err = 0.0;
+  for (musz c = 0; c < 5; c++) {
+    err = fmax(err, fabs(ax_matrix_get(svd.s, 0, c) - s0[c]));
+    // Right singular vectors match V0's columns up to sign
+    double dot = 0.0;
+    for (musz j = 0; j < n; j++) dot += ax_matrix_get(svd.vt, c, j) * ax_matrix_get(v0, j, c);
+    err = fmax(err, fabs(fabs(dot) - 1.0));
+  }
+  CLOVE_IS_TRUE(err < 1e-8);
+  // U^T U = I
+  AxMatrix* utu = ax_matrix_create_dtype(5, 5, AX_F64, arena);
+  ax_matrix_gemm(1.0, svd.u, AX_TRANS, svd.u, AX_NO_TRANS, 0.0, utu);
+  err = 0.0;
+  for (musz i = 0; i < 5; i++) {
+    for (musz j = 0; j < 5; j++) err = fmax(err, fabs(ax_matrix_get(utu, i, j) - (i == j ? 1.0 : 0.0)));
+  }
+  CLOVE_IS_TRUE(err < 1e-10);
+
+  // PCA removes the offsets, in memory and streamed in uneven blocks
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) ax_matrix_set(a, i, j, ax_matrix_get(a, i, j) + 0.5 * (double)j);
+  }
+  params.center = true;
+  params.power_iters = 0;
+  AxSVD pca;
+  CLOVE_INT_EQ(1, ax_matrix_rsvd(a, &params, &pca, arena));
+  AxRsvdStream rs;
+  CLOVE_INT_EQ(1, ax_rsvd_stream_init(&rs, m, n, AX_F64, &params, arena));
+  musz cuts[4] = { 0, 100, 350, m };
+  for (int p = 0; p < 3; p++) {
+    AxMatrix blk = AX_MATRIX_SLICE(*a, AX_RANGE(cuts[p], cuts[p + 1]), AX_RANGE(0, n));
+    ax_rsvd_stream_push(&rs, &blk);
+  }
+  AxSVD spca;
+  CLOVE_INT_EQ(1, ax_rsvd_stream_finish(&rs, &spca, arena));
+  err = 0.0;
+  for (musz j = 0; j < n; j++) {
+    err = fmax(err, fabs(ax_matrix_get(pca.mean, 0, j) - 0.5 * (double)j));
+    err = fmax(err, fabs(ax_matrix_get(spca.mean, 0, j) - 0.5 * (double)j));
+  }
+  for (musz c = 0; c < 5; c++) {
+    err = fmax(err, fabs(ax_matrix_get(pca.s, 0, c) - s0[c]));
+    err = fmax(err, fabs(ax_matrix_get(spca.s, 0, c) - s0[c]));
+    for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(pca.vt, c, j) - ax_matrix_get(spca.vt, c, j)));
+  }
+  CLOVE_IS_TRUE(err < 1e-8);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxEigh) {
+  Arena* arena = ax_arena_create(1 << 24);
+  musz n = 160, k = 6;
+  AxMatrix* g = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* a0 = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* a = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* w = ax_matrix_create_dtype(1, n, AX_F64, arena);
+  AxMatrix* z = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* az = ax_matrix_create_dtype(n, n, AX_F64, arena);
+  AxMatrix* wk = ax_matrix_create_dtype(1, k, AX_F64, arena);
+  AxMatrix* zk = ax_matrix_create_dtype(n, k, AX_F64, arena);
+  AxMatrix* azk = ax_matrix_create_dtype(n, k, AX_F64, arena);
+  ax_matrix_randn(g, 5);
+  // Random symmetric, then identity plus a tiny rank-1 term (heavy deflation)
+  for (int kind = 0; kind < 2; kind++) {
+    for (musz i = 0; i < n; i++) {
+      for (musz j = 0; j < n; j++) {
+        double x = kind == 0 ? ax_matrix_get(g, i, j) + ax_matrix_get(g, j, i)
+                             : (i == j ? 1.0 : 0.0) + 0.01 * sin((double)i) * sin((double)j);
+        ax_matrix_set(a0, i, j, x);
+      }
+    }
+    ax_matrix_copy(a, a0);
+    CLOVE_INT_EQ(1, ax_matrix_eigh(a, w, z));
+    // A Z = Z diag(w), Z^T Z = I, ascending order
+    ax_matrix_gemm(1.0, a0, AX_NO_TRANS, z, AX_NO_TRANS, 0.0, az);
+    double resid = 0.0;
+    for (musz i = 0; i < n; i++) {
+      for (musz j = 0; j < n; j++) {
+        resid = fmax(resid, fabs(ax_matrix_get(az, i, j) - ax_matrix_get(z, i, j) * ax_matrix_get(w, 0, j)));
+      }
+    }
+    CLOVE_IS_TRUE(resid < 1e-11);
+    ax_matrix_gemm(1.0, z, AX_TRANS, z, AX_NO_TRANS, 0.0, az);
+    double orth = 0.0;
+    for (musz i = 0; i < n; i++) {
+      for (musz j = 0; j < n; j++) orth = fmax(orth, fabs(ax_matrix_get(az, i, j) - (i == j ? 1.0 : 0.0)));
+    }
+    CLOVE_IS_TRUE(orth < 1e-12);
+    bool sorted = true;
+    for (musz j = 1; j < n; j++) sorted = sorted && ax_matrix_get(w, 0, j - 1) <= ax_matrix_get(w, 0, j);
+    CLOVE_IS_TRUE(sorted);
+
+    // The top k pairs by index range agree with the full solve
+    ax_matrix_copy(a, a0);
+    CLOVE_INT_EQ(1, ax_matrix_eigh_range(a, n - k, n, wk, zk));
+    ax_matrix_gemm(1.0, a0, AX_NO_TRANS, zk, AX_NO_TRANS, 0.0, azk);
+    double err = 0.0;
+    for (musz j = 0; j < k; j++) {
+      err = fmax(err, fabs(ax_matrix_get(wk, 0, j) - ax_matrix_get(w, 0, n - k + j)));
+      for (musz i = 0; i < n; i++) {
+        err = fmax(err, fabs(ax_matrix_get(azk, i, j) - ax_matrix_get(zk, i, j) * ax_matrix_get(wk, 0, j)));
+      }
+    }
+    CLOVE_IS_TRUE(err < 1e-11);
+
+    // Eigenvalues only
+    AxMatrix* wv = ax_matrix_create_dtype(1, n, AX_F64, arena);
+    ax_matrix_copy(a, a0);
+    CLOVE_INT_EQ(1, ax_matrix_eigh(a, wv, NULL));
+    err = 0.0;
+    for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(wv, 0, j) - ax_matrix_get(w, 0, j)));
+    CLOVE_IS_TRUE(err < 1e-11);
+  }
+
+  // f32: the 1D Laplacian, eigenvalues 2 - 2 cos(pi j / (n + 1))
+  AxMatrix* af = ax_matrix_create_dtype(n, n, AX_F32, arena);
+  AxMatrix* zf = ax_matrix_create_dtype(n, n, AX_F32, arena);
+  for (musz i = 0; i < n; i++) {
+    for (musz j = 0; j < n; j++) ax_matrix_set(af, i, j, i == j ? 2.0 : (i == j + 1 || j == i + 1 ? -1.0 : 0.0));
+  }
+  CLOVE_INT_EQ(1, ax_matrix_eigh(af, w, zf));
+  double err = 0.0;
+  for (musz j = 0; j < n; j++) {
+    err = fmax(err, fabs(ax_matrix_get(w, 0, j) - (2.0 - 2.0 * cos(3.14159265358979323846 * (double)(j + 1) / (double)(n + 1)))));
+  }
+  CLOVE_IS_TRUE(err < 1e-5);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxBatchMultiply) {
+  Arena* arena = ax_arena_create(1 << 22);
+  // (m, k, n): fixed-size square kernels and the general path
+  musz shapes[4][3] = { { 3, 3, 3 }, { 4, 4, 4 }, { 16, 16, 16 }, { 3, 5, 2 } };
+  musz count = 37; // Not a multiple of any vector width
+  for (int sh = 0; sh < 4; sh++) {
+    musz m = shapes[sh][0], k = shapes[sh][1], n = shapes[sh][2];
+    for (int dt = 0; dt < 2; dt++) {
+      AxDType dtype = dt ? AX_F32 : AX_F64;
+      for (int lay = 0; lay < 2; lay++) {
+        AxBatchLayout layout = lay ? AX_BATCH_INTERLEAVED : AX_BATCH_PACKED;
+        AxMatrixBatch a, b, c;
+        CLOVE_INT_EQ(1, ax_matrix_batch_init(&a, count, m, k, dtype, layout, arena));
+        CLOVE_INT_EQ(1, ax_matrix_batch_init(&b, count, k, n, dtype, AX_BATCH_PACKED, arena));
+        CLOVE_INT_EQ(1, ax_matrix_batch_init(&c, count, m, n, dtype, layout, arena));
+        for (musz q = 0; q < count; q++) {
+          for (musz i = 0; i < m; i++) {
+            for (musz j = 0; j < k; j++) ax_matrix_batch_set(&a, q, i, j, (double)((q * 7 + i * 3 + j) % 11) - 5.0);
+          }
+          for (musz i = 0; i < k; i++) {
+            for (musz j = 0; j < n; j++) ax_matrix_batch_set(&b, q, i, j, (double)((q + i * 5 + j * 2) % 7) - 3.0);
+          }
+        }
+        CLOVE_INT_EQ(1, ax_matrix_batch_multiply(&a, &b, &c));
+        double err = 0.0;
+        for (musz q = 0; q < count; q++) {
+          for (musz i = 0; i < m; i++) {
+            for (musz j = 0; j < n; j++) {
+              double want = 0.0;
+              for (musz p = 0; p < k; p++) want += ax_matrix_batch_get(&a, q, i, p) * ax_matrix_batch_get(&b, q, p, j);
+              err = fmax(err, fabs(ax_matrix_batch_get(&c, q, i, j) - want));
+            }
+          }
+        }
+        CLOVE_IS_TRUE(err == 0.0);
+      }
+    }
+  }
+
+  // In place: a = a * b
+  AxMatrixBatch a, b;
+  ax_matrix_batch_init(&a, count, 4, 4, AX_F64, AX_BATCH_PACKED, arena);
+  ax_matrix_batch_init(&b, count, 4, 4, AX_F64, AX_BATCH_PACKED, arena);
+  for (musz q = 0; q < count; q++) {
+    for (musz i = 0; i < 4; i++) {
+      for (musz j = 0; j < 4; j++) {
+        ax_matrix_batch_set(&a, q, i, j, (double)(q + i * 4 + j));
+        ax_matrix_batch_set(&b, q, i, j, i == 3 - j ? 2.0 : 0.0);
+      }
+    }
+  }
+  CLOVE_INT_EQ(1, ax_matrix_batch_multiply(&a, &b, &a));
+  CLOVE_IS_TRUE(ax_matrix_batch_get(&a, 5, 1, 0) == 2.0 * (double)(5 + 4 + 3));
+  CLOVE_IS_TRUE(ax_matrix_batch_get(&a, 36, 2, 3) == 2.0 * (double)(36 + 8));
+
+  ax_arena_destroy(arena);
+}
+
+// Runs a strided batched GEMM on a thread of its own, whose packing
+// buffers are freed as it exits
+typedef struct GemmThreadArgs {
+  const AxMatrixBatch* a;
+  const AxMatrixBatch* b;
+  AxMatrixBatch* c;
+  bool ok;
+} GemmThreadArgs;
+
+static void* gemm_thread(void* p) {
+  GemmThreadArgs* g = (GemmThreadArgs*)p;
+  g->ok = ax_matrix_gemm_strided_batched(1.0, g->a, AX_TRANS, g->b, AX_NO_TRANS, 0.0, g->c);
+  return NULL;
+}
+
+CLOVE_TEST(AxGemmBatched) {
+  Arena* arena = ax_arena_create(1 << 24);
+  // Arrays of matrices: 20 products of (96 x 300) * (300 x 80)^T-stored
+  // operands, enough packed data for several waves and two slices of k
+  musz count = 20, m = 96, k = 300, n = 80;
+  AxMatrix* a[20];
+  AxMatrix* b[20];
+  AxMatrix* c[20];
+  AxMatrix* want = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  for (musz q = 0; q < count; q++) {
+    a[q] = ax_matrix_create_dtype(m, k, AX_F64, arena);
+    b[q] = ax_matrix_create_dtype(n, k, AX_F64, arena);
+    c[q] = ax_matrix_create_dtype(m, n, AX_F64, arena);
+    ax_matrix_randn(a[q], 100 + q);
+    ax_matrix_randn(b[q], 200 + q);
+    ax_matrix_randn(c[q], 300 + q);
+  }
+  CLOVE_INT_EQ(1, ax_matrix_gemm_batched(2.0, (const AxMatrix* const*)a, AX_NO_TRANS,
+                                         (const AxMatrix* const*)b, AX_TRANS, 0.5, c, count));
+  double err = 0.0;
+  for (musz q = 0; q < count; q++) {
+    ax_matrix_randn(want, 300 + q);
+    ax_matrix_gemm(2.0, a[q], AX_NO_TRANS, b[q], AX_TRANS, 0.5, want);
+    for (musz i = 0; i < m; i++) {
+      for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(c[q], i, j) - ax_matrix_get(want, i, j)));
+    }
+  }
+  CLOVE_IS_TRUE(err < 1e-11);
+
+  // C given as transposed views (column stride != 1) takes the per-item path
+  AxMatrix cv[4];
+  AxMatrix* cp[4];
+  for (musz q = 0; q < 4; q++) {
+    AxMatrix* store = ax_matrix_create_dtype(n, m, AX_F64, arena);
+    ax_matrix_transpose_into(store, c[q]);
+    cv[q] = ax_matrix_transpose_view(store);
+    cp[q] = &cv[q];
+  }
+  CLOVE_INT_EQ(1, ax_matrix_gemm_batched(-1.0, (const AxMatrix* const*)a, AX_NO_TRANS,
+                                         (const AxMatrix* const*)b, AX_TRANS, 1.0, cp, 4));
+  err = 0.0;
+  for (musz q = 0; q < 4; q++) {
+    ax_matrix_copy(want, c[q]);
+    ax_matrix_gemm(-1.0, a[q], AX_NO_TRANS, b[q], AX_TRANS, 1.0, want);
+    for (musz i = 0; i < m; i++) {
+      for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(cp[q], i, j) - ax_matrix_get(want, i, j)));
+    }
+  }
+  CLOVE_IS_TRUE(err < 1e-11);
+
+  // Strided stacks in f32, with a transposed interleaved operand
+  musz sc = 9, sm = 40, sk = 33, sn = 50;
+  AxMatrixBatch sa, sb, sd;
+  ax_matrix_batch_init(&sa, sc, sk, sm, AX_F32, AX_BATCH_INTERLEAVED, arena);
+  ax_matrix_batch_init(&sb, sc, sk, sn, AX_F32, AX_BATCH_PACKED, arena);
+  ax_matrix_batch_init(&sd, sc, sm, sn, AX_F32, AX_BATCH_PACKED, arena);
+  for (musz q = 0; q < sc; q++) {
+    for (musz i = 0; i < sk; i++) {
+      for (musz j = 0; j < sm; j++) ax_matrix_batch_set(&sa, q, i, j, (double)((q + i * 3 + j) % 9) - 4.0);
+      for (musz j = 0; j < sn; j++) ax_matrix_batch_set(&sb, q, i, j, (double)((q * 2 + i + j * 5) % 7) - 3.0);
+    }
+  }
+  CLOVE_INT_EQ(1, ax_matrix_gemm_strided_batched(1.0, &sa, AX_TRANS, &sb, AX_NO_TRANS, 0.0, &sd));
+  err = 0.0;
+  for (musz q = 0; q < sc; q++) {
+    for (musz i = 0; i < sm; i++) {
+      for (musz j = 0; j < sn; j++) {
+        double x = 0.0;
+        for (musz p = 0; p < sk; p++) x += ax_matrix_batch_get(&sa, q, p, i) * ax_matrix_batch_get(&sb, q, p, j);
+        err = fmax(err, fabs(ax_matrix_batch_get(&sd, q, i, j) - x));
+      }
+    }
+  }
+  CLOVE_IS_TRUE(err == 0.0);
+
+  // Shutdown releases the packing buffers; the next call grows them again
+  double d0 = ax_matrix_batch_get(&sd, 8, 2, 3);
+  ax_matrix_batch_set(&sd, 8, 2, 3, 99.0);
+  ax_thread_shutdown();
+  CLOVE_INT_EQ(1, ax_matrix_gemm_strided_batched(1.0, &sa, AX_TRANS, &sb, AX_NO_TRANS, 0.0, &sd));
+  CLOVE_IS_TRUE(ax_matrix_batch_get(&sd, 8, 2, 3) == d0);
+
+  // The same product from an application thread that then exits
+  ax_matrix_batch_set(&sd, 8, 2, 3, 99.0);
+  GemmThreadArgs g = { &sa, &sb, &sd, false };
+  pthread_t th;
+  CLOVE_INT_EQ(0, pthread_create(&th, NULL, gemm_thread, &g));
+  pthread_join(th, NULL);
+  CLOVE_INT_EQ(1, g.ok);
+  CLOVE_IS_TRUE(ax_matrix_batch_get(&sd, 8, 2, 3) == d0);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxGemmFused) {
+  Arena* arena = ax_arena_create(1 << 22);
+  musz m = 37, n = 29, k = 300; // Two slices of k: the epilogue runs once
+  AxMatrix* a = ax_matrix_create_dtype(m, k, AX_F64, arena);
+  AxMatrix* b = ax_matrix_create_dtype(k, n, AX_F64, arena);
+  AxMatrix* c = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  AxMatrix* want = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  AxMatrix* res = ax_matrix_create_dtype(m, n, AX_F64, arena);
+  AxMatrix* row_bias = ax_matrix_create_dtype(1, n, AX_F64, arena);
+  AxMatrix* col_bias = ax_matrix_create_dtype(m, 1, AX_F64, arena);
+  ax_matrix_randn(a, 1);
+  ax_matrix_randn(b, 2);
+  ax_matrix_randn(res, 3);
+  ax_matrix_randn(row_bias, 4);
+  ax_matrix_randn(col_bias, 5);
+
+  // c = gelu(2 a b + 0.5 c + bias_j) + res
+  ax_matrix_randn(c, 6);
+  ax_matrix_randn(want, 6);
+  AxGemmEpilogue ep = { row_bias, AX_ACT_GELU, res };
+  CLOVE_INT_EQ(1, ax_matrix_gemm_fused(2.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.5, c, &ep));
+  ax_matrix_gemm(2.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.5, want);
+  double err = 0.0;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      double x = ax_matrix_get(want, i, j) + ax_matrix_get(row_bias, 0, j);
+      x = 0.5 * x * (1.0 + erf(x / sqrt(2.0))) + ax_matrix_get(res, i, j);
+      err = fmax(err, fabs(ax_matrix_get(c, i, j) - x));
+    }
+  }
+  CLOVE_IS_TRUE(err < 1e-12);
+
+  // Per-row bias and ReLU, no residual
+  ep = (AxGemmEpilogue){ col_bias, AX_ACT_RELU, NULL };
+  CLOVE_INT_EQ(1, ax_matrix_gemm_fused(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, c, &ep));
+  ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, want);
+  err = 0.0;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      double x = fmax(ax_matrix_get(want, i, j) + ax_matrix_get(col_bias, i, 0), 0.0);
+      err = fmax(err, fabs(ax_matrix_get(c, i, j) - x));
+    }
+  }
+  CLOVE_IS_TRUE(err < 1e-12);
+
+  // f16 result through the f32 workspace: sigmoid(a b) in (0, 1)
+  AxMatrix* af = ax_matrix_create_dtype(m, k, AX_F32, arena);
+  AxMatrix* bf = ax_matrix_create_dtype(k, n, AX_F32, arena);
+  AxMatrix* ch = ax_matrix_create_dtype(m, n, AX_F16, arena);
+  ax_matrix_copy(af, a);
+  ax_matrix_copy(bf, b);
+  ep = (AxGemmEpilogue){ NULL, AX_ACT_SIGMOID, NULL };
+  CLOVE_INT_EQ(1, ax_matrix_gemm_fused(0.05, af, AX_NO_TRANS, bf, AX_NO_TRANS, 0.0, ch, &ep));
+  ax_matrix_gemm(0.05, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, want);
+  err = 0.0;
+  for (musz i = 0; i < m; i++) {
+    for (musz j = 0; j < n; j++) {
+      err = fmax(err, fabs(ax_matrix_get(ch, i, j) - 1.0 / (1.0 + exp(-ax_matrix_get(want, i, j)))));
+    }
+  }
+  CLOVE_IS_TRUE(err < 1e-3);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxStrassen) {
+  Arena* arena = ax_arena_create(1 << 22);
+  Arena* scratch = ax_arena_create(1 << 20);
+  // Odd dimensions at every level exercise the peeling
+  musz m = 77, k = 65, n = 91;
+  for (int dt = 0; dt < 2; dt++) {
+    AxDType dtype = dt ? AX_F32 : AX_F64;
+    AxMatrix* a = ax_matrix_create_dtype(m, k, dtype, arena);
+    AxMatrix* b = ax_matrix_create_dtype(k, n, dtype, arena);
+    AxMatrix* c = ax_matrix_create_dtype(m, n, dtype, arena);
+    AxMatrix* want = ax_matrix_create_dtype(m, n, dtype, arena);
+    AxMatrix* g = ax_matrix_create_dtype(m, k, AX_F64, arena);
+    ax_matrix_randn(g, 7);
+    ax_matrix_copy(a, g);
+    AxMatrix* h = ax_matrix_create_dtype(k, n, AX_F64, arena);
+    ax_matrix_randn(h, 8);
+    ax_matrix_copy(b, h);
+    ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, want);
+    CLOVE_INT_EQ(1, ax_matrix_gemm_strassen(a, b, c, 16, dt ? NULL : scratch));
+    double err = 0.0;
+    for (musz i = 0; i < m; i++) {
+      for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_matrix_get(c, i, j) - ax_matrix_get(want, i, j)));
+    }
+    CLOVE_IS_TRUE(err < (dt ? 1e-4 : 1e-12));
+  }
+
+  // Breadth-first top levels: one on 4 threads, two on 9 (with odd half
+  // sizes, so up to 3 rows and columns are peeled), and the classical
+  // product on 100, too many threads for 49 products
+  musz pools[3] = { 4, 9, 100 };
+  for (int t = 0; t < 3; t++) {
+    ax_thread_set_count(pools[t]);
+    musz bm = 130, bk = 131, bn = 133;
+    AxMatrix* a = ax_matrix_create_dtype(bm, bk, AX_F64, arena);
+    AxMatrix* b = ax_matrix_create_dtype(bk, bn, AX_F64, arena);
+    AxMatrix* c = ax_matrix_create_dtype(bm, bn, AX_F64, arena);
+    AxMatrix* want = ax_matrix_create_dtype(bm, bn, AX_F64, arena);
+    ax_matrix_randn(a, 11);
+    ax_matrix_randn(b, 12);
+    ax_matrix_gemm(1.0, a, AX_NO_TRANS, b, AX_NO_TRANS, 0.0, want);
+    CLOVE_INT_EQ(1, ax_matrix_gemm_strassen(a, b, c, 16, NULL));
+    double err = 0.0;
+    for (musz i = 0; i < bm; i++) {
+      for (musz j = 0; j < bn; j++) err = fmax(err, fabs(ax_matrix_get(c, i, j) - ax_matrix_get(want, i, j)));
+    }
+    CLOVE_IS_TRUE(err < 1e-11);
+  }
+  ax_thread_set_count(0);
+
+  // Opt-in through ax_matrix_multiply (default dtype f32)
+  AxMatrix* a = ax_matrix_create(64, 64, arena);
+  AxMatrix* b = ax_matrix_create(64, 64, arena);
+  for (musz i = 0; i < 64; i++) {
+    for (musz j = 0; j < 64; j++) {
+      AX_MATRIX_AT(*a, i, j) = (float)((i * 3 + j) % 5) - 2.0f;
+      AX_MATRIX_AT(*b, i, j) = (float)((i + j * 7) % 3) - 1.0f;
+    }
+  }
+  AxMatrix* want = ax_matrix_multiply(a, b, arena);
+  ax_matrix_set_strassen_crossover(32);
+  AxMatrix* c = ax_matrix_multiply(a, b, arena);
+  ax_matrix_set_strassen_crossover(0);
+  // Small integers: every path is exact
+  CLOVE_IS_TRUE(memcmp(c->data, want->data, 64 * 64 * sizeof(float)) == 0);
+
+  ax_arena_destroy(scratch);
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxVector) {
+  Arena* arena = ax_arena_create(1 << 22);
+  musz m = 37, n = 53;
+  for (int dt = 0; dt < 2; dt++) {
+    AxDType dtype = dt ? AX_F32 : AX_F64;
+    double tol = dt ? 1e-4 : 1e-12;
+    AxMatrix* g = ax_matrix_create_dtype(m, n, AX_F64, arena);
+    ax_matrix_randn(g, 11);
+    AxMatrix* a = ax_matrix_create_dtype(m, n, dtype, arena);
+    ax_matrix_copy(a, g);
+    AxMatrix* w = ax_matrix_create_dtype(m, n, dtype, arena);
+    ax_matrix_randn(g, 12);
+    ax_matrix_copy(w, g);
+    AxVector xn, yn, xt, yt;
+    CLOVE_INT_EQ(1, ax_vector_init(&xn, n, dtype, arena));
+    CLOVE_INT_EQ(1, ax_vector_init(&yt, n, dtype, arena));
+    for (musz j = 0; j < n; j++) ax_vector_set(&xn, j, sin((double)j));
+
+    // Contiguous and strided (matrix column) operands, beta zero and not
+    for (int strided = 0; strided < 2; strided++) {
+      if (strided) {
+        xt = ax_matrix_col(w, 3);
+        yn = ax_matrix_col(w, 5);
+      } else {
+        CLOVE_INT_EQ(1, ax_vector_init(&xt, m, dtype, arena));
+        CLOVE_INT_EQ(1, ax_vector_init(&yn, m, dtype, arena));
+        for (musz i = 0; i < m; i++) ax_vector_set(&xt, i, cos((double)i));
+      }
+      for (int b = 0; b < 2; b++) {
+        double beta = b ? 0.5 : 0.0;
+        double want[64], err = 0.0;
+        for (musz i = 0; i < m; i++) {
+          double s = 0.0;
+          for (musz j = 0; j < n; j++) s += ax_matrix_get(a, i, j) * ax_vector_get(&xn, j);
+          want[i] = 2.0 * s + (b ? beta * ax_vector_get(&yn, i) : 0.0);
+        }
+        CLOVE_INT_EQ(1, ax_matrix_gemv(2.0, a, AX_NO_TRANS, &xn, beta, &yn));
+        for (musz i = 0; i < m; i++) err = fmax(err, fabs(ax_vector_get(&yn, i) - want[i]));
+        CLOVE_IS_TRUE(err < tol);
+
+        for (musz j = 0; j < n; j++) {
+          double s = 0.0;
+          for (musz i = 0; i < m; i++) s += ax_matrix_get(a, i, j) * ax_vector_get(&xt, i);
+          want[j] = -1.5 * s + (b ? beta * ax_vector_get(&yt, j) : 0.0);
+        }
+        CLOVE_INT_EQ(1, ax_matrix_gemv(-1.5, a, AX_TRANS, &xt, beta, &yt));
+        err = 0.0;
+        for (musz j = 0; j < n; j++) err = fmax(err, fabs(ax_vector_get(&yt, j) - want[j]));
+        CLOVE_IS_TRUE(err < tol);
+      }
+
+      // Rank-1 update through a strided x
+      AxMatrix* a0 = ax_matrix_create_dtype(m, n, dtype, arena);
+      ax_matrix_copy(a0, a);
+      CLOVE_INT_EQ(1, ax_matrix_ger(0.25, &xt, &xn, a));
+      double err = 0.0;
+      for (musz i = 0; i < m; i++) {
+        for (musz j = 0; j < n; j++) {
+          double e = ax_matrix_get(a0, i, j) + 0.25 * ax_vector_get(&xt, i) * ax_vector_get(&xn, j);
+          err = fmax(err, fabs(ax_matrix_get(a, i, j) - e));
+        }
+      }
+      CLOVE_IS_TRUE(err < tol);
+    }
+
+    // Level 1 against naive loops
+    AxVector r = ax_matrix_col(a, 2);
+    AxVector col = ax_matrix_col(w, 1);
+    double dot = 0.0, ss = 0.0;
+    for (musz j = 0; j < m; j++) dot += ax_vector_get(&r, j) * ax_vector_get(&col, j);
+    for (musz j = 0; j < m; j++) ss += ax_vector_get(&col, j) * ax_vector_get(&col, j);
+    CLOVE_IS_TRUE(fabs(ax_vector_dot(&r, &col) - dot) < tol);
+    CLOVE_IS_TRUE(fabs(ax_vector_nrm2(&col) - sqrt(ss)) < tol);
+    double c0 = ax_vector_get(&col, 0), r0 = ax_vector_get(&r, 0);
+    CLOVE_INT_EQ(1, ax_vector_axpy(3.0, &col, &r));
+    CLOVE_IS_TRUE(fabs(ax_vector_get(&r, 0) - (r0 + 3.0 * c0)) < tol);
+    CLOVE_INT_EQ(1, ax_vector_scal(-2.0, &col));
+    CLOVE_IS_TRUE(fabs(ax_vector_get(&col, 0) + 2.0 * c0) < tol);
+    AxVector row = ax_matrix_row(a, 4);
+    double rs = 0.0;
+    for (musz j = 0; j < n; j++) rs += ax_vector_get(&row, j) * ax_vector_get(&row, j);
+    CLOVE_IS_TRUE(fabs(ax_vector_nrm2(&row) - sqrt(rs)) < tol);
+  }
+
+  // Empty operands: a zero inner dimension leaves y = beta * y
+  AxMatrix* e = ax_matrix_create_dtype(3, 4, AX_F64, arena);
+  AxMatrix e30 = AX_MATRIX_SLICE(*e, AX_RANGE(0, 3), AX_RANGE(0, 0));
+  AxMatrix e03 = AX_MATRIX_SLICE(*e, AX_RANGE(0, 0), AX_RANGE(0, 3));
+  AxVector ey = ax_matrix_col(e, 3), ex = ax_matrix_row(&e30, 0), ez = ax_matrix_col(&e03, 0);
+  for (musz i = 0; i < 3; i++) ax_matrix_set(e, i, 3, (double)i + 1.0);
+  CLOVE_INT_EQ(1, ax_matrix_gemv(1.0, &e30, AX_NO_TRANS, &ex, 2.0, &ey));
+  CLOVE_FLOAT_EQ(6.0f, (float)ax_vector_get(&ey, 2));
+  CLOVE_INT_EQ(1, ax_matrix_gemv(1.0, &e03, AX_TRANS, &ez, 0.0, &ey));
+  CLOVE_FLOAT_EQ(0.0f, (float)ax_vector_get(&ey, 2));
+  CLOVE_INT_EQ(1, ax_matrix_gemv(1.0, &e30, AX_TRANS, &ey, 0.0, &ex));
+  CLOVE_INT_EQ(1, ax_matrix_ger(1.0, &ey, &ex, &e30));
+
+  // nrm2 survives squares that overflow or underflow
+  AxVector big;
+  CLOVE_INT_EQ(1, ax_vector_init(&big, 4, AX_F64, arena));
+  for (musz i = 0; i < 4; i++) ax_vector_set(&big, i, 1e300);
+  CLOVE_IS_TRUE(fabs(ax_vector_nrm2(&big) / 2e300 - 1.0) < 1e-14);
+  for (musz i = 0; i < 4; i++) ax_vector_set(&big, i, 1e-300);
+  CLOVE_IS_TRUE(fabs(ax_vector_nrm2(&big) / 2e-300 - 1.0) < 1e-14);
+
+  ax_arena_destroy(arena);
+}
+
+CLOVE_TEST(AxTensor) {
+  Arena* arena = ax_arena_create(1 << 22);
+  // t[i][j][k] = 100i + 10j + k
+  AxTensor t;
+  CLOVE_INT_EQ(1, ax_tensor_init(&t, 3, (musz[]){ 4, 5, 6 }, AX_F64, arena));
+  for (musz i = 0; i < 4; i++) {
+    for (musz j = 0; j < 5; j++) {
+      for (musz k = 0; k < 6; k++) ax_tensor_set(&t, (musz[]){ i, j, k }, 100.0 * (double)i + 10.0 * (double)j + (double)k);
+    }
+  }
+  CLOVE_INT_EQ(1, ax_tensor_is_contiguous(&t));
+
+  // Slices with steps, reversed, then permuted: values follow the indices
+  AxTensor v;
+  CLOVE_INT_EQ(1, ax_tensor_slice(&t, 2, AX_SLICE(1, AX_SLICE_NONE, 2), &v));
+  CLOVE_INT_EQ(1, ax_tensor_slice(&v, 0, AX_SLICE(AX_SLICE_NONE, AX_SLICE_NONE, -1), &v));
+  CLOVE_IS_TRUE(v.shape[2] == 3);
+  CLOVE_IS_TRUE(ax_tensor_get(&v, (musz[]){ 0, 2, 1 }) == 300.0 + 20.0 + 3.0);
+  AxTensor p;
+  CLOVE_INT_EQ(1, ax_tensor_permute(&v, (musz[]){ 2, 0, 1 }, &p));
+  CLOVE_IS_TRUE(ax_tensor_get(&p, (musz[]){ 2, 1, 4 }) == 200.0 + 40.0 + 5.0);
+  CLOVE_INT_EQ(0, ax_tensor_is_contiguous(&p));
+  CLOVE_INT_EQ(0, ax_tensor_reshape(&p, 1, (musz[]){ 60 }, &v));
+  AxTensor c;
+  CLOVE_INT_EQ(1, ax_tensor_contiguous(&p, &c, arena));
+  CLOVE_INT_EQ(1, ax_tensor_is_contiguous(&c));
+  CLOVE_INT_EQ(1, ax_tensor_reshape(&c, 2, (musz[]){ 12, 5 }, &v));
+  CLOVE_IS_TRUE(ax_tensor_get(&v, (musz[]){ 11, 1 }) == ax_tensor_get(&p, (musz[]){ 2, 3, 1 }));
+
+  // Reshape through a gap: [0::2] keeps each 5x6 block contiguous
+  CLOVE_INT_EQ(1, ax_tensor_slice(&t, 0, AX_SLICE(0, 4, 2), &v));
+  CLOVE_INT_EQ(1, ax_tensor_reshape(&v, 3, (musz[]){ 2, 1, 30 }, &v));
+  CLOVE_IS_TRUE(ax_tensor_get(&v, (musz[]){ 1, 0, 13 }) == 200.0 + 20.0 + 1.0);
+  CLOVE_INT_EQ(0, ax_tensor_reshape(&v, 1, (musz[]){ 60 }, &v));
+  CLOVE_INT_EQ(1, ax_tensor_squeeze(&v, AX_TENSOR_ALL_DIMS, &v));
+  CLOVE_IS_TRUE(v.ndim == 2);
+  CLOVE_INT_EQ(1, ax_tensor_unsqueeze(&v, 2, &v));
+  CLOVE_IS_TRUE(v.ndim == 3);
+
+  // Broadcast a 5x1 column against the transposed tensor into a 6x5x4 result
+  AxTensor col, tt, sum;
+  CLOVE_INT_EQ(1, ax_tensor_select(&t, 2, 0, &col)); // 4x5
+  CLOVE_INT_EQ(1, ax_tensor_select(&col, 0, 0, &col)); // 5: t[0][j][0] = 10j
+  CLOVE_INT_EQ(1, ax_tensor_unsqueeze(&col, 1, &col)); // 5x1
+  CLOVE_INT_EQ(1, ax_tensor_permute(&t, (musz[]){ 2, 1, 0 }, &tt));
+  CLOVE_INT_EQ(1, ax_tensor_init(&sum, 3, (musz[]){ 6, 5, 4 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_binary(&sum, &tt, &col, AX_BINARY_SUB));
+  bool ok = true;
+  for (musz k = 0; k < 6; k++) {
+    for (musz j = 0; j < 5; j++) {
+      for (musz i = 0; i < 4; i++) ok &= ax_tensor_get(&sum, (musz[]){ k, j, i }) == 100.0 * (double)i + (double)k;
+    }
+  }
+  CLOVE_IS_TRUE(ok);
+  CLOVE_INT_EQ(1, ax_tensor_scalar(&sum, &sum, 2.0, AX_BINARY_MUL));
+  CLOVE_IS_TRUE(ax_tensor_get(&sum, (musz[]){ 5, 0, 3 }) == 610.0);
+
+  // Half precision computes in f32
+  AxTensor h;
+  CLOVE_INT_EQ(1, ax_tensor_init(&h, 2, (musz[]){ 3, 7 }, AX_F16, arena));
+  CLOVE_INT_EQ(1, ax_tensor_copy(&h, &(AxTensor){ .ndim = 0, .data = &(mu16){ ax_f32_to_f16(1.5f) }, .dtype = AX_F16 }));
+  CLOVE_INT_EQ(1, ax_tensor_binary(&h, &h, &h, AX_BINARY_MUL));
+  CLOVE_IS_TRUE(ax_tensor_get(&h, (musz[]){ 2, 6 }) == 2.25);
+
+  // Reductions over a permuted 4-d view, in run and lane modes, against
+  // naive loops; outputs keep or drop the reduced dimensions
+  AxTensor x, xp;
+  musz shp[4] = { 7, 9, 11, 13 };
+  CLOVE_INT_EQ(1, ax_tensor_init(&x, 4, shp, AX_F32, arena));
+  musz n = ax_tensor_numel(&x);
+  for (musz e = 0; e < n; e++) ((mf32*)x.data)[e] = (mf32)((e * 7919) % 1000) * 0.01f - 5.0f;
+  CLOVE_INT_EQ(1, ax_tensor_permute(&x, (musz[]){ 1, 3, 0, 2 }, &xp)); // 9x13x7x11
+  musz masks[4] = { AX_TENSOR_DIM(0) | AX_TENSOR_DIM(2), AX_TENSOR_DIM(3), AX_TENSOR_DIM(1) | AX_TENSOR_DIM(3),
+                    AX_TENSOR_DIM(0) };
+  for (int m = 0; m < 4; m++) {
+    for (int keep = 0; keep < 2; keep++) {
+      musz oshape[4], ond = 0;
+      for (musz d = 0; d < 4; d++) {
+        if (!(masks[m] & AX_TENSOR_DIM(d))) {
+          oshape[ond++] = xp.shape[d];
+        } else if (keep) {
+          oshape[ond++] = 1;
+        }
+      }
+      AxTensor s, mx;
+      CLOVE_INT_EQ(1, ax_tensor_init(&s, ond, oshape, AX_F64, arena));
+      CLOVE_INT_EQ(1, ax_tensor_init(&mx, ond, oshape, AX_F32, arena));
+      CLOVE_INT_EQ(1, ax_tensor_sum(&xp, masks[m], &s));
+      CLOVE_INT_EQ(1, ax_tensor_max(&xp, masks[m], &mx));
+      double want_s[9 * 13 * 7 * 11] = { 0 }, want_m[9 * 13 * 7 * 11];
+      for (musz e = 0; e < n; e++) want_m[e] = -INFINITY;
+      musz id[4];
+      for (id[0] = 0; id[0] < 9; id[0]++) {
+        for (id[1] = 0; id[1] < 13; id[1]++) {
+          for (id[2] = 0; id[2] < 7; id[2]++) {
+            for (id[3] = 0; id[3] < 11; id[3]++) {
+              musz o = 0;
+              for (musz d = 0; d < 4; d++) {
+                if (!(masks[m] & AX_TENSOR_DIM(d))) o = o * xp.shape[d] + id[d];
+              }
+              double val = ax_tensor_get(&xp, id);
+              want_s[o] += val;
+              want_m[o] = fmax(want_m[o], val);
+            }
+          }
+        }
+      }
+      double err = 0.0;
+      musz no = ax_tensor_numel(&s);
+      for (musz o = 0; o < no; o++) {
+        err = fmax(err, fabs(((mf64*)s.data)[o] - want_s[o]));
+        err = fmax(err, fabs(((mf32*)mx.data)[o] - want_m[o]));
+      }
+      CLOVE_IS_TRUE(err < 1e-9);
+    }
+  }
+
+  // Long contiguous runs split into segments and chunks
+  AxTensor big, total, mean;
+  CLOVE_INT_EQ(1, ax_tensor_init(&big, 2, (musz[]){ 3, 100003 }, AX_F64, arena));
+  for (musz e = 0; e < 3 * 100003; e++) ((mf64*)big.data)[e] = (double)(e % 17);
+  CLOVE_INT_EQ(1, ax_tensor_init(&total, 0, NULL, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_sum(&big, AX_TENSOR_ALL_DIMS, &total));
+  double want = 0.0;
+  for (musz e = 0; e < 3 * 100003; e++) want += (double)(e % 17);
+  CLOVE_IS_TRUE(*(mf64*)total.data == want);
+  CLOVE_INT_EQ(1, ax_tensor_init(&mean, 1, (musz[]){ 3 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_mean(&big, AX_TENSOR_DIM(1), &mean));
+  want = 0.0;
+  for (musz e = 100003; e < 2 * 100003; e++) want += (double)(e % 17);
+  CLOVE_IS_TRUE(fabs(((mf64*)mean.data)[1] - want / 100003.0) < 1e-12);
+
+  ax_arena_destroy(arena);
+}
+
+// Largest difference between two equally shaped matrices, read element-wise
+static double strided_diff(const AxMatrix* a, const AxMatrix* b) {
+  double err = 0.0;
+  for (musz i = 0; i < a->rows; i++) {
+    for (musz j = 0; j < a->cols; j++) err = fmax(err, fabs(ax_matrix_get(a, i, j) - ax_matrix_get(b, i, j)));
+  }
+  return err;
+}
+
+CLOVE_TEST(AxStridedViews) {
+  Arena* arena = ax_arena_create(1 << 24);
+  // s is 300 x 290 with s[i][j] = i - 0.5 j
+  musz r = 300, c = 290;
+  AxMatrix* s = ax_matrix_create_dtype(r, c, AX_F64, arena);
+  for (musz i = 0; i < r; i++) {
+    for (musz j = 0; j < c; j++) AX_MATRIX_AT_T(mf64, *s, i, j) = (double)i - 0.5 * (double)j;
+  }
+
+  // Views address the same storage
+  AxMatrix t = ax_matrix_transpose_view(s);
+  CLOVE_IS_TRUE(t.rows == c && t.cols == r);
+  CLOVE_IS_TRUE(AX_MATRIX_AT_T(mf64, t, 7, 3) == 3.0 - 3.5);
+  AxMatrix e = AX_MATRIX_SLICE_STEP(*s, AX_RANGE(1, r), AX_RANGE(0, c), 3, 2);
+  CLOVE_IS_TRUE(e.rows == 100 && e.cols == 145);
+  CLOVE_IS_TRUE(ax_matrix_get(&e, 2, 5) == 7.0 - 5.0);
+  AxMatrix d = ax_matrix_diagonal_view(s);
+  CLOVE_IS_TRUE(d.rows == c && d.cols == 1);
+  CLOVE_IS_TRUE(ax_matrix_get(&d, 10, 0) == 5.0);
+  AxMatrix et = AX_MATRIX_SLICE(t, AX_RANGE(4, 9), AX_RANGE(2, 6));
+  CLOVE_IS_TRUE(ax_matrix_get(&et, 1, 2) == 4.0 - 2.5);
+
+  // Copies: blocked transpose, staged conversion, transposed destination
+  AxMatrix* tc = ax_matrix_create_dtype(c, r, AX_F64, arena);
+  CLOVE_INT_EQ(1, ax_matrix_copy(tc, &t));
+  CLOVE_IS_TRUE(strided_diff(tc, &t) == 0.0);
+  AxMatrix* ec = ax_matrix_create_dtype(e.rows, e.cols, AX_F32, arena);
+  CLOVE_INT_EQ(1, ax_matrix_copy(ec, &e));
+  CLOVE_IS_TRUE(strided_diff(ec, &e) == 0.0);
+  AxMatrix* back = ax_matrix_create_dtype(r, c, AX_F64, arena);
+  AxMatrix bt = ax_matrix_transpose_view(back);
+  CLOVE_INT_EQ(1, ax_matrix_copy(&bt, tc));
+  CLOVE_IS_TRUE(strided_diff(back, s) == 0.0);
+  AxMatrix* tr = ax_matrix_create_dtype(e.cols, e.rows, AX_F64, arena);
+  CLOVE_INT_EQ(1, ax_matrix_transpose_into(tr, &e));
+  AxMatrix trt = ax_matrix_transpose_view(tr);
+  CLOVE_IS_TRUE(strided_diff(&trt, &e) == 0.0);
+
+  // Broadcasting on a transposed problem and on staged column steps
+  AxMatrix* row = ax_matrix_create_dtype(1, r, AX_F64, arena);
+  for (musz j = 0; j < r; j++) ax_matrix_set(row, 0, j, (double)(j % 7));
+  AxMatrix* out = ax_matrix_create_dtype(r, c, AX_F64, arena);
+  AxMatrix ot = ax_matrix_transpose_view(out);
+  CLOVE_INT_EQ(1, ax_matrix_broadcast_into(&ot, &t, row, AX_BINARY_SUB));
+  double err = 0.0;
+  for (musz i = 0; i < c; i++) {
+    for (musz j = 0; j < r; j++) err = fmax(err, fabs(ax_matrix_get(&ot, i, j) - (ax_matrix_get(&t, i, j) - (double)(j % 7))));
+  }
+  CLOVE_IS_TRUE(err == 0.0);
+  AxMatrix* ed = ax_matrix_create_dtype(e.rows, e.cols, AX_F64, arena);
+  ax_matrix_copy(ed, &e);
+  AxMatrix* sum = ax_matrix_add(&e, ed, arena);
+  AxMatrix* twice = ax_matrix_create_dtype(e.rows, e.cols, AX_F64, arena);
+  ax_matrix_scalar_into(twice, ed, 2.0, AX_BINARY_MUL);
+  CLOVE_IS_TRUE(strided_diff(sum, twice) == 0.0);
+
+  // Reductions: a transposed view swaps the axis, column steps are staged
+  AxMatrix* got = ax_matrix_create_dtype(1, r, AX_F64, arena);
+  AxMatrix* want = ax_matrix_create_dtype(1, r, AX_F64, arena);
+  CLOVE_INT_EQ(1, ax_matrix_sum(&t, AX_AXIS_0, got));
+  CLOVE_INT_EQ(1, ax_matrix_sum(tc, AX_AXIS_0, want));
+  CLOVE_IS_TRUE(strided_diff(got, want) < 1e-9);
+  AxMatrix* m1 = ax_matrix_create_dtype(e.rows, 1, AX_F64, arena);
+  AxMatrix* m2 = ax_matrix_create_dtype(e.rows, 1, AX_F64, arena);
+  CLOVE_INT_EQ(1, ax_matrix_mean(&e, AX_AXIS_1, m1));
+  CLOVE_INT_EQ(1, ax_matrix_mean(ed, AX_AXIS_1, m2));
+  CLOVE_IS_TRUE(strided_diff(m1, m2) == 0.0);
+  musz at = 0, at_ref = 0;
+  CLOVE_INT_EQ(1, ax_matrix_argmin(&t, AX_AXIS_ALL, &at));
+  CLOVE_INT_EQ(1, ax_matrix_argmin(tc, AX_AXIS_ALL, &at_ref));
+  CLOVE_IS_TRUE(at == at_ref);
+
+  // GEMM reads op(a) from a transposed view and b from a column step, and
+  // writes c through a transposed view; compared with contiguous copies
+  for (int dt = 0; dt < 2; dt++) {
+    AxDType dtype = dt ? AX_F32 : AX_F64;
+    double tol = dt ? 1e-3 : 1e-10;
+    musz m = 70, k = 300, n = 45;
+    AxMatrix* g = ax_matrix_create_dtype(k, m, AX_F64, arena);
+    ax_matrix_randn(g, 21);
+    AxMatrix* as = ax_matrix_create_dtype(k, m, dtype, arena);
+    ax_matrix_copy(as, g);
+    AxMatrix* g2 = ax_matrix_create_dtype(k, 2 * n, AX_F64, arena);
+    ax_matrix_randn(g2, 22);
+    AxMatrix* bs = ax_matrix_create_dtype(k, 2 * n, dtype, arena);
+    ax_matrix_copy(bs, g2);
+    AxMatrix av = ax_matrix_transpose_view(as);
+    AxMatrix bv = AX_MATRIX_SLICE_STEP(*bs, AX_RANGE(0, k), AX_RANGE(1, 2 * n), 1, 2);
+    AxMatrix* ac = ax_matrix_create_dtype(m, k, dtype, arena);
+    AxMatrix* bc = ax_matrix_create_dtype(k, n, dtype, arena);
+    ax_matrix_copy(ac, &av);
+    ax_matrix_copy(bc, &bv);
+    AxMatrix* cs = ax_matrix_create_dtype(n, m, dtype, arena);
+    AxMatrix cv = ax_matrix_transpose_view(cs);
+    AxMatrix* cc = ax_matrix_create_dtype(m, n, dtype, arena);
+    for (musz i = 0; i < m; i++) {
+      for (musz j = 0; j < n; j++) {
+        ax_matrix_set(&cv, i, j, sin((double)(i + j)));
+        ax_matrix_set(cc, i, j, sin((double)(i + j)));
+      }
+    }
+    CLOVE_INT_EQ(1, ax_matrix_gemm(0.5, &av, AX_NO_TRANS, &bv, AX_NO_TRANS, 2.0, &cv));
+    CLOVE_INT_EQ(1, ax_matrix_gemm(0.5, ac, AX_NO_TRANS, bc, AX_NO_TRANS, 2.0, cc));
+    CLOVE_IS_TRUE(strided_diff(&cv, cc) < tol);
+    // op(view) = transpose of the storage: the same product as AX_TRANS
+    CLOVE_INT_EQ(1, ax_matrix_gemm(1.0, as, AX_TRANS, &bv, AX_NO_TRANS, 0.0, cc));
+    CLOVE_INT_EQ(1, ax_matrix_gemm(1.0, &av, AX_NO_TRANS, bc, AX_NO_TRANS, 0.0, &cv));
+    CLOVE_IS_TRUE(strided_diff(&cv, cc) < tol);
+
+    // GEMV and GER on the transposed view
+    AxVector x = ax_matrix_col(bc, 0);
+    AxVector y1, y2;
+    CLOVE_INT_EQ(1, ax_vector_init(&y1, m, dtype, arena));
+    CLOVE_INT_EQ(1, ax_vector_init(&y2, m, dtype, arena));
+    CLOVE_INT_EQ(1, ax_matrix_gemv(1.0, &av, AX_NO_TRANS, &x, 0.0, &y1));
+    CLOVE_INT_EQ(1, ax_matrix_gemv(1.0, ac, AX_NO_TRANS, &x, 0.0, &y2));
+    err = 0.0;
+    for (musz i = 0; i < m; i++) err = fmax(err, fabs(ax_vector_get(&y1, i) - ax_vector_get(&y2, i)));
+    CLOVE_IS_TRUE(err < tol);
+    CLOVE_INT_EQ(1, ax_matrix_ger(-1.0, &y1, &x, &av));
+    CLOVE_INT_EQ(1, ax_matrix_ger(-1.0, &y2, &x, ac));
+    CLOVE_IS_TRUE(strided_diff(&av, ac) < tol);
+  }
+
+  // In-place transpose through a transposed view and a column step
+  AxMatrix sq = AX_MATRIX_SLICE(t, AX_RANGE(0, 64), AX_RANGE(0, 64));
+  AxMatrix* sq0 = ax_matrix_create_dtype(64, 64, AX_F64, arena);
+  ax_matrix_copy(sq0, &sq);
+  CLOVE_INT_EQ(1, ax_matrix_transpose_inplace(&sq));
+  AxMatrix sqt = ax_matrix_transpose_view(sq0);
+  CLOVE_IS_TRUE(strided_diff(&sq, &sqt) == 0.0);
+  AxMatrix sqs = AX_MATRIX_SLICE_STEP(*s, AX_RANGE(0, 20), AX_RANGE(0, 40), 1, 2);
+  AxMatrix* sqs0 = ax_matrix_create_dtype(20, 20, AX_F64, arena);
+  ax_matrix_copy(sqs0, &sqs);
+  CLOVE_INT_EQ(1, ax_matrix_transpose_inplace(&sqs));
+  AxMatrix sqst = ax_matrix_transpose_view(sqs0);
+  CLOVE_IS_TRUE(strided_diff(&sqs, &sqst) == 0.0);
+
+  // Tensors hand strided 2-d views over as matrices
+  AxTensor tt = ax_tensor_from_matrix(&e);
+  CLOVE_INT_EQ(1, ax_tensor_transpose(&tt, 0, 1, &tt));
+  AxMatrix back_view;
+  CLOVE_INT_EQ(1, ax_tensor_as_matrix(&tt, &back_view));
+  AxMatrix ett = ax_matrix_transpose_view(&e);
+  CLOVE_IS_TRUE(strided_diff(&back_view, &ett) == 0.0);
+
+  // LU of a transposed view runs on a staged copy and writes the factor back;
+  // solves against it match the contiguous factor exactly
+  musz nl = 40;
+  AxMatrix* ls = ax_matrix_create_dtype(nl, nl, AX_F64, arena);
+  ax_matrix_randn(ls, 23);
+  for (musz i = 0; i < nl; i++) ax_matrix_set(ls, i, i, ax_matrix_get(ls, i, i) + (double)nl);
+  AxMatrix lv = ax_matrix_transpose_view(ls);
+  AxMatrix* lc = ax_matrix_create_dtype(nl, nl, AX_F64, arena);
+  ax_matrix_copy(lc, &lv);
+  AxLU luv, luc;
+  CLOVE_INT_EQ(1, ax_lu_factor(&lv, &luv, arena));
+  CLOVE_INT_EQ(1, ax_lu_factor(lc, &luc, arena));
+  CLOVE_IS_TRUE(luv.lu == &lv && strided_diff(&lv, lc) == 0.0);
+  CLOVE_IS_TRUE(ax_lu_det(&luv) == ax_lu_det(&luc));
+  AxMatrix* rs = ax_matrix_create_dtype(3, nl, AX_F64, arena);
+  ax_matrix_randn(rs, 24);
+  AxMatrix rv = ax_matrix_transpose_view(rs);
+  AxMatrix* rc = ax_matrix_create_dtype(nl, 3, AX_F64, arena);
+  ax_matrix_copy(rc, &rv);
+  CLOVE_INT_EQ(1, ax_lu_solve(&luv, &rv));
+  CLOVE_INT_EQ(1, ax_lu_solve(&luc, rc));
+  CLOVE_IS_TRUE(strided_diff(&rv, rc) == 0.0);
+
+  // Sparse products with column-strided dense operands: a CSR built from a
+  // transposed view, SpMV into a column step, SpMM between transposed views
+  musz sr = 30, sc = 20;
+  AxMatrix* ds = ax_matrix_create_dtype(sc, sr, AX_F64, arena);
+  for (musz i = 0; i < sc; i++) {
+    for (musz j = 0; j < sr; j++) ax_matrix_set(ds, i, j, (i * 7 + j * 3) % 5 == 0 ? (double)(i + j) - 9.5 : 0.0);
+  }
+  AxMatrix dv = ax_matrix_transpose_view(ds);
+  AxMatrix* dc = ax_matrix_create_dtype(sr, sc, AX_F64, arena);
+  ax_matrix_copy(dc, &dv);
+  AxSparseCSR spv, spc;
+  CLOVE_INT_EQ(1, ax_csr_from_dense(&spv, &dv, arena));
+  CLOVE_INT_EQ(1, ax_csr_from_dense(&spc, dc, arena));
+  CLOVE_IS_TRUE(spv.nnz == spc.nnz && !memcmp(spv.col_idx, spc.col_idx, spc.nnz * sizeof(mu32)) &&
+                !memcmp(spv.values, spc.values, spc.nnz * sizeof(mf64)));
+  AxMatrix* dense = ax_matrix_create_dtype(sc, sr, AX_F64, arena);
+  AxMatrix densev = ax_matrix_transpose_view(dense);
+  CLOVE_INT_EQ(1, ax_matrix_from_csr(&densev, &spv));
+  CLOVE_IS_TRUE(strided_diff(&densev, dc) == 0.0);
+  AxMatrix* xs = ax_matrix_create_dtype(4, sc, AX_F64, arena);
+  ax_matrix_randn(xs, 25);
+  AxMatrix xv = ax_matrix_transpose_view(xs);
+  AxMatrix* xc = ax_matrix_create_dtype(sc, 4, AX_F64, arena);
+  ax_matrix_copy(xc, &xv);
+  AxMatrix* y2 = ax_matrix_create_dtype(sr, 2, AX_F64, arena);
+  AxMatrix y2t = ax_matrix_transpose_view(y2);
+  AxMatrix yrow = AX_MATRIX_SLICE(y2t, AX_RANGE(1, 2), AX_RANGE(0, sr));
+  AxMatrix* yc = ax_matrix_create_dtype(1, sr, AX_F64, arena);
+  AxMatrix xcv = AX_MATRIX_SLICE(xv, AX_RANGE(0, sc), AX_RANGE(1, 2));
+  AxMatrix xcc = AX_MATRIX_SLICE(*xc, AX_RANGE(0, sc), AX_RANGE(1, 2));
+  CLOVE_INT_EQ(1, ax_csr_spmv(1.0, &spv, &xcv, 0.0, &yrow));
+  CLOVE_INT_EQ(1, ax_csr_spmv(1.0, &spc, &xcc, 0.0, yc));
+  CLOVE_IS_TRUE(yrow.col_stride == 2 && strided_diff(&yrow, yc) == 0.0);
+  AxMatrix* cst = ax_matrix_create_dtype(4, sr, AX_F64, arena);
+  AxMatrix cvv = ax_matrix_transpose_view(cst);
+  AxMatrix* ccc = ax_matrix_create_dtype(sr, 4, AX_F64, arena);
+  for (musz i = 0; i < sr; i++) {
+    for (musz j = 0; j < 4; j++) {
+      ax_matrix_set(&cvv, i, j, cos((double)(i * 4 + j)));
+      ax_matrix_set(ccc, i, j, cos((double)(i * 4 + j)));
+    }
+  }
+  CLOVE_INT_EQ(1, ax_csr_spmm(1.5, &spv, &xv, -0.5, &cvv));
+  CLOVE_INT_EQ(1, ax_csr_spmm(1.5, &spc, xc, -0.5, ccc));
+  CLOVE_IS_TRUE(strided_diff(&cvv, ccc) == 0.0);
+
+  // Bit matrices from and into transposed views
+  AxBitMatrix bits;
+  CLOVE_INT_EQ(1, ax_bitmatrix_init(&bits, sr, sc, arena));
+  CLOVE_INT_EQ(1, ax_bitmatrix_from_matrix(&bits, &dv));
+  int bits_ok = 1;
+  for (musz i = 0; i < sr; i++) {
+    for (musz j = 0; j < sc; j++) bits_ok &= ax_bitmatrix_get(&bits, i, j) == (ax_matrix_get(dc, i, j) != 0.0);
+  }
+  CLOVE_INT_EQ(1, bits_ok);
+  AxMatrix* bm = ax_matrix_create_dtype(sc, sr, AX_F32, arena);
+  AxMatrix bmv = ax_matrix_transpose_view(bm);
+  CLOVE_INT_EQ(1, ax_matrix_from_bitmatrix(&bmv, &bits));
+  for (musz i = 0; i < sr; i++) {
+    for (musz j = 0; j < sc; j++) bits_ok &= ax_matrix_get(&bmv, i, j) == (ax_matrix_get(dc, i, j) != 0.0 ? 1.0 : 0.0);
+  }
+  CLOVE_INT_EQ(1, bits_ok);
+
+  ax_arena_destroy(arena);
+}
+
+// Reference einsum: one loop nest over every label (explicit "->", a-z)
+static double einsum_diff(const char* spec, const AxTensor* const* ops, musz count, const AxTensor* out) {
+  musz size[26] = { 0 }, idx[26] = { 0 }, ids[8];
+  char labels[26];
+  bool seen[26] = { false };
+  musz nl = 0;
+  const char* arrow = strstr(spec, "->");
+  for (const char* p = spec; *p; p++) {
+    if (*p < 'a' || *p > 'z' || seen[*p - 'a']) continue;
+    seen[*p - 'a'] = true;
+    labels[nl++] = *p;
+  }
+  for (musz i = 0, d = 0; spec + i < arrow; i++) {
+    if (spec[i] == ',') {
+      ops++;
+      d = 0;
+      continue;
+    }
+    size[spec[i] - 'a'] = ops[0]->shape[d++];
+  }
+  ops -= count - 1;
+  musz numel = ax_tensor_numel(out);
+  double* ref = calloc(numel ? numel : 1, sizeof(double));
+  for (bool more = true; more;) {
+    double v = 1.0;
+    const char* p = spec;
+    for (musz i = 0; i < count; i++, p++) {
+      musz d = 0;
+      for (; *p != ',' && *p != '-'; p++) ids[d++] = idx[*p - 'a'];
+      v *= ax_tensor_get(ops[i], ids);
+    }
+    musz flat = 0;
+    for (p = arrow + 2; *p; p++) flat = flat * size[*p - 'a'] + idx[*p - 'a'];
+    ref[flat] += v;
+    more = false;
+    for (musz l = nl; l-- > 0 && !more;) {
+      musz q = (musz)(labels[l] - 'a');
+      more = ++idx[q] < size[q];
+      if (!more) idx[q] = 0;
+    }
+  }
+  double err = 0.0;
+  for (musz f = 0; f < numel; f++) {
+    musz r = f, d = out->ndim;
+    for (musz k = out->ndim; k-- > 0;) {
+      ids[--d] = r % out->shape[k];
+      r /= out->shape[k];
+    }
+    err = fmax(err, fabs(ax_tensor_get(out, ids) - ref[f]));
+  }
+  free(ref);
+  return err;
+}
+
+CLOVE_TEST(AxEinsum) {
+  Arena* arena = ax_arena_create(1 << 22);
+  AxTensor a, b, c, v, out;
+  CLOVE_INT_EQ(1, ax_tensor_init(&a, 2, (musz[]){ 37, 23 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_init(&b, 2, (musz[]){ 23, 29 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_init(&c, 3, (musz[]){ 3, 29, 23 }, AX_F64, arena));
+  for (musz i = 0; i < 37 * 23; i++) ((double*)a.data)[i] = sin((double)i);
+  for (musz i = 0; i < 23 * 29; i++) ((double*)b.data)[i] = cos((double)i);
+  for (musz i = 0; i < 3 * 29 * 23; i++) ((double*)c.data)[i] = sin(0.5 * (double)i);
+
+  // Matrix product against GEMM, also with a transposed operand view
+  CLOVE_INT_EQ(1, ax_tensor_init(&out, 2, (musz[]){ 37, 29 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("ij,jk->ik", (const AxTensor*[]){ &a, &b }, 2, &out, AX_EINSUM_GREEDY, NULL, arena));
+  AxMatrix ma, mb, mo;
+  ax_tensor_as_matrix(&a, &ma);
+  ax_tensor_as_matrix(&b, &mb);
+  AxMatrix* ref = ax_matrix_create_dtype(37, 29, AX_F64, arena);
+  ax_matrix_gemm(1.0, &ma, AX_NO_TRANS, &mb, AX_NO_TRANS, 0.0, ref);
+  ax_tensor_as_matrix(&out, &mo);
+  CLOVE_IS_TRUE(strided_diff(&mo, ref) < 1e-12);
+  AxTensor at;
+  ax_tensor_transpose(&a, 0, 1, &at);
+  CLOVE_INT_EQ(1, ax_einsum("ji , jk", (const AxTensor*[]){ &at, &b }, 2, &out, AX_EINSUM_OPTIMAL, NULL, NULL));
+  CLOVE_IS_TRUE(strided_diff(&mo, ref) < 1e-12);
+
+  // Batched, with the second operand read through a permuted view
+  AxTensor bt, o3;
+  ax_tensor_permute(&c, (musz[]){ 0, 2, 1 }, &bt); // 3 x 23 x 29
+  AxTensor a3;
+  ax_tensor_unsqueeze(&a, 0, &a3);
+  ax_tensor_expand(&a3, 3, (musz[]){ 3, 37, 23 }, &a3);
+  CLOVE_INT_EQ(1, ax_tensor_init(&o3, 3, (musz[]){ 3, 37, 29 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("bij,bjk->bik", (const AxTensor*[]){ &a3, &bt }, 2, &o3, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("bij,bjk->bik", (const AxTensor*[]){ &a3, &bt }, 2, &o3) < 1e-12);
+  // Output in another order, the batch label in the middle
+  CLOVE_INT_EQ(1, ax_tensor_init(&o3, 3, (musz[]){ 29, 3, 37 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("ij,bkj->kbi", (const AxTensor*[]){ &a, &c }, 2, &o3, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ij,bkj->kbi", (const AxTensor*[]){ &a, &c }, 2, &o3) < 1e-12);
+
+  // The summed group (j, k) merges in bt but not in b: b alone is copied
+  AxTensor o1;
+  CLOVE_INT_EQ(1, ax_tensor_init(&o1, 1, (musz[]){ 3 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("ijk,jk->i", (const AxTensor*[]){ &bt, &b }, 2, &o1, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ijk,jk->i", (const AxTensor*[]){ &bt, &b }, 2, &o1) < 1e-11);
+
+  // Single operands: trace, diagonal, transpose, private sums
+  AxTensor sq, s0, s1;
+  ax_tensor_slice(&b, 1, AX_SLICE(0, 23, 1), &sq);
+  CLOVE_INT_EQ(1, ax_tensor_init(&s0, 0, NULL, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_init(&s1, 1, (musz[]){ 23 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("ii->", (const AxTensor*[]){ &sq }, 1, &s0, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ii->", (const AxTensor*[]){ &sq }, 1, &s0) < 1e-12);
+  CLOVE_INT_EQ(1, ax_einsum("ii->i", (const AxTensor*[]){ &sq }, 1, &s1, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ii->i", (const AxTensor*[]){ &sq }, 1, &s1) < 1e-12);
+  CLOVE_INT_EQ(1, ax_tensor_init(&v, 2, (musz[]){ 29, 23 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("ij->ji", (const AxTensor*[]){ &b }, 1, &v, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ij->ji", (const AxTensor*[]){ &b }, 1, &v) < 1e-12);
+  CLOVE_INT_EQ(1, ax_einsum("ij,jk->j", (const AxTensor*[]){ &a, &b }, 2, &s1, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ij,jk->j", (const AxTensor*[]){ &a, &b }, 2, &s1) < 1e-11);
+
+  // Element-wise products, outer products and dots
+  CLOVE_INT_EQ(1, ax_tensor_init(&v, 2, (musz[]){ 23, 29 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_einsum("ij,ij,ij->ij", (const AxTensor*[]){ &b, &b, &b }, 3, &v, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("ij,ij,ij->ij", (const AxTensor*[]){ &b, &b, &b }, 3, &v) < 1e-12);
+  AxTensor row;
+  ax_tensor_select(&b, 0, 0, &row); // 29
+  CLOVE_INT_EQ(1, ax_einsum("i,j->ij", (const AxTensor*[]){ &s1, &row }, 2, &v, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("i,j->ij", (const AxTensor*[]){ &s1, &row }, 2, &v) < 1e-12);
+  CLOVE_INT_EQ(1, ax_einsum("i,i", (const AxTensor*[]){ &s1, &s1 }, 2, &s0, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(einsum_diff("i,i->", (const AxTensor*[]){ &s1, &s1 }, 2, &s0) < 1e-9);
+
+  // Path search: contracting the vector first costs 2 * 32^2 instead of 32^3
+  AxTensor m32, v32, o32;
+  CLOVE_INT_EQ(1, ax_tensor_init(&m32, 2, (musz[]){ 32, 32 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_init(&v32, 1, (musz[]){ 32 }, AX_F64, arena));
+  CLOVE_INT_EQ(1, ax_tensor_init(&o32, 1, (musz[]){ 32 }, AX_F64, arena));
+  for (musz i = 0; i < 32 * 32; i++) ((double*)m32.data)[i] = cos(0.1 * (double)i);
+  for (musz i = 0; i < 32; i++) ((double*)v32.data)[i] = sin((double)i);
+  for (int p = AX_EINSUM_GREEDY; p <= AX_EINSUM_OPTIMAL; p++) {
+    AxEinsumInfo info;
+    CLOVE_INT_EQ(1, ax_einsum("ab,bc,c->a", (const AxTensor*[]){ &m32, &m32, &v32 }, 3, &o32, (AxEinsumPath)p, &info, arena));
+    CLOVE_IS_TRUE(info.steps == 2 && info.pairs[0][0] == 1 && info.pairs[0][1] == 2);
+    CLOVE_IS_TRUE(info.pairs[1][0] == 0 && info.pairs[1][1] == 3);
+    CLOVE_IS_TRUE(info.flops == 2048.0 && info.naive_flops == 32768.0);
+    CLOVE_IS_TRUE(einsum_diff("ab,bc,c->a", (const AxTensor*[]){ &m32, &m32, &v32 }, 3, &o32) < 1e-9);
+  }
+  // A chain where the greedy choice is not the best order
+  AxTensor w[4], ow;
+  musz dims[5] = { 40, 2, 30, 3, 50 };
+  for (musz i = 0; i < 4; i++) {
+    CLOVE_INT_EQ(1, ax_tensor_init(&w[i], 2, (musz[]){ dims[i], dims[i + 1] }, AX_F64, arena));
+    for (musz q = 0; q < dims[i] * dims[i + 1]; q++) ((double*)w[i].data)[q] = sin((double)(q + i));
+  }
+  CLOVE_INT_EQ(1, ax_tensor_init(&ow, 2, (musz[]){ 40, 50 }, AX_F64, arena));
+  AxEinsumInfo greedy, optimal;
+  const AxTensor* chain[4] = { &w[0], &w[1], &w[2], &w[3] };
+  CLOVE_INT_EQ(1, ax_einsum_path("ab,bc,cd,de->ae", chain, 4, AX_EINSUM_GREEDY, &greedy));
+  CLOVE_INT_EQ(1, ax_einsum("ab,bc,cd,de->ae", chain, 4, &ow, AX_EINSUM_OPTIMAL, &optimal, arena));
+  CLOVE_IS_TRUE(optimal.flops <= greedy.flops && optimal.flops < optimal.naive_flops);
+  CLOVE_IS_TRUE(einsum_diff("ab,bc,cd,de->ae", chain, 4, &ow) < 1e-9);
+
+  // f32 and half precision operands compute in f32; the result converts to `out`
+  AxTensor af, bh;
+  CLOVE_INT_EQ(1, ax_tensor_init(&af, 2, (musz[]){ 37, 23 }, AX_F32, arena));
+  CLOVE_INT_EQ(1, ax_tensor_init(&bh, 2, (musz[]){ 23, 29 }, AX_F16, arena));
+  CLOVE_INT_EQ(1, ax_tensor_sum(&a, 0, &af));
+  CLOVE_INT_EQ(1, ax_tensor_sum(&b, 0, &bh));
+  CLOVE_INT_EQ(1, ax_einsum("ij,jk->ik", (const AxTensor*[]){ &af, &bh }, 2, &out, AX_EINSUM_GREEDY, NULL, arena));
+  CLOVE_IS_TRUE(strided_diff(&mo, ref) < 1e-2);
+
+  ax_arena_destroy(arena);
+}